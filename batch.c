@@ -0,0 +1,264 @@
+/*
+ * ============================================================================
+ * BATCH - Regroupement des trames UDP et envoi/réception par lots
+ * ============================================================================
+ *
+ * Voir batch.h pour la description de l'interface.
+ *
+ * ============================================================================
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE     /* sendmmsg(), recvmmsg() */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "batch.h"
+
+#ifdef __linux__
+#include <sys/uio.h>
+#endif
+
+/*
+ * Fonction batch_init()
+ * ---------------------
+ * Initialise un lot d'envoi vide.
+ *
+ * Paramètres:
+ *   b - Lot à initialiser
+ *   sock - Socket UDP d'envoi
+ *   mtu - Taille maximale d'un datagramme regroupant plusieurs trames
+ *   flush_us - Délai maximal d'attente d'une trame (0 = envoi au plus tôt)
+ *   max_datagrams - Limite de datagrammes en attente (0 = illimité)
+ */
+void batch_init(SendBatch *b, SOCKET sock, size_t mtu, uint64_t flush_us, int max_datagrams) {
+    memset(b, 0, sizeof(*b));
+    b->sock = sock;
+    b->mtu = mtu > PROTO_MAX_DATAGRAM ? PROTO_MAX_DATAGRAM : mtu;
+    b->flush_us = flush_us;
+    b->max_datagrams = max_datagrams;
+    atomic_init(&b->sent_datagrams, 0);
+    atomic_init(&b->send_errors, 0);
+}
+
+void batch_free(SendBatch *b) {
+    free(b->data);
+    free(b->dgrams);
+    b->data = NULL;
+    b->dgrams = NULL;
+    b->data_len = b->data_cap = 0;
+    b->count = b->dgrams_cap = 0;
+}
+
+/* Deux adresses IPv4 désignent-elles la même destination ? */
+static int same_destination(const BatchDatagram *d, const struct sockaddr_in *addr) {
+    return d->addr.sin_addr.s_addr == addr->sin_addr.s_addr
+        && d->addr.sin_port == addr->sin_port;
+}
+
+/*
+ * Fonction batch_add()
+ * --------------------
+ * Ajoute une trame au lot: elle est accolée au dernier datagramme s'il a
+ * la même destination et qu'il reste la place, sinon un nouveau
+ * datagramme est ouvert. Rien n'est envoyé tant que la limite de
+ * datagrammes en attente n'est pas atteinte.
+ *
+ * Retourne:
+ *   0 si la trame est acceptée,
+ *   -1 si le lot est plein et que le socket est saturé (réessayer après
+ *   un batch_flush() réussi), ou en cas d'erreur d'allocation
+ */
+int batch_add(SendBatch *b, const struct sockaddr_in *addr, socklen_t addr_len,
+              const uint8_t *frame, size_t len) {
+    BatchDatagram *last = b->count ? &b->dgrams[b->count - 1] : NULL;
+
+    if (!last || !same_destination(last, addr) || last->len + len > b->mtu) {
+        /* Nouveau datagramme: vider le lot d'abord s'il a atteint sa limite */
+        if (b->max_datagrams && b->count >= b->max_datagrams) {
+            batch_flush(b);
+            if (b->count >= b->max_datagrams) return -1;
+        }
+        if (b->count == b->dgrams_cap) {
+            int new_cap = b->dgrams_cap ? b->dgrams_cap * 2 : BATCH_IO_MAX;
+            BatchDatagram *grown = realloc(b->dgrams, (size_t)new_cap * sizeof(BatchDatagram));
+            if (!grown) return -1;
+            b->dgrams = grown;
+            b->dgrams_cap = new_cap;
+        }
+        last = &b->dgrams[b->count++];
+        last->offset = b->data_len;
+        last->len = 0;
+        last->addr = *addr;
+        last->addr_len = addr_len;
+    }
+
+    if (b->data_len + len > b->data_cap) {
+        size_t new_cap = b->data_cap ? b->data_cap : 4 * b->mtu;
+        while (new_cap < b->data_len + len) new_cap *= 2;
+        uint8_t *grown = realloc(b->data, new_cap);
+        if (!grown) {
+            if (last->len == 0) b->count--;  /* Datagramme ouvert pour rien */
+            return -1;
+        }
+        b->data = grown;
+        b->data_cap = new_cap;
+    }
+
+    if (b->data_len == 0) b->first_us = monotonic_us();
+    memcpy(b->data + b->data_len, frame, len);
+    b->data_len += len;
+    last->len += len;
+    return 0;
+}
+
+/*
+ * Fonction send_datagrams()
+ * -------------------------
+ * Envoie au plus BATCH_IO_MAX datagrammes à partir de l'index first.
+ *
+ * Retourne:
+ *   Nombre de datagrammes envoyés (> 0), 0 si le socket est saturé,
+ *   -1 en cas d'erreur sur le premier datagramme
+ */
+static int send_datagrams(SendBatch *b, int first) {
+    int k = b->count - first;
+    if (k > BATCH_IO_MAX) k = BATCH_IO_MAX;
+
+#ifdef __linux__
+    struct mmsghdr msgs[BATCH_IO_MAX];
+    struct iovec iov[BATCH_IO_MAX];
+    memset(msgs, 0, sizeof(msgs[0]) * (size_t)k);
+
+    for (int i = 0; i < k; i++) {
+        BatchDatagram *d = &b->dgrams[first + i];
+        iov[i].iov_base = b->data + d->offset;
+        iov[i].iov_len = d->len;
+        msgs[i].msg_hdr.msg_name = &d->addr;
+        msgs[i].msg_hdr.msg_namelen = d->addr_len;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int n = sendmmsg(b->sock, msgs, (unsigned int)k, 0);
+    if (n < 0) return net_would_block(errno) ? 0 : -1;
+    return n;
+#else
+    int n = 0;
+    for (; n < k; n++) {
+        BatchDatagram *d = &b->dgrams[first + n];
+        if (sendto(b->sock, (const char *)b->data + d->offset, (int)d->len, 0,
+                   (const struct sockaddr *)&d->addr, d->addr_len) == SOCKET_ERROR) {
+            if (n > 0 || net_would_block(WSAGetLastError())) break;
+            return -1;
+        }
+    }
+    return n;
+#endif
+}
+
+/*
+ * Fonction batch_flush()
+ * ----------------------
+ * Envoie tous les datagrammes en attente, par appels groupés.
+ * Un datagramme refusé par le système (autre que "would block") est
+ * abandonné, comme l'était un sendto() en échec.
+ *
+ * Retourne:
+ *   Nombre de datagrammes encore en attente (socket saturé), 0 si le lot
+ *   est vide
+ */
+int batch_flush(SendBatch *b) {
+    int sent = 0;
+    int failed = 0;
+
+    while (sent < b->count) {
+        int n = send_datagrams(b, sent);
+        if (n == 0) break;  /* Tampon d'émission plein: reprise plus tard */
+        if (n < 0) {
+            fprintf(stderr, "batch send failed: %d\n", WSAGetLastError());
+            failed++;
+            n = 1;  /* Datagramme abandonné */
+        }
+        sent += n;
+    }
+    if (sent == 0) return b->count;
+    atomic_fetch_add_explicit(&b->sent_datagrams, (uint64_t)(sent - failed), memory_order_relaxed);
+    if (failed) atomic_fetch_add_explicit(&b->send_errors, (uint64_t)failed, memory_order_relaxed);
+
+    /* Retrait des datagrammes envoyés */
+    if (sent == b->count) {
+        b->data_len = 0;
+        b->count = 0;
+        return 0;
+    }
+    size_t shift = b->dgrams[sent].offset;
+    memmove(b->data, b->data + shift, b->data_len - shift);
+    b->data_len -= shift;
+    memmove(b->dgrams, b->dgrams + sent, (size_t)(b->count - sent) * sizeof(BatchDatagram));
+    b->count -= sent;
+    for (int i = 0; i < b->count; i++) b->dgrams[i].offset -= shift;
+    return b->count;
+}
+
+/*
+ * Fonction batch_due()
+ * --------------------
+ * Indique si les trames en attente doivent partir maintenant: la plus
+ * ancienne attend depuis au moins flush_us microsecondes.
+ */
+int batch_due(const SendBatch *b, uint64_t now_us) {
+    return b->count > 0 && now_us - b->first_us >= b->flush_us;
+}
+
+/*
+ * Fonction batch_recv()
+ * ---------------------
+ * Reçoit jusqu'à BATCH_IO_MAX datagrammes déjà arrivés sur un socket non
+ * bloquant.
+ *
+ * Retourne:
+ *   Nombre de datagrammes reçus, 0 s'il n'y a rien à lire,
+ *   -1 en cas d'erreur
+ */
+int batch_recv(SOCKET sock, RecvBatch *rb) {
+#ifdef __linux__
+    struct mmsghdr msgs[BATCH_IO_MAX];
+    struct iovec iov[BATCH_IO_MAX];
+    memset(msgs, 0, sizeof(msgs));
+
+    for (int i = 0; i < BATCH_IO_MAX; i++) {
+        iov[i].iov_base = rb->bufs[i];
+        iov[i].iov_len = sizeof(rb->bufs[i]);
+        msgs[i].msg_hdr.msg_name = &rb->addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(rb->addrs[i]);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int n = recvmmsg(sock, msgs, BATCH_IO_MAX, MSG_DONTWAIT, NULL);
+    if (n < 0) return net_would_block(errno) ? 0 : -1;
+
+    for (int i = 0; i < n; i++) {
+        rb->lens[i] = msgs[i].msg_len;
+        rb->addr_lens[i] = msgs[i].msg_hdr.msg_namelen;
+    }
+    return n;
+#else
+    int n = 0;
+    for (; n < BATCH_IO_MAX; n++) {
+        rb->addr_lens[n] = sizeof(rb->addrs[n]);
+        int len = recvfrom(sock, (char *)rb->bufs[n], (int)sizeof(rb->bufs[n]), 0,
+                           (struct sockaddr *)&rb->addrs[n], &rb->addr_lens[n]);
+        if (len == SOCKET_ERROR) {
+            if (n > 0 || net_would_block(WSAGetLastError())) break;
+            return -1;
+        }
+        rb->lens[n] = (size_t)len;
+    }
+    return n;
+#endif
+}
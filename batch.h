@@ -0,0 +1,113 @@
+/*
+ * ============================================================================
+ * BATCH - Regroupement des trames UDP et envoi/réception par lots
+ * ============================================================================
+ *
+ * Description:
+ *   Envoyer un datagramme (et faire un appel système) par commande limite
+ *   fortement le débit lorsqu'un fichier contient des dizaines de milliers
+ *   de lignes. Ce module:
+ *
+ *   - regroupe plusieurs trames (protocol.h) destinées à la même adresse
+ *     dans un même datagramme, jusqu'à la taille mtu (une trame plus grande
+ *     que mtu occupe seule son datagramme);
+ *   - envoie les datagrammes accumulés avec sendmmsg() sous Linux (un seul
+ *     appel système pour BATCH_IO_MAX datagrammes), sendto() ailleurs;
+ *   - reçoit jusqu'à BATCH_IO_MAX datagrammes par appel avec recvmmsg()
+ *     sous Linux, recvfrom() ailleurs.
+ *
+ *   Le moment de l'envoi est décidé par l'appelant: batch_due() indique si
+ *   les trames en attente ont dépassé le délai de vidage (flush_us), afin
+ *   qu'une commande isolée ne soit jamais retenue plus longtemps.
+ *
+ * ============================================================================
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "net_compat.h"
+#include "protocol.h"
+
+/* Taille par défaut d'un datagramme: MTU Ethernet - en-têtes IP et UDP */
+#define BATCH_DEFAULT_MTU 1472
+
+/* Nombre maximal de datagrammes par appel sendmmsg()/recvmmsg() */
+#define BATCH_IO_MAX 32
+
+/*
+ * Structure BatchDatagram
+ * -----------------------
+ * Datagramme en attente d'envoi: plage [offset, offset + len) du tampon
+ * du lot et adresse de destination.
+ */
+typedef struct {
+    size_t offset;
+    size_t len;
+    struct sockaddr_in addr;
+    socklen_t addr_len;
+} BatchDatagram;
+
+/*
+ * Structure SendBatch
+ * -------------------
+ * Champs:
+ *   - sock: Socket UDP d'envoi
+ *   - mtu: Taille maximale d'un datagramme regroupant plusieurs trames
+ *   - flush_us: Délai maximal d'attente d'une trame avant envoi
+ *   - max_datagrams: Datagrammes en attente au-delà desquels batch_add()
+ *     refuse les trames (0 = illimité)
+ *   - data / data_len / data_cap: Octets des datagrammes en attente
+ *   - dgrams / count / dgrams_cap: Datagrammes en attente (le dernier est
+ *     encore ouvert aux nouvelles trames)
+ *   - first_us: Instant d'ajout de la plus ancienne trame en attente
+ *   - sent_datagrams / send_errors: Compteurs (écrits par le seul thread
+ *     qui envoie, lus par la page /metrics: accès atomique relâché)
+ */
+typedef struct {
+    SOCKET sock;
+    size_t mtu;
+    uint64_t flush_us;
+    int max_datagrams;
+    uint8_t *data;
+    size_t data_len;
+    size_t data_cap;
+    BatchDatagram *dgrams;
+    int count;
+    int dgrams_cap;
+    uint64_t first_us;
+    _Atomic uint64_t sent_datagrams;
+    _Atomic uint64_t send_errors;
+} SendBatch;
+
+/*
+ * Structure RecvBatch
+ * -------------------
+ * Datagrammes reçus par un appel à batch_recv().
+ *
+ * Champs:
+ *   - bufs / lens: Contenu et taille de chaque datagramme
+ *   - addrs / addr_lens: Adresse d'origine de chaque datagramme
+ */
+typedef struct {
+    uint8_t bufs[BATCH_IO_MAX][PROTO_MAX_DATAGRAM];
+    size_t lens[BATCH_IO_MAX];
+    struct sockaddr_in addrs[BATCH_IO_MAX];
+    socklen_t addr_lens[BATCH_IO_MAX];
+} RecvBatch;
+
+void batch_init(SendBatch *b, SOCKET sock, size_t mtu, uint64_t flush_us, int max_datagrams);
+void batch_free(SendBatch *b);
+
+int batch_add(SendBatch *b, const struct sockaddr_in *addr, socklen_t addr_len,
+              const uint8_t *frame, size_t len);
+int batch_flush(SendBatch *b);
+int batch_due(const SendBatch *b, uint64_t now_us);
+
+int batch_recv(SOCKET sock, RecvBatch *rb);
+
+#endif /* BATCH_H */
@@ -0,0 +1,674 @@
+/*
+ * ============================================================================
+ * BENCH - Générateur de charge et mesure de bout en bout
+ * ============================================================================
+ *
+ * Description:
+ *   Ce programme remplace N clients simultanés: il génère pour chacun un
+ *   fichier de commandes synthétique, le soumet au maître comme le ferait
+ *   client.c (MSG_SUBMIT, MSG_DATA..., MSG_END) et mesure, pour chaque
+ *   commande, le délai entre l'envoi de sa ligne et la réception de son
+ *   résultat (MSG_RESULT). Il affiche une ligne JSON:
+ *
+ *     {"label":"...","clients":4,"commands":4000,"failed":0,
+ *      "elapsed_s":1.234,"commands_per_sec":3241.5,
+ *      "latency_us":{"mean":...,"p50":...,"p99":...,"p999":...,"max":...}}
+ *
+ *   Les commandes générées varient selon:
+ *     --commands M     Nombre de commandes par client (taille du fichier)
+ *     --duration LOI   Durée de chaque commande (en ms):
+ *                        0                 aucune attente (true)
+ *                        fixed:MS          durée constante
+ *                        uniform:MIN:MAX   uniforme entre MIN et MAX
+ *                        exp:MOYENNE       exponentielle de moyenne donnée
+ *     --output OCTETS  Sortie produite par chaque commande (head -c)
+ *     --clients N      Nombre de clients simultanés
+ *     --rate R         Commandes envoyées par seconde et par client (0, par
+ *                      défaut: tout le fichier d'un coup). Avec un débit
+ *                      inférieur à la capacité des esclaves, le délai mesuré
+ *                      est celui d'une commande isolée et non l'attente en
+ *                      file derrière le reste du fichier.
+ *
+ *   Tous les clients sont servis par une seule boucle select(): le
+ *   générateur lui-même ne doit pas être le goulot d'étranglement.
+ *   Le tirage est reproductible (--seed). bench.sh lance les esclaves et le
+ *   maître sur la boucle locale et enchaîne plusieurs scénarios.
+ *
+ * Usage: bench [--clients N] [--commands M] [--duration LOI] [--output OCTETS]
+ *              [--rate R] [--seed S] [--timeout S] [--label NOM] [--host IP]
+ *              [--port P]
+ *
+ * ============================================================================
+ */
+
+/* Inclusion des bibliothèques standard */
+#include <stdio.h>      /* printf, fprintf, snprintf */
+#include <stdlib.h>     /* malloc, qsort, strtod */
+#include <string.h>     /* strcmp, strncmp, memmove */
+#include <math.h>       /* log() pour la loi exponentielle */
+
+/* Couche réseau portable (Winsock2 sous Windows, sockets POSIX ailleurs) */
+#include "net_compat.h"
+#include "protocol.h"   /* Format binaire des messages */
+
+/* ============================================================================
+ * CONSTANTES DE CONFIGURATION
+ * ============================================================================ */
+
+#define DEFAULT_HOST "127.0.0.1"  /* Adresse du serveur maître */
+#define DEFAULT_PORT 9999          /* Port TCP du serveur maître */
+#define MAX_BENCH_CLIENTS 512      /* Clients simultanés (limite de select()) */
+#define MAX_BENCH_LINE 256         /* Longueur maximale d'une commande générée */
+
+/* ============================================================================
+ * STRUCTURES DE DONNÉES
+ * ============================================================================ */
+
+/*
+ * Énumération DurationLaw
+ * -----------------------
+ * Loi de la durée des commandes générées.
+ */
+typedef enum {
+    DURATION_NONE = 0,  /* true */
+    DURATION_FIXED,     /* sleep a */
+    DURATION_UNIFORM,   /* sleep uniforme dans [a, b] */
+    DURATION_EXP        /* sleep exponentielle de moyenne a */
+} DurationLaw;
+
+/*
+ * Structure BenchConfig
+ * ---------------------
+ * Scénario demandé sur la ligne de commande.
+ *
+ * Champs:
+ *   - law / a_ms / b_ms: Loi de la durée des commandes et ses paramètres
+ *   - output_bytes: Octets écrits par chaque commande
+ *   - rate: Commandes envoyées par seconde et par client (0 = sans limite)
+ *   - duration_spec: Loi telle que saisie (reprise dans le rapport)
+ */
+typedef struct {
+    int clients;
+    long commands;
+    DurationLaw law;
+    double a_ms;
+    double b_ms;
+    long output_bytes;
+    double rate;
+    const char *duration_spec;
+    unsigned long long seed;
+    int timeout_s;
+    const char *label;
+    const char *host;
+    int port;
+} BenchConfig;
+
+/*
+ * Structure FrameReader
+ * ---------------------
+ * Découpe en trames (protocol.h) le flux TCP reçu du maître.
+ *
+ * Champs:
+ *   - buf: Données reçues non encore consommées
+ *   - len: Nombre d'octets valides dans buf
+ *   - consumed: Taille de la dernière trame rendue (retirée au prochain appel)
+ */
+typedef struct {
+    uint8_t buf[PROTO_MAX_FRAME];
+    size_t len;
+    size_t consumed;
+} FrameReader;
+
+/*
+ * Structure BenchConn
+ * -------------------
+ * Un client simulé: son fichier généré, l'état de l'envoi et les instants
+ * d'envoi de chaque ligne.
+ *
+ * Champs:
+ *   - text / text_len: Fichier de commandes généré
+ *   - line_end: Position de la fin de chaque ligne dans text
+ *   - sent_us: Instant où la trame contenant la fin de chaque ligne a été
+ *     entièrement transmise (0 = pas encore)
+ *   - text_sent: Octets du fichier entièrement transmis
+ *   - next_line: Première ligne dont l'instant d'envoi reste à noter
+ *   - allowed: Lignes dont l'envoi est permis (--rate)
+ *   - accept_us: Instant de l'acceptation par le maître
+ *   - frame / frame_len / frame_sent / chunk_len: Trame en cours d'envoi
+ *   - accepted / uploaded / done: Étapes franchies
+ */
+typedef struct {
+    SOCKET sock;
+    char *text;
+    size_t text_len;
+    size_t *line_end;
+    uint64_t *sent_us;
+    long lines;
+    size_t text_sent;
+    long next_line;
+    long allowed;
+    uint64_t accept_us;
+    uint8_t frame[PROTO_HEADER_SIZE + PROTO_MAX_CHUNK];
+    size_t frame_len;
+    size_t frame_sent;
+    size_t chunk_len;
+    int accepted;
+    int uploaded;
+    int done;
+    FrameReader reader;
+} BenchConn;
+
+/* ============================================================================
+ * VARIABLES GLOBALES
+ * ============================================================================ */
+
+uint64_t rng_state;          /* Générateur pseudo-aléatoire (xorshift64*) */
+uint64_t *latencies;         /* Délai de chaque commande terminée (µs) */
+size_t latency_count;        /* Nombre de délais mesurés */
+unsigned long long failed_commands;
+unsigned long long output_bytes_received;
+
+/* ============================================================================
+ * FONCTIONS UTILITAIRES
+ * ============================================================================ */
+
+/*
+ * Fonction random_unit()
+ * ----------------------
+ * Tire un nombre uniforme dans ]0, 1] (xorshift64*, reproductible).
+ */
+double random_unit(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    uint64_t x = rng_state * 0x2545F4914F6CDD1DULL;
+    return ((double)(x >> 11) + 1.0) / 9007199254740992.0;
+}
+
+/*
+ * Fonction parse_duration()
+ * -------------------------
+ * Lit la loi de durée des commandes (voir l'en-tête).
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 si la loi est invalide
+ */
+int parse_duration(const char *spec, BenchConfig *cfg) {
+    char *end;
+    if (strcmp(spec, "0") == 0) {
+        cfg->law = DURATION_NONE;
+        return 0;
+    }
+    if (strncmp(spec, "fixed:", 6) == 0) {
+        cfg->law = DURATION_FIXED;
+        cfg->a_ms = strtod(spec + 6, &end);
+        return *end == '\0' && cfg->a_ms >= 0 ? 0 : -1;
+    }
+    if (strncmp(spec, "uniform:", 8) == 0) {
+        cfg->law = DURATION_UNIFORM;
+        cfg->a_ms = strtod(spec + 8, &end);
+        if (*end != ':') return -1;
+        cfg->b_ms = strtod(end + 1, &end);
+        return *end == '\0' && cfg->a_ms >= 0 && cfg->b_ms >= cfg->a_ms ? 0 : -1;
+    }
+    if (strncmp(spec, "exp:", 4) == 0) {
+        cfg->law = DURATION_EXP;
+        cfg->a_ms = strtod(spec + 4, &end);
+        return *end == '\0' && cfg->a_ms > 0 ? 0 : -1;
+    }
+    return -1;
+}
+
+/*
+ * Fonction draw_duration()
+ * ------------------------
+ * Tire la durée d'une commande selon la loi du scénario.
+ *
+ * Retourne:
+ *   Durée en millisecondes
+ */
+double draw_duration(const BenchConfig *cfg) {
+    switch (cfg->law) {
+    case DURATION_FIXED:
+        return cfg->a_ms;
+    case DURATION_UNIFORM:
+        return cfg->a_ms + (cfg->b_ms - cfg->a_ms) * random_unit();
+    case DURATION_EXP:
+        return -cfg->a_ms * log(random_unit());
+    default:
+        return 0;
+    }
+}
+
+/*
+ * Fonction generate_file()
+ * ------------------------
+ * Génère le fichier de commandes d'un client: une commande par ligne,
+ * "sleep" pour la durée tirée et "head -c" pour la sortie demandée
+ * ("true" si ni l'une ni l'autre).
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 si la mémoire manque
+ */
+int generate_file(BenchConn *conn, const BenchConfig *cfg) {
+    size_t cap = (size_t)cfg->commands * 48 + 64;
+    conn->text = malloc(cap);
+    conn->line_end = malloc((size_t)cfg->commands * sizeof(size_t));
+    conn->sent_us = calloc((size_t)cfg->commands, sizeof(uint64_t));
+    if (!conn->text || !conn->line_end || !conn->sent_us) return -1;
+
+    for (long i = 0; i < cfg->commands; i++) {
+        char line[MAX_BENCH_LINE];
+        int len = 0;
+        double ms = draw_duration(cfg);
+
+        /* Sous la milliseconde, sleep ne mesurerait que son propre lancement */
+        if (ms >= 1.0) {
+            len += snprintf(line + len, sizeof(line) - (size_t)len, "sleep %.3f", ms / 1000.0);
+        }
+        if (cfg->output_bytes > 0) {
+            len += snprintf(line + len, sizeof(line) - (size_t)len, "%shead -c %ld /dev/zero",
+                            len ? "; " : "", cfg->output_bytes);
+        }
+        if (len == 0) len = snprintf(line, sizeof(line), "true");
+        line[len++] = '\n';
+
+        if (conn->text_len + (size_t)len > cap) {
+            cap *= 2;
+            char *grown = realloc(conn->text, cap);
+            if (!grown) return -1;
+            conn->text = grown;
+        }
+        memcpy(conn->text + conn->text_len, line, (size_t)len);
+        conn->text_len += (size_t)len;
+        conn->line_end[i] = conn->text_len;
+    }
+    conn->lines = cfg->commands;
+    return 0;
+}
+
+/*
+ * Fonction next_frame()
+ * ---------------------
+ * Extrait la prochaine trame complète des données déjà reçues.
+ *
+ * Retourne:
+ *   1 si une trame a été extraite, 0 s'il faut recevoir davantage,
+ *   -1 si le maître a envoyé une trame invalide
+ */
+int next_frame(FrameReader *reader, ProtoFrame *frame) {
+    reader->len -= reader->consumed;
+    memmove(reader->buf, reader->buf + reader->consumed, reader->len);
+    reader->consumed = 0;
+
+    int consumed = proto_decode(reader->buf, reader->len, frame);
+    if (consumed <= 0) return consumed;
+    reader->consumed = (size_t)consumed;
+    return 1;
+}
+
+/*
+ * Fonction upload_some()
+ * ----------------------
+ * Envoie la suite du fichier généré (MSG_DATA, puis MSG_END) jusqu'à
+ * saturation du socket ou jusqu'à la dernière ligne permise, et note l'instant d'envoi des lignes dont la
+ * trame vient d'être entièrement transmise.
+ *
+ * Retourne:
+ *   0 si l'envoi se poursuit ou est terminé, -1 en cas d'erreur
+ */
+int upload_some(BenchConn *conn) {
+    while (!conn->uploaded) {
+        if (conn->frame_sent == conn->frame_len) {
+            /* Avec --rate, seules les lignes déjà permises partent */
+            size_t limit = conn->allowed > 0 ? conn->line_end[conn->allowed - 1] : 0;
+            size_t left = limit - conn->text_sent;
+            if (left == 0 && conn->allowed < conn->lines) return 0;
+            conn->chunk_len = left < PROTO_MAX_CHUNK ? left : PROTO_MAX_CHUNK;
+            conn->frame_len = proto_encode_text(conn->frame, sizeof(conn->frame),
+                                                conn->chunk_len ? MSG_DATA : MSG_END, 0,
+                                                conn->text + conn->text_sent, conn->chunk_len);
+            conn->frame_sent = 0;
+        }
+
+        int n = send(conn->sock, (const char *)conn->frame + conn->frame_sent,
+                     (int)(conn->frame_len - conn->frame_sent), 0);
+        if (n == SOCKET_ERROR) {
+            if (net_would_block(WSAGetLastError())) return 0;
+            fprintf(stderr, "send command file failed: %d\n", WSAGetLastError());
+            return -1;
+        }
+        conn->frame_sent += (size_t)n;
+        if (conn->frame_sent < conn->frame_len) continue;
+
+        if (conn->chunk_len == 0) {
+            conn->uploaded = 1;
+            break;
+        }
+        conn->text_sent += conn->chunk_len;
+        uint64_t now = monotonic_us();
+        while (conn->next_line < conn->lines && conn->line_end[conn->next_line] <= conn->text_sent) {
+            conn->sent_us[conn->next_line++] = now;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Fonction upload_pending()
+ * -------------------------
+ * Met à jour les lignes dont l'envoi est permis et indique s'il reste
+ * quelque chose à envoyer maintenant.
+ *
+ * Retourne:
+ *   1 si le client a des données à envoyer, 0 sinon
+ */
+int upload_pending(BenchConn *conn, const BenchConfig *cfg, uint64_t now) {
+    if (!conn->accepted || conn->uploaded) return 0;
+    if (cfg->rate > 0) {
+        long allowed = (long)((double)(now - conn->accept_us) * cfg->rate / 1e6) + 1;
+        conn->allowed = allowed < conn->lines ? allowed : conn->lines;
+    } else {
+        conn->allowed = conn->lines;
+    }
+    return conn->frame_sent < conn->frame_len || conn->next_line < conn->allowed ||
+           conn->allowed == conn->lines;
+}
+
+/*
+ * Fonction handle_frame()
+ * -----------------------
+ * Traite une trame reçue du maître pour un client simulé.
+ *
+ * Retourne:
+ *   0 si la trame est attendue, -1 si le maître refuse ou signale une erreur
+ */
+int handle_frame(BenchConn *conn, const ProtoFrame *frame) {
+    ProtoResult result;
+    ProtoOutput output;
+    uint32_t total, failed;
+
+    if (frame->type == MSG_ACCEPT) {
+        conn->accepted = 1;
+        conn->accept_us = monotonic_us();
+    } else if (proto_decode_output(frame, &output) == 0) {
+        output_bytes_received += output.data_len;
+    } else if (proto_decode_result(frame, &result) == 0) {
+        if (frame->id >= 1 && frame->id <= (uint32_t)conn->lines && conn->sent_us[frame->id - 1]) {
+            latencies[latency_count++] = monotonic_us() - conn->sent_us[frame->id - 1];
+        }
+        if (result.return_code != 0) failed_commands++;
+    } else if (proto_decode_done(frame, &total, &failed) == 0) {
+        conn->done = 1;
+    } else if (frame->type == MSG_BUSY || frame->type == MSG_ERROR) {
+        fprintf(stderr, "Master %s: %.*s\n", frame->type == MSG_BUSY ? "busy" : "error",
+                (int)frame->payload_len, (const char *)frame->payload);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Fonction compare_u64()
+ * ----------------------
+ * Ordre croissant pour qsort().
+ */
+int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/*
+ * Fonction quantile()
+ * -------------------
+ * Quantile q (0 < q <= 1) des délais triés, au rang le plus proche.
+ */
+uint64_t quantile(double q) {
+    if (latency_count == 0) return 0;
+    size_t rank = (size_t)(q * (double)latency_count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > latency_count) rank = latency_count;
+    return latencies[rank - 1];
+}
+
+/* ============================================================================
+ * FONCTION PRINCIPALE
+ * ============================================================================ */
+
+/*
+ * Fonction main()
+ * ---------------
+ * Point d'entrée du générateur de charge.
+ *
+ * Paramètres:
+ *   argc - Nombre d'arguments de la ligne de commande
+ *   argv - Options du scénario (voir l'en-tête)
+ *
+ * Retourne:
+ *   0 si toutes les commandes ont reçu leur résultat, 1 sinon
+ */
+int main(int argc, char *argv[]) {
+
+    /*
+     * ÉTAPE 1: Lecture du scénario
+     * ----------------------------
+     */
+    BenchConfig cfg = {1, 1000, DURATION_NONE, 0, 0, 0, 0, "0", 1, 300, "bench", DEFAULT_HOST,
+                       DEFAULT_PORT};
+
+    for (int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--clients") == 0 && value) {
+            cfg.clients = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--commands") == 0 && value) {
+            cfg.commands = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--duration") == 0 && value) {
+            cfg.duration_spec = argv[++i];
+            if (parse_duration(cfg.duration_spec, &cfg) != 0) {
+                fprintf(stderr, "Invalid duration: %s (0, fixed:MS, uniform:MIN:MAX, exp:MEAN)\n",
+                        cfg.duration_spec);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--output") == 0 && value) {
+            cfg.output_bytes = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--rate") == 0 && value) {
+            cfg.rate = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--seed") == 0 && value) {
+            cfg.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--timeout") == 0 && value) {
+            cfg.timeout_s = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--label") == 0 && value) {
+            cfg.label = argv[++i];
+        } else if (strcmp(argv[i], "--host") == 0 && value) {
+            cfg.host = argv[++i];
+        } else if (strcmp(argv[i], "--port") == 0 && value) {
+            cfg.port = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--clients N] [--commands M] [--duration LAW] "
+                    "[--output BYTES] [--rate R] [--seed S] [--timeout S] [--label NAME] [--host IP] "
+                    "[--port P]\n", argv[0]);
+            exit(1);
+        }
+    }
+    if (cfg.clients < 1 || cfg.clients > MAX_BENCH_CLIENTS || cfg.commands < 1 ||
+        cfg.output_bytes < 0 || cfg.rate < 0 || cfg.timeout_s < 1) {
+        fprintf(stderr, "Invalid scenario: 1-%d clients, at least 1 command each\n",
+                MAX_BENCH_CLIENTS);
+        exit(1);
+    }
+
+    /*
+     * ÉTAPE 2: Génération des fichiers de commandes
+     * ---------------------------------------------
+     * Un fichier par client, tiré avant la mesure.
+     */
+    rng_state = cfg.seed ? cfg.seed : 1;
+    BenchConn *conns = calloc((size_t)cfg.clients, sizeof(BenchConn));
+    latencies = malloc((size_t)cfg.clients * (size_t)cfg.commands * sizeof(uint64_t));
+    if (!conns || !latencies) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    for (int c = 0; c < cfg.clients; c++) {
+        if (generate_file(&conns[c], &cfg) != 0) {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+    }
+
+    /*
+     * ÉTAPE 3: Connexion des clients et soumission
+     * --------------------------------------------
+     * La mesure commence avant la première connexion.
+     */
+    WSADATA wsa_data;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+        fprintf(stderr, "WSAStartup failed: %d\n", WSAGetLastError());
+        exit(1);
+    }
+#ifndef _WIN32
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    struct sockaddr_in master_addr;
+    memset(&master_addr, 0, sizeof(master_addr));
+    master_addr.sin_family = AF_INET;
+    master_addr.sin_port = htons((unsigned short)cfg.port);
+    master_addr.sin_addr.s_addr = inet_addr(cfg.host);
+
+    uint64_t start_us = monotonic_us();
+
+    for (int c = 0; c < cfg.clients; c++) {
+        BenchConn *conn = &conns[c];
+        conn->sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (conn->sock == INVALID_SOCKET ||
+            connect(conn->sock, (struct sockaddr *)&master_addr, sizeof(master_addr)) == SOCKET_ERROR) {
+            fprintf(stderr, "connect failed: %d\n", WSAGetLastError());
+            exit(1);
+        }
+
+        char name[64];
+        ProtoSubmit submit = {0, 0, name, 0};
+        submit.name_len = (size_t)snprintf(name, sizeof(name), "%s-%d", cfg.label, c + 1);
+        uint8_t frame[PROTO_HEADER_SIZE + 255];
+        size_t len = proto_encode_submit(frame, sizeof(frame), &submit);
+        if (len == 0 || send(conn->sock, (const char *)frame, (int)len, 0) == SOCKET_ERROR) {
+            fprintf(stderr, "send request failed: %d\n", WSAGetLastError());
+            exit(1);
+        }
+        net_set_nonblocking(conn->sock);
+    }
+
+    /*
+     * ÉTAPE 4: Envoi des fichiers et réception des résultats
+     * ------------------------------------------------------
+     * Une boucle select() sur tous les clients: chacun envoie son fichier
+     * une fois accepté et reçoit ses résultats en même temps.
+     */
+    int remaining = cfg.clients;
+    int failure = 0;
+    uint64_t deadline_us = start_us + (uint64_t)cfg.timeout_s * 1000000u;
+
+    while (remaining > 0 && !failure) {
+        if (monotonic_us() > deadline_us) {
+            fprintf(stderr, "Timeout: %d clients still waiting for results\n", remaining);
+            failure = 1;
+            break;
+        }
+
+        fd_set rfds, wfds;
+        FD_ZERO(&rfds);
+        FD_ZERO(&wfds);
+        SOCKET max_sock = 0;
+        int paced = 0;
+        uint64_t now = monotonic_us();
+        for (int c = 0; c < cfg.clients; c++) {
+            BenchConn *conn = &conns[c];
+            if (conn->done) continue;
+            FD_SET(conn->sock, &rfds);
+            if (upload_pending(conn, &cfg, now)) FD_SET(conn->sock, &wfds);
+            else if (conn->accepted && !conn->uploaded) paced = 1;
+            if (conn->sock > max_sock) max_sock = conn->sock;
+        }
+
+        /* Un client limité par --rate est réveillé à la milliseconde */
+        struct timeval tv = {paced ? 0 : 1, paced ? 1000 : 0};
+        if (select((int)max_sock + 1, &rfds, &wfds, NULL, &tv) == SOCKET_ERROR) {
+            if (net_would_block(WSAGetLastError())) continue;
+            fprintf(stderr, "select failed: %d\n", WSAGetLastError());
+            failure = 1;
+            break;
+        }
+
+        for (int c = 0; c < cfg.clients && !failure; c++) {
+            BenchConn *conn = &conns[c];
+            if (conn->done) continue;
+
+            if (FD_ISSET(conn->sock, &wfds) && upload_some(conn) < 0) {
+                failure = 1;
+                break;
+            }
+            if (!FD_ISSET(conn->sock, &rfds)) continue;
+
+            FrameReader *reader = &conn->reader;
+            int n = recv(conn->sock, (char *)reader->buf + reader->len,
+                         (int)(sizeof(reader->buf) - reader->len), 0);
+            if (n < 0 && net_would_block(WSAGetLastError())) continue;
+            if (n <= 0) {
+                fprintf(stderr, "Connection to master lost\n");
+                failure = 1;
+                break;
+            }
+            reader->len += (size_t)n;
+
+            ProtoFrame frame;
+            int got = 0;
+            while (!conn->done && (got = next_frame(reader, &frame)) > 0) {
+                if (handle_frame(conn, &frame) < 0) {
+                    failure = 1;
+                    break;
+                }
+            }
+            if (got < 0) {
+                fprintf(stderr, "Invalid frame from master\n");
+                failure = 1;
+            }
+            if (conn->done) {
+                closesocket(conn->sock);
+                remaining--;
+            }
+            /* Accepté pendant ce tour: l'envoi commence sans attendre le suivant */
+            if (!failure && upload_pending(conn, &cfg, monotonic_us()) && upload_some(conn) < 0) {
+                failure = 1;
+            }
+        }
+    }
+
+    uint64_t elapsed_us = monotonic_us() - start_us;
+
+    /*
+     * ÉTAPE 5: Rapport
+     * ----------------
+     * Une ligne JSON sur stdout: débit et quantiles des délais mesurés.
+     */
+    qsort(latencies, latency_count, sizeof(uint64_t), compare_u64);
+    double sum = 0;
+    for (size_t i = 0; i < latency_count; i++) sum += (double)latencies[i];
+    double elapsed_s = (double)elapsed_us / 1e6;
+
+    printf("{\"label\":\"%s\",\"clients\":%d,\"commands\":%zu,\"failed\":%llu,"
+           "\"duration\":\"%s\",\"output_bytes\":%ld,\"rate\":%.1f,\"output_received\":%llu,"
+           "\"elapsed_s\":%.3f,\"commands_per_sec\":%.1f,"
+           "\"latency_us\":{\"mean\":%.0f,\"p50\":%llu,\"p99\":%llu,\"p999\":%llu,\"max\":%llu}}\n",
+           cfg.label, cfg.clients, latency_count, failed_commands, cfg.duration_spec,
+           cfg.output_bytes, cfg.rate, output_bytes_received, elapsed_s,
+           elapsed_s > 0 ? (double)latency_count / elapsed_s : 0.0,
+           latency_count ? sum / (double)latency_count : 0.0,
+           (unsigned long long)quantile(0.50), (unsigned long long)quantile(0.99),
+           (unsigned long long)quantile(0.999),
+           (unsigned long long)(latency_count ? latencies[latency_count - 1] : 0));
+    fflush(stdout);
+
+    WSACleanup();
+    return failure || latency_count != (size_t)cfg.clients * (size_t)cfg.commands ? 1 : 0;
+}
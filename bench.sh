@@ -0,0 +1,118 @@
+#!/bin/bash
+
+# Benchmark: N slave servers and the master on loopback, driven by bench
+# with synthetic command files. Prints one JSON line per scenario on stdout.
+#
+# Usage: ./bench.sh [--slaves N] [--workers N] [--quick] [-- master options]
+#   BENCH_OUT=results.jsonl ./bench.sh     # also append the lines to a file
+
+# Get the directory where the script is located
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+cd "$SCRIPT_DIR"
+
+SLAVES=3
+WORKERS=""
+QUICK=0
+MASTER_ARGS=""
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --slaves) SLAVES=$2; shift 2 ;;
+        --workers) WORKERS="--workers $2"; shift 2 ;;
+        --quick) QUICK=1; shift ;;
+        --) shift; MASTER_ARGS="$*"; break ;;
+        *) echo "Usage: $0 [--slaves N] [--workers N] [--quick] [-- master options]" >&2; exit 1 ;;
+    esac
+done
+
+# Sources of each program (shared modules are listed explicitly)
+SLAVE_SRCS="serveur_esclave.c reactor.c executor.c builtin.c protocol.c batch.c dedup.c output.c metrics.c spsc.c logger.c"
+MASTER_SRCS="serveur_maitre.c reactor.c scheduler.c inflight.c slab.c protocol.c batch.c retry.c spsc.c sender.c deque.c dag.c journal.c cache.c fairshare.c metrics.c logger.c"
+BENCH_SRCS="bench.c protocol.c"
+
+# Returns success if the binary is missing or older than one of its sources/headers
+needs_build() {
+    local target=$1
+    shift
+    [ ! -f "$target" ] && return 0
+    for src in "$@" *.h; do
+        [ "$src" -nt "$target" ] && return 0
+    done
+    return 1
+}
+
+# Compile if needed (optimized: the numbers are only meaningful with -O2)
+if needs_build serveur_esclave $SLAVE_SRCS; then
+    echo "Compilation du serveur esclave..." >&2
+    gcc -O2 -pthread -o serveur_esclave $SLAVE_SRCS || exit 1
+fi
+if needs_build serveur_maitre $MASTER_SRCS; then
+    echo "Compilation du serveur maître..." >&2
+    gcc -O2 -pthread -o serveur_maitre $MASTER_SRCS || exit 1
+fi
+if needs_build bench $BENCH_SRCS; then
+    echo "Compilation du générateur de charge..." >&2
+    gcc -O2 -o bench $BENCH_SRCS -lm || exit 1
+fi
+
+# Servers run in a temporary directory (configuration and logs)
+WORK_DIR=$(mktemp -d)
+PIDS=""
+cleanup() {
+    [ -n "$PIDS" ] && kill $PIDS 2>/dev/null
+    wait 2>/dev/null
+    rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+trap 'exit 1' INT TERM
+
+# Start the slaves on ports 10101, 10102, ...
+for i in $(seq 1 "$SLAVES"); do
+    PORT=$((10100 + i))
+    echo "localhost $PORT" >> "$WORK_DIR/slaves.conf"
+    ./serveur_esclave $WORKERS --log-level warn $PORT > "$WORK_DIR/slave$i.log" 2>&1 &
+    PIDS="$PIDS $!"
+done
+sleep 0.5
+
+# Start the master (port 9999) with the logging of a production run
+./serveur_maitre --log-level warn $MASTER_ARGS "$WORK_DIR/slaves.conf" > "$WORK_DIR/master.log" 2>&1 &
+MASTER_PID=$!
+PIDS="$PIDS $MASTER_PID"
+sleep 0.5
+if ! kill -0 $MASTER_PID 2>/dev/null; then
+    echo "Master failed to start:" >&2
+    cat "$WORK_DIR/master.log" >&2
+    exit 1
+fi
+
+# Scenarios: label, then bench options
+if [ "$QUICK" -eq 1 ]; then
+    SCENARIOS=(
+        "dispatch-1x2000     --clients 1  --commands 2000"
+        "clients-4x500       --clients 4  --commands 500"
+        "paced-1x500         --clients 1  --commands 500  --rate 500"
+    )
+else
+    SCENARIOS=(
+        "dispatch-1x20000    --clients 1  --commands 20000"
+        "clients-16x2000     --clients 16 --commands 2000"
+        "paced-4x2000        --clients 4  --commands 2000 --rate 250"
+        "sleep5ms-8x200      --clients 8  --commands 200  --duration fixed:5"
+        "exp2ms-4x1000       --clients 4  --commands 1000 --duration exp:2"
+        "uniform-paced-4x500 --clients 4  --commands 500  --duration uniform:1:20 --rate 50"
+        "output4k-2x2000     --clients 2  --commands 2000 --output 4096"
+    )
+fi
+
+STATUS=0
+for scenario in "${SCENARIOS[@]}"; do
+    set -- $scenario
+    LABEL=$1
+    shift
+    LINE=$(./bench --label "$LABEL" "$@")
+    [ $? -ne 0 ] && STATUS=1
+    echo "$LINE"
+    [ -n "$BENCH_OUT" ] && echo "$LINE" >> "$BENCH_OUT"
+done
+
+exit $STATUS
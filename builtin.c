@@ -0,0 +1,375 @@
+/*
+ * ============================================================================
+ * BUILTIN - Commandes internes de l'esclave (sans processus fils)
+ * ============================================================================
+ *
+ * Voir builtin.h pour la description de l'interface.
+ *
+ * ============================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "builtin.h"
+#include "net_compat.h"
+
+#ifndef _WIN32
+
+#include <limits.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+/* Table du CRC POSIX de cksum (polynôme 0x04C11DB7), remplie par builtin_init() */
+static uint32_t crc_table[256];
+
+/*
+ * Fonction write_all()
+ * --------------------
+ * Écrit len octets sur fd (tube bloquant: le thread attend que le maître
+ * ait absorbé la sortie précédente, comme le ferait un processus fils).
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur (errno)
+ */
+static int write_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/* Message d'erreur "programme: texte" sur la sortie d'erreur */
+static void report(int err_fd, const char *fmt, const char *arg, int err) {
+    char msg[PATH_MAX + 128];
+    int n = snprintf(msg, sizeof(msg), fmt, arg, strerror(err));
+    if (n > 0) write_all(err_fd, msg, (size_t)n < sizeof(msg) ? (size_t)n : sizeof(msg) - 1);
+}
+
+/* ----------------------------------------------------------------------------
+ * Commandes internes
+ * ---------------------------------------------------------------------------- */
+
+static int builtin_true(int argc, char **argv, int out_fd, int err_fd) {
+    (void)argc; (void)argv; (void)out_fd; (void)err_fd;
+    return 0;
+}
+
+static int builtin_false(int argc, char **argv, int out_fd, int err_fd) {
+    (void)argc; (void)argv; (void)out_fd; (void)err_fd;
+    return 1;
+}
+
+/*
+ * Fonction builtin_echo()
+ * -----------------------
+ * echo du shell, sans option: les mots séparés par une espace, puis un
+ * saut de ligne (la commande ne contient ni guillemet ni '\': aucun
+ * échappement). -n, ou un autre premier mot en '-', est laissé au shell:
+ * son echo et celui de coreutils n'y réagissent pas de la même façon.
+ */
+static int builtin_echo(int argc, char **argv, int out_fd, int err_fd) {
+    if (argc > 1 && argv[1][0] == '-') return BUILTIN_FALLBACK;  /* -n, -e, --help... */
+
+    char line[4096];
+    size_t len = 0;
+    for (int i = 1; i < argc; i++) {
+        size_t word = strlen(argv[i]);
+        if (len + word + 2 > sizeof(line)) return BUILTIN_FALLBACK;
+        if (i > 1) line[len++] = ' ';
+        memcpy(line + len, argv[i], word);
+        len += word;
+    }
+    line[len++] = '\n';
+
+    if (write_all(out_fd, line, len) < 0) {
+        report(err_fd, "%s: write error: %s\n", "echo", errno);
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Fonction builtin_sleep()
+ * ------------------------
+ * sleep DURÉE...: attend la somme des durées. Seule la forme décimale
+ * simple est reprise (chiffres, un point, suffixe s, m, h ou d); toute
+ * autre écriture passe au vrai programme, qui l'accepte ou la refuse.
+ */
+static int builtin_sleep(int argc, char **argv, int out_fd, int err_fd) {
+    (void)out_fd;
+    (void)err_fd;
+    if (argc < 2) return BUILTIN_FALLBACK;
+
+    double total = 0;
+    for (int i = 1; i < argc; i++) {
+        const char *p = argv[i];
+        int digits = 0, dots = 0;
+        for (; (*p >= '0' && *p <= '9') || *p == '.'; p++) {
+            if (*p == '.') dots++;
+            else digits++;
+        }
+        if (digits == 0 || dots > 1) return BUILTIN_FALLBACK;
+
+        double seconds = strtod(argv[i], NULL);
+        if (*p == 'm') seconds *= 60;
+        else if (*p == 'h') seconds *= 3600;
+        else if (*p == 'd') seconds *= 86400;
+        else if (*p != 's' && *p != '\0') return BUILTIN_FALLBACK;
+        if (*p && p[1]) return BUILTIN_FALLBACK;
+        total += seconds;
+    }
+    if (total > 1e9) return BUILTIN_FALLBACK;
+
+    struct timespec left;
+    left.tv_sec = (time_t)total;
+    left.tv_nsec = (long)((total - (double)left.tv_sec) * 1e9);
+    while (nanosleep(&left, &left) < 0 && errno == EINTR) {
+        /* Reprise du temps restant */
+    }
+    return 0;
+}
+
+/*
+ * Fonction builtin_touch()
+ * ------------------------
+ * touch FICHIER...: crée le fichier s'il n'existe pas et met ses dates à
+ * l'heure courante, avec les messages de GNU touch.
+ */
+static int builtin_touch(int argc, char **argv, int out_fd, int err_fd) {
+    (void)out_fd;
+    if (argc < 2) return BUILTIN_FALLBACK;
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] == '-') return BUILTIN_FALLBACK;
+    }
+
+    int status = 0;
+    for (int i = 1; i < argc; i++) {
+        int fd = open(argv[i], O_WRONLY | O_CREAT | O_NONBLOCK | O_NOCTTY | O_CLOEXEC, 0666);
+        int open_errno = fd < 0 ? errno : 0;
+        int ok = fd >= 0 ? futimens(fd, NULL) == 0 : utimensat(AT_FDCWD, argv[i], NULL, 0) == 0;
+        int utime_errno = errno;
+        if (fd >= 0) close(fd);
+
+        if (!ok) {
+            if (open_errno) {
+                report(err_fd, "touch: cannot touch '%s': %s\n", argv[i], open_errno);
+            } else {
+                report(err_fd, "touch: setting times of '%s': %s\n", argv[i], utime_errno);
+            }
+            status = 1;
+        }
+    }
+    return status;
+}
+
+/*
+ * Fonction builtin_cp()
+ * ---------------------
+ * cp SOURCE CIBLE: copie d'un fichier ordinaire vers un fichier (créé
+ * avec les droits de la source, moins l'umask, ou vidé s'il existe) ou
+ * vers un répertoire. Tout autre cas (source absente ou spéciale, même
+ * fichier, droits insuffisants...) passe au vrai cp avant toute écriture.
+ */
+static int builtin_cp(int argc, char **argv, int out_fd, int err_fd) {
+    (void)out_fd;
+    if (argc != 3 || argv[1][0] == '-' || argv[2][0] == '-') return BUILTIN_FALLBACK;
+
+    const char *source = argv[1];
+    struct stat src_st, dst_st;
+    if (stat(source, &src_st) < 0 || !S_ISREG(src_st.st_mode)) return BUILTIN_FALLBACK;
+
+    char target[PATH_MAX];
+    if (snprintf(target, sizeof(target), "%s", argv[2]) >= (int)sizeof(target)) {
+        return BUILTIN_FALLBACK;
+    }
+    int exists = stat(target, &dst_st) == 0;
+    if (!exists && errno != ENOENT) return BUILTIN_FALLBACK;
+    if (exists && S_ISDIR(dst_st.st_mode)) {
+        const char *base = strrchr(source, '/');
+        base = base ? base + 1 : source;
+        if (snprintf(target, sizeof(target), "%s/%s", argv[2], base) >= (int)sizeof(target)) {
+            return BUILTIN_FALLBACK;
+        }
+        exists = stat(target, &dst_st) == 0;
+        if (!exists && errno != ENOENT) return BUILTIN_FALLBACK;
+    }
+    if (exists && (!S_ISREG(dst_st.st_mode) ||
+                   (dst_st.st_dev == src_st.st_dev && dst_st.st_ino == src_st.st_ino))) {
+        return BUILTIN_FALLBACK;
+    }
+
+    int in = open(source, O_RDONLY | O_CLOEXEC);
+    if (in < 0) return BUILTIN_FALLBACK;
+    int out = exists ? open(target, O_WRONLY | O_TRUNC | O_CLOEXEC)
+                     : open(target, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, src_st.st_mode & 0777);
+    if (out < 0) {
+        close(in);
+        return BUILTIN_FALLBACK;
+    }
+
+    static __thread char buf[BUILTIN_IO_CHUNK];
+    int status = 0;
+    for (;;) {
+        ssize_t n = read(in, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            report(err_fd, "cp: error reading '%s': %s\n", source, errno);
+            status = 1;
+            break;
+        }
+        if (n == 0) break;
+        if (write_all(out, buf, (size_t)n) < 0) {
+            report(err_fd, "cp: error writing '%s': %s\n", target, errno);
+            status = 1;
+            break;
+        }
+    }
+    close(in);
+    if (close(out) < 0 && status == 0) {
+        report(err_fd, "cp: failed to close '%s': %s\n", target, errno);
+        status = 1;
+    }
+    return status;
+}
+
+/*
+ * Fonction builtin_cksum()
+ * ------------------------
+ * cksum FICHIER...: "CRC taille nom" pour chaque fichier (algorithme
+ * POSIX, sortie de GNU cksum par défaut). Seuls des fichiers ordinaires
+ * existants sont repris: cksum a ses propres réponses pour un fichier
+ * absent, un répertoire ou un tube.
+ */
+static int builtin_cksum(int argc, char **argv, int out_fd, int err_fd) {
+    if (argc < 2) return BUILTIN_FALLBACK;  /* Lecture de l'entrée standard */
+    for (int i = 1; i < argc; i++) {
+        struct stat st;
+        if (argv[i][0] == '-' || stat(argv[i], &st) < 0 || !S_ISREG(st.st_mode)) {
+            return BUILTIN_FALLBACK;
+        }
+    }
+
+    static __thread unsigned char buf[BUILTIN_IO_CHUNK];
+    int status = 0;
+    for (int i = 1; i < argc; i++) {
+        int fd = open(argv[i], O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            report(err_fd, "cksum: %s: %s\n", argv[i], errno);
+            status = 1;
+            continue;
+        }
+
+        uint32_t crc = 0;
+        unsigned long long size = 0;
+        ssize_t n;
+        while ((n = read(fd, buf, sizeof(buf))) != 0) {
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            for (ssize_t k = 0; k < n; k++) crc = (crc << 8) ^ crc_table[(crc >> 24) ^ buf[k]];
+            size += (unsigned long long)n;
+        }
+        int read_errno = errno;
+        close(fd);
+        if (n < 0) {
+            report(err_fd, "cksum: %s: %s\n", argv[i], read_errno);
+            status = 1;
+            continue;
+        }
+
+        for (unsigned long long len = size; len; len >>= 8) {
+            crc = (crc << 8) ^ crc_table[(crc >> 24) ^ (len & 0xff)];
+        }
+        char line[PATH_MAX + 64];
+        int len = snprintf(line, sizeof(line), "%u %llu %s\n", (unsigned)~crc, size, argv[i]);
+        if (len < 0 || len >= (int)sizeof(line) || write_all(out_fd, line, (size_t)len) < 0) {
+            status = 1;
+        }
+    }
+    return status;
+}
+
+/* ----------------------------------------------------------------------------
+ * Registre
+ * ---------------------------------------------------------------------------- */
+
+/*
+ * Structure BuiltinEntry
+ * ----------------------
+ * Nom de commande et fonction qui l'exécute.
+ */
+typedef struct {
+    const char *name;
+    BuiltinFn fn;
+} BuiltinEntry;
+
+static const BuiltinEntry builtins[] = {
+    { "true", builtin_true },
+    { ":", builtin_true },
+    { "false", builtin_false },
+    { "echo", builtin_echo },
+    { "sleep", builtin_sleep },
+    { "touch", builtin_touch },
+    { "cp", builtin_cp },
+    { "cksum", builtin_cksum },
+    { NULL, NULL }
+};
+
+/*
+ * Fonction builtin_init()
+ * -----------------------
+ * Prépare les tables des commandes internes (avant le premier thread).
+ */
+void builtin_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i << 24;
+        for (int bit = 0; bit < 8; bit++) c = c & 0x80000000u ? (c << 1) ^ 0x04C11DB7u : c << 1;
+        crc_table[i] = c;
+    }
+}
+
+/*
+ * Fonction builtin_find()
+ * -----------------------
+ * Cherche la commande interne qui remplace une commande simple. Les mots
+ * doivent être en ASCII imprimable: les messages des programmes citent
+ * autrement les noms de fichiers selon la locale.
+ *
+ * Retourne:
+ *   La commande interne, NULL si la commande doit être lancée
+ */
+BuiltinFn builtin_find(int argc, char **argv) {
+    const BuiltinEntry *entry = builtins;
+    while (entry->name && strcmp(entry->name, argv[0]) != 0) entry++;
+    if (!entry->name) return NULL;
+
+    for (int i = 1; i < argc; i++) {
+        for (const unsigned char *p = (const unsigned char *)argv[i]; *p; p++) {
+            if (*p < 0x21 || *p > 0x7e) return NULL;
+        }
+    }
+    return entry->fn;
+}
+
+#else /* _WIN32 */
+
+/* Pas de commandes internes sous Windows: l'exécuteur utilise system() */
+void builtin_init(void) {
+}
+
+BuiltinFn builtin_find(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    return NULL;
+}
+
+#endif /* _WIN32 */
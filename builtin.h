@@ -0,0 +1,62 @@
+/*
+ * ============================================================================
+ * BUILTIN - Commandes internes de l'esclave (sans processus fils)
+ * ============================================================================
+ *
+ * Description:
+ *   Une bonne part des fichiers de commandes est faite d'opérations
+ *   triviales: echo, sleep, true, création ou copie d'un fichier, somme
+ *   de contrôle. Même lancées directement (executor.c), elles coûtent un
+ *   processus fils et un exec. Les commandes de ce registre sont exécutées
+ *   par un thread de l'exécuteur, dans le processus de l'esclave; leur
+ *   sortie passe par les mêmes tubes que celle d'un fils, et donc par le
+ *   même envoi fenêtré au maître.
+ *
+ *   Chaque commande interne reproduit le comportement observable (sortie,
+ *   messages d'erreur, code de retour) de ce qu'elle remplace: le shell
+ *   (/bin/sh) pour true, false, : et echo, qui y sont internes, GNU
+ *   coreutils pour les autres:
+ *
+ *     true, false, :     code 0 / 1 / 0
+ *     echo MOTS...       sans option (un premier mot en "-" passe au shell)
+ *     sleep DURÉE...     nombres décimaux avec suffixe s, m, h ou d facultatif
+ *     touch FICHIER...   création ou mise à jour de la date, sans option
+ *     cp SOURCE CIBLE    fichier ordinaire vers fichier ou répertoire
+ *     cksum FICHIER...   CRC POSIX, taille et nom
+ *
+ *   Dès qu'une situation sort de ce qui est reproduit à l'identique
+ *   (option, argument non ASCII, source absente pour cp...), la commande
+ *   interne répond BUILTIN_FALLBACK avant tout effet: l'exécuteur lance
+ *   alors la commande comme sans registre (par /bin/sh pour une commande
+ *   interne du shell, voir executor.c), qui produit son propre message.
+ *
+ * ============================================================================
+ */
+
+#ifndef BUILTIN_H
+#define BUILTIN_H
+
+/* Réponse d'une commande interne: la commande doit être lancée normalement */
+#define BUILTIN_FALLBACK (-1)
+
+/* Taille des blocs lus par cp et cksum */
+#define BUILTIN_IO_CHUNK 65536
+
+/*
+ * Type BuiltinFn
+ * --------------
+ * Commande interne.
+ *
+ * Paramètres:
+ *   argc / argv - Mots de la commande (argv[0] = nom)
+ *   out_fd / err_fd - Sortie standard et sortie d'erreur (bloquantes)
+ *
+ * Retourne:
+ *   Code de retour de la commande, ou BUILTIN_FALLBACK
+ */
+typedef int (*BuiltinFn)(int argc, char **argv, int out_fd, int err_fd);
+
+void builtin_init(void);
+BuiltinFn builtin_find(int argc, char **argv);
+
+#endif /* BUILTIN_H */
@@ -0,0 +1,365 @@
+/*
+ * ============================================================================
+ * CACHE - Cache des résultats des commandes déterministes (maître)
+ * ============================================================================
+ *
+ * Voir cache.h pour la syntaxe et la description de l'interface.
+ *
+ * ============================================================================
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "cache.h"
+
+/* Taille d'en-tête d'un morceau de sortie conservé (flux u16, longueur u32) */
+#define CHUNK_HEADER 6
+
+/* ============================================================================
+ * TABLE DE HACHAGE ET LISTE LRU
+ * ============================================================================ */
+
+/* Hachage FNV-1a 64 bits de la clé (commande, '\0', empreinte) */
+static uint64_t hash_key(const char *command, const char *fingerprint, size_t fingerprint_len) {
+    uint64_t h = 14695981039346656037ull;
+    for (const unsigned char *p = (const unsigned char *)command; ; p++) {
+        h ^= *p;
+        h *= 1099511628211ull;
+        if (*p == '\0') break;
+    }
+    for (size_t i = 0; i < fingerprint_len; i++) {
+        h ^= (unsigned char)fingerprint[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static void lru_unlink(ResultCache *c, CacheEntry *e) {
+    if (e->lru_prev) e->lru_prev->lru_next = e->lru_next;
+    else c->lru_head = e->lru_next;
+    if (e->lru_next) e->lru_next->lru_prev = e->lru_prev;
+    else c->lru_tail = e->lru_prev;
+    e->lru_prev = NULL;
+    e->lru_next = NULL;
+}
+
+static void lru_push_front(ResultCache *c, CacheEntry *e) {
+    e->lru_prev = NULL;
+    e->lru_next = c->lru_head;
+    if (c->lru_head) c->lru_head->lru_prev = e;
+    else c->lru_tail = e;
+    c->lru_head = e;
+}
+
+/*
+ * Fonction remove_entry()
+ * -----------------------
+ * Retire une entrée de la table (et de la liste si elle y figure) et la
+ * libère.
+ */
+static void remove_entry(ResultCache *c, CacheEntry *e) {
+    CacheEntry **link = &c->buckets[e->hash & (c->num_buckets - 1)];
+    while (*link != e) link = &(*link)->next;
+    *link = e->next;
+    c->count--;
+
+    if (e->state == CACHE_READY) {
+        lru_unlink(c, e);
+        c->bytes -= e->bytes;
+    }
+    free(e->key);
+    free(e->message);
+    free(e->output);
+    free(e->waiters);
+    free(e);
+}
+
+/*
+ * Fonction grow_table()
+ * ---------------------
+ * Double le nombre de compartiments (les entrées sont rechaînées).
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation
+ */
+static int grow_table(ResultCache *c) {
+    size_t num_buckets = c->num_buckets * 2;
+    CacheEntry **buckets = calloc(num_buckets, sizeof(CacheEntry *));
+    if (!buckets) return -1;
+
+    for (size_t i = 0; i < c->num_buckets; i++) {
+        CacheEntry *e = c->buckets[i];
+        while (e) {
+            CacheEntry *next = e->next;
+            size_t b = e->hash & (num_buckets - 1);
+            e->next = buckets[b];
+            buckets[b] = e;
+            e = next;
+        }
+    }
+    free(c->buckets);
+    c->buckets = buckets;
+    c->num_buckets = num_buckets;
+    return 0;
+}
+
+/* ============================================================================
+ * INTERFACE PUBLIQUE
+ * ============================================================================ */
+
+/*
+ * Fonction cache_init()
+ * ---------------------
+ * Paramètres:
+ *   max_bytes - Taille totale des résultats conservés
+ *   ttl_us - Durée de vie d'un résultat
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation
+ */
+int cache_init(ResultCache *c, size_t max_bytes, uint64_t ttl_us) {
+    memset(c, 0, sizeof(*c));
+    c->num_buckets = 256;
+    c->buckets = calloc(c->num_buckets, sizeof(CacheEntry *));
+    if (!c->buckets) return -1;
+    c->max_bytes = max_bytes;
+    c->ttl_us = ttl_us;
+    return 0;
+}
+
+void cache_free(ResultCache *c) {
+    for (size_t i = 0; i < c->num_buckets; i++) {
+        while (c->buckets[i]) remove_entry(c, c->buckets[i]);
+    }
+    free(c->buckets);
+    c->buckets = NULL;
+}
+
+/*
+ * Fonction cache_parse()
+ * ----------------------
+ * Reconnaît le préfixe "cache:[empreinte]" d'une commande.
+ *
+ * Paramètres:
+ *   line - Commande, éventuellement précédée du préfixe
+ *   fingerprint / fingerprint_len - Empreinte déclarée (vide si absente)
+ *
+ * Retourne:
+ *   La commande sans le préfixe, ou NULL si la ligne n'en a pas
+ */
+const char *cache_parse(const char *line, const char **fingerprint, size_t *fingerprint_len) {
+    const char *p = line;
+    while (*p == ' ' || *p == '\t') p++;
+    if (strncmp(p, "cache:", 6) != 0) return NULL;
+
+    p += 6;
+    *fingerprint = p;
+    while (*p && *p != ' ' && *p != '\t') p++;
+    *fingerprint_len = (size_t)(p - *fingerprint);
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
+}
+
+/*
+ * Fonction cache_lookup()
+ * -----------------------
+ * Cherche le résultat d'une commande. Un résultat trouvé devient le plus
+ * récemment utilisé; un résultat périmé est retiré.
+ *
+ * Retourne:
+ *   L'entrée (CACHE_READY: résultat disponible, CACHE_PENDING: commande
+ *   en cours), ou NULL si la commande n'est pas en cache
+ */
+CacheEntry *cache_lookup(ResultCache *c, const char *command, const char *fingerprint,
+                         size_t fingerprint_len, uint64_t now_us) {
+    uint64_t hash = hash_key(command, fingerprint, fingerprint_len);
+    size_t command_len = strlen(command);
+    size_t key_len = command_len + 1 + fingerprint_len;
+
+    CacheEntry *e = c->buckets[hash & (c->num_buckets - 1)];
+    while (e && !(e->hash == hash && e->key_len == key_len
+                  && memcmp(e->key, command, command_len + 1) == 0
+                  && memcmp(e->key + command_len + 1, fingerprint, fingerprint_len) == 0)) {
+        e = e->next;
+    }
+
+    if (e && e->state == CACHE_READY && now_us >= e->expires_us) {
+        remove_entry(c, e);
+        e = NULL;
+    }
+    if (!e) {
+        c->misses++;
+        return NULL;
+    }
+    if (e->state == CACHE_READY) {
+        lru_unlink(c, e);
+        lru_push_front(c, e);
+        c->hits++;
+    } else {
+        c->coalesced++;
+    }
+    return e;
+}
+
+/*
+ * Fonction cache_begin()
+ * ----------------------
+ * Crée l'entrée d'une commande qui va être exécutée (CACHE_PENDING): les
+ * demandes identiques attendront son résultat.
+ *
+ * Retourne:
+ *   L'entrée, ou NULL en cas d'erreur d'allocation (la commande s'exécute
+ *   alors sans cache)
+ */
+CacheEntry *cache_begin(ResultCache *c, const char *command, const char *fingerprint,
+                        size_t fingerprint_len) {
+    if (c->count >= c->num_buckets && grow_table(c) < 0) return NULL;
+
+    CacheEntry *e = calloc(1, sizeof(CacheEntry));
+    size_t command_len = strlen(command);
+    if (e) e->key = malloc(command_len + 1 + fingerprint_len);
+    if (!e || !e->key) {
+        free(e);
+        return NULL;
+    }
+    memcpy(e->key, command, command_len + 1);
+    memcpy(e->key + command_len + 1, fingerprint, fingerprint_len);
+    e->key_len = command_len + 1 + fingerprint_len;
+    e->hash = hash_key(command, fingerprint, fingerprint_len);
+    e->state = CACHE_PENDING;
+
+    size_t b = e->hash & (c->num_buckets - 1);
+    e->next = c->buckets[b];
+    c->buckets[b] = e;
+    c->count++;
+    return e;
+}
+
+/*
+ * Fonction cache_add_waiter()
+ * ---------------------------
+ * Inscrit une commande en attente du résultat de l'entrée (CACHE_PENDING).
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation
+ */
+int cache_add_waiter(CacheEntry *e, const CacheWaiter *waiter) {
+    if (e->num_waiters == e->waiters_cap) {
+        int cap = e->waiters_cap ? e->waiters_cap * 2 : 4;
+        CacheWaiter *waiters = realloc(e->waiters, (size_t)cap * sizeof(CacheWaiter));
+        if (!waiters) return -1;
+        e->waiters = waiters;
+        e->waiters_cap = cap;
+    }
+    e->waiters[e->num_waiters++] = *waiter;
+    return 0;
+}
+
+/*
+ * Fonction cache_append_output()
+ * ------------------------------
+ * Conserve un morceau de la sortie de la commande en cours, dans la
+ * limite de CACHE_ENTRY_MAX (au-delà, la sortie est marquée tronquée).
+ */
+void cache_append_output(CacheEntry *e, uint16_t stream, const uint8_t *data, size_t len) {
+    if (e->truncated) return;
+    size_t need = e->output_len + CHUNK_HEADER + len;
+    if (need > CACHE_ENTRY_MAX) {
+        e->truncated = 1;
+        return;
+    }
+    if (need > e->output_cap) {
+        size_t cap = e->output_cap ? e->output_cap : 1024;
+        while (cap < need) cap *= 2;
+        uint8_t *output = realloc(e->output, cap);
+        if (!output) {
+            e->truncated = 1;
+            return;
+        }
+        e->output = output;
+        e->output_cap = cap;
+    }
+
+    uint8_t *p = e->output + e->output_len;
+    p[0] = (uint8_t)stream;
+    p[1] = (uint8_t)(stream >> 8);
+    p[2] = (uint8_t)len;
+    p[3] = (uint8_t)(len >> 8);
+    p[4] = (uint8_t)(len >> 16);
+    p[5] = (uint8_t)(len >> 24);
+    memcpy(p + CHUNK_HEADER, data, len);
+    e->output_len = need;
+}
+
+/*
+ * Fonction cache_complete()
+ * -------------------------
+ * La commande de l'entrée est terminée. Ses attentes doivent avoir été
+ * servies auparavant (elles sont effacées). Le résultat est conservé si
+ * keep est vrai et qu'il tient dans les bornes (les résultats les moins
+ * récemment utilisés sont évincés pour lui faire de la place); sinon
+ * l'entrée est retirée.
+ *
+ * Paramètres:
+ *   code / duration_us / message / message_len: Résultat de la commande
+ *   keep: 0 si le résultat ne doit pas être conservé (commande perdue)
+ *   now_us: Instant présent (horloge monotone), début de la validité
+ */
+void cache_complete(ResultCache *c, CacheEntry *e, int32_t code, uint64_t duration_us,
+                    const char *message, size_t message_len, int keep, uint64_t now_us) {
+    e->num_waiters = 0;
+    size_t bytes = sizeof(CacheEntry) + e->key_len + message_len + e->output_len;
+    if (!keep || e->truncated || bytes > CACHE_ENTRY_MAX || bytes > c->max_bytes) {
+        remove_entry(c, e);
+        return;
+    }
+
+    if (message_len) {
+        e->message = malloc(message_len);
+        if (!e->message) {
+            remove_entry(c, e);
+            return;
+        }
+        memcpy(e->message, message, message_len);
+    }
+    e->message_len = message_len;
+    e->code = code;
+    e->duration_us = duration_us;
+    e->expires_us = now_us + c->ttl_us;
+    e->bytes = bytes;
+    e->state = CACHE_READY;
+    free(e->waiters);
+    e->waiters = NULL;
+    e->waiters_cap = 0;
+
+    c->bytes += bytes;
+    lru_push_front(c, e);
+    while (c->bytes > c->max_bytes && c->lru_tail != e) {
+        remove_entry(c, c->lru_tail);
+        c->evictions++;
+    }
+}
+
+/*
+ * Fonction cache_output_chunk()
+ * -----------------------------
+ * Parcourt la sortie conservée d'une entrée, morceau par morceau.
+ *
+ * Paramètres:
+ *   offset - Position du morceau (0 pour le premier)
+ *   stream / data / len - Morceau lu
+ *
+ * Retourne:
+ *   Position du morceau suivant, ou 0 s'il n'y a plus de morceau
+ */
+size_t cache_output_chunk(const CacheEntry *e, size_t offset, uint16_t *stream,
+                          const uint8_t **data, size_t *len) {
+    if (offset + CHUNK_HEADER > e->output_len) return 0;
+
+    const uint8_t *p = e->output + offset;
+    *stream = (uint16_t)(p[0] | (p[1] << 8));
+    *len = (size_t)p[2] | ((size_t)p[3] << 8) | ((size_t)p[4] << 16) | ((size_t)p[5] << 24);
+    *data = p + CHUNK_HEADER;
+    return offset + CHUNK_HEADER + *len;
+}
@@ -0,0 +1,148 @@
+/*
+ * ============================================================================
+ * CACHE - Cache des résultats des commandes déterministes (maître)
+ * ============================================================================
+ *
+ * Description:
+ *   Une ligne du fichier de commandes peut déclarer sa commande
+ *   déterministe, avec une empreinte facultative de ses entrées:
+ *
+ *     cache: sha256sum /data/big.iso
+ *     cache:<empreinte> make -C build
+ *
+ *   La clé du cache est le texte de la commande et l'empreinte (par
+ *   exemple la somme ou la date des fichiers lus): changer d'empreinte
+ *   invalide les résultats précédents. Tant que le résultat est en cache,
+ *   la commande n'est plus exécutée: son code de retour et sa sortie sont
+ *   renvoyés au client sans passer par un esclave.
+ *
+ *   Une commande déjà en cours d'exécution pour la même clé n'est pas
+ *   relancée: la demande attend son résultat (CACHE_PENDING, liste des
+ *   attentes).
+ *
+ *   Bornes: taille totale (résultats les moins récemment utilisés évincés
+ *   en premier), taille d'un résultat (au-delà, il n'est pas conservé) et
+ *   durée de vie. Un résultat inventé par le maître (commande perdue) n'est
+ *   jamais conservé.
+ *
+ *   Implémentation: table de hachage (FNV-1a 64 bits, chaînage) et liste
+ *   doublement chaînée des résultats, du plus au moins récemment utilisé.
+ *
+ * ============================================================================
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Taille maximale d'un résultat conservé (sortie comprise) */
+#define CACHE_ENTRY_MAX (1024 * 1024)
+
+/*
+ * Énumération CacheState
+ * ----------------------
+ * État d'une entrée du cache.
+ */
+typedef enum {
+    CACHE_PENDING = 0,  /* Commande en cours d'exécution */
+    CACHE_READY         /* Résultat disponible */
+} CacheState;
+
+/*
+ * Structure CacheWaiter
+ * ---------------------
+ * Commande d'un client en attente du résultat d'une commande identique
+ * en cours d'exécution (voir InflightCmd pour les champs).
+ */
+typedef struct {
+    int client_idx;
+    unsigned int client_gen;
+    unsigned int seq;
+    int dag_node;
+} CacheWaiter;
+
+/*
+ * Structure CacheEntry
+ * --------------------
+ * Champs:
+ *   - hash / key / key_len: Clé (commande, '\0', empreinte) et son hachage
+ *   - state: Voir CacheState
+ *   - code / duration_us / message / message_len: Résultat de la commande
+ *   - output / output_len / output_cap: Sortie de la commande, en
+ *     morceaux (flux u16, longueur u32, octets)
+ *   - truncated: Sortie trop volumineuse, conservée en partie seulement
+ *   - expires_us: Fin de validité du résultat (horloge monotone)
+ *   - bytes: Taille décomptée dans le cache
+ *   - waiters / num_waiters / waiters_cap: Commandes en attente du résultat
+ *   - next: Chaînage de la table de hachage
+ *   - lru_prev / lru_next: Liste des résultats (CACHE_READY uniquement)
+ */
+typedef struct CacheEntry {
+    uint64_t hash;
+    char *key;
+    size_t key_len;
+    CacheState state;
+    int32_t code;
+    uint64_t duration_us;
+    char *message;
+    size_t message_len;
+    uint8_t *output;
+    size_t output_len;
+    size_t output_cap;
+    int truncated;
+    uint64_t expires_us;
+    size_t bytes;
+    CacheWaiter *waiters;
+    int num_waiters;
+    int waiters_cap;
+    struct CacheEntry *next;
+    struct CacheEntry *lru_prev;
+    struct CacheEntry *lru_next;
+} CacheEntry;
+
+/*
+ * Structure ResultCache
+ * ---------------------
+ * Champs:
+ *   - buckets / num_buckets: Table de hachage (taille puissance de 2)
+ *   - count: Nombre d'entrées (en cours ou disponibles)
+ *   - lru_head / lru_tail: Résultat le plus / le moins récemment utilisé
+ *   - bytes / max_bytes: Taille des résultats conservés, et sa borne
+ *   - ttl_us: Durée de vie d'un résultat
+ *   - hits / misses / coalesced / evictions: Statistiques
+ */
+typedef struct {
+    CacheEntry **buckets;
+    size_t num_buckets;
+    size_t count;
+    CacheEntry *lru_head;
+    CacheEntry *lru_tail;
+    size_t bytes;
+    size_t max_bytes;
+    uint64_t ttl_us;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t coalesced;
+    uint64_t evictions;
+} ResultCache;
+
+int cache_init(ResultCache *c, size_t max_bytes, uint64_t ttl_us);
+void cache_free(ResultCache *c);
+
+const char *cache_parse(const char *line, const char **fingerprint, size_t *fingerprint_len);
+
+CacheEntry *cache_lookup(ResultCache *c, const char *command, const char *fingerprint,
+                         size_t fingerprint_len, uint64_t now_us);
+CacheEntry *cache_begin(ResultCache *c, const char *command, const char *fingerprint,
+                        size_t fingerprint_len);
+int cache_add_waiter(CacheEntry *e, const CacheWaiter *waiter);
+void cache_append_output(CacheEntry *e, uint16_t stream, const uint8_t *data, size_t len);
+void cache_complete(ResultCache *c, CacheEntry *e, int32_t code, uint64_t duration_us,
+                    const char *message, size_t message_len, int keep, uint64_t now_us);
+
+size_t cache_output_chunk(const CacheEntry *e, size_t offset, uint16_t *stream,
+                          const uint8_t **data, size_t *len);
+
+#endif /* CACHE_H */
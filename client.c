@@ -13,12 +13,20 @@
  * Fonctionnement:
  *   1. Le client ouvre le fichier de commandes spécifié en argument
  *   2. Il se connecte au serveur maître via TCP (port 9999)
- *   3. Il envoie le nom du fichier de commandes au maître
- *   4. Il attend la confirmation "OK" du maître
- *   5. Il attend que les commandes soient exécutées (3 secondes)
- *   6. Il se déconnecte proprement
+ *   3. Il annonce le fichier de commandes au maître (MSG_SUBMIT)
+ *   4. Il attend la confirmation MSG_ACCEPT du maître (MSG_BUSY: maître
+ *      saturé, soumission à renouveler plus tard)
+ *   5. Il envoie le contenu du fichier par morceaux (MSG_DATA, puis
+ *      MSG_END) et, en même temps, affiche la sortie (MSG_OUTPUT) puis le
+ *      résultat (MSG_RESULT) de chaque commande dès que le maître les
+ *      retransmet: le maître distribue les premières lignes avant même
+ *      d'avoir reçu la fin du fichier
+ *   6. Il se déconnecte dès réception du bilan MSG_DONE
  *
- * Usage: client.exe <fichier_commandes>
+ *   Les messages sont des trames binaires décrites dans protocol.h.
+ *
+ * Usage: client.exe [--priority 0-9] [--deadline MS] [--log-level NIVEAU]
+ *                   [--log-format text|json] <fichier_commandes>
  *   Exemple: client.exe test_commands.txt
  *
  * ============================================================================
@@ -29,12 +37,10 @@
 #include <stdlib.h>     /* Pour exit(), atoi() et autres fonctions utilitaires */
 #include <string.h>     /* Pour les fonctions de manipulation de chaînes (strlen, strncmp, etc.) */
 
-/* Inclusion des bibliothèques Windows Socket (Winsock2) */
-#include <winsock2.h>   /* API principale Windows Socket version 2 */
-#include <ws2tcpip.h>   /* Fonctions supplémentaires TCP/IP (inet_addr, etc.) */
-
-/* Directive pour lier automatiquement la bibliothèque Winsock */
-#pragma comment(lib, "ws2_32.lib")
+/* Couche réseau portable (Winsock2 sous Windows, sockets POSIX ailleurs) */
+#include "net_compat.h"
+#include "protocol.h"   /* Format binaire des messages */
+#include "logger.h"     /* Journalisation asynchrone */
 
 /* ============================================================================
  * CONSTANTES DE CONFIGURATION
@@ -42,24 +48,137 @@
 
 #define MASTER_HOST "127.0.0.1"  /* Adresse IP du serveur maître (localhost) */
 #define MASTER_PORT 9999          /* Port TCP du serveur maître */
-#define MAX_CMD_LEN 1024          /* Longueur maximale d'une commande */
 
 /* ============================================================================
  * STRUCTURES DE DONNÉES
  * ============================================================================ */
 
 /*
- * Structure CommandResult
- * -----------------------
- * Représente le résultat d'une commande exécutée par un esclave.
- * Note: Cette structure n'est pas utilisée activement dans ce client,
- * mais est définie pour la compatibilité avec le protocole.
+ * Structure FrameReader
+ * ---------------------
+ * Découpe en trames (protocol.h) le flux TCP reçu du maître. Un appel à
+ * recv() peut contenir plusieurs trames, ou seulement une partie d'une trame.
+ *
+ * Champs:
+ *   - buf: Données reçues non encore consommées
+ *   - len: Nombre d'octets valides dans buf
+ *   - consumed: Taille de la dernière trame rendue (retirée au prochain appel)
+ */
+typedef struct {
+    uint8_t buf[PROTO_MAX_FRAME];
+    size_t len;
+    size_t consumed;
+} FrameReader;
+
+/*
+ * Structure Upload
+ * ----------------
+ * Envoi du fichier de commandes au maître, morceau par morceau, sur un
+ * socket non bloquant.
+ *
+ * Champs:
+ *   - fp: Fichier de commandes
+ *   - frame / len: Trame en cours d'envoi (MSG_DATA ou MSG_END)
+ *   - sent: Octets de la trame déjà envoyés
+ *   - bytes: Octets du fichier lus jusqu'ici
+ *   - at_end: 1 si la trame en cours est MSG_END
+ *   - finished: 1 une fois la trame MSG_END entièrement envoyée
  */
 typedef struct {
-    char command[MAX_CMD_LEN];  /* La commande qui a été exécutée */
-    int return_code;            /* Code de retour de la commande (0 = succès) */
-    char result[256];           /* Message décrivant le résultat */
-} CommandResult;
+    FILE *fp;
+    uint8_t frame[PROTO_HEADER_SIZE + PROTO_MAX_CHUNK];
+    size_t len;
+    size_t sent;
+    unsigned long long bytes;
+    int at_end;
+    int finished;
+} Upload;
+
+/* ============================================================================
+ * FONCTIONS UTILITAIRES
+ * ============================================================================ */
+
+/*
+ * Fonction next_frame()
+ * ---------------------
+ * Extrait la prochaine trame complète des données déjà reçues.
+ *
+ * Paramètres:
+ *   reader - Tampon de découpage
+ *   frame - Trame extraite (valide jusqu'au prochain appel)
+ *
+ * Retourne:
+ *   1 si une trame a été extraite, 0 s'il faut recevoir davantage,
+ *   -1 si le maître a envoyé une trame invalide
+ */
+int next_frame(FrameReader *reader, ProtoFrame *frame) {
+    /* Retrait de la trame rendue lors de l'appel précédent */
+    reader->len -= reader->consumed;
+    memmove(reader->buf, reader->buf + reader->consumed, reader->len);
+    reader->consumed = 0;
+
+    int consumed = proto_decode(reader->buf, reader->len, frame);
+    if (consumed <= 0) return consumed;
+    reader->consumed = (size_t)consumed;
+    return 1;
+}
+
+/*
+ * Fonction fill_reader()
+ * ----------------------
+ * Reçoit les données disponibles sur le socket dans le tampon de découpage.
+ *
+ * Retourne:
+ *   Nombre d'octets reçus (> 0), 0 si le socket non bloquant n'a rien à
+ *   lire, -1 si la connexion est fermée ou en erreur
+ */
+int fill_reader(SOCKET sock, FrameReader *reader) {
+    int n = recv(sock, (char *)reader->buf + reader->len,
+                 (int)(sizeof(reader->buf) - reader->len), 0);
+    if (n < 0 && net_would_block(WSAGetLastError())) return 0;
+    if (n <= 0) return -1;
+    reader->len += (size_t)n;
+    return n;
+}
+
+/*
+ * Fonction upload_some()
+ * ----------------------
+ * Envoie la suite du fichier de commandes, jusqu'à ce que le socket soit
+ * saturé ou que le fichier soit entièrement transmis. Chaque morceau lu
+ * devient une trame MSG_DATA; la fin du fichier est signalée par MSG_END.
+ *
+ * Retourne:
+ *   0 si l'envoi se poursuit ou est terminé, -1 en cas d'erreur
+ */
+int upload_some(SOCKET sock, Upload *up) {
+    static char chunk[PROTO_MAX_CHUNK];
+
+    while (!up->finished) {
+        if (up->sent == up->len) {
+            size_t n = fread(chunk, 1, sizeof(chunk), up->fp);
+            if (n == 0 && ferror(up->fp)) {
+                fprintf(stderr, "Error reading command file\n");
+                return -1;
+            }
+            up->bytes += n;
+            up->at_end = n == 0;
+            up->len = proto_encode_text(up->frame, sizeof(up->frame), n ? MSG_DATA : MSG_END, 0,
+                                        chunk, n);
+            up->sent = 0;
+        }
+
+        int n = send(sock, (const char *)up->frame + up->sent, (int)(up->len - up->sent), 0);
+        if (n == SOCKET_ERROR) {
+            if (net_would_block(WSAGetLastError())) return 0;
+            fprintf(stderr, "send command file failed: %d\n", WSAGetLastError());
+            return -1;
+        }
+        up->sent += (size_t)n;
+        if (up->sent == up->len && up->at_end) up->finished = 1;
+    }
+    return 0;
+}
 
 /* ============================================================================
  * FONCTION PRINCIPALE
@@ -72,26 +191,70 @@ typedef struct {
  *
  * Paramètres:
  *   argc - Nombre d'arguments de la ligne de commande
- *   argv - Tableau des arguments (argv[0] = nom du programme, argv[1] = fichier)
+ *   argv - [--priority 0-9] [--deadline MS] <fichier de commandes>
  *
  * Retourne:
- *   0 en cas de succès, 1 en cas d'erreur
+ *   0 en cas de succès, 1 en cas d'erreur, 2 si le maître est saturé
+ *   (MSG_BUSY: soumission à renouveler)
  */
 int main(int argc, char *argv[]) {
 
     /*
      * ÉTAPE 1: Vérification des arguments
      * ------------------------------------
-     * Le programme nécessite exactement un argument: le nom du fichier
-     * contenant les commandes à exécuter.
+     * Le programme nécessite un argument: le nom du fichier contenant les
+     * commandes à exécuter. --priority donne sa priorité (0 à 9, 0 par
+     * défaut: les fichiers plus prioritaires sont servis d'abord) et
+     * --deadline le délai en ms au-delà duquel ses commandes non encore
+     * lancées sont abandonnées. --log-level et --log-format règlent la
+     * journalisation (logger.h).
      */
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s <command_file>\n", argv[0]);
+    const char *command_file = NULL;
+    int priority = 0;
+    long deadline_ms = 0;
+    LogLevel log_level = LOG_INFO;
+    LogFormat log_format = LOG_TEXT;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--priority") == 0 && i + 1 < argc) {
+            priority = atoi(argv[++i]);
+            if (priority < 0 || priority > PROTO_MAX_PRIORITY) {
+                fprintf(stderr, "Invalid priority: %s (0-%d)\n", argv[i], PROTO_MAX_PRIORITY);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--deadline") == 0 && i + 1 < argc) {
+            deadline_ms = atol(argv[++i]);
+            if (deadline_ms <= 0) {
+                fprintf(stderr, "Invalid deadline: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            if (logger_parse_level(argv[++i], &log_level) != 0) {
+                fprintf(stderr, "Invalid log level: %s (error, warn, info, debug)\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--log-format") == 0 && i + 1 < argc) {
+            if (logger_parse_format(argv[++i], &log_format) != 0) {
+                fprintf(stderr, "Invalid log format: %s (text, json)\n", argv[i]);
+                exit(1);
+            }
+        } else if (!command_file) {
+            command_file = argv[i];
+        } else {
+            command_file = NULL;
+            break;
+        }
+    }
+    if (!command_file) {
+        fprintf(stderr, "Usage: %s [--priority 0-%d] [--deadline MS] [--log-level LEVEL] "
+                "[--log-format text|json] <command_file>\n", argv[0], PROTO_MAX_PRIORITY);
         exit(1);
     }
 
-    /* Stockage du nom du fichier de commandes */
-    const char *command_file = argv[1];
+    /* Les messages sont écrits par le thread de journalisation jusqu'à la sortie */
+    if (logger_start("Client", log_level, log_format) < 0) {
+        fprintf(stderr, "Cannot start logger: messages are written synchronously\n");
+    }
 
     /*
      * ÉTAPE 2: Ouverture du fichier de commandes
@@ -163,7 +326,7 @@ int main(int argc, char *argv[]) {
      * Cette opération est bloquante jusqu'à ce que la connexion soit
      * établie ou qu'une erreur survienne.
      */
-    printf("[Client] Connexion au serveur maître %s:%d...\n", MASTER_HOST, MASTER_PORT);
+    log_info("Connexion au serveur maître %s:%d...", MASTER_HOST, MASTER_PORT);
 
     if (connect(sock, (struct sockaddr *)&master_addr, sizeof(master_addr)) == SOCKET_ERROR) {
         fprintf(stderr, "connect failed: %d\n", WSAGetLastError());
@@ -173,66 +336,184 @@ int main(int argc, char *argv[]) {
         exit(1);
     }
 
-    printf("[Client] Connecté au serveur maître\n");
+    log_info("Connecté au serveur maître");
 
     /*
-     * ÉTAPE 7: Envoi du nom du fichier au serveur maître
-     * ---------------------------------------------------
-     * Le client envoie le nom du fichier de commandes au maître.
-     * Le maître utilisera ce nom pour ouvrir et lire le fichier localement.
+     * ÉTAPE 7: Annonce du fichier au serveur maître
+     * ----------------------------------------------
+     * Le client annonce la soumission (trame MSG_SUBMIT portant le nom du
+     * fichier, à titre informatif, sa priorité et son échéance). Le maître
+     * n'a pas accès au fichier: son contenu sera transmis sur la connexion.
      */
-    if (send(sock, command_file, (int)strlen(command_file), 0) == SOCKET_ERROR) {
-        fprintf(stderr, "send filename failed: %d\n", WSAGetLastError());
+    ProtoSubmit request;
+    request.priority = (uint16_t)priority;
+    request.deadline_ms = (uint32_t)deadline_ms;
+    request.name = command_file;
+    request.name_len = strlen(command_file);
+
+    uint8_t submit[PROTO_HEADER_SIZE + 255];
+    size_t submit_len = proto_encode_submit(submit, sizeof(submit), &request);
+    if (submit_len == 0) {
+        fprintf(stderr, "File name too long: %s\n", command_file);
+        closesocket(sock);
+        fclose(fp);
+        WSACleanup();
+        exit(1);
+    }
+    if (send(sock, (const char *)submit, (int)submit_len, 0) == SOCKET_ERROR) {
+        fprintf(stderr, "send request failed: %d\n", WSAGetLastError());
         closesocket(sock);
         fclose(fp);
         WSACleanup();
         exit(1);
     }
-
-    printf("[Client] Fichier '%s' envoyé au maître\n", command_file);
 
     /*
      * ÉTAPE 8: Attente de l'accusé de réception (ACK) du maître
      * ----------------------------------------------------------
-     * Le client attend que le serveur maître confirme la réception
-     * et l'acceptation du fichier de commandes.
-     * Réponse attendue: "OK" si succès, "ERROR: ..." si échec.
+     * Le client attend que le serveur maître accepte la soumission.
+     * Réponse attendue: MSG_ACCEPT si succès, MSG_ERROR si échec.
      */
-    char ack[256];
-    int n = recv(sock, ack, sizeof(ack) - 1, 0);
-    if (n <= 0) {
+    static FrameReader reader;
+    ProtoFrame frame;
+    int got;
+
+    while ((got = next_frame(&reader, &frame)) == 0 && fill_reader(sock, &reader) > 0) {
+        /* Attente d'une trame complète */
+    }
+    if (got <= 0) {
         fprintf(stderr, "No response from master\n");
         closesocket(sock);
         fclose(fp);
         WSACleanup();
         exit(1);
     }
-    ack[n] = '\0';  /* Terminaison de la chaîne */
 
-    /* Vérification que le maître a accepté les commandes */
-    if (strncmp(ack, "OK", 2) != 0) {
-        fprintf(stderr, "Master error: %s\n", ack);
+    /*
+     * Vérification que le maître a accepté les commandes
+     * ---------------------------------------------------
+     * MSG_BUSY: le maître est saturé (trop de fichiers en cours pour ce
+     * client, ou de connexions); code de sortie 2, la soumission peut être
+     * renouvelée plus tard.
+     */
+    if (frame.type == MSG_BUSY) {
+        fprintf(stderr, "Master busy: %.*s\n", (int)frame.payload_len, (const char *)frame.payload);
+        closesocket(sock);
+        fclose(fp);
+        WSACleanup();
+        exit(2);
+    }
+    if (frame.type != MSG_ACCEPT) {
+        fprintf(stderr, "Master error: %.*s\n", (int)frame.payload_len, (const char *)frame.payload);
         closesocket(sock);
         fclose(fp);
         WSACleanup();
         exit(1);
     }
 
-    printf("[Client] Maître a accepté les commandes\n");
+    /* Maître lancé avec --journal: numéro du travail, repris en cas d'arrêt */
+    uint32_t job = frame.id;
+    if (job != 0) {
+        log_info("Maître a accepté les commandes (travail %u, journalisé)", job);
+    } else {
+        log_info("Maître a accepté les commandes");
+    }
 
     /*
-     * ÉTAPE 9: Attente de l'exécution des commandes
-     * ----------------------------------------------
-     * Le client attend un temps fixe pour permettre aux serveurs
-     * esclaves d'exécuter les commandes.
-     *
-     * Note: Dans une implémentation réelle, le client pourrait
-     * recevoir les résultats des commandes via UDP ou un callback.
+     * ÉTAPE 9: Envoi du fichier et réception des résultats
+     * -----------------------------------------------------
+     * Le contenu du fichier est envoyé par morceaux (MSG_DATA, puis
+     * MSG_END) pendant que les résultats arrivent: le maître distribue
+     * chaque ligne dès qu'il l'a reçue. Le socket passe en mode non
+     * bloquant et select() indique quand envoyer la suite ou lire:
+     *   MSG_OUTPUT (id = numéro de la commande, morceau de sa sortie,
+     *               recopié tel quel sur stdout ou stderr)
+     *   MSG_RESULT (id = numéro de la commande, code, durée)
+     *   MSG_DONE (commandes, échecs)
+     * Les sorties de commandes exécutées en parallèle peuvent s'entremêler
+     * (par morceaux); celle d'une commande est complète avant son résultat.
+     * Le client s'arrête dès réception du bilan, sans délai fixe.
      */
-    printf("[Client] Attente de l'exécution des commandes...\n");
-    Sleep(3000);  /* Pause de 3000 millisecondes (3 secondes) */
+    net_set_nonblocking(sock);
+#ifndef _WIN32
+    /* Une fermeture du maître pendant l'envoi ne doit pas tuer le client */
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    static Upload upload;
+    upload.fp = fp;
+
+    log_info("Envoi du fichier '%s' et attente de l'exécution des commandes...",
+             command_file);
+
+    int done = 0;
+    int failure = 0;
+    uint32_t total = 0, failed = 0;
+
+    while (!done && !failure) {
+        fd_set rfds, wfds;
+        FD_ZERO(&rfds);
+        FD_ZERO(&wfds);
+        FD_SET(sock, &rfds);
+        if (!upload.finished) FD_SET(sock, &wfds);
+
+        if (select((int)sock + 1, &rfds, &wfds, NULL, NULL) == SOCKET_ERROR) {
+            if (net_would_block(WSAGetLastError())) continue;  /* Interrompu par un signal */
+            fprintf(stderr, "select failed: %d\n", WSAGetLastError());
+            break;
+        }
+
+        if (FD_ISSET(sock, &wfds)) {
+            if (upload_some(sock, &upload) < 0) break;
+            if (upload.finished) {
+                log_info("Fichier '%s' envoyé (%llu octets)", command_file, upload.bytes);
+            }
+        }
+        if (!FD_ISSET(sock, &rfds)) continue;
+
+        if (fill_reader(sock, &reader) < 0) break;
+        while (!done && !failure && (got = next_frame(&reader, &frame)) > 0) {
+            ProtoResult result;
+            ProtoOutput output;
+
+            if (proto_decode_output(&frame, &output) == 0) {
+                /* Même file que les messages: l'ordre sortie / résultat est conservé */
+                logger_raw(output.stream == PROTO_STREAM_STDERR, output.data, output.data_len);
+            } else if (proto_decode_result(&frame, &result) == 0) {
+                log_info("Commande #%u terminée: code=%d (%.3f ms)", frame.id,
+                         (int)result.return_code, (double)result.duration_us / 1000.0);
+                if (result.message_len) {
+                    log_info("  %.*s", (int)result.message_len, result.message);
+                }
+            } else if (proto_decode_done(&frame, &total, &failed) == 0) {
+                done = 1;
+            } else if (frame.type == MSG_ERROR) {
+                fprintf(stderr, "Master error: %.*s\n", (int)frame.payload_len,
+                        (const char *)frame.payload);
+                failure = 1;
+            } else {
+                fprintf(stderr, "Unexpected message from master (type %d)\n", frame.type);
+            }
+        }
+        if (got < 0) {
+            fprintf(stderr, "Invalid frame from master\n");
+            failure = 1;
+        }
+    }
+
+    if (!done) {
+        fprintf(stderr, "Connection to master lost before all results were received\n");
+        if (job != 0) {
+            fprintf(stderr, "Job %u is journaled: the master resumes its unfinished commands "
+                    "when it restarts\n", job);
+        }
+        closesocket(sock);
+        fclose(fp);
+        WSACleanup();
+        exit(1);
+    }
 
-    printf("[Client] Commandes traitées\n");
+    log_info("Commandes traitées: %u (%u en échec)", total, failed);
 
     /*
      * ÉTAPE 10: Nettoyage et fermeture
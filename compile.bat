@@ -7,7 +7,7 @@ echo ==========================================
 
 REM Compile slave server
 echo Compiling serveur_esclave.exe...
-gcc -o serveur_esclave.exe serveur_esclave.c -lws2_32
+gcc -pthread -o serveur_esclave.exe serveur_esclave.c reactor.c executor.c builtin.c protocol.c batch.c dedup.c output.c metrics.c spsc.c logger.c -lws2_32
 if %errorlevel% neq 0 (
     echo Error compiling serveur_esclave.c
     exit /b 1
@@ -15,7 +15,7 @@ if %errorlevel% neq 0 (
 
 REM Compile master server
 echo Compiling serveur_maitre.exe...
-gcc -o serveur_maitre.exe serveur_maitre.c -lws2_32
+gcc -pthread -o serveur_maitre.exe serveur_maitre.c reactor.c scheduler.c inflight.c slab.c protocol.c batch.c retry.c spsc.c sender.c deque.c dag.c journal.c cache.c fairshare.c metrics.c logger.c -lws2_32
 if %errorlevel% neq 0 (
     echo Error compiling serveur_maitre.c
     exit /b 1
@@ -23,7 +23,7 @@ if %errorlevel% neq 0 (
 
 REM Compile client
 echo Compiling client.exe...
-gcc -o client.exe client.c -lws2_32
+gcc -pthread -o client.exe client.c protocol.c spsc.c logger.c -lws2_32
 if %errorlevel% neq 0 (
     echo Error compiling client.c
     exit /b 1
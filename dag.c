@@ -0,0 +1,381 @@
+/*
+ * ============================================================================
+ * DAG - Dépendances entre les commandes d'un fichier (maître)
+ * ============================================================================
+ *
+ * Voir dag.h pour la syntaxe et la description de l'interface.
+ *
+ * ============================================================================
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dag.h"
+
+/* ============================================================================
+ * TABLE DES IDENTIFIANTS
+ * ============================================================================ */
+
+/* Hachage FNV-1a d'un identifiant de len octets */
+static size_t hash_name(const char *name, size_t len) {
+    size_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/*
+ * Fonction find_node()
+ * --------------------
+ * Retourne:
+ *   Index du nœud de l'identifiant (len octets), ou -1 s'il est inconnu
+ */
+static int find_node(const Dag *d, const char *name, size_t len) {
+    if (d->index_cap == 0) return -1;
+
+    size_t mask = d->index_cap - 1;
+    for (size_t i = hash_name(name, len) & mask; d->index[i] != 0; i = (i + 1) & mask) {
+        const DagNode *node = &d->nodes[d->index[i] - 1];
+        if (strlen(node->name) == len && memcmp(node->name, name, len) == 0) {
+            return d->index[i] - 1;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Fonction index_node()
+ * ---------------------
+ * Range le nœud idx dans la table de hachage, agrandie (et reconstruite)
+ * au-delà d'un taux de remplissage de 1/2.
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation
+ */
+static int index_node(Dag *d, int idx) {
+    if ((size_t)(d->num_nodes) * 2 > d->index_cap) {
+        size_t cap = d->index_cap ? d->index_cap * 2 : 64;
+        int *index = calloc(cap, sizeof(int));
+        if (!index) return -1;
+        free(d->index);
+        d->index = index;
+        d->index_cap = cap;
+        for (int i = 0; i < d->num_nodes; i++) {
+            if (i != idx) index_node(d, i);
+        }
+    }
+
+    const char *name = d->nodes[idx].name;
+    size_t mask = d->index_cap - 1;
+    size_t i = hash_name(name, strlen(name)) & mask;
+    while (d->index[i] != 0) i = (i + 1) & mask;
+    d->index[i] = idx + 1;
+    return 0;
+}
+
+/*
+ * Fonction add_node()
+ * -------------------
+ * Déclare un identifiant (len octets), en attente.
+ *
+ * Retourne:
+ *   Index du nœud, ou -1 en cas d'erreur d'allocation
+ */
+static int add_node(Dag *d, const char *name, size_t len) {
+    if (d->num_nodes == d->nodes_cap) {
+        int cap = d->nodes_cap ? d->nodes_cap * 2 : 16;
+        DagNode *nodes = realloc(d->nodes, (size_t)cap * sizeof(DagNode));
+        if (!nodes) return -1;
+        d->nodes = nodes;
+        d->nodes_cap = cap;
+    }
+
+    int idx = d->num_nodes++;
+    DagNode *node = &d->nodes[idx];
+    memset(node, 0, sizeof(*node));
+    memcpy(node->name, name, len);
+    node->name[len] = '\0';
+    if (index_node(d, idx) < 0) {
+        d->num_nodes--;
+        return -1;
+    }
+    return idx;
+}
+
+/* ============================================================================
+ * COMMANDES RETENUES
+ * ============================================================================ */
+
+/*
+ * Fonction add_waiter()
+ * ---------------------
+ * Inscrit la commande retenue w parmi celles qui attendent le nœud.
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation
+ */
+static int add_waiter(DagNode *node, int w) {
+    if (node->num_waiters == node->waiters_cap) {
+        int cap = node->waiters_cap ? node->waiters_cap * 2 : 4;
+        int *waiters = realloc(node->waiters, (size_t)cap * sizeof(int));
+        if (!waiters) return -1;
+        node->waiters = waiters;
+        node->waiters_cap = cap;
+    }
+    node->waiters[node->num_waiters++] = w;
+    return 0;
+}
+
+/*
+ * Fonction add_wait()
+ * -------------------
+ * Retient une commande jusqu'à la fin de ses dépendances.
+ *
+ * Retourne:
+ *   Index de la commande retenue, ou -1 en cas d'erreur d'allocation
+ */
+static int add_wait(Dag *d, unsigned int seq, int node, const char *command) {
+    if (d->num_waits == d->waits_cap) {
+        int cap = d->waits_cap ? d->waits_cap * 2 : 16;
+        DagWait *waits = realloc(d->waits, (size_t)cap * sizeof(DagWait));
+        if (!waits) return -1;
+        d->waits = waits;
+        int *ready = realloc(d->ready, (size_t)cap * sizeof(int));
+        if (!ready) return -1;
+        d->ready = ready;
+        d->waits_cap = cap;
+    }
+
+    char *copy = malloc(strlen(command) + 1);
+    if (!copy) return -1;
+    strcpy(copy, command);
+
+    int w = d->num_waits++;
+    DagWait *wait = &d->waits[w];
+    wait->seq = seq;
+    wait->node = node;
+    wait->command = copy;
+    wait->unmet = 0;
+    wait->failed_dep = -1;
+    wait->released = 0;
+    d->pending++;
+    return w;
+}
+
+/* Place la commande retenue w dans la file des commandes prêtes */
+static void release_wait(Dag *d, int w) {
+    d->waits[w].released = 1;
+    d->ready[d->ready_len++] = w;
+}
+
+/* ============================================================================
+ * INTERFACE PUBLIQUE
+ * ============================================================================ */
+
+void dag_free(Dag *d) {
+    for (int i = 0; i < d->num_nodes; i++) free(d->nodes[i].waiters);
+    for (int i = 0; i < d->num_waits; i++) free(d->waits[i].command);
+    free(d->nodes);
+    free(d->index);
+    free(d->waits);
+    free(d->ready);
+    memset(d, 0, sizeof(*d));
+}
+
+/* Longueur du mot commençant en p (jusqu'à un espace ou la fin) */
+static size_t word_len(const char *p) {
+    size_t n = 0;
+    while (p[n] && p[n] != ' ' && p[n] != '\t') n++;
+    return n;
+}
+
+static const char *skip_spaces(const char *p) {
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
+}
+
+/* Un identifiant: lettres, chiffres, '_', '-' et '.' */
+static int valid_name(const char *name, size_t len) {
+    if (len == 0 || len >= DAG_MAX_NAME) return 0;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)name[i];
+        if (!isalnum(c) && c != '_' && c != '-' && c != '.') return 0;
+    }
+    return 1;
+}
+
+/*
+ * Fonction dag_submit()
+ * ---------------------
+ * Analyse le préfixe d'une ligne du fichier (voir dag.h) et décide de son
+ * sort. Une ligne sans préfixe est exécutée immédiatement, sans rien
+ * changer au graphe. Une ligne avec préfixe est retenue, et passe aussitôt
+ * dans la file des commandes prêtes si ses dépendances sont déjà
+ * terminées: elle en sort par dag_peek_ready() / dag_pop_ready().
+ *
+ * Paramètres:
+ *   d - Graphe du fichier
+ *   seq - Rang de la commande dans le fichier
+ *   line - Ligne reçue
+ *   error / error_cap - Message d'erreur (DAG_REJECT)
+ *
+ * Retourne:
+ *   DAG_RUN, DAG_WAIT ou DAG_REJECT (voir DagVerdict). Un identifiant
+ *   déclaré par une ligne rejetée est en échec: ses dépendants le seront
+ *   aussi.
+ */
+DagVerdict dag_submit(Dag *d, unsigned int seq, const char *line, char *error, size_t error_cap) {
+    const char *p = skip_spaces(line);
+    const char *name = NULL;
+    size_t name_len = 0;
+    const char *deps = NULL;
+    size_t deps_len = 0;
+
+    if (*p == '@') {
+        name = p + 1;
+        name_len = word_len(name);
+        p = skip_spaces(name + name_len);
+    }
+    if (strncmp(p, "after:", 6) == 0) {
+        deps = p + 6;
+        deps_len = word_len(deps);
+        p = skip_spaces(deps + deps_len);
+    }
+    if (!name && !deps) return DAG_RUN;
+
+    if (name && !valid_name(name, name_len)) {
+        snprintf(error, error_cap, "Erreur: identifiant invalide: %.*s", (int)name_len, name);
+        return DAG_REJECT;
+    }
+    if (*p == '\0') {
+        snprintf(error, error_cap, "Erreur: commande vide");
+        return DAG_REJECT;
+    }
+
+    /* Déclaration de l'identifiant de la ligne */
+    int self = -1;
+    if (name) {
+        if (find_node(d, name, name_len) >= 0) {
+            snprintf(error, error_cap, "Erreur: identifiant déjà utilisé: %.*s", (int)name_len, name);
+            return DAG_REJECT;
+        }
+        self = add_node(d, name, name_len);
+        if (self < 0) {
+            snprintf(error, error_cap, "Erreur: mémoire insuffisante");
+            return DAG_REJECT;
+        }
+    }
+
+    /* Résolution des dépendances */
+    int pending[DAG_MAX_DEPS];
+    int num_pending = 0;
+    const char *dep = deps;
+    while (deps && dep < deps + deps_len) {
+        size_t len = 0;
+        while (dep + len < deps + deps_len && dep[len] != ',') len++;
+
+        int idx = len > 0 ? find_node(d, dep, len) : -1;
+        if (idx < 0 || idx == self) {
+            snprintf(error, error_cap, "Erreur: dépendance inconnue: %.*s", (int)len, dep);
+            goto reject;
+        }
+        if (d->nodes[idx].state == DAG_FAILED) {
+            snprintf(error, error_cap, "Erreur: dépendance en échec: %s", d->nodes[idx].name);
+            goto reject;
+        }
+        if (d->nodes[idx].state == DAG_PENDING) {
+            if (num_pending == DAG_MAX_DEPS) {
+                snprintf(error, error_cap, "Erreur: plus de %d dépendances", DAG_MAX_DEPS);
+                goto reject;
+            }
+            pending[num_pending++] = idx;
+        }
+        dep += len + 1;
+    }
+
+    /* Commande retenue jusqu'à la fin de ses dépendances */
+    int w = add_wait(d, seq, self, p);
+    if (w < 0) {
+        snprintf(error, error_cap, "Erreur: mémoire insuffisante");
+        goto reject;
+    }
+    for (int i = 0; i < num_pending; i++) {
+        if (add_waiter(&d->nodes[pending[i]], w) == 0) d->waits[w].unmet++;
+    }
+    if (d->waits[w].unmet == 0) release_wait(d, w);
+    return DAG_WAIT;
+
+reject:
+    if (self >= 0) d->nodes[self].state = DAG_FAILED;
+    return DAG_REJECT;
+}
+
+/*
+ * Fonction dag_complete()
+ * -----------------------
+ * La commande qui a déclaré le nœud est terminée: ses dépendants dont
+ * toutes les dépendances sont terminées avec succès, ou dont une
+ * dépendance a échoué, passent dans la file des commandes prêtes.
+ *
+ * Paramètres:
+ *   node - Nœud de la commande (DagReady.node, -1: sans effet)
+ *   ok - 1 si la commande a réussi (code 0)
+ */
+void dag_complete(Dag *d, int node, int ok) {
+    if (node < 0 || node >= d->num_nodes) return;
+
+    DagNode *n = &d->nodes[node];
+    if (n->state != DAG_PENDING) return;
+    n->state = ok ? DAG_OK : DAG_FAILED;
+
+    for (int i = 0; i < n->num_waiters; i++) {
+        DagWait *wait = &d->waits[n->waiters[i]];
+        wait->unmet--;
+        if (!ok && wait->failed_dep < 0) wait->failed_dep = node;
+        if (!wait->released && (wait->unmet == 0 || wait->failed_dep >= 0)) {
+            release_wait(d, n->waiters[i]);
+        }
+    }
+    free(n->waiters);
+    n->waiters = NULL;
+    n->num_waiters = 0;
+    n->waiters_cap = 0;
+}
+
+/*
+ * Fonction dag_peek_ready()
+ * -------------------------
+ * Consulte la plus ancienne commande prête, sans la retirer: elle ne
+ * sort de la file (dag_pop_ready()) qu'une fois distribuée ou signalée
+ * en échec.
+ *
+ * Retourne:
+ *   1 si une commande est prête, 0 sinon
+ */
+int dag_peek_ready(Dag *d, DagReady *ready) {
+    if (d->ready_head == d->ready_len) return 0;
+
+    const DagWait *wait = &d->waits[d->ready[d->ready_head]];
+    ready->seq = wait->seq;
+    ready->node = wait->node;
+    ready->command = wait->command;
+    ready->failed_dep = wait->failed_dep >= 0 ? d->nodes[wait->failed_dep].name : NULL;
+    return 1;
+}
+
+/*
+ * Fonction dag_pop_ready()
+ * ------------------------
+ * Retire la commande rendue par dag_peek_ready() (texte libéré).
+ */
+void dag_pop_ready(Dag *d) {
+    DagWait *wait = &d->waits[d->ready[d->ready_head++]];
+    free(wait->command);
+    wait->command = NULL;
+    d->pending--;
+}
@@ -0,0 +1,169 @@
+/*
+ * ============================================================================
+ * DAG - Dépendances entre les commandes d'un fichier (maître)
+ * ============================================================================
+ *
+ * Description:
+ *   Une ligne du fichier de commandes peut porter, avant la commande, un
+ *   identifiant et la liste des commandes dont elle dépend:
+ *
+ *     @<id> [after:<id>[,<id>...]] <commande>
+ *     after:<id>[,<id>...] <commande>
+ *
+ *   Exemple:
+ *     @fetch curl -sO https://example.org/src.tar.gz
+ *     @build after:fetch make
+ *     @docs after:fetch make docs
+ *     after:build,docs make install
+ *
+ *   Une commande n'est confiée à l'ordonnanceur qu'une fois toutes ses
+ *   dépendances terminées avec le code 0; les branches indépendantes
+ *   s'exécutent en parallèle sur les esclaves. Si une dépendance échoue,
+ *   la commande n'est pas exécutée et échoue à son tour (ce qui se
+ *   propage à ses propres dépendants). Une ligne sans préfixe s'exécute
+ *   immédiatement, comme auparavant.
+ *
+ *   Une dépendance doit désigner un identifiant déclaré plus haut dans le
+ *   fichier: le graphe est donc sans cycle par construction. Un
+ *   identifiant inconnu ou déjà utilisé fait échouer la ligne.
+ *
+ *   Un graphe par client: les identifiants sont propres à chaque fichier.
+ *
+ * ============================================================================
+ */
+
+#ifndef DAG_H
+#define DAG_H
+
+#include <stddef.h>
+
+/* Longueur maximale d'un identifiant de commande */
+#define DAG_MAX_NAME 64
+
+/* Dépendances maximales d'une commande */
+#define DAG_MAX_DEPS 32
+
+/*
+ * Énumération DagState
+ * --------------------
+ * État de la commande qui a déclaré un identifiant.
+ */
+typedef enum {
+    DAG_PENDING = 0,  /* En attente ou en cours d'exécution */
+    DAG_OK,           /* Terminée avec le code 0 */
+    DAG_FAILED        /* Terminée en échec, ou non exécutée */
+} DagState;
+
+/*
+ * Structure DagNode
+ * -----------------
+ * Identifiant déclaré par une commande.
+ *
+ * Champs:
+ *   - name: Identifiant
+ *   - state: État de la commande (voir DagState)
+ *   - waiters / num_waiters / waiters_cap: Commandes en attente de
+ *     celle-ci (index dans Dag.waits)
+ */
+typedef struct {
+    char name[DAG_MAX_NAME];
+    DagState state;
+    int *waiters;
+    int num_waiters;
+    int waiters_cap;
+} DagNode;
+
+/*
+ * Structure DagWait
+ * -----------------
+ * Commande retenue jusqu'à la fin de ses dépendances.
+ *
+ * Champs:
+ *   - seq: Rang de la commande dans le fichier
+ *   - node: Identifiant déclaré par la commande (-1 = aucun)
+ *   - command: Texte de la commande, sans le préfixe (libéré à la sortie
+ *     de la file des commandes prêtes)
+ *   - unmet: Dépendances non encore terminées
+ *   - failed_dep: Dépendance en échec (-1 = aucune)
+ *   - released: 1 une fois placée dans la file des commandes prêtes
+ */
+typedef struct {
+    unsigned int seq;
+    int node;
+    char *command;
+    int unmet;
+    int failed_dep;
+    int released;
+} DagWait;
+
+/*
+ * Structure Dag
+ * -------------
+ * Graphe des dépendances d'un fichier de commandes. Une structure
+ * initialisée à zéro est un graphe vide valide.
+ *
+ * Champs:
+ *   - nodes / num_nodes / nodes_cap: Identifiants déclarés
+ *   - index / index_cap: Table de hachage des identifiants (index du nœud
+ *     + 1, 0 = libre), à adressage ouvert
+ *   - waits / num_waits / waits_cap: Commandes retenues
+ *   - ready / ready_head: Commandes retenues dont les dépendances sont
+ *     terminées (index dans waits), dans l'ordre de leur libération;
+ *     ready contient num_waits emplacements au plus
+ *   - ready_len: Nombre d'entrées de ready
+ *   - pending: Commandes retenues pas encore sorties de la file des
+ *     commandes prêtes
+ */
+typedef struct {
+    DagNode *nodes;
+    int num_nodes;
+    int nodes_cap;
+    int *index;
+    size_t index_cap;
+    DagWait *waits;
+    int num_waits;
+    int waits_cap;
+    int *ready;
+    int ready_head;
+    int ready_len;
+    int pending;
+} Dag;
+
+/*
+ * Énumération DagVerdict
+ * ----------------------
+ * Sort d'une ligne soumise au graphe (dag_submit()).
+ */
+typedef enum {
+    DAG_RUN = 0,      /* Ligne sans préfixe: à exécuter immédiatement */
+    DAG_WAIT,         /* Retenue, libérée à la fin de ses dépendances (peut-être
+                         déjà dans la file des commandes prêtes) */
+    DAG_REJECT        /* À signaler en échec sans l'exécuter */
+} DagVerdict;
+
+/*
+ * Structure DagReady
+ * ------------------
+ * Commande sortant de la file des commandes prêtes (dag_peek_ready()).
+ *
+ * Champs:
+ *   - seq / node / command: Voir DagWait
+ *   - failed_dep: Identifiant de la dépendance en échec, NULL si la
+ *     commande est à exécuter
+ */
+typedef struct {
+    unsigned int seq;
+    int node;
+    const char *command;
+    const char *failed_dep;
+} DagReady;
+
+void dag_free(Dag *d);
+
+DagVerdict dag_submit(Dag *d, unsigned int seq, const char *line, char *error, size_t error_cap);
+void dag_complete(Dag *d, int node, int ok);
+
+int dag_peek_ready(Dag *d, DagReady *ready);
+void dag_pop_ready(Dag *d);
+
+#endif /* DAG_H */
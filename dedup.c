@@ -0,0 +1,205 @@
+/*
+ * ============================================================================
+ * DEDUP - Fenêtre de déduplication des commandes reçues (esclave)
+ * ============================================================================
+ *
+ * Voir dedup.h pour la description de l'interface.
+ *
+ * ============================================================================
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "dedup.h"
+#include "net_compat.h"
+
+/* La table est agrandie au-delà de ce taux de remplissage (en %) */
+#define DEDUP_MAX_LOAD 70
+
+static size_t slot_of(const DedupTable *t, unsigned int id) {
+    return (size_t)((id * 2654435769u) & (unsigned int)(t->capacity - 1));
+}
+
+/* Alloue une table de hachage vide de cap emplacements (puissance de 2) */
+static int alloc_slots(DedupTable *t, size_t cap) {
+    t->slots = calloc(cap, sizeof(DedupEntry));
+    if (!t->slots) return -1;
+    t->capacity = cap;
+    t->count = 0;
+    return 0;
+}
+
+/*
+ * Fonction dedup_init()
+ * ---------------------
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation
+ */
+int dedup_init(DedupTable *t) {
+    memset(t, 0, sizeof(*t));
+    return alloc_slots(t, 1024);
+}
+
+void dedup_free(DedupTable *t) {
+    for (size_t i = 0; i < t->capacity; i++) {
+        free(t->slots[i].result);
+    }
+    free(t->slots);
+    free(t->fifo);
+    memset(t, 0, sizeof(*t));
+}
+
+/* Double la capacité et réinsère toutes les entrées */
+static int grow(DedupTable *t) {
+    DedupEntry *old = t->slots;
+    size_t old_cap = t->capacity;
+    size_t count = t->count;
+
+    if (alloc_slots(t, old_cap * 2) < 0) {
+        t->slots = old;
+        t->capacity = old_cap;
+        t->count = count;
+        return -1;
+    }
+    for (size_t i = 0; i < old_cap; i++) {
+        if (old[i].id == 0) continue;
+        size_t j = slot_of(t, old[i].id);
+        while (t->slots[j].id != 0) j = (j + 1) & (t->capacity - 1);
+        t->slots[j] = old[i];
+    }
+    t->count = count;
+    free(old);
+    return 0;
+}
+
+/*
+ * Fonction dedup_find()
+ * ---------------------
+ * Retourne:
+ *   L'entrée de la commande id, ou NULL si elle est inconnue
+ */
+DedupEntry *dedup_find(DedupTable *t, unsigned int id) {
+    if (id == 0) return NULL;
+
+    size_t i = slot_of(t, id);
+    while (t->slots[i].id != 0) {
+        if (t->slots[i].id == id) return &t->slots[i];
+        i = (i + 1) & (t->capacity - 1);
+    }
+    return NULL;
+}
+
+/*
+ * Fonction dedup_insert()
+ * -----------------------
+ * Enregistre la commande id (non déjà présente) comme étant en cours.
+ *
+ * Retourne:
+ *   L'entrée créée, ou NULL en cas d'erreur d'allocation
+ */
+DedupEntry *dedup_insert(DedupTable *t, unsigned int id) {
+    if ((t->count + 1) * 100 > t->capacity * DEDUP_MAX_LOAD) {
+        if (grow(t) < 0) return NULL;
+    }
+
+    size_t i = slot_of(t, id);
+    while (t->slots[i].id != 0) i = (i + 1) & (t->capacity - 1);
+
+    memset(&t->slots[i], 0, sizeof(DedupEntry));
+    t->slots[i].id = id;
+    t->count++;
+    return &t->slots[i];
+}
+
+/* Supprime une entrée (décalage arrière, voir inflight_remove()) */
+static void remove_entry(DedupTable *t, DedupEntry *e) {
+    size_t mask = t->capacity - 1;
+    size_t hole = (size_t)(e - t->slots);
+    size_t i = hole;
+
+    free(e->result);
+    while (1) {
+        i = (i + 1) & mask;
+        if (t->slots[i].id == 0) break;
+
+        size_t ideal = slot_of(t, t->slots[i].id);
+        int movable = (hole <= i) ? (ideal <= hole || ideal > i)
+                                  : (ideal <= hole && ideal > i);
+        if (movable) {
+            t->slots[hole] = t->slots[i];
+            hole = i;
+        }
+    }
+
+    memset(&t->slots[hole], 0, sizeof(DedupEntry));
+    t->count--;
+}
+
+/* Retire la plus ancienne commande terminée de la file et de la table */
+static void evict_oldest(DedupTable *t) {
+    DedupEntry *e = dedup_find(t, t->fifo[t->fifo_head].id);
+    if (e) remove_entry(t, e);
+    t->fifo_head = (t->fifo_head + 1) % t->fifo_cap;
+    t->fifo_len--;
+}
+
+/*
+ * Fonction dedup_complete()
+ * -------------------------
+ * Marque la commande id comme terminée et mémorise une copie de sa trame
+ * de résultat, renvoyée telle quelle si la commande est retransmise.
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation (la commande est
+ *   alors oubliée: une retransmission la réexécuterait)
+ */
+int dedup_complete(DedupTable *t, unsigned int id, const uint8_t *result, size_t len) {
+    DedupEntry *e = dedup_find(t, id);
+    if (!e) e = dedup_insert(t, id);
+    if (!e) return -1;
+
+    uint8_t *copy = malloc(len);
+    if (!copy) {
+        remove_entry(t, e);
+        return -1;
+    }
+    memcpy(copy, result, len);
+    free(e->result);
+    e->result = copy;
+    e->result_len = len;
+    e->done = 1;
+
+    /* Borne mémoire: la plus ancienne commande terminée est oubliée */
+    if (t->fifo_len == DEDUP_MAX_DONE) evict_oldest(t);
+
+    if (t->fifo_len == t->fifo_cap) {
+        size_t new_cap = t->fifo_cap ? t->fifo_cap * 2 : 1024;
+        DedupDone *grown = malloc(new_cap * sizeof(DedupDone));
+        if (!grown) return 0;  /* Résultat conservé, mais sans expiration */
+        for (size_t i = 0; i < t->fifo_len; i++) {
+            grown[i] = t->fifo[(t->fifo_head + i) % t->fifo_cap];
+        }
+        free(t->fifo);
+        t->fifo = grown;
+        t->fifo_cap = new_cap;
+        t->fifo_head = 0;
+    }
+    DedupDone *slot = &t->fifo[(t->fifo_head + t->fifo_len) % t->fifo_cap];
+    slot->id = id;
+    slot->done_us = monotonic_us();
+    t->fifo_len++;
+    return 0;
+}
+
+/*
+ * Fonction dedup_expire()
+ * -----------------------
+ * Oublie les commandes terminées depuis plus de DEDUP_MIN_AGE_MS.
+ */
+void dedup_expire(DedupTable *t, uint64_t now_us) {
+    while (t->fifo_len > 0
+           && now_us - t->fifo[t->fifo_head].done_us > (uint64_t)DEDUP_MIN_AGE_MS * 1000) {
+        evict_oldest(t);
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * ============================================================================
+ * DEDUP - Fenêtre de déduplication des commandes reçues (esclave)
+ * ============================================================================
+ *
+ * Description:
+ *   Le maître retransmet une commande tant qu'il n'a pas reçu son
+ *   acquittement puis son résultat. Une retransmission ne doit jamais
+ *   exécuter la commande une seconde fois: l'esclave mémorise donc, par
+ *   identifiant, les commandes en cours et le résultat encodé des
+ *   commandes terminées récemment.
+ *
+ *   - Commande inconnue: enregistrée, acquittée et exécutée
+ *   - Commande en cours: simplement réacquittée
+ *   - Commande terminée: le résultat mémorisé est renvoyé tel quel
+ *
+ *   Un résultat est conservé au moins DEDUP_MIN_AGE_MS (plus longtemps que
+ *   le maître ne retransmet), dans la limite de DEDUP_MAX_DONE résultats.
+ *
+ *   Implémentation: table de hachage à adressage ouvert (comme
+ *   inflight.c) et file FIFO des commandes terminées pour l'expiration.
+ *
+ * ============================================================================
+ */
+
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Durée minimale de conservation d'un résultat (ms) */
+#define DEDUP_MIN_AGE_MS 60000
+
+/* Nombre maximal de résultats conservés (borne mémoire) */
+#define DEDUP_MAX_DONE 262144
+
+/*
+ * Structure DedupEntry
+ * --------------------
+ * Champs:
+ *   - id: Identifiant de la commande (0 = emplacement libre)
+ *   - done: 0 = en cours d'exécution, 1 = terminée
+ *   - result / result_len: Trame MSG_RESULT encodée (commande terminée)
+ */
+typedef struct {
+    unsigned int id;
+    int done;
+    uint8_t *result;
+    size_t result_len;
+} DedupEntry;
+
+/*
+ * Structure DedupDone
+ * -------------------
+ * Élément de la file des commandes terminées (ordre d'achèvement).
+ */
+typedef struct {
+    unsigned int id;
+    uint64_t done_us;
+} DedupDone;
+
+/*
+ * Structure DedupTable
+ * --------------------
+ * Champs:
+ *   - slots / capacity / count: Table de hachage (capacité = puissance de 2)
+ *   - fifo / fifo_head / fifo_len / fifo_cap: File circulaire des
+ *     commandes terminées, de la plus ancienne à la plus récente
+ */
+typedef struct {
+    DedupEntry *slots;
+    size_t capacity;
+    size_t count;
+    DedupDone *fifo;
+    size_t fifo_head;
+    size_t fifo_len;
+    size_t fifo_cap;
+} DedupTable;
+
+int dedup_init(DedupTable *t);
+void dedup_free(DedupTable *t);
+
+DedupEntry *dedup_find(DedupTable *t, unsigned int id);
+DedupEntry *dedup_insert(DedupTable *t, unsigned int id);
+int dedup_complete(DedupTable *t, unsigned int id, const uint8_t *result, size_t len);
+void dedup_expire(DedupTable *t, uint64_t now_us);
+
+#endif /* DEDUP_H */
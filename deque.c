@@ -0,0 +1,112 @@
+/*
+ * ============================================================================
+ * DEQUE - File double des commandes en attente d'un esclave (maître)
+ * ============================================================================
+ *
+ * Voir deque.h pour la description de l'interface.
+ *
+ * ============================================================================
+ */
+
+#include <stdlib.h>
+
+#include "deque.h"
+
+/*
+ * Fonction grow()
+ * ---------------
+ * Double la capacité de la file (16 emplacements au départ), éléments
+ * recopiés à partir de l'emplacement 0.
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation
+ */
+static int grow(CmdDeque *d) {
+    size_t cap = d->capacity ? d->capacity * 2 : 16;
+    uint32_t *ids = malloc(cap * sizeof(uint32_t));
+    if (!ids) return -1;
+
+    for (size_t i = 0; i < d->len; i++) {
+        ids[i] = d->ids[(d->head + i) & (d->capacity - 1)];
+    }
+    free(d->ids);
+    d->ids = ids;
+    d->capacity = cap;
+    d->head = 0;
+    return 0;
+}
+
+void deque_free(CmdDeque *d) {
+    free(d->ids);
+    d->ids = NULL;
+    d->capacity = 0;
+    d->head = 0;
+    d->len = 0;
+}
+
+/*
+ * Fonction deque_push_back()
+ * --------------------------
+ * Ajoute une commande à l'arrière de la file.
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation
+ */
+int deque_push_back(CmdDeque *d, uint32_t id) {
+    if (d->len == d->capacity && grow(d) < 0) return -1;
+
+    d->ids[(d->head + d->len) & (d->capacity - 1)] = id;
+    d->len++;
+    return 0;
+}
+
+/*
+ * Fonction deque_push_front()
+ * ---------------------------
+ * Ajoute une commande à l'avant de la file (prochaine à envoyer).
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation
+ */
+int deque_push_front(CmdDeque *d, uint32_t id) {
+    if (d->len == d->capacity && grow(d) < 0) return -1;
+
+    d->head = (d->head - 1) & (d->capacity - 1);
+    d->ids[d->head] = id;
+    d->len++;
+    return 0;
+}
+
+/*
+ * Fonction deque_pop_front()
+ * --------------------------
+ * Retire la commande de l'avant de la file (la plus ancienne).
+ *
+ * Retourne:
+ *   1 si une commande a été retirée, 0 si la file est vide
+ */
+int deque_pop_front(CmdDeque *d, uint32_t *id) {
+    if (d->len == 0) return 0;
+
+    *id = d->ids[d->head];
+    d->head = (d->head + 1) & (d->capacity - 1);
+    d->len--;
+    return 1;
+}
+
+/*
+ * Fonction deque_pop_back()
+ * -------------------------
+ * Retire la commande de l'arrière de la file (la plus récente): c'est
+ * elle qu'un esclave inactif vole.
+ *
+ * Retourne:
+ *   1 si une commande a été retirée, 0 si la file est vide
+ */
+int deque_pop_back(CmdDeque *d, uint32_t *id) {
+    if (d->len == 0) return 0;
+
+    d->len--;
+    *id = d->ids[(d->head + d->len) & (d->capacity - 1)];
+    return 1;
+}
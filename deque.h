@@ -0,0 +1,52 @@
+/*
+ * ============================================================================
+ * DEQUE - File double des commandes en attente d'un esclave (maître)
+ * ============================================================================
+ *
+ * Description:
+ *   Le maître garde, pour chaque esclave, les commandes qui lui sont
+ *   attribuées mais pas encore envoyées. L'esclave reçoit ses commandes
+ *   par l'avant de sa file; un esclave inactif dont la file est vide vole
+ *   celles de l'arrière de la file la plus longue (vol de travail).
+ *   Une commande remise en attente (esclave écarté) repasse à l'avant.
+ *
+ *   Les éléments sont les identifiants des commandes (voir inflight.h):
+ *   la table des commandes en cours peut être réorganisée sans invalider
+ *   les files.
+ *
+ *   Implémentation: tampon circulaire de taille puissance de 2, agrandi
+ *   par doublement. Une file initialisée à zéro est vide et valide.
+ *
+ * ============================================================================
+ */
+
+#ifndef DEQUE_H
+#define DEQUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Structure CmdDeque
+ * ------------------
+ * Champs:
+ *   - ids: Identifiants des commandes (emplacement (head + i) % capacity)
+ *   - capacity: Nombre d'emplacements alloués (0 ou puissance de 2)
+ *   - head: Emplacement du premier élément
+ *   - len: Nombre d'éléments
+ */
+typedef struct {
+    uint32_t *ids;
+    size_t capacity;
+    size_t head;
+    size_t len;
+} CmdDeque;
+
+void deque_free(CmdDeque *d);
+
+int deque_push_back(CmdDeque *d, uint32_t id);
+int deque_push_front(CmdDeque *d, uint32_t id);
+int deque_pop_front(CmdDeque *d, uint32_t *id);
+int deque_pop_back(CmdDeque *d, uint32_t *id);
+
+#endif /* DEQUE_H */
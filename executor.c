@@ -0,0 +1,913 @@
+/*
+ * ============================================================================
+ * EXECUTOR - Pool borné de processus d'exécution des commandes (esclave)
+ * ============================================================================
+ *
+ * Voir executor.h pour la description de l'interface.
+ *
+ * ============================================================================
+ */
+
+#define _GNU_SOURCE     /* pipe2() */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "executor.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+/* Tube "self-pipe": [0] surveillé par le réacteur, [1] écrit par SIGCHLD */
+static int sigchld_pipe[2] = { -1, -1 };
+
+/* Caractères qui demandent l'interprétation du shell */
+static const char shell_special[] = "|&;<>()$`\\\"'*?[]{}~#!\n";
+
+/*
+ * Mots réservés et commandes internes du shell: sans exécutable qui les
+ * remplace (cd, exit...), ou dont l'exécutable du PATH se comporte
+ * autrement (echo -e, printf, test, kill... de GNU coreutils)
+ */
+static const char *const shell_words[] = {
+    "if", "then", "else", "elif", "fi", "case", "esac", "for", "while", "until", "do",
+    "done", "in", "function", "select", "time", "cd", "exit", "export", "unset", "set",
+    "shift", ".", "source", "alias", "unalias", "eval", "exec", "read", "ulimit", "umask",
+    "wait", "trap", "return", "break", "continue", "readonly", "local", "getopts", "hash",
+    "type", "command", "jobs", "fg", "bg", "times", "declare", "typeset", "let", "builtin",
+    "shopt", "pushd", "popd", "dirs", "disown", "logout", "chdir", "fc", "echo", "printf",
+    "test", "true", "false", ":", "kill", "pwd", NULL
+};
+
+/*
+ * Structure PathEntry
+ * -------------------
+ * Programme dont le chemin a déjà été cherché dans le PATH.
+ */
+typedef struct {
+    char name[64];
+    char path[256];
+} PathEntry;
+
+/*
+ * Structure PathDir
+ * -----------------
+ * Répertoire du PATH et date de sa dernière modification connue (0 s'il
+ * n'existe pas): un programme ajouté, supprimé ou remplacé dans un
+ * répertoire change sa date, et le cache est alors oublié.
+ */
+typedef struct {
+    const char *dir;
+    uint64_t stamp;
+} PathDir;
+
+static PathEntry path_cache[EXEC_PATH_CACHE];
+static char *search_path;  /* PATH lu par executor_init(), découpé en path_dirs */
+static PathDir *path_dirs;
+static int num_path_dirs;
+
+/*
+ * Structure BuiltinPool
+ * ---------------------
+ * Threads d'exécution des commandes internes (builtin.c), un par worker:
+ * une commande interne occupe un worker comme un processus fils.
+ *
+ * Champs:
+ *   - lock / ready: Protection et signal de la file
+ *   - head / tail: Commandes à exécuter (chaînées par next)
+ *   - done_pipe: Commandes terminées, un pointeur ExecJob* par écriture
+ *     ([0] surveillé par le réacteur)
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    ExecJob *head;
+    ExecJob *tail;
+    int done_pipe[2];
+} BuiltinPool;
+
+static BuiltinPool pool = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, NULL,
+                            { -1, -1 } };
+#endif
+
+/*
+ * Fonction executor_default_workers()
+ * -----------------------------------
+ * Nombre de processus par défaut: nombre de cœurs en ligne.
+ */
+int executor_default_workers(void) {
+#ifdef _WIN32
+    return 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+/*
+ * Fonction executor_free_slots()
+ * ------------------------------
+ * Capacité libre annoncée au maître: processus inoccupés moins les
+ * commandes déjà en attente (jamais négative).
+ */
+int executor_free_slots(const Executor *ex) {
+    int free_slots = ex->workers - ex->num_running - ex->queue_len;
+    return free_slots > 0 ? free_slots : 0;
+}
+
+/* Crée une entrée ExecJob (commande copiée et terminée par '\0') */
+static ExecJob *job_create(unsigned int id, const char *command, size_t command_len,
+                           const struct sockaddr_in *reply_addr, socklen_t reply_len) {
+    ExecJob *job = calloc(1, sizeof(ExecJob));
+    if (!job) return NULL;
+
+    job->command = malloc(command_len + 1);
+    if (!job->command) {
+        free(job);
+        return NULL;
+    }
+    memcpy(job->command, command, command_len);
+    job->command[command_len] = '\0';
+    job->id = id;
+    job->reply_addr = *reply_addr;
+    job->reply_len = reply_len;
+    job->submit_us = monotonic_us();
+#ifndef _WIN32
+    job->out_fds[EXEC_STDOUT] = -1;
+    job->out_fds[EXEC_STDERR] = -1;
+    job->write_fds[EXEC_STDOUT] = -1;
+    job->write_fds[EXEC_STDERR] = -1;
+#endif
+    return job;
+}
+
+static void job_destroy(ExecJob *job) {
+#ifndef _WIN32
+    free(job->args);
+#endif
+    free(job->command);
+    free(job);
+}
+
+#ifndef _WIN32
+
+/* ----------------------------------------------------------------------------
+ * Implémentation POSIX: processus fils + SIGCHLD
+ * ---------------------------------------------------------------------------- */
+
+/*
+ * Fonction on_sigchld()
+ * ---------------------
+ * Gestionnaire de SIGCHLD: se contente de réveiller la boucle d'événements
+ * (seules les fonctions async-signal-safe sont autorisées ici).
+ */
+static void on_sigchld(int sig) {
+    int saved_errno = errno;
+    char byte = (char)sig;
+    if (write(sigchld_pipe[1], &byte, 1) < 0) {
+        /* Tube plein: un réveil est déjà en attente */
+    }
+    errno = saved_errno;
+}
+
+/* Rappel de lecture des tubes de sortie (défini plus bas) */
+static void on_output_readable(Reactor *r, SOCKET fd, int events, void *arg);
+
+/*
+ * Fonction make_pipe()
+ * --------------------
+ * Crée un tube dont les deux extrémités sont fermées à l'exec (un seul
+ * appel système sous Linux).
+ */
+static int make_pipe(int fds[2]) {
+#ifdef __linux__
+    return pipe2(fds, O_CLOEXEC);
+#else
+    if (pipe(fds) < 0) return -1;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return 0;
+#endif
+}
+
+/*
+ * Fonction split_simple_command()
+ * -------------------------------
+ * Découpe une commande simple en mots séparés par des espaces. La commande
+ * n'est pas simple (le shell doit l'interpréter) si elle contient un
+ * caractère de shell_special, si son premier mot est une affectation
+ * (VAR=valeur), ou si elle est trop longue. Une commande simple dont le
+ * premier mot est dans shell_words reste à lancer par le shell (voir
+ * shell_word()), mais peut être une commande interne de l'esclave.
+ *
+ * Paramètres:
+ *   command - Commande reçue
+ *   buf / cap - Copie découpée (les mots de argv y pointent)
+ *   argv - Mots de la commande, terminés par NULL
+ *
+ * Retourne:
+ *   Nombre de mots, -1 si la commande doit passer par le shell
+ */
+static int split_simple_command(const char *command, char *buf, size_t cap, char **argv) {
+    size_t len = strlen(command);
+    if (len >= cap || strpbrk(command, shell_special)) return -1;
+    memcpy(buf, command, len + 1);
+
+    int argc = 0;
+    char *p = buf;
+    while (*p) {
+        while (*p == ' ' || *p == '\t') *p++ = '\0';
+        if (!*p) break;
+        if (argc == EXEC_DIRECT_MAX_ARGS) return -1;
+        argv[argc++] = p;
+        while (*p && *p != ' ' && *p != '\t') p++;
+    }
+    argv[argc] = NULL;
+
+    if (argc == 0 || strchr(argv[0], '=')) return -1;
+    return argc;
+}
+
+/*
+ * Fonction shell_word()
+ * ---------------------
+ * Retourne:
+ *   1 si name est un mot réservé ou une commande interne du shell (la
+ *   commande passe par "/bin/sh -c", jamais lancée directement), 0 sinon
+ */
+static int shell_word(const char *name) {
+    for (int i = 0; shell_words[i]; i++) {
+        if (strcmp(name, shell_words[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+/* Emplacement du cache réservé à un programme */
+static PathEntry *path_slot(const char *name) {
+    uint32_t hash = 2166136261u;  /* FNV-1a */
+    for (const char *p = name; *p; p++) hash = (hash ^ (uint8_t)*p) * 16777619u;
+    return &path_cache[hash & (EXEC_PATH_CACHE - 1)];
+}
+
+/* Date de modification d'un répertoire (ns sous Linux), 0 s'il n'existe pas */
+static uint64_t dir_stamp(const char *dir) {
+    struct stat st;
+    if (stat(dir, &st) < 0) return 0;
+#ifdef __linux__
+    return (uint64_t)st.st_mtim.tv_sec * 1000000000u + (uint64_t)st.st_mtim.tv_nsec + 1;
+#else
+    return (uint64_t)st.st_mtime * 1000000000u + 1;
+#endif
+}
+
+/*
+ * Fonction check_path_dirs()
+ * --------------------------
+ * Relève la date de chaque répertoire du PATH et vide le cache des
+ * programmes si l'une d'elles a changé: comme le shell, qui cherche à
+ * chaque commande, un programme installé dans un répertoire placé plus
+ * tôt dans le PATH est trouvé dès la commande suivante.
+ */
+static void check_path_dirs(void) {
+    int changed = 0;
+    for (int i = 0; i < num_path_dirs; i++) {
+        uint64_t stamp = dir_stamp(path_dirs[i].dir);
+        if (stamp != path_dirs[i].stamp) {
+            path_dirs[i].stamp = stamp;
+            changed = 1;
+        }
+    }
+    if (changed) memset(path_cache, 0, sizeof(path_cache));
+}
+
+/* 1 si path est un fichier ordinaire exécutable (pas un répertoire) */
+static int is_program(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISREG(st.st_mode) && access(path, X_OK) == 0;
+}
+
+/*
+ * Fonction resolve_program()
+ * --------------------------
+ * Chemin de l'exécutable d'un programme: tel quel s'il contient un '/',
+ * sinon cherché dans le PATH. Le résultat est gardé en cache tant
+ * qu'aucun répertoire du PATH ne change (check_path_dirs()), et revérifié
+ * avant chaque lancement (droits retirés...).
+ *
+ * Retourne:
+ *   Chemin de l'exécutable, NULL si introuvable
+ */
+static const char *resolve_program(const char *name) {
+    if (strchr(name, '/')) return name;
+
+    size_t len = strlen(name);
+    if (len >= sizeof(path_cache[0].name) || !path_dirs) return NULL;
+
+    check_path_dirs();
+    PathEntry *entry = path_slot(name);
+    if (strcmp(entry->name, name) == 0) {
+        if (is_program(entry->path)) return entry->path;
+        entry->name[0] = '\0';
+    }
+
+    for (int i = 0; i < num_path_dirs; i++) {
+        char candidate[sizeof(entry->path)];
+        int n = snprintf(candidate, sizeof(candidate), "%s/%s", path_dirs[i].dir, name);
+        if (n > 0 && (size_t)n < sizeof(candidate) && is_program(candidate)) {
+            memcpy(entry->name, name, len + 1);
+            memcpy(entry->path, candidate, (size_t)n + 1);
+            return entry->path;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Fonction spawn_direct()
+ * -----------------------
+ * Lance une commande simple (argv, voir split_simple_command()) sans
+ * passer par le shell.
+ *
+ * Retourne:
+ *   0 si le fils est lancé, -1 si la commande doit passer par le shell
+ */
+static int spawn_direct(ExecJob *job, const posix_spawn_file_actions_t *actions,
+                        const posix_spawnattr_t *attr, char **argv) {
+    const char *path = resolve_program(argv[0]);
+    if (!path) return -1;  /* Le shell signalera "not found" (code 127) */
+
+    if (posix_spawn(&job->pid, path, actions, attr, argv, environ) != 0) {
+        /* Programme déplacé ou non exécutable: le cache est oublié */
+        if (path != argv[0]) path_slot(argv[0])->name[0] = '\0';
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Fonction spawn_process()
+ * ------------------------
+ * Lance la commande dans un processus fils dont stdout et stderr sont les
+ * côtés écriture out_w / err_w (fermés ici: seul le fils les garde).
+ * posix_spawn évite de dupliquer l'espace mémoire de l'esclave. L'esclave
+ * ignore SIGPIPE (page /metrics): le fils le retrouve par défaut, sans
+ * quoi "yes | head -1" afficherait une erreur d'écriture.
+ *
+ * Paramètres:
+ *   words - Mots de la commande si elle est simple (lancement direct),
+ *           NULL pour "/bin/sh -c commande"; une commande interne du
+ *           shell (shell_word()) passe toujours par le shell
+ *
+ * Retourne:
+ *   0 si le fils est lancé, -1 sinon
+ */
+static int spawn_process(Executor *ex, ExecJob *job, char **words, int out_w, int err_w) {
+    char *argv[] = { "sh", "-c", job->command, NULL };
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, out_w, STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, err_w, STDERR_FILENO);
+
+    posix_spawnattr_t attr;
+    sigset_t defaults;
+    posix_spawnattr_init(&attr);
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF);
+
+    int rc;
+    if (words && !shell_word(words[0]) && spawn_direct(job, &actions, &attr, words) == 0) {
+        ex->direct_spawns++;
+        rc = 0;
+    } else {
+        rc = posix_spawn(&job->pid, "/bin/sh", &actions, &attr, argv, environ);
+        if (rc == 0) ex->shell_spawns++;
+    }
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+
+    /* Seul le fils écrit: la fin de fichier arrivera à sa sortie */
+    close(out_w);
+    close(err_w);
+    return rc == 0 ? 0 : -1;
+}
+
+/*
+ * Fonction start_builtin()
+ * ------------------------
+ * Confie une commande interne au pool de threads. Ses mots sont recopiés
+ * dans la commande (un seul bloc) et le thread garde les côtés écriture
+ * des tubes jusqu'à la fin de la commande.
+ *
+ * Retourne:
+ *   0 si la commande est confiée, -1 sinon (out_w / err_w restent ouverts)
+ */
+static int start_builtin(ExecJob *job, BuiltinFn fn, int argc, char **words, int out_w, int err_w) {
+    size_t text = 0;
+    for (int i = 0; i < argc; i++) text += strlen(words[i]) + 1;
+
+    job->args = malloc((size_t)(argc + 1) * sizeof(char *) + text);
+    if (!job->args) return -1;
+    char *p = (char *)(job->args + argc + 1);
+    for (int i = 0; i < argc; i++) {
+        size_t len = strlen(words[i]) + 1;
+        memcpy(p, words[i], len);
+        job->args[i] = p;
+        p += len;
+    }
+    job->args[argc] = NULL;
+    job->argc = argc;
+    job->builtin = fn;
+    job->write_fds[EXEC_STDOUT] = out_w;
+    job->write_fds[EXEC_STDERR] = err_w;
+
+    pthread_mutex_lock(&pool.lock);
+    if (pool.tail) {
+        pool.tail->next = job;
+    } else {
+        pool.head = job;
+    }
+    pool.tail = job;
+    pthread_cond_signal(&pool.ready);
+    pthread_mutex_unlock(&pool.lock);
+    return 0;
+}
+
+/*
+ * Fonction start_job()
+ * --------------------
+ * Lance une commande: commande interne exécutée par un thread si elle est
+ * au registre (builtin.c), sinon processus fils, lancé directement si la
+ * commande est simple ou par "/bin/sh -c commande". Ses sorties sont
+ * redirigées vers deux tubes dont l'esclave garde le côté lecture (non
+ * bloquant).
+ *
+ * Retourne:
+ *   0 si la commande est lancée, -1 sinon
+ */
+static int start_job(Executor *ex, ExecJob *job) {
+    int out_pipe[2], err_pipe[2];
+
+    /* Le fils n'hérite que des copies placées sur 1 et 2 */
+    if (make_pipe(out_pipe) < 0) return -1;
+    if (make_pipe(err_pipe) < 0) {
+        close(out_pipe[0]);
+        close(out_pipe[1]);
+        return -1;
+    }
+
+    char buf[EXEC_DIRECT_MAX_LEN];
+    char *words[EXEC_DIRECT_MAX_ARGS + 1];
+    int argc = ex->direct ? split_simple_command(job->command, buf, sizeof(buf), words) : -1;
+    BuiltinFn fn = argc > 0 && ex->builtins ? builtin_find(argc, words) : NULL;
+
+    job->start_us = monotonic_us();
+    int rc;
+    if (fn && start_builtin(job, fn, argc, words, out_pipe[1], err_pipe[1]) == 0) {
+        rc = 0;
+    } else {
+        rc = spawn_process(ex, job, argc > 0 ? words : NULL, out_pipe[1], err_pipe[1]);
+    }
+    if (rc != 0) {
+        close(out_pipe[0]);
+        close(err_pipe[0]);
+        return -1;
+    }
+
+    job->out_fds[EXEC_STDOUT] = out_pipe[0];
+    job->out_fds[EXEC_STDERR] = err_pipe[0];
+    for (int s = EXEC_STDOUT; s <= EXEC_STDERR; s++) {
+        net_set_nonblocking(job->out_fds[s]);
+        if (reactor_add(ex->reactor, job->out_fds[s], REACTOR_READ, on_output_readable, ex) < 0) {
+            close(job->out_fds[s]);  /* Sortie perdue: SIGPIPE pour le fils (EPIPE en interne) */
+            job->out_fds[s] = -1;
+        }
+    }
+
+    for (int i = 0; i < ex->workers; i++) {
+        if (!ex->running[i]) {
+            ex->running[i] = job;
+            break;
+        }
+    }
+    ex->num_running++;
+    return 0;
+}
+
+/*
+ * Fonction start_queued_jobs()
+ * ----------------------------
+ * Lance les commandes en attente tant qu'il reste des processus libres.
+ */
+static void start_queued_jobs(Executor *ex) {
+    while (ex->queue_head && ex->num_running < ex->workers) {
+        ExecJob *job = ex->queue_head;
+        ex->queue_head = job->next;
+        if (!ex->queue_head) ex->queue_tail = NULL;
+        ex->queue_len--;
+        job->next = NULL;
+
+        if (start_job(ex, job) < 0) {
+            ex->on_done(job, -1, ex->ctx);
+            job_destroy(job);
+        }
+    }
+}
+
+/*
+ * Fonction finish_if_complete()
+ * -----------------------------
+ * Termine la commande de l'emplacement slot si son fils a été récupéré et
+ * que ses deux sorties ont été lues jusqu'au bout: son résultat est
+ * transmis au rappel de fin et sa place est libérée.
+ */
+static void finish_if_complete(Executor *ex, int slot) {
+    ExecJob *job = ex->running[slot];
+    if (!job->exited || job->out_fds[EXEC_STDOUT] >= 0 || job->out_fds[EXEC_STDERR] >= 0) return;
+
+    ex->running[slot] = NULL;
+    ex->num_running--;
+    ex->on_done(job, job->return_code, ex->ctx);
+    job_destroy(job);
+}
+
+/*
+ * Fonction on_output_readable()
+ * -----------------------------
+ * Rappel de la boucle d'événements: un tube de sortie est lisible (ou
+ * fermé par le fils). L'appelant y lit via son rappel de sortie; la
+ * commande est terminée si c'était la fin de sa dernière sortie.
+ */
+static void on_output_readable(Reactor *r, SOCKET fd, int events, void *arg) {
+    Executor *ex = (Executor *)arg;
+    (void)r;
+    (void)events;
+
+    for (int i = 0; i < ex->workers; i++) {
+        ExecJob *job = ex->running[i];
+        if (!job) continue;
+
+        int stream;
+        if (job->out_fds[EXEC_STDOUT] == fd) {
+            stream = EXEC_STDOUT;
+        } else if (job->out_fds[EXEC_STDERR] == fd) {
+            stream = EXEC_STDERR;
+        } else {
+            continue;
+        }
+
+        if (ex->on_output) {
+            ex->on_output(job, stream, ex->ctx);
+        } else {
+            uint8_t drain[4096];
+            while (executor_read_output(ex, job, stream, drain, sizeof(drain)) > 0) {
+                /* Sortie ignorée */
+            }
+        }
+        finish_if_complete(ex, i);
+        start_queued_jobs(ex);
+        return;
+    }
+}
+
+/*
+ * Fonction on_sigchld_readable()
+ * ------------------------------
+ * Rappel de la boucle d'événements: au moins un fils s'est terminé.
+ * Tous les fils terminés sont récupérés; ceux dont la sortie a été lue
+ * en entier sont terminés, puis les commandes en attente occupent les
+ * places libérées.
+ */
+static void on_sigchld_readable(Reactor *r, SOCKET fd, int events, void *arg) {
+    Executor *ex = (Executor *)arg;
+    char drain[64];
+    (void)r;
+    (void)events;
+
+    while (read(fd, drain, sizeof(drain)) > 0) {
+        /* Vidage du tube */
+    }
+
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        for (int i = 0; i < ex->workers; i++) {
+            ExecJob *job = ex->running[i];
+            if (!job || job->pid != pid) continue;
+
+            if (WIFEXITED(status)) {
+                job->return_code = WEXITSTATUS(status);
+            } else if (WIFSIGNALED(status)) {
+                job->return_code = 128 + WTERMSIG(status);  /* Convention du shell */
+            } else {
+                job->return_code = -1;
+            }
+            job->exited = 1;
+            finish_if_complete(ex, i);
+            break;
+        }
+    }
+
+    start_queued_jobs(ex);
+}
+
+/*
+ * Fonction builtin_thread_main()
+ * ------------------------------
+ * Thread du pool: exécute les commandes internes l'une après l'autre. En
+ * fin de commande, ferme ses sorties (fin de fichier pour la boucle
+ * d'événements) puis signale la commande sur done_pipe. Si la commande
+ * interne a renoncé (BUILTIN_FALLBACK), les sorties restent ouvertes pour
+ * le processus qui la remplacera.
+ */
+static void *builtin_thread_main(void *arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&pool.lock);
+        while (!pool.head) pthread_cond_wait(&pool.ready, &pool.lock);
+        ExecJob *job = pool.head;
+        pool.head = job->next;
+        if (!pool.head) pool.tail = NULL;
+        pthread_mutex_unlock(&pool.lock);
+        job->next = NULL;
+
+        job->builtin_code = job->builtin(job->argc, job->args, job->write_fds[EXEC_STDOUT],
+                                         job->write_fds[EXEC_STDERR]);
+        if (job->builtin_code != BUILTIN_FALLBACK) {
+            close(job->write_fds[EXEC_STDOUT]);
+            close(job->write_fds[EXEC_STDERR]);
+        }
+        while (write(pool.done_pipe[1], &job, sizeof(job)) < 0 && errno == EINTR) {
+            /* Écriture atomique (< PIPE_BUF) */
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Fonction on_builtin_done_readable()
+ * -----------------------------------
+ * Rappel de la boucle d'événements: des commandes internes sont
+ * terminées. Une commande terminée l'est comme un fils récupéré; une
+ * commande à laquelle le thread a renoncé est lancée dans un processus
+ * fils, sur les mêmes tubes.
+ */
+static void on_builtin_done_readable(Reactor *r, SOCKET fd, int events, void *arg) {
+    Executor *ex = (Executor *)arg;
+    ExecJob *done[64];
+    (void)r;
+    (void)events;
+
+    ssize_t n;
+    while ((n = read(fd, done, sizeof(done))) > 0) {
+        for (size_t k = 0; k < (size_t)n / sizeof(ExecJob *); k++) {
+            ExecJob *job = done[k];
+            int slot = 0;
+            while (slot < ex->workers && ex->running[slot] != job) slot++;
+            if (slot == ex->workers) continue;
+
+            if (job->builtin_code == BUILTIN_FALLBACK) {
+                if (spawn_process(ex, job, job->args, job->write_fds[EXEC_STDOUT],
+                                  job->write_fds[EXEC_STDERR]) == 0) {
+                    continue;  /* Fin signalée par SIGCHLD */
+                }
+                job->return_code = -1;
+            } else {
+                job->return_code = job->builtin_code;
+                ex->builtin_runs++;
+            }
+            job->exited = 1;
+            finish_if_complete(ex, slot);
+        }
+    }
+
+    start_queued_jobs(ex);
+}
+
+/*
+ * Fonction start_builtin_threads()
+ * --------------------------------
+ * Crée le pool de threads des commandes internes. Les threads ne reçoivent
+ * aucun signal: SIGCHLD et les autres restent traités par le thread
+ * principal.
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 sinon (les commandes internes sont désactivées)
+ */
+static int start_builtin_threads(Executor *ex) {
+    if (make_pipe(pool.done_pipe) < 0) return -1;
+    net_set_nonblocking(pool.done_pipe[0]);
+    if (reactor_add(ex->reactor, pool.done_pipe[0], REACTOR_READ, on_builtin_done_readable, ex) < 0) {
+        return -1;
+    }
+
+    sigset_t all, previous;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &previous);
+    int started = 0;
+    for (int i = 0; i < ex->workers; i++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, builtin_thread_main, NULL) != 0) break;
+        pthread_detach(thread);
+        started++;
+    }
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    return started == ex->workers ? 0 : -1;
+}
+
+/*
+ * Fonction executor_init()
+ * ------------------------
+ * Initialise un pool de workers processus et branche la réception de
+ * SIGCHLD sur la boucle d'événements.
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur
+ */
+int executor_init(Executor *ex, int workers, Reactor *reactor, exec_done_cb on_done,
+                  exec_output_cb on_output, void *ctx) {
+    memset(ex, 0, sizeof(*ex));
+    ex->workers = workers > 0 ? workers : 1;
+    ex->reactor = reactor;
+    ex->on_done = on_done;
+    ex->on_output = on_output;
+    ex->ctx = ctx;
+    ex->direct = 1;
+    ex->builtins = 1;
+    ex->running = calloc((size_t)ex->workers, sizeof(ExecJob *));
+    if (!ex->running) return -1;
+
+    /* Environnement lu une fois: le PATH sert à tous les lancements directs */
+    const char *path = getenv("PATH");
+    search_path = strdup(path ? path : "/usr/local/bin:/usr/bin:/bin");
+    if (search_path) {
+        int count = 1;
+        for (const char *p = search_path; *p; p++) count += *p == ':';
+        path_dirs = calloc((size_t)count, sizeof(PathDir));
+        for (char *dir = search_path; path_dirs && dir; ) {
+            char *end = strchr(dir, ':');
+            if (end) *end = '\0';
+            path_dirs[num_path_dirs++].dir = *dir ? dir : ".";  /* Vide: répertoire courant */
+            dir = end ? end + 1 : NULL;
+        }
+    }
+
+    if (pipe(sigchld_pipe) < 0) return -1;
+    net_set_nonblocking(sigchld_pipe[0]);
+    net_set_nonblocking(sigchld_pipe[1]);
+    fcntl(sigchld_pipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(sigchld_pipe[1], F_SETFD, FD_CLOEXEC);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_sigchld;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    if (sigaction(SIGCHLD, &sa, NULL) < 0) return -1;
+
+    builtin_init();
+    if (start_builtin_threads(ex) < 0) {
+        /* Moins de threads que de workers: tout passe par des processus */
+        ex->builtins = 0;
+    }
+
+    return reactor_add(reactor, sigchld_pipe[0], REACTOR_READ, on_sigchld_readable, ex);
+}
+
+/*
+ * Fonction executor_submit()
+ * --------------------------
+ * Confie une commande à l'exécuteur: lancement immédiat si un processus
+ * est libre, mise en file d'attente sinon. La commande (command_len
+ * octets, sans terminateur) est copiée.
+ *
+ * Retourne:
+ *   0 si la commande est acceptée, -1 si la file d'attente est pleine
+ *   (ou en cas d'erreur d'allocation)
+ */
+int executor_submit(Executor *ex, unsigned int id, const char *command, size_t command_len,
+                    const struct sockaddr_in *reply_addr, socklen_t reply_len) {
+    if (ex->queue_len >= EXEC_QUEUE_MAX) return -1;
+
+    ExecJob *job = job_create(id, command, command_len, reply_addr, reply_len);
+    if (!job) return -1;
+
+    if (ex->queue_tail) {
+        ex->queue_tail->next = job;
+    } else {
+        ex->queue_head = job;
+    }
+    ex->queue_tail = job;
+    ex->queue_len++;
+
+    start_queued_jobs(ex);
+    return 0;
+}
+
+/*
+ * Fonction executor_read_output()
+ * -------------------------------
+ * Lit la sortie disponible d'une commande, directement dans buf. À la fin
+ * du flux, le tube est fermé et retiré de la boucle d'événements.
+ *
+ * Paramètres:
+ *   job - Commande en cours
+ *   stream - EXEC_STDOUT ou EXEC_STDERR
+ *   buf / cap - Destination des données
+ *
+ * Retourne:
+ *   Nombre d'octets lus (> 0), 0 si rien n'est disponible pour l'instant,
+ *   -1 si le flux est terminé
+ */
+long executor_read_output(Executor *ex, ExecJob *job, int stream, uint8_t *buf, size_t cap) {
+    int fd = job->out_fds[stream];
+    if (fd < 0) return -1;
+
+    ssize_t n = read(fd, buf, cap);
+    if (n > 0) return (long)n;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+
+    reactor_remove(ex->reactor, fd);
+    close(fd);
+    job->out_fds[stream] = -1;
+    return -1;
+}
+
+/*
+ * Fonction executor_pause_output()
+ * --------------------------------
+ * Suspend (paused = 1) ou reprend la lecture des sorties d'une commande.
+ * Les tubes sont retirés de la boucle d'événements plutôt que désarmés:
+ * un tube fermé par le fils signale EPOLLHUP même sans événement demandé.
+ */
+void executor_pause_output(Executor *ex, ExecJob *job, int paused) {
+    for (int s = EXEC_STDOUT; s <= EXEC_STDERR; s++) {
+        int fd = job->out_fds[s];
+        if (fd < 0) continue;
+        if (paused) {
+            reactor_remove(ex->reactor, fd);
+        } else {
+            reactor_add(ex->reactor, fd, REACTOR_READ, on_output_readable, ex);
+        }
+    }
+}
+
+#else /* _WIN32 */
+
+/* ----------------------------------------------------------------------------
+ * Implémentation Windows: exécution synchrone avec system()
+ * ---------------------------------------------------------------------------- */
+
+int executor_init(Executor *ex, int workers, Reactor *reactor, exec_done_cb on_done,
+                  exec_output_cb on_output, void *ctx) {
+    (void)workers;
+    memset(ex, 0, sizeof(*ex));
+    ex->workers = 1;
+    ex->reactor = reactor;
+    ex->on_done = on_done;
+    ex->on_output = on_output;
+    ex->ctx = ctx;
+    return 0;
+}
+
+int executor_submit(Executor *ex, unsigned int id, const char *command, size_t command_len,
+                    const struct sockaddr_in *reply_addr, socklen_t reply_len) {
+    ExecJob *job = job_create(id, command, command_len, reply_addr, reply_len);
+    if (!job) return -1;
+
+    job->start_us = monotonic_us();
+    ex->num_running = 1;
+    int ret = system(job->command);
+    ex->num_running = 0;
+
+    ex->on_done(job, ret, ex->ctx);
+    job_destroy(job);
+    return 0;
+}
+
+/* Sortie non capturée sous Windows: elle s'affiche dans la console */
+long executor_read_output(Executor *ex, ExecJob *job, int stream, uint8_t *buf, size_t cap) {
+    (void)ex;
+    (void)job;
+    (void)stream;
+    (void)buf;
+    (void)cap;
+    return -1;
+}
+
+void executor_pause_output(Executor *ex, ExecJob *job, int paused) {
+    (void)ex;
+    (void)job;
+    (void)paused;
+}
+
+#endif /* _WIN32 */
@@ -0,0 +1,189 @@
+/*
+ * ============================================================================
+ * EXECUTOR - Pool borné de processus d'exécution des commandes (esclave)
+ * ============================================================================
+ *
+ * Description:
+ *   L'esclave n'exécute plus les commandes une par une avec system() dans
+ *   sa boucle de réception. Chaque commande reçue est confiée à l'exécuteur,
+ *   qui lance au plus N processus fils simultanés (/bin/sh -c commande via
+ *   posix_spawn) et met les suivantes en file d'attente.
+ *
+ *   La fin d'un fils est signalée par SIGCHLD: le gestionnaire de signal
+ *   écrit un octet dans un tube (self-pipe) surveillé par la boucle
+ *   d'événements de l'esclave, qui récupère alors les fils terminés avec
+ *   waitpid(WNOHANG) et appelle la fonction de rappel de fin.
+ *
+ *   La sortie standard et la sortie d'erreur de chaque fils sont
+ *   redirigées vers deux tubes, lus par la boucle d'événements: le rappel
+ *   de sortie est appelé dès que l'un d'eux est lisible, et l'appelant y
+ *   lit lui-même les données (executor_read_output()) directement dans
+ *   son tampon d'envoi. S'il ne peut plus rien absorber, il suspend la
+ *   lecture (executor_pause_output()): le tube se remplit et le fils se
+ *   bloque en écriture, ce qui borne la mémoire quelle que soit la taille
+ *   de la sortie. Une commande n'est terminée qu'une fois le fils récupéré
+ *   ET ses deux tubes vidés jusqu'à la fin de fichier.
+ *
+ *   Lancement direct: la plupart des commandes reçues sont simples
+ *   ("sleep 0.01", "gzip -9 fichier") et passer par /bin/sh coûte un
+ *   exec de plus et l'analyse de la ligne, souvent davantage que la
+ *   commande elle-même. Une commande sans aucune syntaxe du shell
+ *   (redirection, tube, guillemets, variable, motif, affectation, mot
+ *   réservé ou commande interne) est découpée en mots et lancée
+ *   directement par posix_spawn. Le chemin de chaque programme est
+ *   cherché une fois dans le PATH lu au démarrage puis gardé en cache.
+ *   Toute autre commande, ou un échec du lancement direct (programme
+ *   introuvable, script sans interpréteur...), passe par "/bin/sh -c",
+ *   qui produit les mêmes messages et codes d'erreur qu'auparavant.
+ *
+ *   Commandes internes: echo, sleep, true, touch, cp, cksum... (voir
+ *   builtin.h) ne lancent aucun processus. Un pool de threads, un par
+ *   worker, les exécute en écrivant dans les mêmes tubes qu'un fils; la
+ *   fin d'une commande interne est signalée à la boucle d'événements par
+ *   un tube, comme SIGCHLD.
+ *
+ *   Sous Windows (pas de fork), les commandes sont exécutées de façon
+ *   synchrone avec system(), comme auparavant, sans capture de la sortie.
+ *
+ * ============================================================================
+ */
+
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "builtin.h"
+#include "net_compat.h"
+#include "reactor.h"
+
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+/* Nombre maximal de commandes en attente d'un processus libre */
+#define EXEC_QUEUE_MAX 4096
+
+/* Lancement direct: longueur de commande et nombre de mots au-delà desquels le shell est utilisé */
+#define EXEC_DIRECT_MAX_LEN 4096
+#define EXEC_DIRECT_MAX_ARGS 64
+
+/* Programmes dont le chemin est gardé en cache (puissance de 2) */
+#define EXEC_PATH_CACHE 64
+
+/* Flux de sortie capturés d'une commande */
+#define EXEC_STDOUT 0
+#define EXEC_STDERR 1
+
+/*
+ * Structure ExecJob
+ * -----------------
+ * Commande confiée à l'exécuteur.
+ *
+ * Champs:
+ *   - id: Identifiant attribué par le maître
+ *   - command: Commande shell (copie allouée)
+ *   - reply_addr / reply_len: Adresse à laquelle renvoyer le résultat
+ *   - pid: Processus fils exécutant la commande (0 = en attente)
+ *   - out_fds: Côté lecture des tubes stdout / stderr (-1 = fermé)
+ *   - exited / return_code: Fils récupéré et son code de sortie
+ *   - builtin / args / argc: Commande interne et ses mots (NULL sinon)
+ *   - write_fds: Côté écriture des tubes, tenu par le thread de la
+ *     commande interne
+ *   - builtin_code: Code de retour de la commande interne
+ *   - submit_us: Instant de réception (horloge monotone)
+ *   - start_us: Instant de lancement (horloge monotone)
+ *   - user: Donnée libre de l'appelant (NULL à la création)
+ *   - next: Chaînage de la file d'attente
+ */
+typedef struct ExecJob {
+    unsigned int id;
+    char *command;
+    struct sockaddr_in reply_addr;
+    socklen_t reply_len;
+#ifndef _WIN32
+    pid_t pid;
+    int out_fds[2];
+    int exited;
+    int return_code;
+    BuiltinFn builtin;
+    char **args;
+    int argc;
+    int write_fds[2];
+    int builtin_code;
+#endif
+    uint64_t submit_us;
+    uint64_t start_us;
+    void *user;
+    struct ExecJob *next;
+} ExecJob;
+
+/*
+ * Type exec_done_cb
+ * -----------------
+ * Appelé lorsqu'une commande est terminée (ou n'a pas pu être lancée).
+ *
+ * Paramètres:
+ *   job - Commande terminée (libérée par l'exécuteur après l'appel)
+ *   return_code - Code de sortie (128 + signal si tuée, -1 si non lancée)
+ *   ctx - Contexte fourni à executor_init()
+ */
+typedef void (*exec_done_cb)(ExecJob *job, int return_code, void *ctx);
+
+/*
+ * Type exec_output_cb
+ * -------------------
+ * Appelé lorsqu'un flux de sortie de la commande est lisible; l'appelant
+ * y lit avec executor_read_output() autant qu'il peut en absorber.
+ *
+ * Paramètres:
+ *   job - Commande en cours
+ *   stream - EXEC_STDOUT ou EXEC_STDERR
+ *   ctx - Contexte fourni à executor_init()
+ */
+typedef void (*exec_output_cb)(ExecJob *job, int stream, void *ctx);
+
+/*
+ * Structure Executor
+ * ------------------
+ * Champs:
+ *   - workers: Nombre maximal de processus simultanés
+ *   - running: Commandes en cours (tableau de taille workers)
+ *   - num_running: Nombre d'entrées non nulles dans running
+ *   - queue_head / queue_tail / queue_len: File d'attente FIFO
+ *   - reactor: Boucle d'événements surveillant les tubes de sortie
+ *   - on_done / on_output / ctx: Rappels de fin de commande et de sortie
+ *   - direct: 1 pour lancer les commandes simples sans /bin/sh (défaut)
+ *   - builtins: 1 pour exécuter les commandes internes dans l'esclave (défaut)
+ *   - direct_spawns / shell_spawns: Commandes lancées directement / par le shell
+ *   - builtin_runs: Commandes exécutées par une commande interne
+ */
+typedef struct {
+    int workers;
+    ExecJob **running;
+    int num_running;
+    ExecJob *queue_head;
+    ExecJob *queue_tail;
+    int queue_len;
+    Reactor *reactor;
+    exec_done_cb on_done;
+    exec_output_cb on_output;
+    void *ctx;
+    int direct;
+    int builtins;
+    uint64_t direct_spawns;
+    uint64_t shell_spawns;
+    uint64_t builtin_runs;
+} Executor;
+
+int executor_init(Executor *ex, int workers, Reactor *reactor, exec_done_cb on_done,
+                  exec_output_cb on_output, void *ctx);
+int executor_submit(Executor *ex, unsigned int id, const char *command, size_t command_len,
+                    const struct sockaddr_in *reply_addr, socklen_t reply_len);
+int executor_free_slots(const Executor *ex);
+long executor_read_output(Executor *ex, ExecJob *job, int stream, uint8_t *buf, size_t cap);
+void executor_pause_output(Executor *ex, ExecJob *job, int paused);
+int executor_default_workers(void);
+
+#endif /* EXECUTOR_H */
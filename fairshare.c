@@ -0,0 +1,171 @@
+/*
+ * ============================================================================
+ * FAIRSHARE - Partage équitable des esclaves entre les clients (maître)
+ * ============================================================================
+ *
+ * Voir fairshare.h pour la description.
+ *
+ * Les locataires sont peu nombreux (un par machine cliente): la table est
+ * parcourue linéairement. Toutes les fonctions acceptent l'index -1
+ * (locataire non créé faute de mémoire), sans effet: la connexion est
+ * alors servie sans borne.
+ *
+ * ============================================================================
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "fairshare.h"
+
+/* ============================================================================
+ * INTERFACE PUBLIQUE
+ * ============================================================================ */
+
+/*
+ * Fonction fair_init()
+ * --------------------
+ * Initialise la table des locataires, vide.
+ *
+ * Paramètres:
+ *   f - Table des locataires
+ *   max_running - Commandes distribuées à la fois par locataire (0 = aucune borne)
+ *   max_jobs - Fichiers en cours par locataire (0 = aucune borne)
+ */
+void fair_init(FairShare *f, int max_running, int max_jobs) {
+    memset(f, 0, sizeof(*f));
+    f->max_running = max_running;
+    f->max_jobs = max_jobs;
+}
+
+void fair_free(FairShare *f) {
+    free(f->tenants);
+    f->tenants = NULL;
+    f->num_tenants = 0;
+    f->tenants_cap = 0;
+}
+
+/*
+ * Fonction fair_tenant()
+ * ----------------------
+ * Locataire d'une adresse IP, créé (poids 1) à sa première connexion.
+ *
+ * Retourne:
+ *   Index du locataire, ou -1 en cas d'erreur d'allocation
+ */
+int fair_tenant(FairShare *f, uint32_t ip) {
+    for (int i = 0; i < f->num_tenants; i++) {
+        if (f->tenants[i].ip == ip) return i;
+    }
+
+    if (f->num_tenants == f->tenants_cap) {
+        int cap = f->tenants_cap > 0 ? f->tenants_cap * 2 : 16;
+        Tenant *tenants = realloc(f->tenants, (size_t)cap * sizeof(Tenant));
+        if (!tenants) return -1;
+        f->tenants = tenants;
+        f->tenants_cap = cap;
+    }
+
+    int t = f->num_tenants++;
+    memset(&f->tenants[t], 0, sizeof(Tenant));
+    f->tenants[t].ip = ip;
+    f->tenants[t].weight = 1;
+    f->tenants[t].vtime = f->vclock;
+    return t;
+}
+
+/*
+ * Fonction fair_set_weight()
+ * --------------------------
+ * Fixe le poids d'une adresse IP (option --client-weight).
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 si le poids est invalide ou en cas d'erreur
+ *   d'allocation
+ */
+int fair_set_weight(FairShare *f, uint32_t ip, int weight) {
+    if (weight < 1 || weight > FAIR_MAX_WEIGHT) return -1;
+
+    int t = fair_tenant(f, ip);
+    if (t < 0) return -1;
+    f->tenants[t].weight = weight;
+    return 0;
+}
+
+/*
+ * Fonction fair_admit()
+ * ---------------------
+ * Contrôle d'admission d'un nouveau fichier du locataire. En cas de
+ * succès, le fichier est compté (fair_start_job()).
+ *
+ * Retourne:
+ *   0 si le fichier est accepté, -1 si le locataire en a déjà max_jobs
+ *   en cours
+ */
+int fair_admit(FairShare *f, int t) {
+    if (t < 0) return 0;
+    if (f->max_jobs > 0 && f->tenants[t].jobs >= f->max_jobs) {
+        f->tenants[t].rejected++;
+        return -1;
+    }
+    fair_start_job(f, t);
+    return 0;
+}
+
+/* Fichier du locataire accepté sans contrôle (travail repris du journal) */
+void fair_start_job(FairShare *f, int t) {
+    if (t >= 0) f->tenants[t].jobs++;
+}
+
+void fair_end_job(FairShare *f, int t) {
+    if (t >= 0) f->tenants[t].jobs--;
+}
+
+/*
+ * Fonction fair_activate()
+ * ------------------------
+ * Une connexion du locataire entre en phase de distribution. S'il était
+ * inactif, son temps virtuel est ramené au temps courant: l'inactivité
+ * ne donne pas de priorité sur les locataires déjà servis.
+ */
+void fair_activate(FairShare *f, int t) {
+    if (t < 0) return;
+    Tenant *tenant = &f->tenants[t];
+    if (tenant->active++ == 0 && tenant->vtime < f->vclock) {
+        tenant->vtime = f->vclock;
+    }
+}
+
+void fair_deactivate(FairShare *f, int t) {
+    if (t >= 0) f->tenants[t].active--;
+}
+
+/*
+ * Fonction fair_may_dispatch()
+ * ----------------------------
+ * Retourne:
+ *   1 si le locataire peut recevoir une commande de plus (max_running)
+ */
+int fair_may_dispatch(const FairShare *f, int t) {
+    return t < 0 || f->max_running == 0 || f->tenants[t].running < f->max_running;
+}
+
+/*
+ * Fonction fair_on_dispatch()
+ * ---------------------------
+ * Enregistre la distribution d'une commande du locataire: son temps
+ * virtuel avance d'autant moins que son poids est élevé.
+ */
+void fair_on_dispatch(FairShare *f, int t) {
+    if (t < 0) return;
+    Tenant *tenant = &f->tenants[t];
+    f->vclock = tenant->vtime;
+    tenant->vtime += FAIR_UNIT / (uint64_t)tenant->weight;
+    tenant->running++;
+    tenant->dispatched++;
+}
+
+/* Commande du locataire terminée (ou abandonnée) */
+void fair_on_release(FairShare *f, int t) {
+    if (t >= 0) f->tenants[t].running--;
+}
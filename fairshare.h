@@ -0,0 +1,97 @@
+/*
+ * ============================================================================
+ * FAIRSHARE - Partage équitable des esclaves entre les clients (maître)
+ * ============================================================================
+ *
+ * Description:
+ *   Les connexions d'une même adresse IP forment un locataire (tenant).
+ *   Chaque locataire a un poids (1 par défaut) et un temps virtuel qui
+ *   avance de 1/poids à chaque commande distribuée: le maître sert
+ *   d'abord le locataire le moins servi (file équitable pondérée, WFQ).
+ *   Un gros fichier ne retarde donc plus les petites soumissions des
+ *   autres clients: à poids égaux, chacun reçoit la même part des
+ *   esclaves.
+ *
+ *   Un locataire qui redevient actif reprend au temps virtuel courant
+ *   (celui de la dernière commande distribuée): il ne cumule pas de
+ *   crédit pendant son inactivité.
+ *
+ *   Bornes facultatives, par locataire:
+ *   - max_running: commandes distribuées (en file ou en cours) à la fois;
+ *   - max_jobs: fichiers soumis en cours (contrôle d'admission: au-delà,
+ *     la soumission est refusée et le client invité à réessayer).
+ *
+ * ============================================================================
+ */
+
+#ifndef FAIRSHARE_H
+#define FAIRSHARE_H
+
+#include <stdint.h>
+
+/* Avance du temps virtuel pour une commande d'un locataire de poids 1 */
+#define FAIR_UNIT 1000000ULL
+
+/* Poids maximal d'un locataire */
+#define FAIR_MAX_WEIGHT 1000
+
+/*
+ * Structure Tenant
+ * ----------------
+ * Champs:
+ *   - ip: Adresse IPv4 du locataire (ordre réseau)
+ *   - weight: Poids (part des esclaves relative aux autres locataires)
+ *   - vtime: Temps virtuel (commandes distribuées, pondérées)
+ *   - active: Connexions en phase de distribution
+ *   - jobs: Fichiers soumis non terminés
+ *   - running: Commandes distribuées sans résultat
+ *   - dispatched: Nombre total de commandes distribuées
+ *   - rejected: Nombre de soumissions refusées
+ */
+typedef struct {
+    uint32_t ip;
+    int weight;
+    uint64_t vtime;
+    int active;
+    int jobs;
+    int running;
+    unsigned long dispatched;
+    unsigned long rejected;
+} Tenant;
+
+/*
+ * Structure FairShare
+ * -------------------
+ * Champs:
+ *   - tenants / num_tenants / tenants_cap: Locataires connus (jamais
+ *     retirés: leurs index restent valides)
+ *   - vclock: Temps virtuel de la dernière commande distribuée
+ *   - max_running / max_jobs: Bornes par locataire (0 = aucune)
+ */
+typedef struct {
+    Tenant *tenants;
+    int num_tenants;
+    int tenants_cap;
+    uint64_t vclock;
+    int max_running;
+    int max_jobs;
+} FairShare;
+
+void fair_init(FairShare *f, int max_running, int max_jobs);
+void fair_free(FairShare *f);
+
+int fair_tenant(FairShare *f, uint32_t ip);
+int fair_set_weight(FairShare *f, uint32_t ip, int weight);
+
+int fair_admit(FairShare *f, int t);
+void fair_start_job(FairShare *f, int t);
+void fair_end_job(FairShare *f, int t);
+
+void fair_activate(FairShare *f, int t);
+void fair_deactivate(FairShare *f, int t);
+
+int fair_may_dispatch(const FairShare *f, int t);
+void fair_on_dispatch(FairShare *f, int t);
+void fair_on_release(FairShare *f, int t);
+
+#endif /* FAIRSHARE_H */
@@ -0,0 +1,142 @@
+/*
+ * ============================================================================
+ * INFLIGHT - Table des commandes envoyées en attente de résultat
+ * ============================================================================
+ *
+ * Voir inflight.h pour la description de l'interface.
+ *
+ * Les identifiants sont attribués séquentiellement: le hachage multiplicatif
+ * de Fibonacci les répartit uniformément sur la table.
+ *
+ * ============================================================================
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "inflight.h"
+
+/* La table est agrandie au-delà de ce taux de remplissage (en %) */
+#define INFLIGHT_MAX_LOAD 70
+
+static size_t slot_of(const InflightTable *t, unsigned int id) {
+    return (size_t)((id * 2654435769u) & (unsigned int)(t->capacity - 1));
+}
+
+/*
+ * Fonction inflight_init()
+ * ------------------------
+ * Initialise une table vide. La capacité est arrondie à une puissance de 2.
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation
+ */
+int inflight_init(InflightTable *t, size_t initial_capacity) {
+    size_t cap = 16;
+    while (cap < initial_capacity) cap *= 2;
+
+    t->slots = calloc(cap, sizeof(InflightCmd));
+    if (!t->slots) return -1;
+    t->capacity = cap;
+    t->count = 0;
+    return 0;
+}
+
+void inflight_free(InflightTable *t) {
+    free(t->slots);
+    t->slots = NULL;
+    t->capacity = 0;
+    t->count = 0;
+}
+
+/* Double la capacité et réinsère toutes les entrées */
+static int grow(InflightTable *t) {
+    InflightTable bigger;
+    if (inflight_init(&bigger, t->capacity * 2) < 0) return -1;
+
+    for (size_t i = 0; i < t->capacity; i++) {
+        if (t->slots[i].id == 0) continue;
+        size_t j = slot_of(&bigger, t->slots[i].id);
+        while (bigger.slots[j].id != 0) j = (j + 1) & (bigger.capacity - 1);
+        bigger.slots[j] = t->slots[i];
+        bigger.count++;
+    }
+
+    free(t->slots);
+    *t = bigger;
+    return 0;
+}
+
+/*
+ * Fonction inflight_insert()
+ * --------------------------
+ * Réserve l'emplacement de la commande id (id != 0, non déjà présent).
+ *
+ * Retourne:
+ *   Pointeur vers l'entrée (à compléter par l'appelant), ou NULL si
+ *   l'agrandissement de la table a échoué. Le pointeur reste valide
+ *   jusqu'à la prochaine insertion ou suppression.
+ */
+InflightCmd *inflight_insert(InflightTable *t, unsigned int id) {
+    if ((t->count + 1) * 100 > t->capacity * INFLIGHT_MAX_LOAD) {
+        if (grow(t) < 0) return NULL;
+    }
+
+    size_t i = slot_of(t, id);
+    while (t->slots[i].id != 0) i = (i + 1) & (t->capacity - 1);
+
+    memset(&t->slots[i], 0, sizeof(InflightCmd));
+    t->slots[i].id = id;
+    t->count++;
+    return &t->slots[i];
+}
+
+/*
+ * Fonction inflight_find()
+ * ------------------------
+ * Recherche la commande id.
+ *
+ * Retourne:
+ *   Pointeur vers l'entrée, ou NULL si la commande est inconnue
+ */
+InflightCmd *inflight_find(InflightTable *t, unsigned int id) {
+    if (id == 0) return NULL;
+
+    size_t i = slot_of(t, id);
+    while (t->slots[i].id != 0) {
+        if (t->slots[i].id == id) return &t->slots[i];
+        i = (i + 1) & (t->capacity - 1);
+    }
+    return NULL;
+}
+
+/*
+ * Fonction inflight_remove()
+ * --------------------------
+ * Supprime une entrée obtenue par inflight_find()/inflight_insert().
+ * Les entrées suivantes de la même chaîne de sondage sont décalées vers
+ * l'arrière pour ne pas laisser de trou (pas de marqueur de suppression).
+ */
+void inflight_remove(InflightTable *t, InflightCmd *cmd) {
+    size_t mask = t->capacity - 1;
+    size_t hole = (size_t)(cmd - t->slots);
+    size_t i = hole;
+
+    while (1) {
+        i = (i + 1) & mask;
+        if (t->slots[i].id == 0) break;
+
+        /* L'entrée i peut combler le trou si sa position idéale ne se
+         * situe pas (circulairement) entre le trou et i. */
+        size_t ideal = slot_of(t, t->slots[i].id);
+        int movable = (hole <= i) ? (ideal <= hole || ideal > i)
+                                  : (ideal <= hole && ideal > i);
+        if (movable) {
+            t->slots[hole] = t->slots[i];
+            hole = i;
+        }
+    }
+
+    memset(&t->slots[hole], 0, sizeof(InflightCmd));
+    t->count--;
+}
@@ -0,0 +1,96 @@
+/*
+ * ============================================================================
+ * INFLIGHT - Table des commandes envoyées en attente de résultat
+ * ============================================================================
+ *
+ * Description:
+ *   Chaque commande attribuée à un esclave reçoit un identifiant unique (id),
+ *   renvoyé tel quel par l'esclave dans son acquittement et son résultat.
+ *   La table associe cet identifiant à l'esclave choisi, à l'instant
+ *   d'envoi et à la trame envoyée, ce qui permet au maître de décompter les
+ *   commandes en cours, de mesurer la latence et de retransmettre.
+ *
+ *   Implémentation: table de hachage à adressage ouvert (sondage linéaire,
+ *   suppression par décalage arrière), agrandie automatiquement.
+ *
+ * ============================================================================
+ */
+
+#ifndef INFLIGHT_H
+#define INFLIGHT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Structure InflightCmd
+ * ---------------------
+ * Commande envoyée dont le résultat n'est pas encore revenu.
+ *
+ * Champs:
+ *   - id: Identifiant de la commande (0 = emplacement libre)
+ *   - slave_idx: Esclave auquel la commande a été envoyée
+ *   - sent_us: Instant d'envoi (horloge monotone, microsecondes)
+ *   - queued_us: Instant de mise en file chez le maître (attente avant
+ *     envoi, exposée par /metrics)
+ *   - client_idx / client_gen: Connexion cliente d'origine (emplacement et
+ *     génération, pour ignorer le résultat si le client est parti)
+ *   - seq: Rang de la commande dans le fichier du client (à partir de 1)
+ *   - frame / frame_len: Trame MSG_COMMAND encodée, pour la retransmission
+ *   - acked: 1 dès que l'esclave a acquitté la commande (MSG_ACK)
+ *   - retries: Retransmissions depuis l'envoi ou le premier acquittement
+ *     (exposant du délai d'attente)
+ *   - misses: Retransmissions consécutives restées sans réponse
+ *   - serial: Numéro de la dernière échéance planifiée (voir retry.h)
+ *   - out_next: Rang du prochain morceau de sortie attendu (MSG_OUTPUT)
+ *   - queued: 1 tant que la commande attend dans la file de son esclave,
+ *     chez le maître (pas encore envoyée)
+ *   - dag_node: Identifiant déclaré par la commande dans le graphe des
+ *     dépendances de son fichier (-1 = aucun, voir dag.h)
+ *   - cache: Entrée du cache des résultats en attente de cette commande
+ *     (NULL = aucune, voir cache.h)
+ *   - tenant: Locataire du client d'origine (voir fairshare.h), -1 = aucun
+ */
+typedef struct {
+    unsigned int id;
+    int slave_idx;
+    uint64_t sent_us;
+    uint64_t queued_us;
+    int client_idx;
+    unsigned int client_gen;
+    unsigned int seq;
+    uint8_t *frame;
+    size_t frame_len;
+    int acked;
+    unsigned int retries;
+    unsigned int misses;
+    unsigned int serial;
+    uint32_t out_next;
+    int queued;
+    int dag_node;
+    struct CacheEntry *cache;
+    int tenant;
+} InflightCmd;
+
+/*
+ * Structure InflightTable
+ * -----------------------
+ * Champs:
+ *   - slots: Tableau d'emplacements (taille = puissance de 2)
+ *   - capacity: Nombre d'emplacements
+ *   - count: Nombre d'emplacements occupés
+ */
+typedef struct {
+    InflightCmd *slots;
+    size_t capacity;
+    size_t count;
+} InflightTable;
+
+int inflight_init(InflightTable *t, size_t initial_capacity);
+void inflight_free(InflightTable *t);
+
+InflightCmd *inflight_insert(InflightTable *t, unsigned int id);
+InflightCmd *inflight_find(InflightTable *t, unsigned int id);
+void inflight_remove(InflightTable *t, InflightCmd *cmd);
+
+#endif /* INFLIGHT_H */
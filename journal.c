@@ -0,0 +1,320 @@
+/*
+ * ============================================================================
+ * JOURNAL - Journal des travaux du maître, pour la reprise après un arrêt
+ * ============================================================================
+ *
+ * Voir journal.h pour le format et la description de l'interface.
+ *
+ * ============================================================================
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define open _open
+#define read _read
+#define write _write
+#define close _close
+#define ftruncate _chsize
+#define fdatasync _commit
+#define lseek _lseek
+#define JOURNAL_OPEN_FLAGS (O_RDWR | O_CREAT | O_APPEND | O_BINARY)
+#else
+#include <unistd.h>
+#define JOURNAL_OPEN_FLAGS (O_RDWR | O_CREAT | O_APPEND)
+#endif
+
+#include "journal.h"
+
+/* ============================================================================
+ * ENCODAGE
+ * ============================================================================ */
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* Contrôle FNV-1a de len octets */
+static uint32_t checksum(const uint8_t *p, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* ============================================================================
+ * THREAD D'ÉCRITURE
+ * ============================================================================ */
+
+/* Écrit len octets, en reprenant après une écriture partielle */
+static int write_all(int fd, const uint8_t *p, size_t len) {
+    while (len > 0) {
+        int n = (int)write(fd, p, (unsigned int)len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/*
+ * Fonction journal_main()
+ * -----------------------
+ * Boucle du thread d'écriture: attend des enregistrements, échange les
+ * tampons, écrit et synchronise le lot hors du verrou.
+ */
+static void *journal_main(void *arg) {
+    Journal *j = (Journal *)arg;
+
+    pthread_mutex_lock(&j->lock);
+    while (1) {
+        while (j->len == 0 && !j->reset && !j->stop) {
+            j->sleeping = 1;
+            pthread_cond_wait(&j->wake, &j->lock);
+            j->sleeping = 0;
+        }
+        if (j->len == 0 && !j->reset) break;  /* Arrêt, tout est écrit */
+
+        /* Échange des tampons: la boucle d'événements remplit le vide */
+        uint8_t *batch = j->buf;
+        size_t batch_len = j->len;
+        size_t batch_cap = j->cap;
+        j->buf = j->spare;
+        j->cap = j->spare_cap;
+        j->len = 0;
+        j->spare = batch;
+        j->spare_cap = batch_cap;
+        int reset = j->reset;
+        j->reset = 0;
+        pthread_mutex_unlock(&j->lock);
+
+        int err = 0;
+        if (reset) err = ftruncate(j->fd, 0);
+        if (err == 0 && batch_len > 0) err = write_all(j->fd, batch, batch_len);
+        if (err == 0) err = fdatasync(j->fd);
+
+        pthread_mutex_lock(&j->lock);
+        if (err != 0 && !j->failed) {
+            fprintf(stderr, "Journal write failed: %s (journal disabled)\n", strerror(errno));
+            j->failed = 1;
+        }
+        j->commits++;
+    }
+    pthread_mutex_unlock(&j->lock);
+    return NULL;
+}
+
+/* ============================================================================
+ * INTERFACE PUBLIQUE
+ * ============================================================================ */
+
+/*
+ * Fonction journal_open()
+ * -----------------------
+ * Ouvre (ou crée) le fichier du journal. Il doit être relu
+ * (journal_replay()) avant le démarrage du thread d'écriture; les
+ * enregistrements ajoutés entre-temps partent avec le premier lot.
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur
+ */
+int journal_open(Journal *j, const char *path) {
+    memset(j, 0, sizeof(*j));
+    j->fd = open(path, JOURNAL_OPEN_FLAGS, 0644);
+    if (j->fd < 0) return -1;
+    pthread_mutex_init(&j->lock, NULL);
+    pthread_cond_init(&j->wake, NULL);
+    return 0;
+}
+
+/*
+ * Fonction journal_replay()
+ * -------------------------
+ * Relit le journal du début et appelle fn pour chaque enregistrement
+ * valide, dans l'ordre d'écriture. La fin tronquée ou corrompue d'un
+ * journal interrompu est retirée du fichier.
+ *
+ * Retourne:
+ *   Nombre d'enregistrements relus, ou -1 en cas d'erreur de lecture
+ */
+long journal_replay(Journal *j, JournalReplayFn fn, void *arg) {
+    struct stat st;
+    if (fstat(j->fd, &st) < 0) return -1;
+
+    size_t file_len = (size_t)st.st_size;
+    uint8_t *data = malloc(file_len ? file_len : 1);
+    if (!data) return -1;
+
+    size_t got = 0;
+    lseek(j->fd, 0, SEEK_SET);
+    while (got < file_len) {
+        int n = (int)read(j->fd, data + got, (unsigned int)(file_len - got));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        got += (size_t)n;
+    }
+
+    size_t off = 0;
+    long count = 0;
+    while (off + JOURNAL_HEADER_SIZE + JOURNAL_TRAILER_SIZE <= got) {
+        const uint8_t *p = data + off;
+        uint32_t body_len = get_u32(p);
+        if (body_len < JOURNAL_HEADER_SIZE - 4 || body_len > JOURNAL_HEADER_SIZE - 4 + JOURNAL_MAX_DATA) break;
+
+        size_t rec_len = 4 + (size_t)body_len + JOURNAL_TRAILER_SIZE;
+        if (off + rec_len > got) break;
+        if (checksum(p + 4, body_len) != get_u32(p + 4 + body_len)) break;
+
+        JournalRecord rec;
+        rec.type = p[4];
+        rec.job = get_u32(p + 5);
+        rec.seq = get_u32(p + 9);
+        rec.code = (int32_t)get_u32(p + 13);
+        rec.data = p + JOURNAL_HEADER_SIZE;
+        rec.data_len = body_len - (JOURNAL_HEADER_SIZE - 4);
+        fn(&rec, arg);
+
+        off += rec_len;
+        count++;
+    }
+
+    if (off < file_len) {
+        fprintf(stderr, "Journal: %lu trailing bytes discarded (interrupted write)\n",
+                (unsigned long)(file_len - off));
+        if (ftruncate(j->fd, (long)off) != 0) {
+            fprintf(stderr, "Journal truncate failed: %s\n", strerror(errno));
+        }
+    }
+    j->size = off;
+    free(data);
+    return count;
+}
+
+/*
+ * Fonction journal_start()
+ * ------------------------
+ * Démarre le thread d'écriture.
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur
+ */
+int journal_start(Journal *j) {
+    if (pthread_create(&j->thread, NULL, journal_main, j) != 0) {
+        fprintf(stderr, "pthread_create failed for journal thread\n");
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Fonction journal_close()
+ * ------------------------
+ * Écrit les derniers enregistrements, arrête le thread d'écriture et
+ * ferme le fichier.
+ */
+void journal_close(Journal *j) {
+    pthread_mutex_lock(&j->lock);
+    j->stop = 1;
+    pthread_cond_signal(&j->wake);
+    pthread_mutex_unlock(&j->lock);
+    pthread_join(j->thread, NULL);
+
+    pthread_mutex_destroy(&j->lock);
+    pthread_cond_destroy(&j->wake);
+    close(j->fd);
+    j->fd = -1;
+    free(j->buf);
+    free(j->spare);
+    j->buf = NULL;
+    j->spare = NULL;
+}
+
+/*
+ * Fonction journal_append()
+ * -------------------------
+ * Ajoute un enregistrement au prochain lot. Le lot part au prochain
+ * journal_commit() (ou avec le lot en cours d'écriture, si le thread est
+ * occupé); l'enregistrement est durable après sa synchronisation. Sans
+ * effet si le journal n'est plus tenu.
+ */
+void journal_append(Journal *j, const JournalRecord *rec) {
+    size_t data_len = rec->data_len > JOURNAL_MAX_DATA ? JOURNAL_MAX_DATA : rec->data_len;
+    size_t rec_len = JOURNAL_HEADER_SIZE + data_len + JOURNAL_TRAILER_SIZE;
+
+    pthread_mutex_lock(&j->lock);
+    if (j->failed) {
+        pthread_mutex_unlock(&j->lock);
+        return;
+    }
+    if (j->len + rec_len > j->cap) {
+        size_t cap = j->cap ? j->cap : 64 * 1024;
+        while (cap < j->len + rec_len) cap *= 2;
+        uint8_t *buf = realloc(j->buf, cap);
+        if (!buf) {
+            fprintf(stderr, "Out of memory: journal disabled\n");
+            j->failed = 1;
+            pthread_mutex_unlock(&j->lock);
+            return;
+        }
+        j->buf = buf;
+        j->cap = cap;
+    }
+
+    uint8_t *p = j->buf + j->len;
+    put_u32(p, (uint32_t)(JOURNAL_HEADER_SIZE - 4 + data_len));
+    p[4] = rec->type;
+    put_u32(p + 5, rec->job);
+    put_u32(p + 9, rec->seq);
+    put_u32(p + 13, (uint32_t)rec->code);
+    if (data_len) memcpy(p + JOURNAL_HEADER_SIZE, rec->data, data_len);
+    put_u32(p + JOURNAL_HEADER_SIZE + data_len, checksum(p + 4, JOURNAL_HEADER_SIZE - 4 + data_len));
+    j->len += rec_len;
+    j->size += rec_len;
+    pthread_mutex_unlock(&j->lock);
+}
+
+/*
+ * Fonction journal_commit()
+ * -------------------------
+ * Réveille le thread d'écriture s'il attend et que des enregistrements
+ * ont été ajoutés: appelée une fois par tour de la boucle d'événements,
+ * elle regroupe dans un même lot tout ce que ce tour a produit.
+ */
+void journal_commit(Journal *j) {
+    pthread_mutex_lock(&j->lock);
+    if (j->sleeping && j->len > 0) pthread_cond_signal(&j->wake);
+    pthread_mutex_unlock(&j->lock);
+}
+
+/*
+ * Fonction journal_reset()
+ * ------------------------
+ * Vide le journal: plus aucun travail n'est ouvert, ses enregistrements
+ * (y compris ceux du lot en attente) ne serviraient à rien à la reprise.
+ */
+void journal_reset(Journal *j) {
+    pthread_mutex_lock(&j->lock);
+    j->len = 0;
+    j->size = 0;
+    j->reset = 1;
+    if (j->sleeping) pthread_cond_signal(&j->wake);
+    pthread_mutex_unlock(&j->lock);
+}
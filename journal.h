@@ -0,0 +1,128 @@
+/*
+ * ============================================================================
+ * JOURNAL - Journal des travaux du maître, pour la reprise après un arrêt
+ * ============================================================================
+ *
+ * Description:
+ *   Fichier en ajout seul où le maître consigne chaque travail soumis
+ *   (fichier de commandes, au fil de sa réception), chaque commande
+ *   distribuée et chaque commande terminée. Au redémarrage, le journal
+ *   est relu (journal_replay()) et seules les commandes non terminées
+ *   sont relancées.
+ *
+ *   Validation groupée: la boucle d'événements ne fait qu'ajouter les
+ *   enregistrements à un tampon en mémoire (journal_append()), et réveille
+ *   une fois par tour le thread d'écriture (journal_commit()). Celui-ci
+ *   échange ce tampon contre un tampon vide, l'écrit d'un seul appel puis
+ *   le rend durable (fdatasync()). Tout ce qui a été ajouté pendant une
+ *   synchronisation part avec la suivante: un seul fdatasync() par lot,
+ *   quel que soit le débit, et la distribution n'attend jamais le disque.
+ *
+ *   Format d'un enregistrement (petit-boutiste):
+ *     +----------+------+---------+---------+----------+---------+----------+
+ *     | longueur | type | travail |  rang   |   code   | données | contrôle |
+ *     | 4 octets | 1    | 4       | 4       | 4        | ...     | 4        |
+ *     +----------+------+---------+---------+----------+---------+----------+
+ *   longueur = 13 + données; contrôle = FNV-1a des octets de type à
+ *   données. Un enregistrement tronqué ou corrompu (arrêt pendant une
+ *   écriture) marque la fin du journal: il est retiré à la relecture.
+ *
+ *   Lorsque plus aucun travail n'est ouvert, le journal peut être vidé
+ *   (journal_reset()): il ne grandit pas indéfiniment.
+ *
+ * ============================================================================
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Taille d'en-tête (longueur, type, travail, rang, code) et de contrôle */
+#define JOURNAL_HEADER_SIZE 17
+#define JOURNAL_TRAILER_SIZE 4
+
+/* Données maximales d'un enregistrement */
+#define JOURNAL_MAX_DATA (1024 * 1024)
+
+/*
+ * Énumération JournalType
+ * -----------------------
+ * Types d'enregistrements.
+ */
+typedef enum {
+    JOURNAL_SUBMIT = 1,   /* Nouveau travail (données: client et nom du fichier) */
+    JOURNAL_DATA = 2,     /* Morceau du fichier de commandes (données) */
+    JOURNAL_END = 3,      /* Fichier entièrement reçu */
+    JOURNAL_DISPATCH = 4, /* Commande (rang) confiée à un esclave */
+    JOURNAL_DONE = 5,     /* Commande (rang) terminée (code de retour) */
+    JOURNAL_CLOSE = 6     /* Travail terminé ou abandonné par son client */
+} JournalType;
+
+/*
+ * Structure JournalRecord
+ * -----------------------
+ * Champs:
+ *   - type: Type d'enregistrement (voir JournalType)
+ *   - job: Numéro du travail
+ *   - seq: Rang de la commande dans le fichier (DISPATCH, DONE)
+ *   - code: Code de retour de la commande (DONE)
+ *   - data / data_len: Données (SUBMIT, DATA)
+ */
+typedef struct {
+    uint8_t type;
+    uint32_t job;
+    uint32_t seq;
+    int32_t code;
+    const uint8_t *data;
+    size_t data_len;
+} JournalRecord;
+
+/*
+ * Structure Journal
+ * -----------------
+ * Champs:
+ *   - fd: Descripteur du fichier (-1 = journal fermé)
+ *   - size: Octets du fichier, tampon compris (boucle d'événements)
+ *   - buf / len / cap: Enregistrements ajoutés, pas encore écrits
+ *   - spare / spare_cap: Tampon en cours d'écriture (thread d'écriture)
+ *   - reset: Vider le fichier avant d'écrire le tampon suivant
+ *   - sleeping: Le thread d'écriture attend des enregistrements
+ *   - stop: Demande d'arrêt du thread (tampon écrit auparavant)
+ *   - failed: Écriture impossible: le journal n'est plus tenu
+ *   - commits: Nombre de synchronisations (lots validés)
+ *   - thread / lock / wake: Thread d'écriture et son réveil
+ */
+typedef struct {
+    int fd;
+    uint64_t size;
+    uint8_t *buf;
+    size_t len;
+    size_t cap;
+    uint8_t *spare;
+    size_t spare_cap;
+    int reset;
+    int sleeping;
+    int stop;
+    int failed;
+    uint64_t commits;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+} Journal;
+
+/* Rappel de journal_replay(), appelé pour chaque enregistrement valide */
+typedef void (*JournalReplayFn)(const JournalRecord *rec, void *arg);
+
+int journal_open(Journal *j, const char *path);
+long journal_replay(Journal *j, JournalReplayFn fn, void *arg);
+int journal_start(Journal *j);
+void journal_close(Journal *j);
+
+void journal_append(Journal *j, const JournalRecord *rec);
+void journal_commit(Journal *j);
+void journal_reset(Journal *j);
+
+#endif /* JOURNAL_H */
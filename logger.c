@@ -0,0 +1,422 @@
+/*
+ * ============================================================================
+ * LOGGER - Journalisation asynchrone (maître, esclave et client)
+ * ============================================================================
+ *
+ * Voir logger.h pour la description.
+ *
+ * Un enregistrement de la file: en-tête LogRecord, puis le texte du
+ * message (sans '\0' ni fin de ligne) ou les octets bruts à recopier.
+ * Le thread d'écriture met les lignes en forme dans un tampon et l'écrit
+ * d'un bloc; lorsque la file est vide, il vide stdout/stderr puis dort,
+ * de plus en plus longtemps (au plus LOGGER_IDLE_MAX_MS): le producteur
+ * n'a jamais à le réveiller.
+ *
+ * ============================================================================
+ */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "net_compat.h"
+#include "spsc.h"
+#include "logger.h"
+
+/* Taille du tampon de mise en forme du thread d'écriture */
+#define LOGGER_OUT_SIZE (64 * 1024)
+
+/*
+ * Énumération LogKind
+ * -------------------
+ * Nature d'un enregistrement.
+ */
+typedef enum {
+    LOG_KIND_MESSAGE = 0,  /* Message mis en forme selon le format choisi */
+    LOG_KIND_STDOUT,       /* Octets recopiés tels quels sur stdout */
+    LOG_KIND_STDERR        /* Octets recopiés tels quels sur stderr */
+} LogKind;
+
+/*
+ * Structure LogRecord
+ * -------------------
+ * En-tête d'un enregistrement de la file.
+ *
+ * Champs:
+ *   - time_us: Instant du message (horloge monotone)
+ *   - level: Niveau du message (voir LogLevel)
+ *   - kind: Voir LogKind
+ */
+typedef struct {
+    uint64_t time_us;
+    uint8_t level;
+    uint8_t kind;
+} LogRecord;
+
+/*
+ * Structure Logger
+ * ----------------
+ * État du journal (un seul par processus).
+ *
+ * Champs:
+ *   - ring: Messages en attente d'écriture (producteur: thread principal)
+ *   - thread / started: Thread d'écriture
+ *   - stop: Demande d'arrêt (file vidée auparavant)
+ *   - dropped: Messages perdus, file pleine (écrit par le producteur)
+ *   - reported: Pertes déjà signalées (thread d'écriture)
+ *   - program: Nom du programme, en tête des lignes
+ *   - format: Voir LogFormat
+ *   - base_level: Niveau choisi au démarrage (retrouvé après SIGUSR1)
+ *   - epoch_us: Heure UTC correspondant à l'instant 0 de l'horloge monotone
+ *   - out / out_len: Tampon de mise en forme (thread d'écriture)
+ *   - out_stream: Flux de destination du contenu de out
+ */
+typedef struct {
+    SpscRing ring;
+    pthread_t thread;
+    int started;
+    atomic_int stop;
+    _Atomic uint64_t dropped;
+    uint64_t reported;
+    char program[64];
+    LogFormat format;
+    LogLevel base_level;
+    int64_t epoch_us;
+    char out[LOGGER_OUT_SIZE];
+    size_t out_len;
+    FILE *out_stream;
+} Logger;
+
+atomic_int logger_level = LOG_INFO;
+
+static Logger logger;
+
+static const char *const level_names[] = { "error", "warn", "info", "debug" };
+
+/* ============================================================================
+ * THREAD D'ÉCRITURE
+ * ============================================================================ */
+
+/* Écrit le tampon de mise en forme sur son flux */
+static void flush_out(void) {
+    if (logger.out_len > 0) {
+        fwrite(logger.out, 1, logger.out_len, logger.out_stream);
+        logger.out_len = 0;
+    }
+}
+
+/* Ajoute des octets au tampon de mise en forme, destinés au flux stream */
+static void out_append(FILE *stream, const char *data, size_t len) {
+    if (stream != logger.out_stream) {
+        flush_out();
+        logger.out_stream = stream;
+    }
+    while (len > 0) {
+        if (logger.out_len == sizeof(logger.out)) flush_out();
+        size_t n = sizeof(logger.out) - logger.out_len;
+        if (n > len) n = len;
+        memcpy(logger.out + logger.out_len, data, n);
+        logger.out_len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+/* Ajoute une chaîne JSON échappée (guillemets, barres obliques, contrôles) */
+static void out_append_json(const char *text, size_t len) {
+    size_t start = 0;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        char esc[8];
+        out_append(stdout, text + start, i - start);
+        if (c == '"' || c == '\\') {
+            esc[0] = '\\';
+            esc[1] = (char)c;
+            out_append(stdout, esc, 2);
+        } else if (c == '\n') {
+            out_append(stdout, "\\n", 2);
+        } else {
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+            out_append(stdout, esc, 6);
+        }
+        start = i + 1;
+    }
+    out_append(stdout, text + start, len - start);
+}
+
+/*
+ * Fonction format_message()
+ * -------------------------
+ * Met en forme un message selon le format choisi, dans le tampon de
+ * sortie.
+ */
+static void format_message(const LogRecord *rec, const char *text, size_t len) {
+    char prefix[160];
+    int n;
+
+    if (logger.format == LOG_JSON) {
+        int64_t ts = logger.epoch_us + (int64_t)rec->time_us;
+        n = snprintf(prefix, sizeof(prefix), "{\"ts\":%lld.%06lld,\"level\":\"%s\",\"prog\":\"",
+                     (long long)(ts / 1000000), (long long)(ts % 1000000),
+                     level_names[rec->level <= LOG_DEBUG ? rec->level : LOG_DEBUG]);
+        out_append(stdout, prefix, (size_t)n);
+        out_append_json(logger.program, strlen(logger.program));
+        out_append(stdout, "\",\"msg\":\"", 9);
+        out_append_json(text, len);
+        out_append(stdout, "\"}\n", 3);
+    } else {
+        n = snprintf(prefix, sizeof(prefix), "[%s] ", logger.program);
+        out_append(stdout, prefix, (size_t)n);
+        out_append(stdout, text, len);
+        out_append(stdout, "\n", 1);
+    }
+}
+
+/* Signale les messages perdus depuis le dernier signalement */
+static void report_dropped(void) {
+    uint64_t dropped = atomic_load_explicit(&logger.dropped, memory_order_relaxed);
+    if (dropped == logger.reported) return;
+
+    char text[96];
+    int n = snprintf(text, sizeof(text), "%llu messages perdus (file de journalisation pleine)",
+                     (unsigned long long)(dropped - logger.reported));
+    LogRecord rec = { monotonic_us(), LOG_WARN, LOG_KIND_MESSAGE };
+    format_message(&rec, text, (size_t)n);
+    logger.reported = dropped;
+}
+
+/*
+ * Fonction drain_ring()
+ * ---------------------
+ * Met en forme tous les enregistrements en attente.
+ *
+ * Retourne:
+ *   Nombre d'enregistrements traités
+ */
+static int drain_ring(void) {
+    int count = 0;
+    const uint8_t *p;
+    size_t len;
+
+    while ((p = spsc_peek(&logger.ring, &len)) != NULL) {
+        LogRecord rec;
+        memcpy(&rec, p, sizeof(rec));
+        const char *data = (const char *)p + sizeof(rec);
+        size_t data_len = len - sizeof(rec);
+
+        if (rec.kind == LOG_KIND_MESSAGE) {
+            format_message(&rec, data, data_len);
+        } else {
+            out_append(rec.kind == LOG_KIND_STDERR ? stderr : stdout, data, data_len);
+        }
+        spsc_release(&logger.ring);
+        count++;
+    }
+    report_dropped();
+    return count;
+}
+
+/*
+ * Fonction logger_main()
+ * ----------------------
+ * Boucle du thread d'écriture: vide la file, écrit, puis dort d'autant
+ * plus longtemps que la file reste vide.
+ */
+static void *logger_main(void *arg) {
+    int idle_ms = 1;
+    (void)arg;
+
+    while (1) {
+        int stopping = atomic_load(&logger.stop);
+        if (drain_ring() > 0) {
+            idle_ms = 1;
+            continue;  /* D'autres messages sont peut-être arrivés entre-temps */
+        }
+        flush_out();
+        fflush(stdout);
+        fflush(stderr);
+        if (stopping) break;
+
+        Sleep(idle_ms);
+        if (idle_ms < LOGGER_IDLE_MAX_MS) idle_ms *= 2;
+    }
+    return NULL;
+}
+
+/* ============================================================================
+ * INTERFACE PUBLIQUE
+ * ============================================================================ */
+
+/*
+ * Fonction logger_start()
+ * -----------------------
+ * Démarre la journalisation asynchrone. Avant cet appel (ou s'il échoue),
+ * les messages sont écrits directement. Les messages en attente sont
+ * écrits à la sortie du programme (exit()).
+ *
+ * Paramètres:
+ *   program - Nom en tête des lignes (ex: "Master Server")
+ *   level - Niveau des messages écrits
+ *   format - Format des lignes
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur
+ */
+int logger_start(const char *program, LogLevel level, LogFormat format) {
+    snprintf(logger.program, sizeof(logger.program), "%s", program);
+    logger.format = format;
+    logger.base_level = level;
+    atomic_store(&logger_level, (int)level);
+
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    logger.epoch_us = (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000 - (int64_t)monotonic_us();
+
+    if (spsc_init(&logger.ring, LOGGER_RING_SIZE) < 0) return -1;
+    atomic_init(&logger.stop, 0);
+    atomic_init(&logger.dropped, 0);
+    logger.reported = 0;
+    logger.out_len = 0;
+    logger.out_stream = stdout;
+
+    fflush(stdout);
+    if (pthread_create(&logger.thread, NULL, logger_main, NULL) != 0) {
+        fprintf(stderr, "pthread_create failed for logger thread\n");
+        spsc_free(&logger.ring);
+        return -1;
+    }
+    logger.started = 1;
+    atexit(logger_stop);
+    return 0;
+}
+
+/*
+ * Fonction logger_stop()
+ * ----------------------
+ * Écrit les messages en attente et arrête le thread d'écriture. Les
+ * messages suivants sont écrits directement.
+ */
+void logger_stop(void) {
+    if (!logger.started) return;
+    atomic_store(&logger.stop, 1);
+    pthread_join(logger.thread, NULL);
+    logger.started = 0;
+    spsc_free(&logger.ring);
+}
+
+/*
+ * Fonction logger_parse_level()
+ * -----------------------------
+ * Retourne:
+ *   0 si name est un niveau connu (error, warn, info, debug), -1 sinon
+ */
+int logger_parse_level(const char *name, LogLevel *level) {
+    for (int i = LOG_ERROR; i <= LOG_DEBUG; i++) {
+        if (strcmp(name, level_names[i]) == 0) {
+            *level = (LogLevel)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int logger_parse_format(const char *name, LogFormat *format) {
+    if (strcmp(name, "text") == 0) {
+        *format = LOG_TEXT;
+    } else if (strcmp(name, "json") == 0) {
+        *format = LOG_JSON;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Fonction logger_toggle_debug()
+ * ------------------------------
+ * Active le niveau debug, ou revient au niveau choisi au démarrage.
+ * Appelable depuis un gestionnaire de signal (une seule opération
+ * atomique).
+ */
+void logger_toggle_debug(void) {
+    int level = atomic_load(&logger_level);
+    int base = logger.base_level == LOG_DEBUG ? LOG_INFO : (int)logger.base_level;
+    atomic_store(&logger_level, level == LOG_DEBUG ? base : LOG_DEBUG);
+}
+
+/*
+ * Fonction push_record()
+ * ----------------------
+ * Dépose un enregistrement dans la file, sans jamais attendre.
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 si la file est pleine (rien n'est déposé)
+ */
+static int push_record(LogLevel level, LogKind kind, const void *data, size_t len) {
+    uint8_t *slot = spsc_reserve(&logger.ring, sizeof(LogRecord) + len);
+    if (!slot) return -1;
+    LogRecord rec = { monotonic_us(), (uint8_t)level, (uint8_t)kind };
+    memcpy(slot, &rec, sizeof(rec));
+    memcpy(slot + sizeof(rec), data, len);
+    spsc_commit(&logger.ring);
+    return 0;
+}
+
+/*
+ * Fonction logger_write()
+ * -----------------------
+ * Journalise un message (sans fin de ligne), mis en forme par printf.
+ * Utiliser de préférence les macros log_*(), qui ne mettent en forme que
+ * les messages du niveau courant.
+ */
+void logger_write(LogLevel level, const char *fmt, ...) {
+    char text[LOGGER_LINE_MAX];
+    va_list ap;
+
+    va_start(ap, fmt);
+    int n = vsnprintf(text, sizeof(text), fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    if ((size_t)n >= sizeof(text)) n = (int)sizeof(text) - 1;
+
+    if (!logger.started) {
+        LogRecord rec = { monotonic_us(), (uint8_t)level, LOG_KIND_MESSAGE };
+        logger.out_stream = stdout;
+        format_message(&rec, text, (size_t)n);
+        flush_out();
+        fflush(stdout);
+        return;
+    }
+    if (push_record(level, LOG_KIND_MESSAGE, text, (size_t)n) < 0) {
+        atomic_fetch_add_explicit(&logger.dropped, 1, memory_order_relaxed);
+    }
+}
+
+/*
+ * Fonction logger_raw()
+ * ---------------------
+ * Recopie des octets tels quels sur stdout ou stderr, dans l'ordre des
+ * messages journalisés (sortie des commandes affichée par le client).
+ * Contrairement aux messages, ces octets ne sont jamais perdus: si la
+ * file est pleine, l'appelant attend qu'elle se vide.
+ */
+void logger_raw(int to_stderr, const void *data, size_t len) {
+    if (!logger.started) {
+        fwrite(data, 1, len, to_stderr ? stderr : stdout);
+        return;
+    }
+    LogKind kind = to_stderr ? LOG_KIND_STDERR : LOG_KIND_STDOUT;
+    const char *bytes = data;
+    while (len > 0) {
+        /* Par morceaux: un enregistrement doit tenir dans la file */
+        size_t chunk = len < LOGGER_RING_SIZE / 4 ? len : LOGGER_RING_SIZE / 4;
+        while (push_record(LOG_INFO, kind, bytes, chunk) < 0) Sleep(1);
+        bytes += chunk;
+        len -= chunk;
+    }
+}
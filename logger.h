@@ -0,0 +1,101 @@
+/*
+ * ============================================================================
+ * LOGGER - Journalisation asynchrone (maître, esclave et client)
+ * ============================================================================
+ *
+ * Description:
+ *   Un printf() par commande (réception, envoi, résultat...) fait un appel
+ *   système d'écriture sur la console ou le fichier de sortie à chaque
+ *   ligne: sur un lot de 100 000 commandes, la boucle d'événements passe
+ *   plus de temps à écrire ses traces qu'à distribuer.
+ *
+ *   Les messages sont ici mis en forme dans la boucle d'événements puis
+ *   déposés dans une file sans verrou (spsc.h). Un thread d'écriture les
+ *   vide par blocs: une seule écriture pour des centaines de lignes. Le
+ *   producteur ne bloque jamais: si la file est pleine, le message est
+ *   perdu et compté, et la perte est signalée dans la sortie.
+ *
+ *   Niveaux: error, warn, info (défaut), debug. Les messages émis pour
+ *   chaque commande sont de niveau debug: ils ne coûtent qu'une
+ *   comparaison tant que ce niveau n'est pas actif (macros log_*(), les
+ *   arguments ne sont pas évalués). Le niveau se choisit au démarrage
+ *   (--log-level) et, sous POSIX, SIGUSR1 bascule le niveau debug en cours
+ *   d'exécution.
+ *
+ *   Formats:
+ *     text - "[Programme] message", comme auparavant
+ *     json - un objet par ligne:
+ *            {"ts":1760000000.123456,"level":"info","prog":"...","msg":"..."}
+ *
+ *   Producteur unique: seule la boucle d'événements (thread principal)
+ *   journalise; les autres threads écrivent leurs rares erreurs sur
+ *   stderr. Les messages d'erreur en anglais restent écrits directement
+ *   sur stderr.
+ *
+ * ============================================================================
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+/* Taille de la file des messages en attente d'écriture (octets) */
+#define LOGGER_RING_SIZE (1024 * 1024)
+
+/* Longueur maximale d'un message (au-delà, il est tronqué) */
+#define LOGGER_LINE_MAX 1024
+
+/* Attente maximale du thread d'écriture lorsque la file est vide (ms) */
+#define LOGGER_IDLE_MAX_MS 16
+
+/*
+ * Énumération LogLevel
+ * --------------------
+ * Importance d'un message: un message est écrit si son niveau est
+ * inférieur ou égal au niveau courant.
+ */
+typedef enum {
+    LOG_ERROR = 0,
+    LOG_WARN,
+    LOG_INFO,
+    LOG_DEBUG
+} LogLevel;
+
+/*
+ * Énumération LogFormat
+ * ---------------------
+ * Format des lignes écrites.
+ */
+typedef enum {
+    LOG_TEXT = 0,  /* [Programme] message */
+    LOG_JSON       /* Un objet JSON par ligne */
+} LogFormat;
+
+/* Niveau courant (lu par les macros log_*()) */
+extern atomic_int logger_level;
+
+int logger_start(const char *program, LogLevel level, LogFormat format);
+void logger_stop(void);
+
+int logger_parse_level(const char *name, LogLevel *level);
+int logger_parse_format(const char *name, LogFormat *format);
+void logger_toggle_debug(void);
+
+void logger_write(LogLevel level, const char *fmt, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+void logger_raw(int to_stderr, const void *data, size_t len);
+
+/* Un message de ce niveau serait-il écrit ? */
+#define log_enabled(level) ((int)(level) <= atomic_load_explicit(&logger_level, memory_order_relaxed))
+
+#define log_error(...) do { if (log_enabled(LOG_ERROR)) logger_write(LOG_ERROR, __VA_ARGS__); } while (0)
+#define log_warn(...)  do { if (log_enabled(LOG_WARN)) logger_write(LOG_WARN, __VA_ARGS__); } while (0)
+#define log_info(...)  do { if (log_enabled(LOG_INFO)) logger_write(LOG_INFO, __VA_ARGS__); } while (0)
+#define log_debug(...) do { if (log_enabled(LOG_DEBUG)) logger_write(LOG_DEBUG, __VA_ARGS__); } while (0)
+
+#endif /* LOGGER_H */
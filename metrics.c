@@ -0,0 +1,404 @@
+/*
+ * ============================================================================
+ * METRICS - Compteurs, histogrammes et page /metrics (maître et esclave)
+ * ============================================================================
+ *
+ * Voir metrics.h pour la description.
+ *
+ * ============================================================================
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "metrics.h"
+
+/* Bornes exportées des histogrammes: 2^4 µs (16 µs) à 2^36 µs (19 h) */
+#define METRICS_EXPORT_MIN_BITS 4
+#define METRICS_EXPORT_MAX_BITS 36
+
+/* ============================================================================
+ * HISTOGRAMMES
+ * ============================================================================ */
+
+/* Rang du bit de poids fort de v (v > 0) */
+static int msb_index(uint64_t v) {
+    int n = 0;
+    while (v >>= 1) n++;
+    return n;
+}
+
+/*
+ * Fonction metrics_bucket()
+ * -------------------------
+ * Intervalle d'une valeur: les METRICS_HIST_SUB premières valeurs ont
+ * chacune le leur, puis chaque puissance de 2 [2^k, 2^(k+1)) est découpée
+ * en METRICS_HIST_SUB intervalles égaux. Les valeurs au-delà de
+ * 2^METRICS_HIST_MAX_BITS tombent dans le dernier.
+ */
+static int metrics_bucket(uint64_t v) {
+    if (v < METRICS_HIST_SUB) return (int)v;
+
+    int msb = msb_index(v);
+    if (msb >= METRICS_HIST_MAX_BITS) return METRICS_HIST_BUCKETS - 1;
+    int shift = msb - METRICS_HIST_SUB_BITS;
+    return (shift + 1) * METRICS_HIST_SUB + (int)((v >> shift) & (METRICS_HIST_SUB - 1));
+}
+
+/* Plus petite valeur et largeur de l'intervalle index */
+static void bucket_range(int index, uint64_t *low, uint64_t *width) {
+    if (index < METRICS_HIST_SUB) {
+        *low = (uint64_t)index;
+        *width = 1;
+        return;
+    }
+    int shift = index / METRICS_HIST_SUB - 1;
+    *low = (uint64_t)(METRICS_HIST_SUB + index % METRICS_HIST_SUB) << shift;
+    *width = (uint64_t)1 << shift;
+}
+
+/*
+ * Fonction metrics_record()
+ * -------------------------
+ * Ajoute une mesure (en microsecondes) à l'histogramme. Quelques
+ * opérations entières, sans allocation: appelable sur le chemin critique.
+ */
+void metrics_record(MetricsHistogram *h, uint64_t value_us) {
+    h->counts[metrics_bucket(value_us)]++;
+    h->count++;
+    h->sum_us += value_us;
+    if (value_us > h->max_us) h->max_us = value_us;
+}
+
+/*
+ * Fonction metrics_quantile()
+ * ---------------------------
+ * Paramètres:
+ *   h - Histogramme
+ *   q - Quantile recherché (0.5 = médiane)
+ *
+ * Retourne:
+ *   Valeur estimée (milieu de l'intervalle, au plus la plus grande
+ *   mesure), 0 si l'histogramme est vide
+ */
+uint64_t metrics_quantile(const MetricsHistogram *h, double q) {
+    if (h->count == 0) return 0;
+
+    uint64_t rank = (uint64_t)(q * (double)h->count + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > h->count) rank = h->count;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < METRICS_HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            uint64_t low, width;
+            bucket_range(i, &low, &width);
+            uint64_t mid = low + width / 2;
+            return mid < h->max_us ? mid : h->max_us;
+        }
+    }
+    return h->max_us;
+}
+
+/* ============================================================================
+ * RENDU AU FORMAT TEXTE DE PROMETHEUS
+ * ============================================================================ */
+
+/*
+ * Fonction metrics_printf()
+ * -------------------------
+ * Ajoute du texte formaté à la page. Une erreur d'allocation est mémorisée
+ * (failed): la page est alors remplacée par une erreur 500.
+ */
+void metrics_printf(MetricsText *out, const char *fmt, ...) {
+    if (out->failed) return;
+
+    while (1) {
+        size_t room = out->cap - out->len;
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(out->data ? out->data + out->len : NULL, room, fmt, ap);
+        va_end(ap);
+        if (n < 0) {
+            out->failed = 1;
+            return;
+        }
+        if ((size_t)n < room) {
+            out->len += (size_t)n;
+            return;
+        }
+
+        size_t cap = out->cap ? out->cap : 4096;
+        while (cap - out->len <= (size_t)n) cap *= 2;
+        char *data = realloc(out->data, cap);
+        if (!data) {
+            out->failed = 1;
+            return;
+        }
+        out->data = data;
+        out->cap = cap;
+    }
+}
+
+void metrics_header(MetricsText *out, const char *name, const char *type, const char *help) {
+    metrics_printf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+/*
+ * Fonction metrics_value()
+ * ------------------------
+ * Ajoute un échantillon: nom{labels} valeur.
+ *
+ * Paramètres:
+ *   labels - Étiquettes sans accolades (ex: slave="10.0.0.2:8081"), ou NULL
+ */
+void metrics_value(MetricsText *out, const char *name, const char *labels, double value) {
+    const char *open = labels ? "{" : "";
+    const char *close = labels ? "}" : "";
+
+    if (value == (double)(int64_t)value) {
+        metrics_printf(out, "%s%s%s%s %lld\n", name, open, labels ? labels : "", close,
+                       (long long)value);
+    } else {
+        metrics_printf(out, "%s%s%s%s %.9g\n", name, open, labels ? labels : "", close, value);
+    }
+}
+
+/*
+ * Fonction metrics_histogram()
+ * ----------------------------
+ * Ajoute un histogramme de durées, en secondes: intervalles cumulés aux
+ * puissances de 2 (compte des mesures inférieures à la borne), somme et
+ * nombre, puis la plus grande mesure et les quantiles p50 / p90 / p99
+ * (famille <nom>_quantile), plus précis que ceux recalculés à partir des
+ * intervalles exportés.
+ */
+void metrics_histogram(MetricsText *out, const char *name, const char *help,
+                       const MetricsHistogram *h) {
+    static const double quantiles[] = { 0.5, 0.9, 0.99 };
+
+    metrics_header(out, name, "histogram", help);
+
+    uint64_t cumulative = 0;
+    int next = 0;
+    for (int bits = METRICS_EXPORT_MIN_BITS; bits <= METRICS_EXPORT_MAX_BITS; bits++) {
+        /* Intervalles entièrement sous la borne 2^bits */
+        int limit = metrics_bucket((uint64_t)1 << bits);
+        while (next < limit) cumulative += h->counts[next++];
+        metrics_printf(out, "%s_bucket{le=\"%.9g\"} %llu\n", name,
+                       (double)((uint64_t)1 << bits) / 1e6, (unsigned long long)cumulative);
+    }
+    metrics_printf(out, "%s_bucket{le=\"+Inf\"} %llu\n", name, (unsigned long long)h->count);
+    metrics_printf(out, "%s_sum %.9g\n", name, (double)h->sum_us / 1e6);
+    metrics_printf(out, "%s_count %llu\n", name, (unsigned long long)h->count);
+
+    metrics_printf(out, "# HELP %s_max Largest observation\n# TYPE %s_max gauge\n", name, name);
+    metrics_printf(out, "%s_max %.9g\n", name, (double)h->max_us / 1e6);
+
+    metrics_printf(out, "# HELP %s_quantile Quantiles (12.5%% precision)\n"
+                        "# TYPE %s_quantile gauge\n", name, name);
+    for (size_t i = 0; i < sizeof(quantiles) / sizeof(quantiles[0]); i++) {
+        metrics_printf(out, "%s_quantile{quantile=\"%g\"} %.9g\n", name, quantiles[i],
+                       (double)metrics_quantile(h, quantiles[i]) / 1e6);
+    }
+}
+
+/* ============================================================================
+ * SERVEUR HTTP
+ * ============================================================================ */
+
+/*
+ * Structure MetricsConn
+ * ---------------------
+ * Connexion HTTP en cours: requête en lecture, puis réponse en écriture.
+ */
+typedef struct {
+    MetricsServer *server;
+    SOCKET sock;
+    char request[METRICS_REQUEST_MAX];
+    size_t request_len;
+    char *response;
+    size_t response_len;
+    size_t response_sent;
+} MetricsConn;
+
+static void close_conn(Reactor *reactor, MetricsConn *conn) {
+    reactor_remove(reactor, conn->sock);
+    closesocket(conn->sock);
+    free(conn->response);
+    free(conn);
+}
+
+/*
+ * Fonction build_response()
+ * -------------------------
+ * Prépare la réponse à la requête reçue: la page pour GET /metrics
+ * (ou /), 404 pour un autre chemin, 405 pour une autre méthode.
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation
+ */
+static int build_response(MetricsConn *conn) {
+    MetricsServer *m = conn->server;
+    MetricsText page = { 0 };
+    const char *status = "200 OK";
+
+    const char *path = conn->request + 4;
+    size_t path_len = strcspn(path, " ?\r\n");
+
+    if (strncmp(conn->request, "GET ", 4) != 0) {
+        status = "405 Method Not Allowed";
+        metrics_printf(&page, "method not allowed\n");
+    } else if ((path_len == 8 && strncmp(path, "/metrics", 8) == 0)
+               || (path_len == 1 && path[0] == '/')) {
+        m->render(&page, m->arg);
+        m->requests++;
+    } else {
+        status = "404 Not Found";
+        metrics_printf(&page, "not found\n");
+    }
+    if (page.failed) {
+        free(page.data);
+        memset(&page, 0, sizeof(page));
+        status = "500 Internal Server Error";
+    }
+
+    MetricsText response = { 0 };
+    metrics_printf(&response,
+                   "HTTP/1.0 %s\r\n"
+                   "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                   "Content-Length: %zu\r\n"
+                   "Connection: close\r\n\r\n", status, page.len);
+    if (page.len > 0) metrics_printf(&response, "%.*s", (int)page.len, page.data);
+    free(page.data);
+
+    if (response.failed) {
+        free(response.data);
+        return -1;
+    }
+    conn->response = response.data;
+    conn->response_len = response.len;
+    conn->response_sent = 0;
+    return 0;
+}
+
+/* Rappel de la boucle d'événements: lecture de la requête, puis réponse */
+static void on_conn_event(Reactor *reactor, SOCKET sock, int events, void *arg) {
+    MetricsConn *conn = arg;
+
+    if (!conn->response) {
+        if (events & REACTOR_ERROR) {
+            close_conn(reactor, conn);
+            return;
+        }
+        int n = recv(sock, conn->request + conn->request_len,
+                     (int)(sizeof(conn->request) - 1 - conn->request_len), 0);
+        if (n <= 0) {
+            if (n < 0 && net_would_block(WSAGetLastError())) return;
+            close_conn(reactor, conn);
+            return;
+        }
+        conn->request_len += (size_t)n;
+        conn->request[conn->request_len] = '\0';
+
+        /* En-têtes incomplets: attendre la suite (tant qu'il reste la place) */
+        if (!strstr(conn->request, "\r\n\r\n") && !strstr(conn->request, "\n\n")
+            && conn->request_len < sizeof(conn->request) - 1) {
+            return;
+        }
+        if (build_response(conn) < 0) {
+            close_conn(reactor, conn);
+            return;
+        }
+        reactor_modify(reactor, sock, REACTOR_WRITE);
+    }
+
+    while (conn->response_sent < conn->response_len) {
+        int n = send(sock, conn->response + conn->response_sent,
+                     (int)(conn->response_len - conn->response_sent), 0);
+        if (n == SOCKET_ERROR) {
+            if (net_would_block(WSAGetLastError())) return;  /* Suite sur REACTOR_WRITE */
+            break;
+        }
+        conn->response_sent += (size_t)n;
+    }
+    close_conn(reactor, conn);
+}
+
+/* Rappel de la boucle d'événements: connexions en attente sur le port HTTP */
+static void on_metrics_listener(Reactor *reactor, SOCKET sock, int events, void *arg) {
+    (void)events;
+    MetricsServer *m = arg;
+
+    while (1) {
+        SOCKET conn_sock = accept(sock, NULL, NULL);
+        if (conn_sock == INVALID_SOCKET) return;  /* File d'attente vide */
+
+        MetricsConn *conn = calloc(1, sizeof(MetricsConn));
+        if (!conn) {
+            closesocket(conn_sock);
+            continue;
+        }
+        net_set_nonblocking(conn_sock);
+        conn->server = m;
+        conn->sock = conn_sock;
+        if (reactor_add(reactor, conn_sock, REACTOR_READ, on_conn_event, conn) < 0) {
+            closesocket(conn_sock);
+            free(conn);
+        }
+    }
+}
+
+/*
+ * Fonction metrics_listen()
+ * -------------------------
+ * Ouvre le port HTTP de la page /metrics et l'enregistre dans la boucle
+ * d'événements.
+ *
+ * Paramètres:
+ *   m - Serveur à initialiser
+ *   reactor - Boucle d'événements du programme
+ *   port - Port TCP d'écoute
+ *   render / arg - Rendu de la page, appelé à chaque requête
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur
+ */
+int metrics_listen(MetricsServer *m, Reactor *reactor, int port, MetricsRenderFn render, void *arg) {
+    memset(m, 0, sizeof(*m));
+    m->sock = INVALID_SOCKET;
+    m->render = render;
+    m->arg = arg;
+
+    SOCKET sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == INVALID_SOCKET) return -1;
+
+    int opt = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (const char *)&opt, sizeof(opt));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons((unsigned short)port);
+
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) == SOCKET_ERROR
+        || listen(sock, 16) == SOCKET_ERROR
+        || net_set_nonblocking(sock) < 0
+        || reactor_add(reactor, sock, REACTOR_READ, on_metrics_listener, m) < 0) {
+        closesocket(sock);
+        return -1;
+    }
+    m->sock = sock;
+    return 0;
+}
+
+void metrics_close(MetricsServer *m, Reactor *reactor) {
+    if (m->sock == INVALID_SOCKET) return;
+    reactor_remove(reactor, m->sock);
+    closesocket(m->sock);
+    m->sock = INVALID_SOCKET;
+}
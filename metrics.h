@@ -0,0 +1,118 @@
+/*
+ * ============================================================================
+ * METRICS - Compteurs, histogrammes et page /metrics (maître et esclave)
+ * ============================================================================
+ *
+ * Description:
+ *   Mesures exposées au format texte de Prometheus sur un port HTTP local
+ *   (--metrics-port): GET /metrics retourne l'état courant, calculé à la
+ *   demande par une fonction de rendu propre au programme.
+ *
+ *   Coût sur le chemin critique: chaque compteur est un entier ordinaire
+ *   tenu par un seul thread (la boucle d'événements, ou le thread d'envoi
+ *   d'un esclave pour ses datagrammes, en accès atomique relâché): aucun
+ *   verrou, aucune écriture partagée. Les valeurs sont lues, additionnées
+ *   et mises en forme uniquement lorsque la page est demandée.
+ *
+ *   Histogrammes (durées en microsecondes) à la manière de HdrHistogram:
+ *   chaque puissance de 2 est découpée en METRICS_HIST_SUB intervalles
+ *   égaux, soit une précision relative de 1/METRICS_HIST_SUB (12,5 %) de
+ *   1 µs à plusieurs jours, en tableau fixe et sans allocation. Ils sont
+ *   exposés avec des bornes aux puissances de 2 (en secondes), et leurs
+ *   quantiles p50 / p90 / p99 (estimés au milieu de l'intervalle).
+ *
+ *   Le serveur HTTP est minimal: une requête par connexion, réponse puis
+ *   fermeture (Connection: close), servi par la boucle d'événements du
+ *   programme.
+ *
+ * ============================================================================
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "net_compat.h"
+#include "reactor.h"
+
+/* Intervalles par puissance de 2 d'un histogramme (puissance de 2) */
+#define METRICS_HIST_SUB 8
+#define METRICS_HIST_SUB_BITS 3
+
+/* Plus grande puissance de 2 suivie (2^40 µs, environ 12 jours) */
+#define METRICS_HIST_MAX_BITS 40
+
+#define METRICS_HIST_BUCKETS ((METRICS_HIST_MAX_BITS - METRICS_HIST_SUB_BITS + 1) * METRICS_HIST_SUB)
+
+/* Taille maximale d'une requête HTTP reçue */
+#define METRICS_REQUEST_MAX 2048
+
+/*
+ * Structure MetricsHistogram
+ * --------------------------
+ * Distribution de durées, tenue par un seul thread.
+ *
+ * Champs:
+ *   - counts: Nombre de mesures par intervalle (voir metrics_bucket())
+ *   - count / sum_us: Nombre et somme des mesures
+ *   - max_us: Plus grande mesure
+ */
+typedef struct {
+    uint64_t counts[METRICS_HIST_BUCKETS];
+    uint64_t count;
+    uint64_t sum_us;
+    uint64_t max_us;
+} MetricsHistogram;
+
+/*
+ * Structure MetricsText
+ * ---------------------
+ * Page en cours de rendu (agrandie à la demande).
+ */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+    int failed;
+} MetricsText;
+
+/* Rendu de la page: ajoute les mesures du programme à out */
+typedef void (*MetricsRenderFn)(MetricsText *out, void *arg);
+
+/*
+ * Structure MetricsServer
+ * -----------------------
+ * Champs:
+ *   - sock: Socket d'écoute HTTP (INVALID_SOCKET = désactivé)
+ *   - render / arg: Fonction de rendu de la page
+ *   - requests: Nombre de pages servies
+ */
+typedef struct {
+    SOCKET sock;
+    MetricsRenderFn render;
+    void *arg;
+    uint64_t requests;
+} MetricsServer;
+
+/* Histogrammes */
+void metrics_record(MetricsHistogram *h, uint64_t value_us);
+uint64_t metrics_quantile(const MetricsHistogram *h, double q);
+
+/* Rendu au format texte de Prometheus */
+void metrics_printf(MetricsText *out, const char *fmt, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+void metrics_header(MetricsText *out, const char *name, const char *type, const char *help);
+void metrics_value(MetricsText *out, const char *name, const char *labels, double value);
+void metrics_histogram(MetricsText *out, const char *name, const char *help,
+                       const MetricsHistogram *h);
+
+/* Serveur HTTP */
+int metrics_listen(MetricsServer *m, Reactor *reactor, int port, MetricsRenderFn render, void *arg);
+void metrics_close(MetricsServer *m, Reactor *reactor);
+
+#endif /* METRICS_H */
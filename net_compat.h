@@ -0,0 +1,196 @@
+/*
+ * ============================================================================
+ * NET_COMPAT - Couche de compatibilité réseau Winsock / POSIX
+ * ============================================================================
+ *
+ * Description:
+ *   Ce fichier d'en-tête permet de compiler le maître, les esclaves et le
+ *   client aussi bien avec MinGW (Winsock2, chemin compile.bat) qu'avec un
+ *   GCC POSIX (chemin start_all.sh).
+ *
+ *   Sous Windows, il inclut simplement Winsock2. Sous Linux/macOS, il
+ *   fournit les quelques symboles Winsock utilisés par le projet (SOCKET,
+ *   INVALID_SOCKET, closesocket(), WSAStartup(), Sleep(), ...) afin que le
+ *   code applicatif reste identique sur les deux plates-formes.
+ *
+ * ============================================================================
+ */
+
+#ifndef NET_COMPAT_H
+#define NET_COMPAT_H
+
+#include <stdint.h>     /* uint64_t */
+
+#ifdef _WIN32
+
+/*
+ * Le réacteur Windows repose sur select(): la taille par défaut de fd_set
+ * (64 sockets) est trop petite pour un maître qui sert des dizaines de
+ * clients simultanés. Doit être défini avant l'inclusion de winsock2.h.
+ */
+#ifndef FD_SETSIZE
+#define FD_SETSIZE 1024
+#endif
+
+/* Inclusion des bibliothèques Windows Socket (Winsock2) */
+#include <winsock2.h>   /* API principale Windows Socket version 2 */
+#include <ws2tcpip.h>   /* Fonctions supplémentaires TCP/IP */
+#include <windows.h>    /* Pour Sleep() */
+#include <process.h>    /* Pour _getpid() - obtenir l'ID du processus */
+
+/* Directives pour lier automatiquement les bibliothèques nécessaires */
+#pragma comment(lib, "ws2_32.lib")   /* Bibliothèque Winsock */
+#pragma comment(lib, "winmm.lib")    /* Bibliothèque multimédia Windows */
+
+/* Sous Windows, getpid() n'existe que sous le nom _getpid() */
+#ifndef getpid
+#define getpid _getpid
+#endif
+
+/*
+ * Fonction net_set_nonblocking()
+ * ------------------------------
+ * Passe un socket en mode non bloquant.
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur
+ */
+static inline int net_set_nonblocking(SOCKET sock) {
+    u_long mode = 1;
+    return ioctlsocket(sock, FIONBIO, &mode) == 0 ? 0 : -1;
+}
+
+/*
+ * Fonction net_would_block()
+ * --------------------------
+ * Indique si le code d'erreur signifie "réessayer plus tard"
+ * (opération non bloquante sans données disponibles).
+ */
+static inline int net_would_block(int err) {
+    return err == WSAEWOULDBLOCK;
+}
+
+/*
+ * Fonction net_wait_writable()
+ * ----------------------------
+ * Attend qu'un socket soit inscriptible, au plus timeout_ms millisecondes
+ * (utilisé par les threads qui n'ont pas de boucle d'événements).
+ *
+ * Retourne:
+ *   1 si le socket est inscriptible, 0 à l'expiration du délai, -1 en cas
+ *   d'erreur
+ */
+static inline int net_wait_writable(SOCKET sock, int timeout_ms) {
+    fd_set wfds;
+    FD_ZERO(&wfds);
+    FD_SET(sock, &wfds);
+    struct timeval tv = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+    int n = select(0, NULL, &wfds, NULL, &tv);
+    return n == SOCKET_ERROR ? -1 : n;
+}
+
+/*
+ * Fonction monotonic_us()
+ * -----------------------
+ * Horloge monotone en microsecondes (mesure de durées, délais).
+ */
+static inline uint64_t monotonic_us(void) {
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)(now.QuadPart / freq.QuadPart) * 1000000u
+           + (uint64_t)(now.QuadPart % freq.QuadPart) * 1000000u / (uint64_t)freq.QuadPart;
+}
+
+#else /* POSIX */
+
+#include <sys/types.h>
+#include <sys/socket.h>  /* socket(), bind(), sendto(), ... */
+#include <sys/select.h>  /* select() */
+#include <poll.h>        /* poll() */
+#include <netinet/in.h>  /* struct sockaddr_in */
+#include <netinet/tcp.h> /* TCP_NODELAY */
+#include <arpa/inet.h>   /* inet_ntoa(), inet_addr() */
+#include <netdb.h>       /* gethostbyname() */
+#include <unistd.h>      /* close(), getpid(), usleep() */
+#include <fcntl.h>       /* fcntl() pour le mode non bloquant */
+#include <errno.h>       /* errno */
+#include <signal.h>      /* signal(), SIGPIPE */
+#include <time.h>        /* clock_gettime() */
+
+/* Équivalents POSIX des types et constantes Winsock */
+typedef int SOCKET;
+#define INVALID_SOCKET (-1)
+#define SOCKET_ERROR   (-1)
+
+/* Winsock n'est pas nécessaire sous POSIX: initialisation factice */
+typedef struct {
+    int unused;
+} WSADATA;
+#define MAKEWORD(low, high) ((unsigned short)(((low) & 0xff) | (((high) & 0xff) << 8)))
+#define WSAStartup(version, data) ((void)(version), (void)(data), 0)
+#define WSACleanup() ((void)0)
+#define WSAGetLastError() (errno)
+#define WSAEWOULDBLOCK EWOULDBLOCK
+
+#define closesocket(s) close(s)
+#define Sleep(ms) usleep((useconds_t)(ms) * 1000)
+#define _getpid getpid
+
+/*
+ * Fonction net_set_nonblocking()
+ * ------------------------------
+ * Passe un descripteur en mode non bloquant (O_NONBLOCK).
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur
+ */
+static inline int net_set_nonblocking(SOCKET sock) {
+    int flags = fcntl(sock, F_GETFL, 0);
+    if (flags < 0) return -1;
+    return fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+}
+
+/*
+ * Fonction net_would_block()
+ * --------------------------
+ * Indique si le code d'erreur signifie "réessayer plus tard"
+ * (opération non bloquante sans données disponibles).
+ */
+static inline int net_would_block(int err) {
+    return err == EAGAIN || err == EWOULDBLOCK || err == EINTR;
+}
+
+/*
+ * Fonction net_wait_writable()
+ * ----------------------------
+ * Attend qu'un descripteur soit inscriptible, au plus timeout_ms
+ * millisecondes (utilisé par les threads qui n'ont pas de boucle
+ * d'événements). poll() n'est pas limité à FD_SETSIZE descripteurs.
+ *
+ * Retourne:
+ *   1 si le descripteur est inscriptible, 0 à l'expiration du délai,
+ *   -1 en cas d'erreur
+ */
+static inline int net_wait_writable(SOCKET sock, int timeout_ms) {
+    struct pollfd pfd;
+    pfd.fd = sock;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    return poll(&pfd, 1, timeout_ms);
+}
+
+/*
+ * Fonction monotonic_us()
+ * -----------------------
+ * Horloge monotone en microsecondes (mesure de durées, délais).
+ */
+static inline uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+#endif /* _WIN32 */
+
+#endif /* NET_COMPAT_H */
@@ -0,0 +1,183 @@
+/*
+ * ============================================================================
+ * OUTPUT - Envoi fiable et borné de la sortie des commandes (esclave)
+ * ============================================================================
+ *
+ * Voir output.h pour la description de l'interface.
+ *
+ * ============================================================================
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "output.h"
+
+/* Délai de retransmission après backoff essais (µs) */
+static uint64_t rto_us(unsigned int backoff) {
+    uint64_t ms = OUTPUT_RTO_MS;
+    for (unsigned int i = 0; i < backoff && ms < OUTPUT_RTO_MAX_MS; i++) ms *= 2;
+    if (ms > OUTPUT_RTO_MAX_MS) ms = OUTPUT_RTO_MAX_MS;
+    return ms * 1000;
+}
+
+/*
+ * Fonction output_create()
+ * ------------------------
+ * Crée le flux de sortie d'une commande.
+ *
+ * Paramètres:
+ *   job - Commande en cours (identifiant et adresse du maître)
+ *   frame_cap - Taille maximale d'une trame MSG_OUTPUT
+ *
+ * Retourne:
+ *   Le flux, ou NULL en cas d'erreur d'allocation
+ */
+OutputStream *output_create(ExecJob *job, size_t frame_cap) {
+    OutputStream *s = calloc(1, sizeof(OutputStream));
+    if (!s) return NULL;
+
+    s->id = job->id;
+    s->reply_addr = job->reply_addr;
+    s->reply_len = job->reply_len;
+    s->frame_cap = frame_cap;
+    s->job = job;
+    return s;
+}
+
+void output_destroy(OutputStream *s) {
+    for (int i = 0; i < OUTPUT_WINDOW; i++) free(s->frames[i]);
+    free(s->result);
+    free(s);
+}
+
+/*
+ * Fonction output_pending()
+ * -------------------------
+ * Nombre de morceaux envoyés et non encore acquittés.
+ */
+uint32_t output_pending(const OutputStream *s) {
+    return s->next - s->base;
+}
+
+/*
+ * Fonction output_slot()
+ * ----------------------
+ * Tampon (frame_cap octets) où encoder le morceau de rang next; les
+ * données peuvent y être lues directement, après PROTO_OUTPUT_OVERHEAD.
+ *
+ * Retourne:
+ *   Le tampon, ou NULL si la fenêtre est pleine (ou en cas d'erreur
+ *   d'allocation: la sortie est alors abandonnée)
+ */
+uint8_t *output_slot(OutputStream *s) {
+    if (s->abandoned || output_pending(s) >= OUTPUT_WINDOW) return NULL;
+
+    uint8_t **slot = &s->frames[s->next % OUTPUT_WINDOW];
+    if (!*slot) {
+        *slot = malloc(s->frame_cap);
+        if (!*slot) {
+            output_abandon(s);
+            return NULL;
+        }
+    }
+    return *slot;
+}
+
+/*
+ * Fonction output_push()
+ * ----------------------
+ * Enregistre le morceau encodé dans le tampon rendu par output_slot() et
+ * arme la retransmission s'il est le seul en attente.
+ */
+void output_push(OutputStream *s, size_t frame_len, uint64_t now_us) {
+    s->frame_lens[s->next % OUTPUT_WINDOW] = frame_len;
+    s->next++;
+    if (!s->deadline_us) s->deadline_us = now_us + rto_us(s->backoff);
+}
+
+/*
+ * Fonction output_ack()
+ * ---------------------
+ * Applique un acquittement cumulatif: les morceaux de rang inférieur à
+ * next sont reçus. Tout acquittement, même sans progression, prouve que
+ * le maître est joignable.
+ *
+ * Retourne:
+ *   1 si des morceaux ont été acquittés,
+ *   -1 si l'acquittement est le OUTPUT_DUP_ACKS-ième doublon (le morceau
+ *   base est probablement perdu: renvoyer la fenêtre),
+ *   0 sinon
+ */
+int output_ack(OutputStream *s, uint32_t next, uint64_t now_us) {
+    s->misses = 0;
+    if (next == s->base) {
+        if (output_pending(s) == 0) return 0;
+        return ++s->dup_acks == OUTPUT_DUP_ACKS ? -1 : 0;
+    }
+    if (next - s->base > output_pending(s)) return 0;  /* Acquittement périmé */
+
+    s->base = next;
+    s->backoff = 0;
+    s->dup_acks = 0;
+    s->deadline_us = output_pending(s) ? now_us + rto_us(0) : 0;
+    return 1;
+}
+
+/*
+ * Fonction output_backoff()
+ * -------------------------
+ * Après une retransmission des morceaux en attente: double le délai
+ * (jusqu'à OUTPUT_RTO_MAX_MS) et compte l'essai.
+ */
+void output_backoff(OutputStream *s, uint64_t now_us) {
+    s->misses++;
+    if (s->backoff < 16) s->backoff++;
+    s->deadline_us = now_us + rto_us(s->backoff);
+}
+
+/*
+ * Fonction output_abandon()
+ * -------------------------
+ * Renonce à envoyer la sortie: les morceaux retenus sont libérés.
+ */
+void output_abandon(OutputStream *s) {
+    for (int i = 0; i < OUTPUT_WINDOW; i++) {
+        free(s->frames[i]);
+        s->frames[i] = NULL;
+    }
+    s->base = s->next;
+    s->deadline_us = 0;
+    s->abandoned = 1;
+}
+
+/*
+ * Fonction output_hold_result()
+ * -----------------------------
+ * Retient une copie de la trame de résultat jusqu'aux derniers
+ * acquittements.
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation
+ */
+int output_hold_result(OutputStream *s, const uint8_t *frame, size_t len) {
+    uint8_t *copy = malloc(len);
+    if (!copy) return -1;
+    memcpy(copy, frame, len);
+    free(s->result);
+    s->result = copy;
+    s->result_len = len;
+    return 0;
+}
+
+/*
+ * Fonction output_frame()
+ * -----------------------
+ * Retourne:
+ *   La trame du morceau seq (en attente d'acquittement), ou NULL
+ */
+const uint8_t *output_frame(const OutputStream *s, uint32_t seq, size_t *len) {
+    if (seq - s->base >= output_pending(s)) return NULL;
+    *len = s->frame_lens[seq % OUTPUT_WINDOW];
+    return s->frames[seq % OUTPUT_WINDOW];
+}
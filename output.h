@@ -0,0 +1,119 @@
+/*
+ * ============================================================================
+ * OUTPUT - Envoi fiable et borné de la sortie des commandes (esclave)
+ * ============================================================================
+ *
+ * Description:
+ *   La sortie capturée d'une commande (stdout / stderr, voir executor.h)
+ *   est envoyée au maître en morceaux MSG_OUTPUT numérotés, lus
+ *   directement dans la trame qui sera envoyée puis conservée pour la
+ *   retransmission.
+ *
+ *   Chaque commande a sa propre fenêtre d'émission (go-back-N): au plus
+ *   OUTPUT_WINDOW morceaux non acquittés. Le maître acquitte le rang du
+ *   prochain morceau attendu (MSG_OUTPUT_ACK); lorsque la fenêtre est
+ *   pleine, l'esclave cesse de lire les tubes de la commande et le fils se
+ *   bloque en écriture. La mémoire d'une commande est donc bornée à
+ *   OUTPUT_WINDOW trames, quelle que soit la taille de sa sortie.
+ *
+ *   Sans progression pendant le délai de retransmission (OUTPUT_RTO_MS,
+ *   doublé à chaque essai jusqu'à OUTPUT_RTO_MAX_MS), tous les morceaux
+ *   non acquittés sont renvoyés. Le maître ignorant les morceaux hors
+ *   séquence, chacun d'eux lui fait répéter le même acquittement: au
+ *   OUTPUT_DUP_ACKS-ième doublon, la fenêtre est renvoyée sans attendre
+ *   l'échéance (retransmission rapide, une fois par perte).
+ *
+ *   Un acquittement sans progression (client lent, le maître retient la
+ *   sortie) prouve que le maître est joignable; après OUTPUT_MAX_MISSES
+ *   retransmissions consécutives sans aucune réponse, la sortie est
+ *   abandonnée.
+ *
+ *   Le résultat MSG_RESULT de la commande est retenu dans le flux jusqu'à
+ *   ce que toute la sortie soit acquittée.
+ *
+ * ============================================================================
+ */
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "net_compat.h"
+#include "executor.h"
+
+/* Morceaux non acquittés par commande */
+#define OUTPUT_WINDOW 32
+
+/* Délai de retransmission initial et maximal (ms) */
+#define OUTPUT_RTO_MS 200
+#define OUTPUT_RTO_MAX_MS 2000
+
+/* Acquittements dupliqués déclenchant une retransmission rapide */
+#define OUTPUT_DUP_ACKS 3
+
+/* Retransmissions consécutives sans réponse avant abandon de la sortie */
+#define OUTPUT_MAX_MISSES 10
+
+/*
+ * Structure OutputStream
+ * ----------------------
+ * Sortie d'une commande en cours d'envoi.
+ *
+ * Champs:
+ *   - id: Identifiant de la commande
+ *   - reply_addr / reply_len: Adresse du maître
+ *   - frames / frame_lens: Trames MSG_OUTPUT non acquittées (emplacement
+ *     seq % OUTPUT_WINDOW), allouées à la première utilisation
+ *   - frame_cap: Taille allouée de chaque trame
+ *   - base: Rang du plus ancien morceau non acquitté
+ *   - next: Rang du prochain morceau
+ *   - deadline_us: Échéance de retransmission (0 = rien en attente)
+ *   - backoff: Exposant du délai de retransmission
+ *   - misses: Retransmissions consécutives restées sans réponse
+ *   - dup_acks: Acquittements répétés sans progression depuis le dernier
+ *     acquittement utile
+ *   - abandoned: Sortie abandonnée (maître injoignable): elle est lue et
+ *     ignorée jusqu'à la fin de la commande
+ *   - paused: Lecture des tubes suspendue (fenêtre pleine)
+ *   - job: Commande en cours, NULL une fois terminée
+ *   - result / result_len: Trame MSG_RESULT retenue jusqu'aux derniers
+ *     acquittements
+ *   - next_stream: Chaînage de la liste des flux de l'esclave
+ */
+typedef struct OutputStream {
+    unsigned int id;
+    struct sockaddr_in reply_addr;
+    socklen_t reply_len;
+    uint8_t *frames[OUTPUT_WINDOW];
+    size_t frame_lens[OUTPUT_WINDOW];
+    size_t frame_cap;
+    uint32_t base;
+    uint32_t next;
+    uint64_t deadline_us;
+    unsigned int backoff;
+    unsigned int misses;
+    unsigned int dup_acks;
+    int abandoned;
+    int paused;
+    ExecJob *job;
+    uint8_t *result;
+    size_t result_len;
+    struct OutputStream *next_stream;
+} OutputStream;
+
+OutputStream *output_create(ExecJob *job, size_t frame_cap);
+void output_destroy(OutputStream *s);
+
+uint8_t *output_slot(OutputStream *s);
+void output_push(OutputStream *s, size_t frame_len, uint64_t now_us);
+int output_ack(OutputStream *s, uint32_t next, uint64_t now_us);
+void output_backoff(OutputStream *s, uint64_t now_us);
+void output_abandon(OutputStream *s);
+int output_hold_result(OutputStream *s, const uint8_t *frame, size_t len);
+
+uint32_t output_pending(const OutputStream *s);
+const uint8_t *output_frame(const OutputStream *s, uint32_t seq, size_t *len);
+
+#endif /* OUTPUT_H */
@@ -0,0 +1,386 @@
+/*
+ * ============================================================================
+ * PROTOCOL - Format binaire des messages client / maître / esclaves
+ * ============================================================================
+ *
+ * Voir protocol.h pour la description du format.
+ *
+ * ============================================================================
+ */
+
+#include <string.h>
+
+#include "protocol.h"
+
+/* ============================================================================
+ * CODAGE LITTLE-ENDIAN
+ * ============================================================================ */
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+/*
+ * Fonction put_header()
+ * ---------------------
+ * Écrit l'en-tête commun d'une trame de payload_len octets de charge utile.
+ *
+ * Retourne:
+ *   Taille totale de la trame, ou 0 si elle ne tient pas dans cap octets
+ *   ou dépasse PROTO_MAX_FRAME
+ */
+static size_t put_header(uint8_t *buf, size_t cap, MsgType type, uint32_t id,
+                         uint16_t flags, size_t payload_len) {
+    size_t total = PROTO_HEADER_SIZE + payload_len;
+    if (total > cap || total > PROTO_MAX_FRAME) return 0;
+
+    put_u16(buf, (uint16_t)total);
+    buf[2] = PROTO_VERSION;
+    buf[3] = (uint8_t)type;
+    put_u32(buf + 4, id);
+    put_u16(buf + 8, flags);
+    return total;
+}
+
+/* ============================================================================
+ * ENCODAGE
+ * ============================================================================ */
+
+/*
+ * Fonction proto_encode_command()
+ * -------------------------------
+ * Encode une trame MSG_COMMAND.
+ *
+ * Retourne:
+ *   Taille de la trame, ou 0 si elle ne tient pas dans buf
+ */
+size_t proto_encode_command(uint8_t *buf, size_t cap, uint32_t id, const ProtoCommand *cmd) {
+    size_t total = put_header(buf, cap, MSG_COMMAND, id, 0, 6 + cmd->command_len);
+    if (!total) return 0;
+
+    uint8_t *p = buf + PROTO_HEADER_SIZE;
+    memcpy(p, &cmd->origin_ip, 4);  /* Déjà en ordre réseau */
+    put_u16(p + 4, cmd->origin_port);
+    memcpy(p + 6, cmd->command, cmd->command_len);
+    return total;
+}
+
+/*
+ * Fonction proto_encode_result()
+ * ------------------------------
+ * Encode une trame MSG_RESULT.
+ *
+ * Retourne:
+ *   Taille de la trame, ou 0 si elle ne tient pas dans buf
+ */
+size_t proto_encode_result(uint8_t *buf, size_t cap, uint32_t id, const ProtoResult *res) {
+    size_t total = put_header(buf, cap, MSG_RESULT, id, 0, 16 + res->message_len);
+    if (!total) return 0;
+
+    uint8_t *p = buf + PROTO_HEADER_SIZE;
+    put_u32(p, (uint32_t)res->return_code);
+    put_u64(p + 4, res->duration_us);
+    put_u16(p + 12, res->capacity);
+    put_u16(p + 14, res->free_slots);
+    if (res->message_len) memcpy(p + 16, res->message, res->message_len);
+    return total;
+}
+
+/*
+ * Fonction proto_encode_text()
+ * ----------------------------
+ * Encode une trame dont la charge utile est un simple texte
+ * (MSG_ACCEPT, MSG_ERROR, MSG_BUSY, MSG_ACK, MSG_DATA, MSG_END, MSG_PING).
+ *
+ * Retourne:
+ *   Taille de la trame, ou 0 si elle ne tient pas dans buf
+ */
+size_t proto_encode_text(uint8_t *buf, size_t cap, MsgType type, uint32_t id,
+                         const char *text, size_t text_len) {
+    size_t total = put_header(buf, cap, type, id, 0, text_len);
+    if (!total) return 0;
+
+    if (text_len) memcpy(buf + PROTO_HEADER_SIZE, text, text_len);
+    return total;
+}
+
+/*
+ * Fonction proto_encode_done()
+ * ----------------------------
+ * Encode le bilan final MSG_DONE envoyé au client.
+ */
+size_t proto_encode_done(uint8_t *buf, size_t cap, uint32_t total, uint32_t failed) {
+    size_t len = put_header(buf, cap, MSG_DONE, 0, 0, 8);
+    if (!len) return 0;
+
+    put_u32(buf + PROTO_HEADER_SIZE, total);
+    put_u32(buf + PROTO_HEADER_SIZE + 4, failed);
+    return len;
+}
+
+/*
+ * Fonction proto_encode_output()
+ * ------------------------------
+ * Encode un morceau de sortie MSG_OUTPUT. Les données peuvent avoir été
+ * lues directement à leur place dans la trame (buf + PROTO_OUTPUT_OVERHEAD):
+ * elles ne sont alors pas recopiées.
+ */
+size_t proto_encode_output(uint8_t *buf, size_t cap, uint32_t id, const ProtoOutput *out) {
+    size_t total = put_header(buf, cap, MSG_OUTPUT, id, out->stream, 4 + out->data_len);
+    if (!total) return 0;
+
+    put_u32(buf + PROTO_HEADER_SIZE, out->seq);
+    if (out->data_len && out->data != buf + PROTO_OUTPUT_OVERHEAD) {
+        memmove(buf + PROTO_OUTPUT_OVERHEAD, out->data, out->data_len);
+    }
+    return total;
+}
+
+/*
+ * Fonction proto_encode_output_ack()
+ * ----------------------------------
+ * Encode l'acquittement cumulatif MSG_OUTPUT_ACK: tous les morceaux de
+ * rang inférieur à next ont été reçus.
+ */
+size_t proto_encode_output_ack(uint8_t *buf, size_t cap, uint32_t id, uint32_t next) {
+    size_t len = put_header(buf, cap, MSG_OUTPUT_ACK, id, 0, 4);
+    if (!len) return 0;
+
+    put_u32(buf + PROTO_HEADER_SIZE, next);
+    return len;
+}
+
+/*
+ * Fonction proto_encode_heartbeat()
+ * ---------------------------------
+ * Encode la réponse MSG_HEARTBEAT d'un esclave à MSG_PING.
+ */
+size_t proto_encode_heartbeat(uint8_t *buf, size_t cap, const ProtoHeartbeat *hb) {
+    size_t len = put_header(buf, cap, MSG_HEARTBEAT, 0, 0, 12);
+    if (!len) return 0;
+
+    uint8_t *p = buf + PROTO_HEADER_SIZE;
+    put_u16(p, hb->capacity);
+    put_u16(p + 2, hb->free_slots);
+    put_u16(p + 4, hb->running);
+    put_u32(p + 6, hb->queued);
+    put_u16(p + 10, hb->load_x100);
+    return len;
+}
+
+/*
+ * Fonction proto_encode_register()
+ * --------------------------------
+ * Encode l'inscription MSG_REGISTER d'un esclave auprès du maître: port
+ * UDP sur lequel l'esclave reçoit les commandes.
+ */
+size_t proto_encode_register(uint8_t *buf, size_t cap, uint16_t port) {
+    size_t len = put_header(buf, cap, MSG_REGISTER, 0, 0, 2);
+    if (!len) return 0;
+
+    put_u16(buf + PROTO_HEADER_SIZE, port);
+    return len;
+}
+
+/*
+ * Fonction proto_encode_submit()
+ * ------------------------------
+ * Encode la soumission MSG_SUBMIT d'un fichier: nom du fichier, priorité
+ * (flags) et échéance (id).
+ */
+size_t proto_encode_submit(uint8_t *buf, size_t cap, const ProtoSubmit *submit) {
+    size_t total = put_header(buf, cap, MSG_SUBMIT, submit->deadline_ms, submit->priority,
+                              submit->name_len);
+    if (!total) return 0;
+
+    memcpy(buf + PROTO_HEADER_SIZE, submit->name, submit->name_len);
+    return total;
+}
+
+/* ============================================================================
+ * DÉCODAGE
+ * ============================================================================ */
+
+/*
+ * Fonction proto_decode()
+ * -----------------------
+ * Décode l'en-tête de la trame située au début de buf.
+ *
+ * Paramètres:
+ *   buf / len - Données reçues (éventuellement plusieurs trames)
+ *   frame - Trame décodée (charge utile pointant dans buf)
+ *
+ * Retourne:
+ *   Taille de la trame consommée (> 0),
+ *   0 si buf ne contient pas encore une trame complète (flux TCP),
+ *   -1 si la trame est invalide (longueur ou version)
+ */
+int proto_decode(const uint8_t *buf, size_t len, ProtoFrame *frame) {
+    if (len < PROTO_HEADER_SIZE) return 0;
+
+    uint16_t total = get_u16(buf);
+    if (total < PROTO_HEADER_SIZE) return -1;
+    if (buf[2] != PROTO_VERSION) return -1;
+    if (len < total) return 0;
+
+    frame->version = buf[2];
+    frame->type = buf[3];
+    frame->id = get_u32(buf + 4);
+    frame->flags = get_u16(buf + 8);
+    frame->payload = buf + PROTO_HEADER_SIZE;
+    frame->payload_len = (size_t)total - PROTO_HEADER_SIZE;
+    return total;
+}
+
+/*
+ * Fonction proto_decode_command()
+ * -------------------------------
+ * Retourne:
+ *   0 si la trame est une commande valide, -1 sinon
+ */
+int proto_decode_command(const ProtoFrame *frame, ProtoCommand *cmd) {
+    if (frame->type != MSG_COMMAND || frame->payload_len < 6) return -1;
+
+    memcpy(&cmd->origin_ip, frame->payload, 4);
+    cmd->origin_port = get_u16(frame->payload + 4);
+    cmd->command = (const char *)frame->payload + 6;
+    cmd->command_len = frame->payload_len - 6;
+    return 0;
+}
+
+/*
+ * Fonction proto_decode_result()
+ * ------------------------------
+ * Retourne:
+ *   0 si la trame est un résultat valide, -1 sinon
+ */
+int proto_decode_result(const ProtoFrame *frame, ProtoResult *res) {
+    if (frame->type != MSG_RESULT || frame->payload_len < 16) return -1;
+
+    const uint8_t *p = frame->payload;
+    res->return_code = (int32_t)get_u32(p);
+    res->duration_us = get_u64(p + 4);
+    res->capacity = get_u16(p + 12);
+    res->free_slots = get_u16(p + 14);
+    res->message = (const char *)p + 16;
+    res->message_len = frame->payload_len - 16;
+    return 0;
+}
+
+/*
+ * Fonction proto_decode_done()
+ * ----------------------------
+ * Retourne:
+ *   0 si la trame est un bilan valide, -1 sinon
+ */
+int proto_decode_done(const ProtoFrame *frame, uint32_t *total, uint32_t *failed) {
+    if (frame->type != MSG_DONE || frame->payload_len < 8) return -1;
+
+    *total = get_u32(frame->payload);
+    *failed = get_u32(frame->payload + 4);
+    return 0;
+}
+
+/*
+ * Fonction proto_decode_output()
+ * ------------------------------
+ * Retourne:
+ *   0 si la trame est un morceau de sortie valide, -1 sinon
+ */
+int proto_decode_output(const ProtoFrame *frame, ProtoOutput *out) {
+    if (frame->type != MSG_OUTPUT || frame->payload_len < 4) return -1;
+    if (frame->flags != PROTO_STREAM_STDOUT && frame->flags != PROTO_STREAM_STDERR) return -1;
+
+    out->stream = frame->flags;
+    out->seq = get_u32(frame->payload);
+    out->data = frame->payload + 4;
+    out->data_len = frame->payload_len - 4;
+    return 0;
+}
+
+/*
+ * Fonction proto_decode_output_ack()
+ * ----------------------------------
+ * Retourne:
+ *   0 si la trame est un acquittement de sortie valide, -1 sinon
+ */
+int proto_decode_output_ack(const ProtoFrame *frame, uint32_t *next) {
+    if (frame->type != MSG_OUTPUT_ACK || frame->payload_len < 4) return -1;
+
+    *next = get_u32(frame->payload);
+    return 0;
+}
+
+/*
+ * Fonction proto_decode_heartbeat()
+ * ---------------------------------
+ * Retourne:
+ *   0 si la trame est un battement de cœur valide, -1 sinon
+ */
+int proto_decode_heartbeat(const ProtoFrame *frame, ProtoHeartbeat *hb) {
+    if (frame->type != MSG_HEARTBEAT || frame->payload_len < 12) return -1;
+
+    const uint8_t *p = frame->payload;
+    hb->capacity = get_u16(p);
+    hb->free_slots = get_u16(p + 2);
+    hb->running = get_u16(p + 4);
+    hb->queued = get_u32(p + 6);
+    hb->load_x100 = get_u16(p + 10);
+    return 0;
+}
+
+/*
+ * Fonction proto_decode_register()
+ * --------------------------------
+ * Retourne:
+ *   0 si la trame est une inscription valide (port non nul), -1 sinon
+ */
+int proto_decode_register(const ProtoFrame *frame, uint16_t *port) {
+    if (frame->type != MSG_REGISTER || frame->payload_len < 2) return -1;
+
+    *port = get_u16(frame->payload);
+    return *port != 0 ? 0 : -1;
+}
+
+/*
+ * Fonction proto_decode_submit()
+ * ------------------------------
+ * Une priorité trop élevée est ramenée à PROTO_MAX_PRIORITY.
+ *
+ * Retourne:
+ *   0 si la trame est une soumission valide (nom non vide), -1 sinon
+ */
+int proto_decode_submit(const ProtoFrame *frame, ProtoSubmit *submit) {
+    if (frame->type != MSG_SUBMIT || frame->payload_len == 0) return -1;
+
+    submit->priority = frame->flags > PROTO_MAX_PRIORITY ? PROTO_MAX_PRIORITY : frame->flags;
+    submit->deadline_ms = frame->id;
+    submit->name = (const char *)frame->payload;
+    submit->name_len = frame->payload_len;
+    return 0;
+}
@@ -0,0 +1,257 @@
+/*
+ * ============================================================================
+ * PROTOCOL - Format binaire des messages client / maître / esclaves
+ * ============================================================================
+ *
+ * Description:
+ *   Tous les échanges (TCP client-maître, UDP maître-esclaves) utilisent
+ *   des trames binaires de longueur variable, préfixées par leur taille.
+ *   Les entiers sont codés en little-endian, octet par octet, quelle que
+ *   soit l'architecture de la machine.
+ *
+ *   En-tête commun (PROTO_HEADER_SIZE = 10 octets):
+ *
+ *     Offset  Taille  Champ
+ *     0       2       length   Taille totale de la trame, en-tête compris
+ *     2       1       version  PROTO_VERSION
+ *     3       1       type     MsgType
+ *     4       4       id       Identifiant de la requête
+ *     8       2       flags    Options propres au type de message
+ *     10      ...     payload  Charge utile (length - 10 octets)
+ *
+ *   Une trame ne contient jamais de terminateur '\0': les chaînes sont
+ *   délimitées par la longueur de la trame. Plusieurs trames peuvent se
+ *   suivre dans un même datagramme UDP ou dans le flux TCP.
+ *
+ *   Charges utiles:
+ *     MSG_COMMAND  (maître -> esclave)  ip_origine u32 | port_origine u16 | commande
+ *     MSG_RESULT   (esclave -> maître,  code i32 | durée_us u64 | capacité u16 |
+ *                   maître -> client)   libres u16 | message (optionnel)
+ *     MSG_SUBMIT   (client -> maître)   nom du fichier de commandes (informatif);
+ *                                       flags = priorité, id = échéance en ms
+ *     MSG_DATA     (client -> maître)   morceau du fichier (PROTO_MAX_CHUNK max)
+ *     MSG_END      (client -> maître)   vide: fin du fichier
+ *     MSG_ACCEPT   (maître -> client)   vide (id = numéro du travail journalisé, 0 sinon)
+ *     MSG_ERROR    (maître -> client)   message d'erreur
+ *     MSG_DONE     (maître -> client)   commandes u32 | échecs u32
+ *     MSG_ACK      (esclave -> maître)  vide: commande id reçue (voir retry.h)
+ *     MSG_OUTPUT   (esclave -> maître,  rang u32 | données de sortie de la commande
+ *                   maître -> client)
+ *     MSG_OUTPUT_ACK (maître -> esclave) rang u32: morceaux précédents reçus
+ *     MSG_PING     (maître -> esclave)  vide: demande de battement de cœur
+ *     MSG_HEARTBEAT (esclave -> maître) capacité u16 | libres u16 | en cours u16 |
+ *                                       en attente u32 | charge x100 u16
+ *     MSG_REGISTER (esclave -> maître)  port u16: inscription de l'esclave,
+ *                                       joignable à l'adresse IP émettrice
+ *     MSG_BUSY     (maître -> client)   message: soumission refusée faute de
+ *                                       place, à renouveler plus tard
+ *
+ *   Pour MSG_RESULT et MSG_OUTPUT envoyés au client, id est le rang de la
+ *   commande dans le fichier soumis (1, 2, ...).
+ *
+ *   La sortie d'une commande (MSG_OUTPUT) est découpée en morceaux
+ *   numérotés à partir de 0; flags indique le flux (PROTO_STREAM_STDOUT ou
+ *   PROTO_STREAM_STDERR). Le maître acquitte les morceaux reçus dans
+ *   l'ordre (MSG_OUTPUT_ACK, acquittement cumulatif) et l'esclave
+ *   n'envoie MSG_RESULT qu'une fois toute la sortie acquittée: le client
+ *   reçoit donc la sortie complète d'une commande avant son résultat.
+ *
+ *   Après MSG_ACCEPT, le client transmet le contenu du fichier en trames
+ *   MSG_DATA successives, terminées par MSG_END. Les morceaux sont
+ *   découpés sans tenir compte des lignes: le maître reconstitue les
+ *   lignes et les distribue pendant que le fichier est encore en cours
+ *   d'envoi.
+ *
+ * ============================================================================
+ */
+
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Version courante du format; une trame d'une autre version est rejetée */
+#define PROTO_VERSION 1
+
+/* Taille de l'en-tête commun */
+#define PROTO_HEADER_SIZE 10
+
+/* Taille maximale d'une trame (champ length sur 16 bits) */
+#define PROTO_MAX_FRAME 65535
+
+/* Taille maximale d'un datagramme UDP IPv4 (65535 - en-têtes IP et UDP) */
+#define PROTO_MAX_DATAGRAM 65507
+
+/* Taille maximale de la charge utile d'une trame MSG_DATA */
+#define PROTO_MAX_CHUNK 16384
+
+/* Surcoût d'une trame MSG_OUTPUT: en-tête et rang du morceau */
+#define PROTO_OUTPUT_OVERHEAD (PROTO_HEADER_SIZE + 4)
+
+/* Priorité maximale d'une soumission (MSG_SUBMIT, champ flags; 0 = normale) */
+#define PROTO_MAX_PRIORITY 9
+
+/* Flux d'une trame MSG_OUTPUT (champ flags) */
+#define PROTO_STREAM_STDOUT 1
+#define PROTO_STREAM_STDERR 2
+
+/* Taille maximale d'une commande transportée dans un seul datagramme */
+#define PROTO_MAX_COMMAND (PROTO_MAX_DATAGRAM - PROTO_HEADER_SIZE - 6)
+
+/*
+ * Énumération MsgType
+ * -------------------
+ * Types de trames.
+ */
+typedef enum {
+    MSG_COMMAND = 1,
+    MSG_RESULT = 2,
+    MSG_SUBMIT = 3,
+    MSG_ACCEPT = 4,
+    MSG_ERROR = 5,
+    MSG_DONE = 6,
+    MSG_ACK = 7,
+    MSG_DATA = 8,
+    MSG_END = 9,
+    MSG_OUTPUT = 10,
+    MSG_OUTPUT_ACK = 11,
+    MSG_PING = 12,
+    MSG_HEARTBEAT = 13,
+    MSG_REGISTER = 14,
+    MSG_BUSY = 15
+} MsgType;
+
+/*
+ * Structure ProtoFrame
+ * --------------------
+ * Trame décodée. La charge utile pointe dans le tampon d'origine
+ * (aucune copie): elle n'est valide que tant que ce tampon l'est.
+ */
+typedef struct {
+    uint8_t version;
+    uint8_t type;
+    uint32_t id;
+    uint16_t flags;
+    const uint8_t *payload;
+    size_t payload_len;
+} ProtoFrame;
+
+/*
+ * Structure ProtoCommand
+ * ----------------------
+ * Contenu d'une trame MSG_COMMAND.
+ *
+ * Champs:
+ *   - origin_ip: Adresse IPv4 du client d'origine (ordre réseau)
+ *   - origin_port: Port du client d'origine
+ *   - command / command_len: Commande (non terminée par '\0')
+ */
+typedef struct {
+    uint32_t origin_ip;
+    uint16_t origin_port;
+    const char *command;
+    size_t command_len;
+} ProtoCommand;
+
+/*
+ * Structure ProtoResult
+ * ---------------------
+ * Contenu d'une trame MSG_RESULT.
+ *
+ * Champs:
+ *   - return_code: Code de sortie de la commande (-1 = non exécutée)
+ *   - duration_us: Durée d'exécution mesurée par l'esclave
+ *   - capacity: Nombre de workers de l'esclave (0 si non pertinent)
+ *   - free_slots: Workers libres de l'esclave
+ *   - message / message_len: Message facultatif (erreur), non terminé par '\0'
+ */
+typedef struct {
+    int32_t return_code;
+    uint64_t duration_us;
+    uint16_t capacity;
+    uint16_t free_slots;
+    const char *message;
+    size_t message_len;
+} ProtoResult;
+
+/*
+ * Structure ProtoOutput
+ * ---------------------
+ * Contenu d'une trame MSG_OUTPUT.
+ *
+ * Champs:
+ *   - stream: PROTO_STREAM_STDOUT ou PROTO_STREAM_STDERR
+ *   - seq: Rang du morceau dans la sortie de la commande (à partir de 0)
+ *   - data / data_len: Octets produits par la commande
+ */
+typedef struct {
+    uint16_t stream;
+    uint32_t seq;
+    const uint8_t *data;
+    size_t data_len;
+} ProtoOutput;
+
+/*
+ * Structure ProtoSubmit
+ * ---------------------
+ * Contenu d'une trame MSG_SUBMIT.
+ *
+ * Champs:
+ *   - priority: Priorité du fichier (0 à PROTO_MAX_PRIORITY, la plus
+ *     élevée passe d'abord), dans le champ flags
+ *   - deadline_ms: Délai d'exécution de toutes ses commandes à compter de
+ *     la soumission (0 = aucun), dans le champ id
+ *   - name / name_len: Nom du fichier de commandes (informatif)
+ */
+typedef struct {
+    uint16_t priority;
+    uint32_t deadline_ms;
+    const char *name;
+    size_t name_len;
+} ProtoSubmit;
+
+/*
+ * Structure ProtoHeartbeat
+ * ------------------------
+ * Contenu d'une trame MSG_HEARTBEAT: état de santé et charge de l'esclave.
+ *
+ * Champs:
+ *   - capacity: Nombre de workers de l'esclave
+ *   - free_slots: Workers libres (moins les commandes en attente)
+ *   - running: Commandes en cours d'exécution
+ *   - queued: Commandes en attente d'un worker libre
+ *   - load_x100: Charge moyenne de la machine sur 1 minute, x100
+ */
+typedef struct {
+    uint16_t capacity;
+    uint16_t free_slots;
+    uint16_t running;
+    uint32_t queued;
+    uint16_t load_x100;
+} ProtoHeartbeat;
+
+/* Encodage: retournent la taille de la trame écrite, 0 si buf est trop petit */
+size_t proto_encode_command(uint8_t *buf, size_t cap, uint32_t id, const ProtoCommand *cmd);
+size_t proto_encode_result(uint8_t *buf, size_t cap, uint32_t id, const ProtoResult *res);
+size_t proto_encode_text(uint8_t *buf, size_t cap, MsgType type, uint32_t id,
+                         const char *text, size_t text_len);
+size_t proto_encode_done(uint8_t *buf, size_t cap, uint32_t total, uint32_t failed);
+size_t proto_encode_output(uint8_t *buf, size_t cap, uint32_t id, const ProtoOutput *out);
+size_t proto_encode_output_ack(uint8_t *buf, size_t cap, uint32_t id, uint32_t next);
+size_t proto_encode_heartbeat(uint8_t *buf, size_t cap, const ProtoHeartbeat *hb);
+size_t proto_encode_register(uint8_t *buf, size_t cap, uint16_t port);
+size_t proto_encode_submit(uint8_t *buf, size_t cap, const ProtoSubmit *submit);
+
+/* Décodage */
+int proto_decode(const uint8_t *buf, size_t len, ProtoFrame *frame);
+int proto_decode_command(const ProtoFrame *frame, ProtoCommand *cmd);
+int proto_decode_result(const ProtoFrame *frame, ProtoResult *res);
+int proto_decode_done(const ProtoFrame *frame, uint32_t *total, uint32_t *failed);
+int proto_decode_output(const ProtoFrame *frame, ProtoOutput *out);
+int proto_decode_output_ack(const ProtoFrame *frame, uint32_t *next);
+int proto_decode_heartbeat(const ProtoFrame *frame, ProtoHeartbeat *hb);
+int proto_decode_register(const ProtoFrame *frame, uint16_t *port);
+int proto_decode_submit(const ProtoFrame *frame, ProtoSubmit *submit);
+
+#endif /* PROTOCOL_H */
@@ -0,0 +1,307 @@
+/*
+ * ============================================================================
+ * REACTOR - Boucle d'événements réseau (epoll / select)
+ * ============================================================================
+ *
+ * Voir reactor.h pour la description de l'interface.
+ *
+ * Deux implémentations sont fournies:
+ *   - __linux__: epoll, avec une table de rappels indexée par descripteur
+ *   - sinon:     select(), avec une liste de sockets enregistrés
+ *
+ * Dans les deux cas, un socket retiré pendant le traitement d'un lot
+ * d'événements n'est plus notifié (son rappel est recherché au moment
+ * de la distribution, pas au moment de l'attente).
+ *
+ * ============================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "reactor.h"
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+/* Nombre maximal d'événements récupérés par appel à epoll_wait() */
+#define REACTOR_MAX_EVENTS 256
+
+/*
+ * Structure ReactorEntry
+ * ----------------------
+ * Enregistrement d'un socket surveillé.
+ *
+ * Champs:
+ *   - sock: Socket surveillé (INVALID_SOCKET si l'entrée est libre)
+ *   - events: Masque REACTOR_READ / REACTOR_WRITE demandé
+ *   - cb: Fonction de rappel
+ *   - arg: Contexte transmis au rappel
+ */
+typedef struct {
+    SOCKET sock;
+    int events;
+    reactor_cb cb;
+    void *arg;
+} ReactorEntry;
+
+struct Reactor {
+#ifdef __linux__
+    int epfd;                 /* Descripteur epoll */
+#endif
+    ReactorEntry *entries;    /* Linux: indexé par fd; sinon: liste compacte */
+    int capacity;             /* Nombre d'entrées allouées */
+    int count;                /* Nombre d'entrées utilisées (liste compacte) */
+};
+
+/*
+ * Fonction reactor_create()
+ * -------------------------
+ * Alloue et initialise un réacteur vide.
+ *
+ * Retourne:
+ *   Pointeur vers le réacteur, ou NULL en cas d'erreur
+ */
+Reactor *reactor_create(void) {
+    Reactor *r = calloc(1, sizeof(Reactor));
+    if (!r) return NULL;
+
+#ifdef __linux__
+    r->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (r->epfd < 0) {
+        free(r);
+        return NULL;
+    }
+#endif
+    return r;
+}
+
+/*
+ * Fonction reactor_destroy()
+ * --------------------------
+ * Libère le réacteur. Les sockets enregistrés ne sont pas fermés.
+ */
+void reactor_destroy(Reactor *r) {
+    if (!r) return;
+#ifdef __linux__
+    close(r->epfd);
+#endif
+    free(r->entries);
+    free(r);
+}
+
+#ifdef __linux__
+
+/* ----------------------------------------------------------------------------
+ * Implémentation epoll
+ * ---------------------------------------------------------------------------- */
+
+static unsigned int to_epoll_events(int events) {
+    unsigned int ev = 0;
+    if (events & REACTOR_READ) ev |= EPOLLIN;
+    if (events & REACTOR_WRITE) ev |= EPOLLOUT;
+    return ev;
+}
+
+/* Agrandit la table pour pouvoir indexer le descripteur fd */
+static int reserve_fd(Reactor *r, int fd) {
+    if (fd < r->capacity) return 0;
+
+    int new_cap = r->capacity ? r->capacity : 64;
+    while (new_cap <= fd) new_cap *= 2;
+
+    ReactorEntry *grown = realloc(r->entries, (size_t)new_cap * sizeof(ReactorEntry));
+    if (!grown) return -1;
+    for (int i = r->capacity; i < new_cap; i++) {
+        grown[i].sock = INVALID_SOCKET;
+        grown[i].cb = NULL;
+    }
+    r->entries = grown;
+    r->capacity = new_cap;
+    return 0;
+}
+
+int reactor_add(Reactor *r, SOCKET sock, int events, reactor_cb cb, void *arg) {
+    if (sock < 0 || reserve_fd(r, sock) < 0) return -1;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = to_epoll_events(events);
+    ev.data.fd = sock;
+    if (epoll_ctl(r->epfd, EPOLL_CTL_ADD, sock, &ev) < 0) return -1;
+
+    r->entries[sock].sock = sock;
+    r->entries[sock].events = events;
+    r->entries[sock].cb = cb;
+    r->entries[sock].arg = arg;
+    r->count++;
+    return 0;
+}
+
+int reactor_modify(Reactor *r, SOCKET sock, int events) {
+    if (sock < 0 || sock >= r->capacity || !r->entries[sock].cb) return -1;
+    if (r->entries[sock].events == events) return 0;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = to_epoll_events(events);
+    ev.data.fd = sock;
+    if (epoll_ctl(r->epfd, EPOLL_CTL_MOD, sock, &ev) < 0) return -1;
+
+    r->entries[sock].events = events;
+    return 0;
+}
+
+int reactor_remove(Reactor *r, SOCKET sock) {
+    if (sock < 0 || sock >= r->capacity || !r->entries[sock].cb) return -1;
+
+    epoll_ctl(r->epfd, EPOLL_CTL_DEL, sock, NULL);
+    r->entries[sock].sock = INVALID_SOCKET;
+    r->entries[sock].cb = NULL;
+    r->entries[sock].arg = NULL;
+    r->count--;
+    return 0;
+}
+
+/*
+ * Fonction reactor_run_once()
+ * ---------------------------
+ * Attend au plus timeout_ms millisecondes (-1 = indéfiniment) puis
+ * distribue les événements prêts à leurs rappels.
+ *
+ * Retourne:
+ *   Nombre d'événements traités, 0 si délai expiré, -1 en cas d'erreur
+ */
+int reactor_run_once(Reactor *r, int timeout_ms) {
+    struct epoll_event events[REACTOR_MAX_EVENTS];
+
+    int n = epoll_wait(r->epfd, events, REACTOR_MAX_EVENTS, timeout_ms);
+    if (n < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        int fd = events[i].data.fd;
+        if (fd >= r->capacity || !r->entries[fd].cb) continue;  /* Retiré entre-temps */
+
+        int mask = 0;
+        if (events[i].events & (EPOLLIN | EPOLLHUP)) mask |= REACTOR_READ;
+        if (events[i].events & EPOLLOUT) mask |= REACTOR_WRITE;
+        if (events[i].events & EPOLLERR) mask |= REACTOR_ERROR;
+
+        r->entries[fd].cb(r, fd, mask, r->entries[fd].arg);
+    }
+    return n;
+}
+
+#else /* !__linux__ */
+
+/* ----------------------------------------------------------------------------
+ * Implémentation select() (Winsock et systèmes sans epoll)
+ * ---------------------------------------------------------------------------- */
+
+static int find_entry(Reactor *r, SOCKET sock) {
+    for (int i = 0; i < r->count; i++) {
+        if (r->entries[i].sock == sock) return i;
+    }
+    return -1;
+}
+
+int reactor_add(Reactor *r, SOCKET sock, int events, reactor_cb cb, void *arg) {
+    if (sock == INVALID_SOCKET || find_entry(r, sock) >= 0) return -1;
+    if (r->count >= FD_SETSIZE) return -1;
+
+    if (r->count == r->capacity) {
+        int new_cap = r->capacity ? r->capacity * 2 : 64;
+        ReactorEntry *grown = realloc(r->entries, (size_t)new_cap * sizeof(ReactorEntry));
+        if (!grown) return -1;
+        r->entries = grown;
+        r->capacity = new_cap;
+    }
+
+    r->entries[r->count].sock = sock;
+    r->entries[r->count].events = events;
+    r->entries[r->count].cb = cb;
+    r->entries[r->count].arg = arg;
+    r->count++;
+    return 0;
+}
+
+int reactor_modify(Reactor *r, SOCKET sock, int events) {
+    int i = find_entry(r, sock);
+    if (i < 0) return -1;
+    r->entries[i].events = events;
+    return 0;
+}
+
+int reactor_remove(Reactor *r, SOCKET sock) {
+    int i = find_entry(r, sock);
+    if (i < 0) return -1;
+    r->entries[i] = r->entries[r->count - 1];
+    r->count--;
+    return 0;
+}
+
+int reactor_run_once(Reactor *r, int timeout_ms) {
+    fd_set rfds, wfds, efds;
+    FD_ZERO(&rfds);
+    FD_ZERO(&wfds);
+    FD_ZERO(&efds);
+
+    SOCKET max_sock = 0;
+    for (int i = 0; i < r->count; i++) {
+        SOCKET s = r->entries[i].sock;
+        if (r->entries[i].events & REACTOR_READ) FD_SET(s, &rfds);
+        if (r->entries[i].events & REACTOR_WRITE) FD_SET(s, &wfds);
+        FD_SET(s, &efds);
+        if (s > max_sock) max_sock = s;
+    }
+
+    struct timeval tv;
+    struct timeval *ptv = NULL;
+    if (timeout_ms >= 0) {
+        tv.tv_sec = timeout_ms / 1000;
+        tv.tv_usec = (timeout_ms % 1000) * 1000;
+        ptv = &tv;
+    }
+
+    if (r->count == 0) {
+        /* select() sans socket échoue sous Winsock: simple attente */
+        if (timeout_ms > 0) Sleep(timeout_ms);
+        return 0;
+    }
+
+    int n = select((int)max_sock + 1, &rfds, &wfds, &efds, ptv);
+    if (n <= 0) return n;
+
+    /*
+     * Copie des sockets prêts avant distribution: les rappels peuvent
+     * ajouter ou retirer des entrées et donc réordonner la liste.
+     */
+    SOCKET ready[FD_SETSIZE];
+    int masks[FD_SETSIZE];
+    int nready = 0;
+    for (int i = 0; i < r->count; i++) {
+        SOCKET s = r->entries[i].sock;
+        int mask = 0;
+        if (FD_ISSET(s, &rfds)) mask |= REACTOR_READ;
+        if (FD_ISSET(s, &wfds)) mask |= REACTOR_WRITE;
+        if (FD_ISSET(s, &efds)) mask |= REACTOR_ERROR;
+        if (mask) {
+            ready[nready] = s;
+            masks[nready] = mask;
+            nready++;
+        }
+    }
+
+    for (int i = 0; i < nready; i++) {
+        int idx = find_entry(r, ready[i]);
+        if (idx < 0) continue;  /* Retiré entre-temps */
+        r->entries[idx].cb(r, ready[i], masks[i], r->entries[idx].arg);
+    }
+    return nready;
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,56 @@
+/*
+ * ============================================================================
+ * REACTOR - Boucle d'événements réseau (epoll / select)
+ * ============================================================================
+ *
+ * Description:
+ *   Petit réacteur mono-thread qui multiplexe un ensemble de sockets et
+ *   appelle une fonction de rappel lorsqu'un socket devient lisible ou
+ *   inscriptible.
+ *
+ *   - Linux: implémentation basée sur epoll (O(1) par événement)
+ *   - Autres systèmes (Windows/Winsock, macOS): repli sur select()
+ *
+ * Utilisation typique:
+ *   Reactor *r = reactor_create();
+ *   reactor_add(r, sock, REACTOR_READ, on_readable, ctx);
+ *   while (1) reactor_run_once(r, -1);
+ *
+ * ============================================================================
+ */
+
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include "net_compat.h"
+
+/* Masques d'événements surveillés / signalés */
+#define REACTOR_READ  0x1   /* Données disponibles en lecture (ou accept possible) */
+#define REACTOR_WRITE 0x2   /* Écriture possible sans blocage */
+#define REACTOR_ERROR 0x4   /* Erreur ou fermeture détectée (signalé uniquement) */
+
+typedef struct Reactor Reactor;
+
+/*
+ * Type reactor_cb
+ * ---------------
+ * Fonction de rappel appelée pour un socket prêt.
+ *
+ * Paramètres:
+ *   r      - Réacteur appelant
+ *   sock   - Socket concerné
+ *   events - Combinaison de REACTOR_READ / REACTOR_WRITE / REACTOR_ERROR
+ *   arg    - Contexte fourni lors de reactor_add()
+ */
+typedef void (*reactor_cb)(Reactor *r, SOCKET sock, int events, void *arg);
+
+Reactor *reactor_create(void);
+void reactor_destroy(Reactor *r);
+
+int reactor_add(Reactor *r, SOCKET sock, int events, reactor_cb cb, void *arg);
+int reactor_modify(Reactor *r, SOCKET sock, int events);
+int reactor_remove(Reactor *r, SOCKET sock);
+
+int reactor_run_once(Reactor *r, int timeout_ms);
+
+#endif /* REACTOR_H */
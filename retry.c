@@ -0,0 +1,105 @@
+/*
+ * ============================================================================
+ * RETRY - Échéancier des retransmissions de commandes (maître)
+ * ============================================================================
+ *
+ * Voir retry.h pour la description de l'interface.
+ *
+ * ============================================================================
+ */
+
+#include <stdlib.h>
+
+#include "retry.h"
+
+/*
+ * Fonction retry_init()
+ * ---------------------
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation
+ */
+int retry_init(RetryQueue *q, size_t initial_capacity) {
+    q->cap = initial_capacity > 16 ? initial_capacity : 16;
+    q->len = 0;
+    q->heap = malloc(q->cap * sizeof(RetryTimer));
+    return q->heap ? 0 : -1;
+}
+
+void retry_free(RetryQueue *q) {
+    free(q->heap);
+    q->heap = NULL;
+    q->len = 0;
+    q->cap = 0;
+}
+
+/*
+ * Fonction retry_push()
+ * ---------------------
+ * Planifie une échéance pour la commande id.
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation
+ */
+int retry_push(RetryQueue *q, uint64_t due_us, unsigned int id, unsigned int serial) {
+    if (q->len == q->cap) {
+        RetryTimer *grown = realloc(q->heap, q->cap * 2 * sizeof(RetryTimer));
+        if (!grown) return -1;
+        q->heap = grown;
+        q->cap *= 2;
+    }
+
+    /* Remontée depuis la dernière feuille */
+    size_t i = q->len++;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (q->heap[parent].due_us <= due_us) break;
+        q->heap[i] = q->heap[parent];
+        i = parent;
+    }
+    q->heap[i].due_us = due_us;
+    q->heap[i].id = id;
+    q->heap[i].serial = serial;
+    return 0;
+}
+
+/*
+ * Fonction retry_pop_due()
+ * ------------------------
+ * Retire l'échéance la plus proche si elle est atteinte.
+ *
+ * Retourne:
+ *   1 si une échéance a été retirée dans out, 0 sinon
+ */
+int retry_pop_due(RetryQueue *q, uint64_t now_us, RetryTimer *out) {
+    if (q->len == 0 || q->heap[0].due_us > now_us) return 0;
+
+    *out = q->heap[0];
+    RetryTimer last = q->heap[--q->len];
+
+    /* Descente de la dernière entrée depuis la racine */
+    size_t i = 0;
+    while (1) {
+        size_t child = 2 * i + 1;
+        if (child >= q->len) break;
+        if (child + 1 < q->len && q->heap[child + 1].due_us < q->heap[child].due_us) child++;
+        if (last.due_us <= q->heap[child].due_us) break;
+        q->heap[i] = q->heap[child];
+        i = child;
+    }
+    if (q->len > 0) q->heap[i] = last;
+    return 1;
+}
+
+/*
+ * Fonction retry_timeout_ms()
+ * ---------------------------
+ * Délai avant la prochaine échéance, pour la boucle d'événements.
+ *
+ * Retourne:
+ *   Délai en millisecondes (arrondi au supérieur), -1 si aucune échéance
+ */
+int retry_timeout_ms(const RetryQueue *q, uint64_t now_us) {
+    if (q->len == 0) return -1;
+    if (q->heap[0].due_us <= now_us) return 0;
+    return (int)((q->heap[0].due_us - now_us + 999) / 1000);
+}
@@ -0,0 +1,61 @@
+/*
+ * ============================================================================
+ * RETRY - Échéancier des retransmissions de commandes (maître)
+ * ============================================================================
+ *
+ * Description:
+ *   Les commandes envoyées aux esclaves par UDP peuvent être perdues
+ *   (datagramme perdu, tampon de réception de l'esclave plein). Chaque
+ *   commande en cours possède une échéance: si l'esclave ne l'a pas
+ *   acquittée (MSG_ACK) ou n'a pas renvoyé son résultat à temps, le maître
+ *   la retransmet.
+ *
+ *   Implémentation: tas binaire (min-heap) ordonné par échéance. Une
+ *   échéance n'est jamais retirée du tas: lorsqu'elle est replanifiée, le
+ *   numéro de série de la commande change et l'ancienne entrée est
+ *   simplement ignorée lorsqu'elle arrive en tête (suppression paresseuse).
+ *
+ * ============================================================================
+ */
+
+#ifndef RETRY_H
+#define RETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Structure RetryTimer
+ * --------------------
+ * Champs:
+ *   - due_us: Échéance (horloge monotone, microsecondes)
+ *   - id: Identifiant de la commande
+ *   - serial: Numéro de série de la planification (voir InflightCmd)
+ */
+typedef struct {
+    uint64_t due_us;
+    unsigned int id;
+    unsigned int serial;
+} RetryTimer;
+
+/*
+ * Structure RetryQueue
+ * --------------------
+ * Champs:
+ *   - heap: Tas binaire des échéances (heap[0] = la plus proche)
+ *   - len / cap: Nombre d'entrées et capacité allouée
+ */
+typedef struct {
+    RetryTimer *heap;
+    size_t len;
+    size_t cap;
+} RetryQueue;
+
+int retry_init(RetryQueue *q, size_t initial_capacity);
+void retry_free(RetryQueue *q);
+
+int retry_push(RetryQueue *q, uint64_t due_us, unsigned int id, unsigned int serial);
+int retry_pop_due(RetryQueue *q, uint64_t now_us, RetryTimer *out);
+int retry_timeout_ms(const RetryQueue *q, uint64_t now_us);
+
+#endif /* RETRY_H */
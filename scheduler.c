@@ -0,0 +1,258 @@
+/*
+ * ============================================================================
+ * SCHEDULER - Choix de l'esclave pour chaque commande
+ * ============================================================================
+ *
+ * Voir scheduler.h pour la description des politiques.
+ *
+ * Les parcours démarrent à l'index s->next, qui avance après chaque choix:
+ * à charge égale, les esclaves sont donc servis à tour de rôle au lieu de
+ * toujours favoriser le premier de la liste.
+ *
+ * ============================================================================
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "scheduler.h"
+
+/* ============================================================================
+ * POLITIQUES DE SÉLECTION
+ * ============================================================================ */
+
+/*
+ * Fonction pick_round_robin()
+ * ---------------------------
+ * Premier esclave disponible à partir de s->next.
+ */
+static int pick_round_robin(Scheduler *s) {
+    for (int k = 0; k < s->num_slaves; k++) {
+        int i = (s->next + k) % s->num_slaves;
+        if (s->loads[i].available) return i;
+    }
+    return -1;
+}
+
+/*
+ * Fonction pick_least_outstanding()
+ * ---------------------------------
+ * Esclave disponible ayant le moins de commandes en cours par worker.
+ * Comparaison a/ca < b/cb effectuée en produits croisés (entiers).
+ */
+static int pick_least_outstanding(Scheduler *s) {
+    int best = -1;
+    for (int k = 0; k < s->num_slaves; k++) {
+        int i = (s->next + k) % s->num_slaves;
+        if (!s->loads[i].available) continue;
+        if (best < 0
+            || (long)s->loads[i].outstanding * s->loads[best].capacity
+                   < (long)s->loads[best].outstanding * s->loads[i].capacity) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+/*
+ * Fonction pick_weighted_ewma()
+ * -----------------------------
+ * Esclave disponible dont le temps d'achèvement estimé d'une nouvelle
+ * commande, (outstanding + 1) / capacity x latence EWMA, est minimal. Un esclave sans
+ * mesure utilise SCHED_DEFAULT_LATENCY_MS afin d'être essayé rapidement.
+ */
+static int pick_weighted_ewma(Scheduler *s) {
+    int best = -1;
+    double best_cost = 0.0;
+    for (int k = 0; k < s->num_slaves; k++) {
+        int i = (s->next + k) % s->num_slaves;
+        if (!s->loads[i].available) continue;
+
+        double latency = s->loads[i].completed > 0
+                             ? s->loads[i].ewma_latency_ms
+                             : SCHED_DEFAULT_LATENCY_MS;
+        if (latency < SCHED_MIN_LATENCY_MS) latency = SCHED_MIN_LATENCY_MS;
+        double cost = (s->loads[i].outstanding + 1) * latency / s->loads[i].capacity;
+        if (best < 0 || cost < best_cost) {
+            best = i;
+            best_cost = cost;
+        }
+    }
+    return best;
+}
+
+/* Table des politiques, indexée par SchedPolicy */
+static const struct {
+    const char *name;
+    sched_pick_fn pick;
+} policies[] = {
+    { "rr",    pick_round_robin },
+    { "least", pick_least_outstanding },
+    { "ewma",  pick_weighted_ewma },
+};
+
+/* ============================================================================
+ * INTERFACE PUBLIQUE
+ * ============================================================================ */
+
+/*
+ * Fonction sched_init()
+ * ---------------------
+ * Initialise l'ordonnanceur pour num_slaves esclaves, tous disponibles.
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation
+ */
+int sched_init(Scheduler *s, SchedPolicy policy, int num_slaves) {
+    memset(s, 0, sizeof(*s));
+    s->loads = calloc(num_slaves > 0 ? (size_t)num_slaves : 1, sizeof(SlaveLoad));
+    if (!s->loads) return -1;
+
+    s->policy = policy;
+    s->pick = policies[policy].pick;
+    s->num_slaves = num_slaves;
+    s->loads_cap = num_slaves > 0 ? num_slaves : 1;
+    for (int i = 0; i < num_slaves; i++) {
+        s->loads[i].available = 1;
+        s->loads[i].capacity = 1;
+    }
+    return 0;
+}
+
+void sched_free(Scheduler *s) {
+    free(s->loads);
+    s->loads = NULL;
+    s->num_slaves = 0;
+    s->loads_cap = 0;
+}
+
+/*
+ * Fonction sched_add_slave()
+ * --------------------------
+ * Ajoute un esclave, disponible, à la fin de la table (agrandie par
+ * doublement si nécessaire).
+ *
+ * Retourne:
+ *   Index du nouvel esclave, ou -1 en cas d'erreur d'allocation
+ */
+int sched_add_slave(Scheduler *s) {
+    if (s->num_slaves == s->loads_cap) {
+        int cap = s->loads_cap > 0 ? s->loads_cap * 2 : 16;
+        SlaveLoad *loads = realloc(s->loads, (size_t)cap * sizeof(SlaveLoad));
+        if (!loads) return -1;
+        s->loads = loads;
+        s->loads_cap = cap;
+    }
+
+    int idx = s->num_slaves++;
+    memset(&s->loads[idx], 0, sizeof(SlaveLoad));
+    s->loads[idx].available = 1;
+    s->loads[idx].capacity = 1;
+    return idx;
+}
+
+/*
+ * Fonction sched_parse_policy()
+ * -----------------------------
+ * Convertit un nom de politique ("rr", "least", "ewma").
+ *
+ * Retourne:
+ *   0 si le nom est reconnu, -1 sinon
+ */
+int sched_parse_policy(const char *name, SchedPolicy *policy) {
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); i++) {
+        if (strcmp(name, policies[i].name) == 0) {
+            *policy = (SchedPolicy)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *sched_policy_name(SchedPolicy policy) {
+    return policies[policy].name;
+}
+
+/*
+ * Fonction sched_pick()
+ * ---------------------
+ * Choisit l'esclave de la prochaine commande selon la politique active.
+ *
+ * Retourne:
+ *   Index de l'esclave, ou -1 si aucun esclave n'est disponible
+ */
+int sched_pick(Scheduler *s) {
+    if (s->num_slaves == 0) return -1;
+
+    int idx = s->pick(s);
+    if (idx >= 0) {
+        s->next = (idx + 1) % s->num_slaves;
+    }
+    return idx;
+}
+
+/*
+ * Fonction sched_on_dispatch()
+ * ----------------------------
+ * Enregistre l'envoi d'une commande à un esclave.
+ */
+void sched_on_dispatch(Scheduler *s, int slave_idx) {
+    s->loads[slave_idx].outstanding++;
+    s->loads[slave_idx].dispatched++;
+}
+
+/*
+ * Fonction sched_on_result()
+ * --------------------------
+ * Enregistre le résultat d'une commande et met à jour la latence lissée:
+ *   ewma = alpha x mesure + (1 - alpha) x ewma
+ *
+ * Paramètres:
+ *   slave_idx - Esclave ayant répondu
+ *   latency_ms - Délai entre l'envoi et la réception du résultat
+ */
+void sched_on_result(Scheduler *s, int slave_idx, double latency_ms) {
+    SlaveLoad *load = &s->loads[slave_idx];
+
+    if (load->outstanding > 0) load->outstanding--;
+    load->completed++;
+
+    if (load->completed == 1) {
+        load->ewma_latency_ms = latency_ms;  /* Première mesure */
+    } else {
+        load->ewma_latency_ms = SCHED_EWMA_ALPHA * latency_ms
+                                + (1.0 - SCHED_EWMA_ALPHA) * load->ewma_latency_ms;
+    }
+}
+
+/*
+ * Fonction sched_on_lost()
+ * ------------------------
+ * Une commande envoyée à l'esclave a été abandonnée sans résultat
+ * (esclave injoignable): elle ne compte plus parmi les commandes en cours,
+ * sans fausser la latence mesurée.
+ */
+void sched_on_lost(Scheduler *s, int slave_idx) {
+    if (s->loads[slave_idx].outstanding > 0) s->loads[slave_idx].outstanding--;
+}
+
+/*
+ * Fonction sched_on_capacity()
+ * ----------------------------
+ * Enregistre la capacité annoncée par un esclave (nombre de workers et
+ * workers libres). Une valeur invalide (<= 0) laisse la capacité inchangée.
+ */
+void sched_on_capacity(Scheduler *s, int slave_idx, int capacity, int free_slots) {
+    if (capacity > 0) s->loads[slave_idx].capacity = capacity;
+    if (free_slots >= 0) s->loads[slave_idx].free_slots = free_slots;
+}
+
+/*
+ * Fonction sched_set_available()
+ * ------------------------------
+ * Écarte (available = 0) ou réintègre un esclave selon son état de santé:
+ * un esclave écarté n'est plus choisi par aucune politique.
+ */
+void sched_set_available(Scheduler *s, int slave_idx, int available) {
+    s->loads[slave_idx].available = available;
+}
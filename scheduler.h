@@ -0,0 +1,126 @@
+/*
+ * ============================================================================
+ * SCHEDULER - Choix de l'esclave pour chaque commande
+ * ============================================================================
+ *
+ * Description:
+ *   Le maître suit, pour chaque esclave, le nombre de commandes envoyées
+ *   sans réponse (CommandResult) et une moyenne mobile exponentielle (EWMA)
+ *   de la latence d'exécution observée. Une politique interchangeable
+ *   utilise ces mesures pour choisir l'esclave de la commande suivante:
+ *
+ *   - rr:    tourniquet (round-robin) sur les esclaves disponibles
+ *   - least: esclave ayant le moins de commandes en cours par worker
+ *   - ewma:  esclave dont le temps d'achèvement estimé
+ *            (commandes en cours + 1) / workers x latence EWMA
+ *            est le plus faible
+ *
+ *   Le nombre de workers de chaque esclave (capacity) est celui annoncé
+ *   dans ses CommandResult et battements de cœur; il vaut 1 tant qu'aucune
+ *   réponse n'est reçue. Un esclave qui ne répond plus aux sondes du
+ *   maître est écarté (available = 0) jusqu'à ce qu'il réponde de nouveau.
+ *
+ *   La table des mesures grandit avec la liste des esclaves
+ *   (sched_add_slave()): un esclave inscrit ou ajouté à slaves.conf en
+ *   cours de fonctionnement reçoit l'index suivant, les index existants
+ *   restent valides. Les mesures sont contiguës: un choix ne parcourt
+ *   qu'un tableau compact, même avec des centaines d'esclaves.
+ *
+ * ============================================================================
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+/* Coefficient de lissage de la moyenne mobile (poids de la dernière mesure) */
+#define SCHED_EWMA_ALPHA 0.2
+
+/* Latence supposée d'un esclave qui n'a encore rien exécuté (ms) */
+#define SCHED_DEFAULT_LATENCY_MS 10.0
+
+/* Plancher de latence: une mesure nulle ne doit pas annuler la charge */
+#define SCHED_MIN_LATENCY_MS 0.01
+
+/*
+ * Énumération SchedPolicy
+ * -----------------------
+ * Politiques de sélection disponibles.
+ */
+typedef enum {
+    SCHED_ROUND_ROBIN = 0,
+    SCHED_LEAST_OUTSTANDING,
+    SCHED_WEIGHTED_EWMA
+} SchedPolicy;
+
+/*
+ * Structure SlaveLoad
+ * -------------------
+ * Mesures de charge d'un esclave, mises à jour à chaque envoi et à chaque
+ * réponse reçue.
+ *
+ * Champs:
+ *   - available: 1 si l'esclave peut recevoir des commandes
+ *   - capacity: Commandes exécutables simultanément (workers annoncés, >= 1)
+ *   - free_slots: Dernière capacité libre annoncée par l'esclave
+ *   - outstanding: Commandes envoyées dont le résultat n'est pas revenu
+ *   - ewma_latency_ms: Latence d'exécution lissée (0 = aucune mesure)
+ *   - dispatched: Nombre total de commandes envoyées
+ *   - completed: Nombre total de résultats reçus
+ */
+typedef struct {
+    int available;
+    int capacity;
+    int free_slots;
+    int outstanding;
+    double ewma_latency_ms;
+    unsigned long dispatched;
+    unsigned long completed;
+} SlaveLoad;
+
+typedef struct Scheduler Scheduler;
+
+/*
+ * Type sched_pick_fn
+ * ------------------
+ * Implémentation d'une politique: retourne l'index de l'esclave choisi
+ * ou -1 si aucun esclave n'est disponible.
+ */
+typedef int (*sched_pick_fn)(Scheduler *s);
+
+/*
+ * Structure Scheduler
+ * -------------------
+ * État de l'ordonnanceur.
+ *
+ * Champs:
+ *   - policy: Politique active
+ *   - pick: Fonction de sélection correspondant à la politique
+ *   - loads: Mesures de charge, une entrée par esclave
+ *   - num_slaves: Nombre d'entrées dans loads
+ *   - loads_cap: Nombre d'entrées allouées
+ *   - next: Point de départ du prochain parcours (tourniquet / départage)
+ */
+struct Scheduler {
+    SchedPolicy policy;
+    sched_pick_fn pick;
+    SlaveLoad *loads;
+    int num_slaves;
+    int loads_cap;
+    int next;
+};
+
+int sched_init(Scheduler *s, SchedPolicy policy, int num_slaves);
+void sched_free(Scheduler *s);
+int sched_add_slave(Scheduler *s);
+
+int sched_parse_policy(const char *name, SchedPolicy *policy);
+const char *sched_policy_name(SchedPolicy policy);
+
+int sched_pick(Scheduler *s);
+void sched_on_dispatch(Scheduler *s, int slave_idx);
+void sched_on_result(Scheduler *s, int slave_idx, double latency_ms);
+void sched_on_lost(Scheduler *s, int slave_idx);
+void sched_on_capacity(Scheduler *s, int slave_idx, int capacity, int free_slots);
+void sched_set_available(Scheduler *s, int slave_idx, int available);
+
+#endif /* SCHEDULER_H */
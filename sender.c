@@ -0,0 +1,204 @@
+/*
+ * ============================================================================
+ * SENDER - Threads d'envoi des commandes vers les esclaves (maître)
+ * ============================================================================
+ *
+ * Voir sender.h pour la description de l'interface.
+ *
+ * ============================================================================
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "sender.h"
+
+/* Attente maximale du socket saturé avant de revérifier la demande d'arrêt */
+#define SENDER_WAIT_MS 100
+
+/*
+ * Fonction wake_sender()
+ * ----------------------
+ * Réveille le thread d'envoi s'il dort. La barrière garantit que le thread
+ * voit la trame publiée, ou que le producteur le voit endormi.
+ */
+static void wake_sender(SlaveSender *s) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(&s->sleeping)) {
+        pthread_mutex_lock(&s->lock);
+        pthread_cond_signal(&s->wake);
+        pthread_mutex_unlock(&s->lock);
+    }
+}
+
+/*
+ * Fonction sleep_sender()
+ * -----------------------
+ * Endort le thread d'envoi jusqu'à la publication d'une trame, ou au plus
+ * jusqu'à deadline_us (0 = sans limite).
+ */
+static void sleep_sender(SlaveSender *s, uint64_t deadline_us) {
+    pthread_mutex_lock(&s->lock);
+    atomic_store(&s->sleeping, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if (spsc_empty(&s->ring) && !atomic_load(&s->stop)) {
+        if (deadline_us == 0) {
+            pthread_cond_wait(&s->wake, &s->lock);
+        } else {
+            uint64_t now = monotonic_us();
+            uint64_t wait_us = deadline_us > now ? deadline_us - now : 0;
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_sec += (time_t)(wait_us / 1000000u);
+            ts.tv_nsec += (long)(wait_us % 1000000u) * 1000;
+            if (ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&s->wake, &s->lock, &ts);
+        }
+    }
+
+    atomic_store(&s->sleeping, 0);
+    pthread_mutex_unlock(&s->lock);
+}
+
+/*
+ * Fonction sender_main()
+ * ----------------------
+ * Boucle du thread d'envoi d'un esclave:
+ *   1. Transfère les trames de la file SPSC vers le lot de datagrammes
+ *   2. Envoie le lot s'il est dû (délai écoulé ou envoi demandé)
+ *   3. S'endort jusqu'à la prochaine trame ou échéance du lot
+ * Si le tampon d'émission est plein, le thread attend que le socket
+ * redevienne inscriptible: la file se remplit alors et la boucle
+ * d'événements ralentit d'elle-même (sender_reserve() échoue).
+ */
+static void *sender_main(void *arg) {
+    SlaveSender *s = (SlaveSender *)arg;
+    int flush_requested = 0;
+
+    while (!atomic_load(&s->stop)) {
+        const uint8_t *frame;
+        size_t len;
+
+        while ((frame = spsc_peek(&s->ring, &len)) != NULL) {
+            if (len == 0) {
+                flush_requested = 1;  /* Demande d'envoi immédiat */
+            } else if (batch_add(&s->batch, &s->addr, sizeof(s->addr), frame, len) < 0) {
+                net_wait_writable(s->batch.sock, SENDER_WAIT_MS);
+                break;  /* Lot plein et socket saturé: trame reprise au prochain tour */
+            }
+            spsc_release(&s->ring);
+        }
+
+        if (s->batch.count > 0 && (flush_requested || batch_due(&s->batch, monotonic_us()))) {
+            if (batch_flush(&s->batch) > 0) {
+                net_wait_writable(s->batch.sock, SENDER_WAIT_MS);
+                continue;
+            }
+        }
+        if (s->batch.count == 0) flush_requested = 0;
+
+        sleep_sender(s, s->batch.count > 0 ? s->batch.first_us + s->batch.flush_us : 0);
+    }
+    return NULL;
+}
+
+/*
+ * Fonction sender_start()
+ * -----------------------
+ * Initialise la file et le lot d'un esclave et démarre son thread d'envoi.
+ *
+ * Paramètres:
+ *   s - Émetteur à initialiser
+ *   sock - Socket UDP de l'esclave
+ *   addr - Adresse de l'esclave
+ *   mtu / flush_us / max_datagrams - Réglages du lot (voir batch_init())
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur
+ */
+int sender_start(SlaveSender *s, SOCKET sock, const struct sockaddr_in *addr,
+                 size_t mtu, uint64_t flush_us, int max_datagrams) {
+    if (spsc_init(&s->ring, SENDER_RING_SIZE) < 0) return -1;
+
+    batch_init(&s->batch, sock, mtu, flush_us, max_datagrams);
+    s->addr = *addr;
+    s->dirty = 0;
+    atomic_init(&s->sleeping, 0);
+    atomic_init(&s->stop, 0);
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->wake, NULL);
+
+    if (pthread_create(&s->thread, NULL, sender_main, s) != 0) {
+        fprintf(stderr, "pthread_create failed for sender thread\n");
+        pthread_mutex_destroy(&s->lock);
+        pthread_cond_destroy(&s->wake);
+        batch_free(&s->batch);
+        spsc_free(&s->ring);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Fonction sender_stop()
+ * ----------------------
+ * Arrête le thread d'envoi et libère ses ressources. Les trames encore
+ * dans la file sont abandonnées.
+ */
+void sender_stop(SlaveSender *s) {
+    atomic_store(&s->stop, 1);
+    pthread_mutex_lock(&s->lock);
+    pthread_cond_signal(&s->wake);
+    pthread_mutex_unlock(&s->lock);
+    pthread_join(s->thread, NULL);
+
+    pthread_mutex_destroy(&s->lock);
+    pthread_cond_destroy(&s->wake);
+    batch_free(&s->batch);
+    spsc_free(&s->ring);
+}
+
+/*
+ * Fonction sender_reserve()
+ * -------------------------
+ * Réserve la place d'une trame de len octets dans la file de l'esclave.
+ * La trame y est encodée directement, puis publiée par sender_commit().
+ *
+ * Retourne:
+ *   Adresse où écrire la trame, ou NULL si la file est pleine (l'esclave
+ *   n'absorbe pas le débit: réessayer plus tard)
+ */
+uint8_t *sender_reserve(SlaveSender *s, size_t len) {
+    return spsc_reserve(&s->ring, len);
+}
+
+/*
+ * Fonction sender_commit()
+ * ------------------------
+ * Publie la trame réservée et réveille le thread d'envoi si nécessaire.
+ */
+void sender_commit(SlaveSender *s) {
+    spsc_commit(&s->ring);
+    s->dirty = 1;
+    wake_sender(s);
+}
+
+/*
+ * Fonction sender_flush()
+ * -----------------------
+ * Demande l'envoi immédiat des trames publiées, sans attendre l'échéance
+ * du lot (le maître n'a plus rien à distribuer pour l'instant). Sans
+ * effet si aucune trame n'a été publiée depuis la dernière demande.
+ */
+void sender_flush(SlaveSender *s) {
+    if (!s->dirty) return;
+    if (!spsc_reserve(&s->ring, 0)) return;  /* File pleine: le lot partira de lui-même */
+    s->dirty = 0;
+    spsc_commit(&s->ring);
+    wake_sender(s);
+}
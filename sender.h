@@ -0,0 +1,76 @@
+/*
+ * ============================================================================
+ * SENDER - Threads d'envoi des commandes vers les esclaves (maître)
+ * ============================================================================
+ *
+ * Description:
+ *   Dernier étage du pipeline de distribution du maître. La boucle
+ *   d'événements découpe les lignes reçues, choisit l'esclave et encode la
+ *   trame MSG_COMMAND directement dans la file SPSC (spsc.h) de cet
+ *   esclave. Un thread par esclave vide sa file: il regroupe les trames
+ *   en datagrammes (batch.h) et les envoie, en attendant lui-même que le
+ *   tampon d'émission se libère. La boucle d'événements ne fait donc plus
+ *   aucun appel système d'envoi vers les esclaves.
+ *
+ *     boucle d'événements --(SPSC)--> thread d'envoi esclave 1 --> UDP
+ *                         --(SPSC)--> thread d'envoi esclave 2 --> UDP
+ *                         ...
+ *
+ *   Un lot part lorsqu'il est plein, lorsque sa plus ancienne trame a
+ *   attendu flush_us, ou sur demande (sender_flush()): la demande est un
+ *   enregistrement vide placé dans la file, donc traité après les trames
+ *   qui le précèdent.
+ *
+ *   Le thread dort lorsque sa file est vide; le producteur ne le réveille
+ *   (variable de condition) que s'il est effectivement endormi.
+ *
+ * ============================================================================
+ */
+
+#ifndef SENDER_H
+#define SENDER_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "net_compat.h"
+#include "spsc.h"
+#include "batch.h"
+
+/* Taille par défaut de la file d'un esclave (octets de trames encodées) */
+#define SENDER_RING_SIZE (256 * 1024)
+
+/*
+ * Structure SlaveSender
+ * ---------------------
+ * Champs:
+ *   - ring: Trames à envoyer (producteur: boucle d'événements)
+ *   - batch: Datagrammes en cours de constitution (thread d'envoi)
+ *   - addr: Adresse de l'esclave
+ *   - thread: Thread d'envoi
+ *   - lock / wake / sleeping: Endormissement du thread lorsque la file est vide
+ *   - stop: Demande d'arrêt du thread
+ *   - dirty: Producteur: trames publiées depuis la dernière demande d'envoi
+ */
+typedef struct {
+    SpscRing ring;
+    SendBatch batch;
+    struct sockaddr_in addr;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    atomic_int sleeping;
+    atomic_int stop;
+    int dirty;
+} SlaveSender;
+
+int sender_start(SlaveSender *s, SOCKET sock, const struct sockaddr_in *addr,
+                 size_t mtu, uint64_t flush_us, int max_datagrams);
+void sender_stop(SlaveSender *s);
+
+/* Producteur (boucle d'événements) */
+uint8_t *sender_reserve(SlaveSender *s, size_t len);
+void sender_commit(SlaveSender *s);
+void sender_flush(SlaveSender *s);
+
+#endif /* SENDER_H */
@@ -13,19 +13,70 @@
  *
  * Fonctionnement:
  *   1. Le serveur démarre et écoute sur un port UDP spécifié
- *   2. Il attend les requêtes de commande (CommandRequest) du maître
- *   3. Pour chaque commande reçue:
- *      a. Il exécute la commande avec system()
- *      b. Il capture le code de retour
- *      c. Il renvoie le résultat (CommandResult) au maître
- *   4. Il retourne à l'écoute pour la prochaine commande
+ *   2. Une boucle d'événements (reactor.c) surveille le socket UDP et la
+ *      fin des processus fils (SIGCHLD)
+ *   3. Pour chaque commande reçue (trame MSG_COMMAND):
+ *      a. Elle est confiée à l'exécuteur (executor.c), qui la lance dans un
+ *         processus fils si l'un des N workers est libre, ou la met en
+ *         file d'attente sinon: directement si c'est une commande simple
+ *         (sans syntaxe du shell), par "/bin/sh -c" sinon; echo, sleep,
+ *         touch, cp, cksum... sont exécutées par un thread de l'esclave,
+ *         sans processus (builtin.c)
+ *      b. Le socket continue d'être lu pendant l'exécution
+ *   4. La sortie standard et la sortie d'erreur du fils sont capturées par
+ *      des tubes et envoyées au maître au fil de l'eau (MSG_OUTPUT, voir
+ *      output.c), avec une fenêtre d'émission bornée par commande
+ *   5. À la fin d'un fils, une fois sa sortie entièrement acquittée, le
+ *      code de sortie est renvoyé au maître dans une trame MSG_RESULT,
+ *      avec la capacité libre de l'esclave
  *
- * Usage: serveur_esclave.exe <port>
- *   Exemple: serveur_esclave.exe 10001
+ *   L'esclave répond à chaque sonde MSG_PING du maître par un battement de
+ *   cœur MSG_HEARTBEAT (capacité, commandes en cours et en attente,
+ *   charge de la machine): sans réponse, le maître cesse de lui confier
+ *   des commandes, et le réintègre dès que les réponses reprennent.
  *
- * Protocole:
- *   - Entrée: CommandRequest via UDP (commande + info client)
- *   - Sortie: CommandResult via UDP (commande + code retour + message)
+ *   Chaque commande reçue est acquittée (MSG_ACK). Le maître retransmet
+ *   les commandes sans acquittement ou sans résultat; la fenêtre de
+ *   déduplication (dedup.c) garantit qu'une commande retransmise n'est
+ *   exécutée qu'une fois.
+ *
+ * Usage: serveur_esclave.exe [--workers N] [--mtu N] [--master hôte[:port]]
+ *                            [--metrics-port N] [--log-level L] [--log-format F]
+ *                            [--shell] [--no-builtins] <port>
+ *   Exemple: serveur_esclave.exe --workers 4 10001
+ *   Par défaut, N = nombre de cœurs de la machine.
+ *   --shell fait passer toutes les commandes par /bin/sh, y compris les
+ *   commandes simples (comparaison, ou PATH modifié en cours de route);
+ *   --no-builtins lance de vrais processus pour les commandes internes.
+ *
+ *   Avec --master, l'esclave s'inscrit de lui-même auprès du maître
+ *   (MSG_REGISTER sur son port d'inscription, 9999 par défaut) tant que
+ *   celui-ci ne le sonde pas: il n'a pas besoin de figurer dans
+ *   slaves.conf.
+ *
+ *   Les datagrammes sont lus et envoyés par paquets (recvmmsg/sendmmsg sous
+ *   Linux, batch.c); les résultats d'un même tour de boucle sont regroupés
+ *   dans des datagrammes d'au plus --mtu octets (défaut 1472).
+ *
+ *   Avec --metrics-port, GET /metrics sur ce port TCP retourne les
+ *   compteurs de l'esclave au format texte de Prometheus (commandes
+ *   reçues, doublons, refus, retransmissions de sortie, erreurs d'envoi,
+ *   histogrammes d'attente et de durée d'exécution).
+ *
+ *   Les messages sont écrits par un thread dédié (logger.c): la boucle
+ *   d'événements ne se bloque jamais sur la console. Ceux émis pour chaque
+ *   commande sont de niveau debug (--log-level debug, ou SIGUSR1 en cours
+ *   d'exécution); --log-format json écrit un objet JSON par ligne.
+ *
+ * Protocole (protocol.h):
+ *   - Entrée: MSG_COMMAND via UDP (identifiant + info client + commande),
+ *             MSG_OUTPUT_ACK via UDP (morceaux de sortie reçus),
+ *             MSG_PING via UDP (sonde de santé)
+ *   - Sortie: MSG_REGISTER via UDP (port) vers le maître, avec --master,
+ *             MSG_ACK via UDP (identifiant) à la réception,
+ *             MSG_HEARTBEAT via UDP (capacité + charge) en réponse à MSG_PING,
+ *             MSG_OUTPUT via UDP (morceau de stdout / stderr),
+ *             MSG_RESULT via UDP (identifiant + code retour + durée + capacité)
  *
  * ============================================================================
  */
@@ -35,60 +86,79 @@
 #include <stdlib.h>     /* Pour exit(), atoi(), system() et autres fonctions utilitaires */
 #include <string.h>     /* Pour les fonctions de manipulation de chaînes (strcpy, sprintf, etc.) */
 
-/* Inclusion des bibliothèques Windows Socket (Winsock2) */
-#include <winsock2.h>   /* API principale Windows Socket version 2 */
-#include <ws2tcpip.h>   /* Fonctions supplémentaires TCP/IP */
-#include <process.h>    /* Pour getpid() - obtenir l'ID du processus */
-
-/* Directives pour lier automatiquement les bibliothèques nécessaires */
-#pragma comment(lib, "ws2_32.lib")   /* Bibliothèque Winsock */
-#pragma comment(lib, "winmm.lib")    /* Bibliothèque multimédia Windows */
+/* Couche réseau portable (Winsock2 sous Windows, sockets POSIX ailleurs) */
+#include "net_compat.h"
+#include "reactor.h"    /* Boucle d'événements epoll/select */
+#include "executor.h"   /* Pool de processus d'exécution */
+#include "protocol.h"   /* Format binaire des messages */
+#include "batch.h"      /* Regroupement des trames, sendmmsg/recvmmsg */
+#include "dedup.h"      /* Fenêtre de déduplication des retransmissions */
+#include "output.h"     /* Envoi fenêtré de la sortie des commandes */
+#include "metrics.h"    /* Compteurs, histogrammes et page /metrics */
+#include "logger.h"     /* Journalisation asynchrone */
 
 /* ============================================================================
  * CONSTANTES DE CONFIGURATION
  * ============================================================================ */
 
-#define MAX_CMD_LEN 1024     /* Longueur maximale d'une commande shell */
-#define MAX_RESULT_LEN 2048  /* Longueur maximale d'un résultat (non utilisé actuellement) */
+#define MAX_RESULT_LEN 256   /* Longueur maximale d'un message de résultat */
+#define MIN_OUTPUT_FRAME 512 /* Taille minimale d'une trame MSG_OUTPUT (petits --mtu) */
+#define REGISTER_PORT 9999   /* Port UDP d'inscription du maître par défaut */
+#define REGISTER_INTERVAL_MS 2000 /* Période des inscriptions tant que le maître ne sonde pas */
 
 /* ============================================================================
  * STRUCTURES DE DONNÉES
  * ============================================================================ */
 
 /*
- * Structure CommandRequest
- * ------------------------
- * Représente une requête de commande envoyée par le serveur maître.
- * Cette structure est reçue via UDP et contient toutes les informations
- * nécessaires pour exécuter et tracer une commande.
+ * Structure SlaveStats
+ * --------------------
+ * Compteurs et histogrammes exposés par la page /metrics (--metrics-port),
+ * modifiés par la boucle d'événements seule (incréments ordinaires).
  *
  * Champs:
- *   - command: La commande shell à exécuter
- *   - client_addr: Adresse IP du client original (pour traçabilité)
- *   - client_port: Port du client original (pour traçabilité)
+ *   - received: Commandes reçues (retransmissions exclues)
+ *   - duplicates: Retransmissions reçues d'une commande déjà connue
+ *   - rejected: Commandes refusées, file d'attente pleine
+ *   - results: Résultats produits
+ *   - failed: Résultats dont le code de retour est non nul
+ *   - output_bytes: Octets de sortie lus et envoyés au maître
+ *   - output_resends: Morceaux de sortie retransmis
+ *   - heartbeats: Battements de cœur envoyés (réponses aux sondes)
+ *   - queue_wait: Attente d'un worker libre
+ *   - exec: Durée d'exécution des commandes
  */
 typedef struct {
-    char command[MAX_CMD_LEN];   /* Commande shell à exécuter */
-    char client_addr[50];        /* Adresse IP du client (ex: "127.0.0.1") */
-    int client_port;             /* Port du client */
-} CommandRequest;
+    uint64_t received;
+    uint64_t duplicates;
+    uint64_t rejected;
+    uint64_t results;
+    uint64_t failed;
+    uint64_t output_bytes;
+    uint64_t output_resends;
+    uint64_t heartbeats;
+    MetricsHistogram queue_wait;
+    MetricsHistogram exec;
+} SlaveStats;
 
-/*
- * Structure CommandResult
- * -----------------------
- * Représente le résultat d'une commande exécutée.
- * Cette structure est renvoyée au serveur maître via UDP.
- *
- * Champs:
- *   - command: La commande qui a été exécutée (pour correspondance)
- *   - return_code: Code de retour de system() (0 = succès)
- *   - result: Message textuel décrivant le résultat
- */
-typedef struct {
-    char command[MAX_CMD_LEN];   /* Commande exécutée */
-    int return_code;             /* Code de retour (0 = succès, autre = erreur) */
-    char result[256];            /* Message de résultat */
-} CommandResult;
+/* ============================================================================
+ * VARIABLES GLOBALES
+ * ============================================================================ */
+
+SOCKET slave_sock = INVALID_SOCKET;  /* Socket UDP du serveur */
+Executor executor;                   /* Pool de processus d'exécution */
+SendBatch result_batch;              /* Résultats en attente d'envoi au maître */
+int want_write = 0;                  /* Lot bloqué par un tampon d'émission plein */
+DedupTable dedup;                    /* Commandes en cours et résultats récents */
+OutputStream *output_streams = NULL; /* Sorties en cours d'envoi au maître */
+size_t output_frame_cap;             /* Taille d'une trame MSG_OUTPUT */
+int register_enabled = 0;            /* Inscription auprès du maître (--master) */
+struct sockaddr_in register_addr;    /* Adresse d'inscription du maître */
+int listen_port = 0;                 /* Port annoncé dans MSG_REGISTER */
+uint64_t last_ping_us = 0;           /* Dernière sonde MSG_PING reçue (0 = jamais) */
+uint64_t next_register_us = 0;       /* Prochaine vérification de l'inscription */
+SlaveStats stats;                    /* Mesures exposées par /metrics */
+MetricsServer metrics_server;        /* Page /metrics (--metrics-port) */
 
 /* ============================================================================
  * FONCTIONS UTILITAIRES
@@ -111,6 +181,542 @@ void signal_handler(int sig) {
     exit(0);
 }
 
+#ifndef _WIN32
+/* Gestionnaire de SIGUSR1: active ou désactive les messages par commande */
+void on_sigusr1(int sig) {
+    (void)sig;
+    logger_toggle_debug();
+}
+#endif
+
+/*
+ * Fonction deliver_result()
+ * -------------------------
+ * Mémorise et envoie la trame MSG_RESULT d'une commande.
+ *
+ * Paramètres:
+ *   id - Identifiant de la commande
+ *   reply_addr / reply_len - Adresse du maître
+ *   frame / frame_len - Trame de résultat encodée
+ */
+void deliver_result(unsigned int id, const struct sockaddr_in *reply_addr, socklen_t reply_len,
+                    const uint8_t *frame, size_t frame_len) {
+    /* Mémorisation pour répondre à une retransmission sans réexécuter */
+    if (dedup_complete(&dedup, id, frame, frame_len) < 0) {
+        fprintf(stderr, "Cannot remember result %u\n", id);
+    }
+
+    /*
+     * Envoi du résultat au serveur maître
+     * -----------------------------------
+     * Le résultat est ajouté au lot destiné à l'adresse du maître
+     * (mémorisée lors de la réception de la requête). Les résultats
+     * produits pendant un même tour de boucle partent ensemble, en un
+     * seul appel sendmmsg(), à la fin de ce tour.
+     */
+    if (batch_add(&result_batch, reply_addr, reply_len, frame, frame_len) < 0) {
+        fprintf(stderr, "Cannot queue result %u\n", id);
+    }
+}
+
+/*
+ * Fonction close_output()
+ * -----------------------
+ * Retire un flux de sortie de la liste et le libère.
+ */
+void close_output(OutputStream *out) {
+    OutputStream **link = &output_streams;
+    while (*link && *link != out) link = &(*link)->next_stream;
+    if (*link) *link = out->next_stream;
+    if (out->job) out->job->user = NULL;
+    output_destroy(out);
+}
+
+/*
+ * Fonction send_result()
+ * ----------------------
+ * Construit et envoie la trame MSG_RESULT d'une commande au maître.
+ *
+ * Paramètres:
+ *   job - Commande concernée (identifiant, texte, adresse de réponse)
+ *   ret - Code de sortie (-1 = impossible d'exécuter la commande)
+ *   message - Message imposé, ou NULL pour le message standard
+ */
+void send_result(const ExecJob *job, int ret, const char *message) {
+    ProtoResult result;
+    char text[MAX_RESULT_LEN];
+
+    /*
+     * Préparation du résultat
+     * -----------------------
+     * La trame contient:
+     * - Le code de retour et la durée d'exécution
+     * - La capacité libre de l'esclave, utilisée par l'ordonnanceur du maître
+     * - Un message uniquement s'il est imposé: le message standard se déduit
+     *   du code de retour et n'est qu'affiché localement
+     */
+    memset(&result, 0, sizeof(result));
+    result.return_code = ret;
+    result.capacity = (uint16_t)executor.workers;
+    result.free_slots = (uint16_t)executor_free_slots(&executor);
+    if (job->start_us) {
+        result.duration_us = monotonic_us() - job->start_us;
+        metrics_record(&stats.exec, result.duration_us);
+        metrics_record(&stats.queue_wait, job->start_us - job->submit_us);
+    }
+    stats.results++;
+    if (ret != 0) stats.failed++;
+
+    /* Génération du message de résultat selon le code de retour */
+    if (message) {
+        snprintf(text, sizeof(text), "%s", message);
+        result.message = text;
+        result.message_len = strlen(text);
+    } else if (ret < 0) {
+        /* Erreur système - impossible d'exécuter la commande */
+        strcpy(text, "Erreur: impossible d'exécuter la commande");
+    } else if (ret > 0) {
+        /* La commande a retourné une erreur */
+        sprintf(text, "Erreur d'exécution (code: %d)", ret);
+    } else {
+        /* Succès - code de retour 0 */
+        strcpy(text, "Commande exécutée avec succès");
+    }
+
+    /* Affichage du résultat dans la console du serveur */
+    log_debug("Résultat: %s (code=%d)", text, ret);
+
+    uint8_t frame[PROTO_HEADER_SIZE + 16 + MAX_RESULT_LEN];
+    size_t frame_len = proto_encode_result(frame, sizeof(frame), job->id, &result);
+
+    /*
+     * Sortie pas encore entièrement acquittée: le résultat attend dans le
+     * flux, afin que le client reçoive toute la sortie avant le résultat
+     */
+    OutputStream *out = (OutputStream *)job->user;
+    if (out && output_pending(out) > 0 && output_hold_result(out, frame, frame_len) == 0) {
+        out->job = NULL;
+        return;
+    }
+    deliver_result(job->id, &job->reply_addr, job->reply_len, frame, frame_len);
+    if (out) close_output(out);
+}
+
+/*
+ * Fonction on_command_done()
+ * --------------------------
+ * Rappel de l'exécuteur: une commande est terminée et toute sa sortie a
+ * été lue.
+ */
+void on_command_done(ExecJob *job, int return_code, void *ctx) {
+    OutputStream *out = (OutputStream *)job->user;
+    (void)ctx;
+    send_result(job, return_code,
+                out && out->abandoned ? "Erreur: sortie perdue (maître injoignable)" : NULL);
+}
+
+/*
+ * Fonction on_command_output()
+ * ----------------------------
+ * Rappel de l'exécuteur: la sortie d'une commande est lisible.
+ * Les données sont lues directement dans les trames MSG_OUTPUT de la
+ * fenêtre d'émission, sans tampon intermédiaire, tant que la fenêtre
+ * n'est pas pleine. Au-delà, la lecture est suspendue jusqu'aux
+ * prochains acquittements du maître.
+ */
+void on_command_output(ExecJob *job, int stream, void *ctx) {
+    OutputStream *out = (OutputStream *)job->user;
+    (void)ctx;
+
+    uint8_t drain[4096];
+
+    if (!out) {
+        out = output_create(job, output_frame_cap);
+        if (!out) {
+            fprintf(stderr, "Cannot allocate output stream %u\n", job->id);
+            while (executor_read_output(&executor, job, stream, drain, sizeof(drain)) > 0) {
+                /* Sortie ignorée */
+            }
+            return;
+        }
+        out->next_stream = output_streams;
+        output_streams = out;
+        job->user = out;
+    }
+
+    uint8_t *frame;
+    while ((frame = output_slot(out)) != NULL) {
+        ProtoOutput chunk;
+        long n = executor_read_output(&executor, job, stream, frame + PROTO_OUTPUT_OVERHEAD,
+                                      out->frame_cap - PROTO_OUTPUT_OVERHEAD);
+        if (n <= 0) return;  /* Tube vide pour l'instant, ou fin du flux */
+
+        chunk.stream = stream == EXEC_STDERR ? PROTO_STREAM_STDERR : PROTO_STREAM_STDOUT;
+        chunk.seq = out->next;
+        chunk.data = frame + PROTO_OUTPUT_OVERHEAD;
+        chunk.data_len = (size_t)n;
+        size_t frame_len = proto_encode_output(frame, out->frame_cap, job->id, &chunk);
+        output_push(out, frame_len, monotonic_us());
+        stats.output_bytes += (uint64_t)n;
+
+        /* Lot plein: le morceau partira avec la prochaine retransmission */
+        batch_add(&result_batch, &out->reply_addr, out->reply_len, frame, frame_len);
+    }
+
+    if (out->abandoned) {
+        /* Maître injoignable: la sortie est lue et ignorée */
+        while (executor_read_output(&executor, job, stream, drain, sizeof(drain)) > 0) {
+            /* Sortie ignorée */
+        }
+        return;
+    }
+
+    /* Fenêtre pleine: le fils se bloquera sur son tube, mémoire bornée */
+    executor_pause_output(&executor, job, 1);
+    out->paused = 1;
+}
+
+/*
+ * Fonction resend_output()
+ * ------------------------
+ * Go-back-N: renvoie tous les morceaux non acquittés d'une commande (le
+ * maître ignore ceux qui suivent un morceau perdu).
+ */
+void resend_output(const OutputStream *out) {
+    for (uint32_t seq = out->base; seq != out->next; seq++) {
+        size_t len;
+        const uint8_t *frame = output_frame(out, seq, &len);
+        batch_add(&result_batch, &out->reply_addr, out->reply_len, frame, len);
+        stats.output_resends++;
+    }
+}
+
+/*
+ * Fonction handle_output_ack()
+ * ----------------------------
+ * Traite un acquittement MSG_OUTPUT_ACK du maître: la fenêtre avance, la
+ * lecture de la sortie reprend si elle était suspendue, et le résultat
+ * retenu part dès que toute la sortie est acquittée.
+ */
+void handle_output_ack(const ProtoFrame *frame) {
+    uint32_t next;
+    if (proto_decode_output_ack(frame, &next) < 0) return;
+
+    OutputStream *out = output_streams;
+    while (out && out->id != frame->id) out = out->next_stream;
+    if (!out || out->abandoned) return;
+
+    if (output_ack(out, next, monotonic_us()) < 0) resend_output(out);
+
+    if (out->job && out->paused && output_pending(out) < OUTPUT_WINDOW) {
+        executor_pause_output(&executor, out->job, 0);
+        out->paused = 0;
+    }
+    if (!out->job && output_pending(out) == 0) {
+        deliver_result(out->id, &out->reply_addr, out->reply_len, out->result, out->result_len);
+        close_output(out);
+    }
+}
+
+/*
+ * Fonction process_output_timers()
+ * --------------------------------
+ * Retransmet les morceaux de sortie restés sans acquittement, ou abandonne
+ * la sortie d'une commande dont le maître ne répond plus.
+ *
+ * Retourne:
+ *   Délai avant la prochaine échéance en millisecondes, -1 si aucune
+ */
+int process_output_timers(uint64_t now_us) {
+    uint64_t next_deadline = 0;
+    OutputStream *out = output_streams;
+
+    while (out) {
+        OutputStream *following = out->next_stream;
+
+        if (out->deadline_us && now_us >= out->deadline_us) {
+            if (out->misses >= OUTPUT_MAX_MISSES) {
+                fprintf(stderr, "Master unreachable: output of command %u dropped\n", out->id);
+                output_abandon(out);
+                if (out->job) {
+                    if (out->paused) executor_pause_output(&executor, out->job, 0);
+                    out->paused = 0;
+                } else {
+                    deliver_result(out->id, &out->reply_addr, out->reply_len,
+                                   out->result, out->result_len);
+                    close_output(out);
+                    out = following;
+                    continue;
+                }
+            } else {
+                resend_output(out);
+                output_backoff(out, now_us);
+            }
+        }
+        if (out->deadline_us && (!next_deadline || out->deadline_us < next_deadline)) {
+            next_deadline = out->deadline_us;
+        }
+        out = following;
+    }
+
+    if (!next_deadline) return -1;
+    return (int)((next_deadline - now_us + 999) / 1000);
+}
+
+/*
+ * Fonction submit_request()
+ * -------------------------
+ * Acquitte une commande reçue et la confie à l'exécuteur, ou la refuse si
+ * la file d'attente est pleine. Une commande retransmise par le maître
+ * n'est jamais exécutée deux fois:
+ *   - encore en cours: elle est simplement réacquittée
+ *   - terminée: le résultat mémorisé est renvoyé
+ *
+ * Paramètres:
+ *   frame - Trame reçue (identifiant de la commande)
+ *   request - Commande décodée
+ *   reply_addr / reply_len - Adresse du maître, pour la réponse
+ */
+void submit_request(const ProtoFrame *frame, const ProtoCommand *request,
+                    const struct sockaddr_in *reply_addr, socklen_t reply_len) {
+    uint8_t ack[PROTO_HEADER_SIZE];
+    size_t ack_len = proto_encode_text(ack, sizeof(ack), MSG_ACK, frame->id, NULL, 0);
+
+    DedupEntry *known = dedup_find(&dedup, frame->id);
+    if (known) {
+        stats.duplicates++;
+        if (known->done) {
+            log_debug("Commande %u déjà exécutée: résultat renvoyé", frame->id);
+            batch_add(&result_batch, reply_addr, reply_len, known->result, known->result_len);
+        } else {
+            batch_add(&result_batch, reply_addr, reply_len, ack, ack_len);
+        }
+        return;
+    }
+    if (!dedup_insert(&dedup, frame->id)) {
+        fprintf(stderr, "Cannot track command %u: a retransmission would run it again\n", frame->id);
+    }
+    batch_add(&result_batch, reply_addr, reply_len, ack, ack_len);
+    stats.received++;
+
+    struct in_addr origin;
+    origin.s_addr = request->origin_ip;
+
+    /* Affichage de la commande reçue avec les informations du client */
+    log_debug("Reçu commande: %.*s (de %s:%d)",
+              (int)request->command_len, request->command,
+              inet_ntoa(origin), request->origin_port);
+
+    /*
+     * Exécution de la commande
+     * ------------------------
+     * L'exécuteur lance la commande dans un processus fils ou la met en
+     * attente d'un worker libre. Si la file d'attente est pleine, la
+     * commande est refusée immédiatement.
+     *
+     * ATTENTION: l'exécution de commandes non validées via le shell
+     * présente des risques de sécurité (injection de commandes).
+     */
+    if (executor_submit(&executor, frame->id, request->command, request->command_len,
+                        reply_addr, reply_len) < 0) {
+        ExecJob rejected;
+        memset(&rejected, 0, sizeof(rejected));
+        rejected.id = frame->id;
+        rejected.reply_addr = *reply_addr;
+        rejected.reply_len = reply_len;
+        stats.rejected++;
+        send_result(&rejected, -1, "Erreur: file d'attente de l'esclave pleine");
+    }
+}
+
+/*
+ * Fonction send_heartbeat()
+ * -------------------------
+ * Répond à une sonde MSG_PING du maître par l'état de santé de l'esclave:
+ * capacité, commandes en cours et en attente, charge de la machine.
+ */
+void send_heartbeat(const struct sockaddr_in *reply_addr, socklen_t reply_len) {
+    ProtoHeartbeat hb;
+    double load = 0.0;
+
+#ifndef _WIN32
+    if (getloadavg(&load, 1) < 1) load = 0.0;
+#endif
+    hb.capacity = (uint16_t)executor.workers;
+    hb.free_slots = (uint16_t)executor_free_slots(&executor);
+    hb.running = (uint16_t)executor.num_running;
+    hb.queued = (uint32_t)executor.queue_len;
+    hb.load_x100 = load * 100.0 < 65535.0 ? (uint16_t)(load * 100.0) : 65535;
+
+    uint8_t frame[PROTO_HEADER_SIZE + 12];
+    size_t len = proto_encode_heartbeat(frame, sizeof(frame), &hb);
+    batch_add(&result_batch, reply_addr, reply_len, frame, len);
+    stats.heartbeats++;
+}
+
+/*
+ * Fonction process_registration()
+ * -------------------------------
+ * Esclave lancé avec --master: tant que le maître ne le sonde pas (pas
+ * encore inscrit, maître redémarré, ou esclave retiré de sa
+ * configuration), l'esclave s'annonce toutes les REGISTER_INTERVAL_MS par
+ * une trame MSG_REGISTER. Les sondes du maître font taire l'inscription.
+ *
+ * Retourne:
+ *   Délai avant la prochaine vérification en millisecondes, ou -1 si
+ *   l'inscription est désactivée
+ */
+int process_registration(uint64_t now_us) {
+    static int announcing = 0;
+
+    if (!register_enabled) return -1;
+
+    if (now_us >= next_register_us) {
+        if (last_ping_us == 0 || now_us - last_ping_us >= (uint64_t)REGISTER_INTERVAL_MS * 1000) {
+            if (!announcing) {
+                log_info("Inscription auprès du maître %s:%d",
+                         inet_ntoa(register_addr.sin_addr), ntohs(register_addr.sin_port));
+                announcing = 1;
+            }
+            uint8_t frame[PROTO_HEADER_SIZE + 2];
+            size_t len = proto_encode_register(frame, sizeof(frame), (uint16_t)listen_port);
+            batch_add(&result_batch, &register_addr, sizeof(register_addr), frame, len);
+        } else {
+            announcing = 0;
+        }
+        next_register_us = now_us + (uint64_t)REGISTER_INTERVAL_MS * 1000;
+    }
+    return (int)((next_register_us - now_us + 999) / 1000);
+}
+
+/*
+ * Fonction on_request_readable()
+ * ------------------------------
+ * Rappel de la boucle d'événements: des requêtes sont arrivées.
+ * Toutes les requêtes en attente sont lues: les commandes sont confiées à
+ * l'exécuteur, les acquittements de sortie font avancer les fenêtres, les
+ * sondes reçoivent un battement de cœur;
+ * la lecture n'est jamais bloquée par une commande en cours.
+ */
+void on_request_readable(Reactor *reactor, SOCKET sock, int events, void *arg) {
+    static RecvBatch rb;
+    (void)reactor;
+    (void)arg;
+
+    /* Écriture possible: le lot bloqué sera renvoyé en fin de tour */
+    if (!(events & (REACTOR_READ | REACTOR_ERROR))) return;
+
+    while (1) {
+        /*
+         * Réception des commandes du maître
+         * ---------------------------------
+         * batch_recv() lit jusqu'à BATCH_IO_MAX datagrammes par appel
+         * système (recvmmsg sous Linux), sans bloquer.
+         */
+        int n = batch_recv(sock, &rb);
+
+        /* Vérification des erreurs de réception */
+        if (n < 0) {
+            fprintf(stderr, "recvfrom failed: %d\n", WSAGetLastError());
+            return;
+        }
+
+        for (int i = 0; i < n; i++) {
+            /* Un datagramme peut contenir plusieurs trames consécutives */
+            size_t offset = 0;
+            while (offset < rb.lens[i]) {
+                ProtoFrame frame;
+                ProtoCommand request;
+                int consumed = proto_decode(rb.bufs[i] + offset, rb.lens[i] - offset, &frame);
+                if (consumed > 0 && frame.type == MSG_OUTPUT_ACK) {
+                    offset += (size_t)consumed;
+                    handle_output_ack(&frame);
+                    continue;
+                }
+                if (consumed > 0 && frame.type == MSG_PING) {
+                    offset += (size_t)consumed;
+                    last_ping_us = monotonic_us();
+                    send_heartbeat(&rb.addrs[i], rb.addr_lens[i]);
+                    continue;
+                }
+                if (consumed <= 0 || proto_decode_command(&frame, &request) < 0) {
+                    fprintf(stderr, "Invalid frame from %s:%d\n",
+                            inet_ntoa(rb.addrs[i].sin_addr), ntohs(rb.addrs[i].sin_port));
+                    break;  /* Reste du datagramme ignoré */
+                }
+                offset += (size_t)consumed;
+                submit_request(&frame, &request, &rb.addrs[i], rb.addr_lens[i]);
+            }
+        }
+        if (n < BATCH_IO_MAX) return;  /* Toutes les requêtes en attente ont été lues */
+    }
+}
+
+/*
+ * Fonction flush_results()
+ * ------------------------
+ * Envoie les résultats accumulés pendant le tour de boucle. Si le tampon
+ * d'émission est plein, le socket est surveillé en écriture pour
+ * réessayer dès que possible.
+ */
+void flush_results(Reactor *reactor) {
+    int blocked = batch_flush(&result_batch) > 0;
+    if (blocked != want_write) {
+        reactor_modify(reactor, slave_sock, blocked ? REACTOR_READ | REACTOR_WRITE : REACTOR_READ);
+        want_write = blocked;
+    }
+}
+
+/*
+ * Fonction render_metrics()
+ * -------------------------
+ * Rendu de la page /metrics de l'esclave (voir metrics.h), à chaque
+ * requête, sans rien modifier.
+ */
+void render_metrics(MetricsText *out, void *arg) {
+    (void)arg;
+
+    metrics_header(out, "slave_commands_received_total", "counter", "Commands received");
+    metrics_value(out, "slave_commands_received_total", NULL, (double)stats.received);
+    metrics_header(out, "slave_commands_duplicate_total", "counter",
+                   "Retransmitted commands already known");
+    metrics_value(out, "slave_commands_duplicate_total", NULL, (double)stats.duplicates);
+    metrics_header(out, "slave_commands_rejected_total", "counter",
+                   "Commands refused because the queue was full");
+    metrics_value(out, "slave_commands_rejected_total", NULL, (double)stats.rejected);
+    metrics_header(out, "slave_results_total", "counter", "Results produced");
+    metrics_value(out, "slave_results_total", NULL, (double)stats.results);
+    metrics_header(out, "slave_results_failed_total", "counter", "Results with a non-zero code");
+    metrics_value(out, "slave_results_failed_total", NULL, (double)stats.failed);
+    metrics_header(out, "slave_output_bytes_total", "counter", "Command output bytes sent");
+    metrics_value(out, "slave_output_bytes_total", NULL, (double)stats.output_bytes);
+    metrics_header(out, "slave_output_retransmits_total", "counter", "Output chunks retransmitted");
+    metrics_value(out, "slave_output_retransmits_total", NULL, (double)stats.output_resends);
+    metrics_header(out, "slave_heartbeats_total", "counter", "Heartbeats sent");
+    metrics_value(out, "slave_heartbeats_total", NULL, (double)stats.heartbeats);
+    metrics_header(out, "slave_datagrams_sent_total", "counter", "Datagrams sent to the master");
+    metrics_value(out, "slave_datagrams_sent_total", NULL,
+                  (double)atomic_load_explicit(&result_batch.sent_datagrams, memory_order_relaxed));
+    metrics_header(out, "slave_send_errors_total", "counter", "Datagrams dropped on send errors");
+    metrics_value(out, "slave_send_errors_total", NULL,
+                  (double)atomic_load_explicit(&result_batch.send_errors, memory_order_relaxed));
+
+    metrics_header(out, "slave_workers", "gauge", "Commands run at the same time");
+    metrics_value(out, "slave_workers", NULL, (double)executor.workers);
+    metrics_header(out, "slave_commands_running", "gauge", "Commands running");
+    metrics_value(out, "slave_commands_running", NULL, (double)executor.num_running);
+    metrics_header(out, "slave_commands_queued", "gauge", "Commands waiting for a worker");
+    metrics_value(out, "slave_commands_queued", NULL, (double)executor.queue_len);
+    metrics_header(out, "slave_spawns_total", "counter", "Commands started, directly, through /bin/sh or as a builtin");
+    metrics_value(out, "slave_spawns_total", "mode=\"direct\"", (double)executor.direct_spawns);
+    metrics_value(out, "slave_spawns_total", "mode=\"shell\"", (double)executor.shell_spawns);
+    metrics_value(out, "slave_spawns_total", "mode=\"builtin\"", (double)executor.builtin_runs);
+
+    metrics_histogram(out, "slave_queue_wait_seconds", "Time waiting for a free worker",
+                      &stats.queue_wait);
+    metrics_histogram(out, "slave_command_exec_seconds", "Command execution time", &stats.exec);
+}
+
 /* ============================================================================
  * FONCTION PRINCIPALE
  * ============================================================================ */
@@ -119,12 +725,14 @@ void signal_handler(int sig) {
  * Fonction main()
  * ---------------
  * Point d'entrée du serveur esclave.
- * Configure le socket UDP, puis entre dans une boucle infinie
- * d'attente et d'exécution de commandes.
+ * Configure le socket UDP et le pool de workers, puis entre dans la
+ * boucle d'événements.
  *
  * Paramètres:
- *   argc - Nombre d'arguments (doit être 2)
- *   argv - argv[1] = port d'écoute UDP
+ *   argc - Nombre d'arguments
+ *   argv - [--workers N] [--mtu N] [--master hôte[:port]] [--metrics-port N]
+ *          [--log-level L] [--log-format text|json] [--shell] [--no-builtins]
+ *          <port d'écoute UDP>
  *
  * Retourne:
  *   0 en cas de succès (jamais atteint en fonctionnement normal)
@@ -135,24 +743,84 @@ int main(int argc, char *argv[]) {
     /*
      * ÉTAPE 1: Vérification des arguments
      * ------------------------------------
-     * Le programme nécessite exactement un argument: le numéro de port
-     * sur lequel le serveur esclave doit écouter.
+     * Le programme nécessite un argument: le numéro de port sur lequel
+     * le serveur esclave doit écouter. L'option --workers fixe le nombre
+     * de commandes exécutées simultanément, --mtu la taille maximale d'un
+     * datagramme regroupant plusieurs résultats; --master active
+     * l'inscription auprès du maître (port d'inscription 9999 par défaut);
+     * --metrics-port ouvre la page HTTP /metrics (0 = fermée, par défaut);
+     * --log-level (error, warn, info, debug) et --log-format (text, json)
+     * règlent la journalisation; debug affiche chaque commande. --shell
+     * désactive le lancement direct des commandes simples et les commandes
+     * internes, --no-builtins seulement ces dernières.
      */
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s <port>\n", argv[0]);
+    const char *port_arg = NULL;
+    const char *master_arg = NULL;
+    int workers = executor_default_workers();
+    int mtu = BATCH_DEFAULT_MTU;
+    int metrics_port = 0;
+    int always_shell = 0;
+    int no_builtins = 0;
+    LogLevel log_level = LOG_INFO;
+    LogFormat log_format = LOG_TEXT;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workers = atoi(argv[++i]);
+            if (workers <= 0) {
+                fprintf(stderr, "Invalid worker count: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--mtu") == 0 && i + 1 < argc) {
+            mtu = atoi(argv[++i]);
+            if (mtu < PROTO_HEADER_SIZE || mtu > PROTO_MAX_DATAGRAM) {
+                fprintf(stderr, "Invalid MTU: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--master") == 0 && i + 1 < argc) {
+            master_arg = argv[++i];
+        } else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            if (logger_parse_level(argv[++i], &log_level) < 0) {
+                fprintf(stderr, "Unknown log level: %s (error, warn, info, debug)\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--log-format") == 0 && i + 1 < argc) {
+            if (logger_parse_format(argv[++i], &log_format) < 0) {
+                fprintf(stderr, "Unknown log format: %s (text, json)\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--shell") == 0) {
+            always_shell = 1;
+        } else if (strcmp(argv[i], "--no-builtins") == 0) {
+            no_builtins = 1;
+        } else if (strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc) {
+            metrics_port = atoi(argv[++i]);
+            if (metrics_port < 0 || metrics_port > 65535) {
+                fprintf(stderr, "Invalid metrics port: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (!port_arg) {
+            port_arg = argv[i];
+        } else {
+            port_arg = NULL;
+            break;
+        }
+    }
+    if (!port_arg) {
+        fprintf(stderr, "Usage: %s [--workers N] [--mtu N] [--master host[:port]] [--metrics-port N] "
+                "[--log-level L] [--log-format text|json] [--shell] [--no-builtins] <port>\n", argv[0]);
         exit(1);
     }
+    if (logger_start("Slave Server", log_level, log_format) < 0) {
+        fprintf(stderr, "Cannot start logger: messages are written synchronously\n");
+    }
 
     /* Conversion du port de chaîne en entier */
-    int port = atoi(argv[1]);
+    int port = atoi(port_arg);
+    listen_port = port;
 
     /* Déclaration des variables */
-    SOCKET sock;                        /* Socket UDP du serveur */
     struct sockaddr_in server_addr;     /* Adresse du serveur (ce programme) */
-    struct sockaddr_in client_addr;     /* Adresse du client (serveur maître) */
-    int client_addr_len;                /* Taille de l'adresse client */
-    CommandRequest request;             /* Structure pour recevoir les requêtes */
-    CommandResult result;               /* Structure pour envoyer les résultats */
 
     /*
      * ÉTAPE 2: Initialisation de Winsock
@@ -177,8 +845,8 @@ int main(int argc, char *argv[]) {
      * UDP est choisi pour sa simplicité et sa faible latence,
      * bien qu'il ne garantisse pas la livraison des paquets.
      */
-    sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-    if (sock == INVALID_SOCKET) {
+    slave_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (slave_sock == INVALID_SOCKET) {
         fprintf(stderr, "socket failed: %d\n", WSAGetLastError());
         WSACleanup();
         exit(1);
@@ -200,117 +868,125 @@ int main(int argc, char *argv[]) {
     server_addr.sin_addr.s_addr = htonl(INADDR_ANY); /* Écoute sur toutes les interfaces */
 
     /* Liaison du socket au port - permet de recevoir des paquets sur ce port */
-    if (bind(sock, (struct sockaddr *)&server_addr, sizeof(server_addr)) == SOCKET_ERROR) {
+    if (bind(slave_sock, (struct sockaddr *)&server_addr, sizeof(server_addr)) == SOCKET_ERROR) {
         fprintf(stderr, "bind failed: %d\n", WSAGetLastError());
-        closesocket(sock);
+        closesocket(slave_sock);
+        WSACleanup();
+        exit(1);
+    }
+    net_set_nonblocking(slave_sock);
+    batch_init(&result_batch, slave_sock, (size_t)mtu, 0, 0);
+    output_frame_cap = mtu > MIN_OUTPUT_FRAME ? (size_t)mtu : MIN_OUTPUT_FRAME;
+    if (dedup_init(&dedup) < 0) {
+        fprintf(stderr, "Cannot allocate dedup table\n");
+        closesocket(slave_sock);
         WSACleanup();
         exit(1);
     }
-
-    /* Affichage du message de démarrage avec le PID pour identification */
-    printf("[Slave Server] Esclave lancé sur le port %d (PID=%d)\n", port, getpid());
 
     /*
-     * ÉTAPE 5: Boucle principale du serveur
-     * --------------------------------------
-     * Boucle infinie qui:
-     * 1. Attend une requête de commande du maître
-     * 2. Exécute la commande
-     * 3. Renvoie le résultat
-     * 4. Recommence
+     * Adresse d'inscription du maître (--master hôte[:port])
+     * ------------------------------------------------------
+     * Résolue une fois au démarrage; l'esclave s'y annonce depuis son
+     * propre socket, le maître le joint donc à l'adresse émettrice.
      */
-    while (1) {
-        /* Préparation pour la réception */
-        client_addr_len = sizeof(client_addr);
-
-        /*
-         * ÉTAPE 5a: Réception d'une commande du maître
-         * ---------------------------------------------
-         * recvfrom() est bloquant - le serveur attend ici jusqu'à
-         * recevoir un datagramme UDP.
-         *
-         * Paramètres:
-         *   - sock: Socket UDP
-         *   - &request: Buffer pour stocker les données reçues
-         *   - sizeof(request): Taille maximale à recevoir
-         *   - 0: Pas de flags spéciaux
-         *   - &client_addr: Stocke l'adresse de l'expéditeur
-         *   - &client_addr_len: Taille de l'adresse
-         */
-        int n = recvfrom(sock, (char *)&request, sizeof(request), 0,
-                        (struct sockaddr *)&client_addr, &client_addr_len);
-
-        /* Vérification des erreurs de réception */
-        if (n == SOCKET_ERROR) {
-            fprintf(stderr, "recvfrom failed: %d\n", WSAGetLastError());
-            continue;  /* Ignorer l'erreur et attendre la prochaine requête */
+    if (master_arg) {
+        char host[256];
+        int register_port = REGISTER_PORT;
+        snprintf(host, sizeof(host), "%s", master_arg);
+        char *colon = strchr(host, ':');
+        if (colon) {
+            *colon = '\0';
+            register_port = atoi(colon + 1);
         }
 
-        /* Affichage de la commande reçue avec les informations du client */
-        printf("[Slave Server] Reçu commande: %s (de %s:%d)\n",
-               request.command, request.client_addr, request.client_port);
+        struct hostent *he = gethostbyname(host);
+        if (!he || register_port <= 0 || register_port > 65535) {
+            fprintf(stderr, "Invalid master address: %s\n", master_arg);
+            closesocket(slave_sock);
+            WSACleanup();
+            exit(1);
+        }
+        memset(&register_addr, 0, sizeof(register_addr));
+        register_addr.sin_family = AF_INET;
+        register_addr.sin_port = htons(register_port);
+        memcpy(&register_addr.sin_addr, he->h_addr_list[0], he->h_length);
+        register_enabled = 1;
+    }
 
-        /*
-         * ÉTAPE 5b: Exécution de la commande
-         * -----------------------------------
-         * La fonction system() exécute la commande dans un shell.
-         * Elle retourne:
-         *   - 0: Succès
-         *   - Valeur positive: Code d'erreur de la commande
-         *   - Valeur négative: Erreur système (impossible d'exécuter)
-         *
-         * ATTENTION: L'utilisation de system() avec des entrées non
-         * validées présente des risques de sécurité (injection de commandes).
-         */
-        int ret = system(request.command);
+    /*
+     * ÉTAPE 5: Boucle d'événements et pool de workers
+     * ------------------------------------------------
+     * Le socket UDP, la notification de fin des processus fils et les
+     * tubes de sortie des fils sont surveillés par le même réacteur.
+     */
+    Reactor *reactor = reactor_create();
+    if (!reactor || executor_init(&executor, workers, reactor, on_command_done,
+                                   on_command_output, NULL) < 0) {
+        fprintf(stderr, "Cannot initialize executor\n");
+        closesocket(slave_sock);
+        WSACleanup();
+        exit(1);
+    }
+    if (always_shell) executor.direct = 0;
+    if (no_builtins) executor.builtins = 0;
+    reactor_add(reactor, slave_sock, REACTOR_READ, on_request_readable, NULL);
+    metrics_server.sock = INVALID_SOCKET;
+    if (metrics_port > 0
+        && metrics_listen(&metrics_server, reactor, metrics_port, render_metrics, NULL) < 0) {
+        fprintf(stderr, "Cannot open metrics port %d: %d\n", metrics_port, WSAGetLastError());
+        closesocket(slave_sock);
+        WSACleanup();
+        exit(1);
+    }
+#ifndef _WIN32
+    /* Un lecteur de /metrics qui se déconnecte ne doit pas tuer l'esclave */
+    signal(SIGPIPE, SIG_IGN);
 
-        /*
-         * ÉTAPE 5c: Préparation du résultat
-         * ----------------------------------
-         * Construction de la structure CommandResult avec:
-         * - La commande exécutée (pour correspondance)
-         * - Le code de retour
-         * - Un message descriptif du résultat
-         */
-        strcpy(result.command, request.command);
-        result.return_code = ret;
-
-        /* Génération du message de résultat selon le code de retour */
-        if (ret < 0) {
-            /* Erreur système - impossible d'exécuter la commande */
-            strcpy(result.result, "Erreur: impossible d'exécuter la commande");
-        } else if (ret > 0) {
-            /* La commande a retourné une erreur */
-            sprintf(result.result, "Erreur d'exécution (code: %d)", ret);
-        } else {
-            /* Succès - code de retour 0 */
-            strcpy(result.result, "Commande exécutée avec succès");
-        }
+    /* SIGUSR1: bascule du niveau debug (messages émis pour chaque commande) */
+    signal(SIGUSR1, on_sigusr1);
+#endif
 
-        /* Affichage du résultat dans la console du serveur */
-        printf("[Slave Server] Résultat: %s (code=%d)\n", result.result, ret);
+    /* Affichage du message de démarrage avec le PID pour identification */
+    log_info("Esclave lancé sur le port %d avec %d workers (PID=%d)",
+             port, executor.workers, getpid());
+    if (metrics_server.sock != INVALID_SOCKET) {
+        log_info("Mesures sur http://localhost:%d/metrics", metrics_port);
+    }
 
-        /*
-         * ÉTAPE 5d: Envoi du résultat au serveur maître
-         * ----------------------------------------------
-         * sendto() envoie le résultat à l'adresse du maître
-         * (stockée dans client_addr lors de la réception).
-         */
-        if (sendto(sock, (const char *)&result, sizeof(result), 0,
-                  (struct sockaddr *)&client_addr, client_addr_len) == SOCKET_ERROR) {
-            fprintf(stderr, "sendto failed: %d\n", WSAGetLastError());
+    /*
+     * ÉTAPE 6: Boucle principale du serveur
+     * --------------------------------------
+     * Boucle infinie qui:
+     * 1. Attend une requête du maître, une sortie ou la fin d'un processus
+     *    fils, au plus jusqu'à la prochaine retransmission de sortie
+     * 2. Lance ou met en attente les nouvelles commandes
+     * 3. Retransmet les morceaux de sortie non acquittés
+     * 4. S'inscrit auprès du maître s'il ne le sonde pas (--master)
+     * 5. Renvoie, regroupés, sorties et résultats des commandes terminées
+     * 6. Recommence
+     */
+    int timeout_ms = 0;  /* Premier tour immédiat: inscription sans attendre */
+    while (1) {
+        if (reactor_run_once(reactor, timeout_ms) < 0) {
+            fprintf(stderr, "reactor wait failed: %d\n", WSAGetLastError());
         }
-
-        /* Retour au début de la boucle pour attendre la prochaine commande */
+        timeout_ms = process_output_timers(monotonic_us());
+        int register_ms = process_registration(monotonic_us());
+        if (register_ms >= 0 && (timeout_ms < 0 || register_ms < timeout_ms)) timeout_ms = register_ms;
+        flush_results(reactor);
+        dedup_expire(&dedup, monotonic_us());
     }
 
     /*
-     * ÉTAPE 6: Nettoyage (jamais atteint en fonctionnement normal)
+     * ÉTAPE 7: Nettoyage (jamais atteint en fonctionnement normal)
      * -------------------------------------------------------------
      * Ces lignes ne sont jamais exécutées car le serveur tourne
      * indéfiniment. Elles sont présentes pour la complétude du code.
      */
-    closesocket(sock);
+    metrics_close(&metrics_server, reactor);
+    reactor_destroy(reactor);
+    closesocket(slave_sock);
     WSACleanup();
     return 0;
 }
@@ -8,26 +8,141 @@
  *
  * Description:
  *   Ce programme représente le serveur maître (coordinateur) dans l'architecture
- *   maître-esclaves. Il accepte les connexions des clients via TCP, lit les
- *   fichiers de commandes, et distribue les commandes aux serveurs esclaves
- *   via UDP pour une exécution parallèle.
+ *   maître-esclaves. Il accepte les connexions des clients via TCP, reçoit
+ *   le contenu de leurs fichiers de commandes, et distribue les commandes
+ *   aux serveurs esclaves via UDP pour une exécution parallèle.
  *
  * Architecture:
  *   - Communication Client-Maître: TCP sur port 9999
  *   - Communication Maître-Esclaves: UDP sur ports configurés (10001, 10002, ...)
+ *   - Inscription des esclaves: UDP sur port 9999 (--register-port)
  *
  * Fonctionnement:
  *   1. Le serveur charge la configuration des esclaves depuis slaves.conf
- *   2. Il écoute les connexions clients sur le port TCP 9999
- *   3. Pour chaque client connecté:
- *      a. Il reçoit le nom du fichier de commandes
- *      b. Il ouvre et lit le fichier ligne par ligne
- *      c. Pour chaque commande, il trouve un esclave disponible
- *      d. Il envoie la commande à l'esclave via UDP
- *   4. Il ferme la connexion client et attend le prochain
+ *   2. Il écoute les connexions clients sur le port TCP 9999 (non bloquant)
+ *   3. Une boucle d'événements unique (reactor.c: epoll sous Linux, select
+ *      sous Winsock) multiplexe le socket d'écoute, toutes les connexions
+ *      clients et les sockets UDP de chaque esclave:
+ *      a. Nouvelle connexion: acceptée immédiatement, sans bloquer les autres
+ *      b. Trame MSG_SUBMIT reçue: le client passe en phase de distribution
+ *         et transmet le contenu de son fichier (trames MSG_DATA, puis
+ *         MSG_END); les lignes sont reconstituées au fil de la réception
+ *      c. Entre deux attentes, chaque client en distribution envoie un lot
+ *         d'au plus DISPATCH_BATCH lignes complètes aux esclaves, à tour de
+ *         rôle, sans attendre la fin du fichier: plusieurs fichiers
+ *         progressent simultanément
+ *      d. Les réponses des esclaves sont lues dès leur arrivée et
+ *         retransmises au client d'origine: sortie de la commande au fil de
+ *         l'eau (trames MSG_OUTPUT), puis son résultat (trame MSG_RESULT)
+ *   4. Quand toutes ses commandes sont terminées, le client reçoit le bilan
+ *      MSG_DONE et la connexion est fermée
  *
- * Usage: serveur_maitre.exe <fichier_config_esclaves>
- *   Exemple: serveur_maitre.exe slaves.conf
+ * Santé des esclaves:
+ *   Toutes les HEARTBEAT_INTERVAL_MS, le maître sonde chaque esclave
+ *   (MSG_PING); l'esclave répond par un battement de cœur MSG_HEARTBEAT
+ *   (capacité, commandes en cours et en attente, charge). Toute trame
+ *   reçue d'un esclave prouve qu'il est vivant. Un esclave muet depuis
+ *   HEARTBEAT_MISSES périodes est écarté de l'ordonnancement et ses
+ *   commandes en cours sont redistribuées aux autres; il est réintégré dès
+ *   qu'il répond de nouveau. Au démarrage, un esclave n'est utilisé
+ *   qu'après sa première réponse. Sans aucun esclave disponible, les
+ *   lignes reçues attendent.
+ *
+ * Registre des esclaves:
+ *   La table des esclaves grandit à la demande, sans limite fixée à la
+ *   compilation. Un esclave lancé avec --master s'inscrit de lui-même
+ *   (MSG_REGISTER sur le port d'inscription) et est sondé aussitôt. Sur
+ *   SIGHUP, slaves.conf est relu sans redémarrage: les esclaves ajoutés
+ *   sont créés, ceux qui n'y figurent plus sont retirés (plus sondés ni
+ *   choisis, commandes en file redistribuées, commandes déjà envoyées
+ *   terminées chez eux). Les clients connectés ne sont pas interrompus.
+ *
+ *   Tous les messages sont des trames binaires décrites dans protocol.h.
+ *
+ * Journal des travaux (journal.c):
+ *   Avec --journal, chaque travail (contenu du fichier reçu), chaque
+ *   commande distribuée et chaque résultat sont consignés dans un fichier
+ *   en ajout seul, rendu durable par lots (un fdatasync() par lot, dans
+ *   un thread d'écriture). Au redémarrage après un arrêt, les travaux
+ *   non terminés sont repris sans client connecté: seules les commandes
+ *   sans résultat consigné sont relancées.
+ *
+ * Cache des résultats (cache.c):
+ *   Avec --cache, le résultat et la sortie d'une commande déclarée
+ *   déterministe ("cache:" en tête de ligne) sont conservés: la même
+ *   commande est ensuite servie directement par le maître, et une
+ *   commande identique déjà en cours n'est pas relancée (elle partage
+ *   son résultat). Le cache est borné en taille (LRU) et en durée.
+ *
+ * Partage équitable (fairshare.c):
+ *   Les clients d'une même adresse IP forment un locataire. Les commandes
+ *   attendent dans le fichier de leur client et n'entrent dans la file du
+ *   maître qu'à mesure que les esclaves se libèrent; chaque place va au
+ *   fichier le plus prioritaire, puis à l'échéance la plus proche (EDF,
+ *   priorité et échéance annoncées dans MSG_SUBMIT), puis au locataire le
+ *   moins servi, selon son poids (--client-weight). Passé l'échéance d'un
+ *   fichier, ses commandes non lancées sont abandonnées et les résultats
+ *   tardifs signalés. Bornes
+ *   par locataire: commandes distribuées (--client-running) et fichiers
+ *   en cours (--client-jobs, au-delà la soumission est refusée: MSG_BUSY).
+ *
+ * Mesures (metrics.c):
+ *   Avec --metrics-port, GET /metrics sur ce port TCP retourne les
+ *   compteurs du maître au format texte de Prometheus: débit de
+ *   distribution, retransmissions, profondeur de file et erreurs d'envoi
+ *   par esclave, histogrammes d'attente, d'aller-retour et d'exécution,
+ *   cache, journal et locataires. Les compteurs sont de simples entiers
+ *   de la boucle d'événements (atomiques relâchés pour ceux des threads
+ *   d'envoi), lus seulement à la demande.
+ *
+ * Journalisation (logger.c):
+ *   Les messages sont déposés dans une file sans verrou et écrits par un
+ *   thread dédié, par blocs: la boucle d'événements n'attend jamais une
+ *   écriture. Les messages émis pour chaque commande sont de niveau debug
+ *   (--log-level debug, ou SIGUSR1 pour basculer en cours d'exécution);
+ *   --log-format json écrit un objet JSON par ligne.
+ *
+ * Usage: serveur_maitre.exe [--policy rr|least|ewma] [--mtu N] [--flush-us N]
+ *                           [--register-port N] [--prefetch N] [--journal FILE]
+ *                           [--cache MO] [--cache-ttl S] [--client-running N]
+ *                           [--client-jobs N] [--client-weight IP=W]
+ *                           [--metrics-port N] [--log-level L] [--log-format F]
+ *                           <fichier_config_esclaves>
+ *   Exemple: serveur_maitre.exe --policy ewma slaves.conf
+ *
+ * Envoi par lots (batch.c, sender.c):
+ *   Les commandes destinées à un même esclave sont regroupées dans des
+ *   datagrammes d'au plus --mtu octets (défaut 1472), envoyés avec
+ *   sendmmsg() sous Linux. Un lot part dès qu'il est plein, lorsque sa
+ *   plus ancienne commande a attendu --flush-us microsecondes (défaut
+ *   1000), ou dès que le maître n'a plus de commande reçue à distribuer.
+ *
+ * Pipeline de distribution:
+ *   La boucle d'événements découpe les lignes, choisit l'esclave et
+ *   encode chaque trame directement dans la file sans verrou (spsc.c) de
+ *   cet esclave. Un thread d'envoi par esclave vide cette file, constitue
+ *   les datagrammes et fait les appels système d'envoi: les étages
+ *   tournent sur des cœurs différents, et la boucle d'événements ne se
+ *   bloque jamais sur un tampon d'émission plein. L'ordonnanceur, la
+ *   table des commandes en cours et les connexions clients restent
+ *   propres à la boucle d'événements (aucun verrou).
+ *
+ * Files des esclaves et vol de travail (deque.c):
+ *   Une commande attribuée à un esclave attend dans la file de cet
+ *   esclave, chez le maître; elle ne lui est envoyée que lorsqu'il en a
+ *   moins de workers + --prefetch (défaut 2) en cours. Un esclave qui
+ *   annonce de la place (résultat, battement de cœur) et dont la file est
+ *   vide vole la dernière commande de la file la plus longue: la durée
+ *   d'un lot suit le travail total divisé par le nombre d'esclaves, et non
+ *   la file de l'esclave le moins chanceux.
+ *
+ * Ordonnancement (scheduler.c):
+ *   Chaque commande porte un identifiant renvoyé par l'esclave dans sa
+ *   trame MSG_RESULT; le maître en déduit le nombre de commandes en cours et
+ *   la latence de chaque esclave, et répartit les commandes selon:
+ *     rr    - tourniquet
+ *     least - moins de commandes en cours (défaut)
+ *     ewma  - temps d'achèvement estimé selon la latence lissée
  *
  * Format du fichier de configuration (slaves.conf):
  *   hostname port
@@ -35,6 +150,7 @@
  *     localhost 10001
  *     localhost 10002
  *     localhost 10003
+ *   Recharger après modification: kill -HUP <pid du maître>
  *
  * ============================================================================
  */
@@ -44,63 +160,70 @@
 #include <stdlib.h>     /* Pour exit(), atoi() et autres fonctions utilitaires */
 #include <string.h>     /* Pour les fonctions de manipulation de chaînes */
 #include <errno.h>      /* Pour les codes d'erreur système */
+#include <time.h>       /* Pour time(): premier identifiant de commande */
+#include <signal.h>     /* Pour SIGHUP: rechargement de slaves.conf */
 
-/* Inclusion des bibliothèques Windows Socket (Winsock2) */
-#include <winsock2.h>   /* API principale Windows Socket version 2 */
-#include <ws2tcpip.h>   /* Fonctions supplémentaires TCP/IP */
-#include <process.h>    /* Pour _getpid() - obtenir l'ID du processus */
-
-/* Directives pour lier automatiquement les bibliothèques nécessaires */
-#pragma comment(lib, "ws2_32.lib")   /* Bibliothèque Winsock */
-#pragma comment(lib, "winmm.lib")    /* Bibliothèque multimédia Windows */
+/* Couche réseau portable (Winsock2 sous Windows, sockets POSIX ailleurs) */
+#include "net_compat.h"
+#include "reactor.h"    /* Boucle d'événements epoll/select */
+#include "scheduler.h"  /* Choix de l'esclave (rr, least, ewma) */
+#include "inflight.h"   /* Commandes envoyées en attente de résultat */
+#include "slab.h"       /* Allocation des trames de commande par classes de taille */
+#include "protocol.h"   /* Format binaire des messages */
+#include "batch.h"      /* Regroupement des trames, sendmmsg/recvmmsg */
+#include "sender.h"     /* Threads d'envoi vers les esclaves */
+#include "retry.h"      /* Échéances de retransmission */
+#include "deque.h"      /* Files des commandes en attente, vol de travail */
+#include "dag.h"        /* Dépendances entre les commandes d'un fichier */
+#include "journal.h"    /* Journal des travaux, reprise après un arrêt */
+#include "cache.h"      /* Cache des résultats des commandes déterministes */
+#include "fairshare.h"  /* Partage équitable des esclaves entre les clients */
+#include "metrics.h"    /* Compteurs, histogrammes et page /metrics */
+#include "logger.h"     /* Journalisation asynchrone */
 
 /* ============================================================================
  * CONSTANTES DE CONFIGURATION
  * ============================================================================ */
 
-#define MAX_CMD_LEN 1024     /* Longueur maximale d'une commande shell */
-#define MAX_SLAVES 10        /* Nombre maximum de serveurs esclaves supportés */
-#define MAX_CLIENTS 100      /* Nombre maximum de clients simultanés (non utilisé) */
+#define MAX_CMD_LEN PROTO_MAX_COMMAND /* Longueur maximale d'une commande (un seul datagramme) */
+#define MAX_CLIENTS 1024     /* Nombre maximum de clients simultanés */
 #define MASTER_PORT 9999     /* Port TCP sur lequel le maître écoute les clients */
+#define REGISTER_PORT 9999   /* Port UDP des inscriptions d'esclaves (MSG_REGISTER) */
+#define DISPATCH_BATCH 64    /* Commandes distribuées par client et par tour de boucle */
+#define DEFAULT_FLUSH_US 1000 /* Attente maximale d'une commande mise en lot (µs) */
+#define SLAVE_BATCH_MAX 256  /* Datagrammes en attente par esclave avant de ralentir */
+#define SLAVE_QUEUE_MAX 1024 /* Commandes en file par esclave avant de suspendre la distribution */
+#define DEFAULT_PREFETCH 2   /* Commandes envoyées d'avance à un esclave, au-delà de ses workers */
+#define CLIENT_TEXT_MAX 65536 /* Octets reçus non distribués avant de suspendre la lecture */
+#define CLIENT_TEXT_SIZE (CLIENT_TEXT_MAX + PROTO_MAX_CHUNK) /* Taille du tampon des lignes */
+#define CLIENT_OUT_MAX (1024 * 1024) /* Octets en attente d'envoi au client avant de retenir la sortie */
+#define DISPATCH_BACKLOG 1   /* Commandes en file chez le maître par worker disponible (voir dispatch_window) */
+
+/* Fiabilité du canal UDP maître-esclaves (voir retry.h) */
+#define RETRY_INITIAL_MS 200 /* Attente de l'acquittement avant la 1re retransmission */
+#define RESULT_POLL_MS 1000  /* Attente du résultat d'une commande acquittée */
+#define RETRY_MAX_MS 5000    /* Plafond du délai (doublé à chaque retransmission) */
+#define RETRY_MAX_MISSES 8   /* Retransmissions sans réponse avant abandon */
+
+/* Santé des esclaves */
+#define HEARTBEAT_INTERVAL_MS 500 /* Période des sondes MSG_PING */
+#define HEARTBEAT_MISSES 3   /* Périodes sans nouvelles avant d'écarter un esclave */
+
+/* Cache des résultats (voir cache.h) */
+#define DEFAULT_CACHE_TTL_S 600 /* Durée de vie d'un résultat en cache (--cache-ttl) */
+
+/* Journal des travaux (voir journal.h) */
+#define JOURNAL_COMPACT_BYTES (16 * 1024 * 1024) /* Taille à partir de laquelle un journal sans travail ouvert est vidé */
 
 /* ============================================================================
  * STRUCTURES DE DONNÉES
  * ============================================================================ */
 
 /*
- * Structure CommandRequest
- * ------------------------
- * Représente une requête de commande envoyée aux serveurs esclaves.
- * Contient la commande à exécuter ainsi que les informations du client
- * original pour la traçabilité.
- *
- * Champs:
- *   - command: La commande shell à exécuter
- *   - client_addr: Adresse IP du client original
- *   - client_port: Port du client original
- */
-typedef struct {
-    char command[MAX_CMD_LEN];   /* Commande shell à exécuter */
-    char client_addr[50];        /* Adresse IP du client (ex: "127.0.0.1") */
-    int client_port;             /* Port du client */
-} CommandRequest;
-
-/*
- * Structure CommandResult
- * -----------------------
- * Représente le résultat d'une commande exécutée par un esclave.
- * Utilisé pour recevoir les résultats des esclaves.
- *
- * Champs:
- *   - command: La commande qui a été exécutée
- *   - return_code: Code de retour de la commande (0 = succès)
- *   - result: Message textuel décrivant le résultat
+ * Les messages échangés avec les clients et les esclaves sont des trames
+ * binaires de longueur variable (MSG_COMMAND, MSG_RESULT, ...), décrites
+ * dans protocol.h.
  */
-typedef struct {
-    char command[MAX_CMD_LEN];   /* Commande exécutée */
-    int return_code;             /* Code de retour (0 = succès, autre = erreur) */
-    char result[256];            /* Message de résultat */
-} CommandResult;
 
 /*
  * Structure SlaveServer
@@ -114,68 +237,2127 @@ typedef struct {
  *   - port: Port UDP de l'esclave
  *   - sock: Socket UDP utilisé pour communiquer avec cet esclave
  *   - addr: Structure sockaddr_in pré-configurée pour l'envoi
- *   - available: Indicateur de disponibilité (1 = disponible)
+ *   - sender: File des trames à envoyer et thread d'envoi de l'esclave
+ *   - last_seen_us: Réception de la dernière trame de l'esclave (0 = jamais)
+ *   - health: Dernier battement de cœur reçu (charge, file d'attente)
+ *   - idx: Index de l'esclave dans slaves[] et dans l'ordonnanceur
+ *   - configured: 1 si l'esclave figure dans slaves.conf (0 = inscrit de
+ *     lui-même, voir on_register_event())
+ *   - config_gen: Dernier chargement de slaves.conf où il figurait
+ *   - retired: 1 si l'esclave a été retiré de slaves.conf: il n'est plus
+ *     sondé ni choisi, mais ses commandes déjà envoyées se terminent
+ *   - queue: Commandes attribuées à l'esclave, pas encore envoyées (voir
+ *     pump_slave())
+ *   - sent: Commandes envoyées dont le résultat n'est pas revenu
+ *   - pump_blocked: 1 si la file d'envoi était pleine lors du dernier envoi
+ *   - stolen: Nombre de commandes volées à d'autres esclaves
+ *
+ * La disponibilité et la charge de chaque esclave sont suivies par
+ * l'ordonnanceur (scheduler.h), au même index. Chaque esclave est alloué
+ * une fois pour toutes: son adresse, transmise à la boucle d'événements et
+ * à son thread d'envoi, ne change pas quand la table grandit.
  */
 typedef struct {
     char hostname[256];          /* Nom d'hôte de l'esclave */
     int port;                    /* Port UDP de l'esclave */
     SOCKET sock;                 /* Socket UDP pour cet esclave */
     struct sockaddr_in addr;     /* Adresse socket pré-configurée */
-    int available;               /* 1 si disponible, 0 sinon */
+    SlaveSender sender;          /* Thread d'envoi et sa file de trames */
+    uint64_t last_seen_us;       /* Dernière trame reçue de l'esclave */
+    ProtoHeartbeat health;       /* Dernier battement de cœur */
+    int idx;                     /* Index dans slaves[] et l'ordonnanceur */
+    int configured;              /* Listé dans slaves.conf */
+    unsigned int config_gen;     /* Dernier chargement qui le listait */
+    int retired;                 /* Retiré de slaves.conf */
+    CmdDeque queue;              /* Commandes en attente d'envoi */
+    int sent;                    /* Commandes envoyées sans résultat */
+    int pump_blocked;            /* File d'envoi pleine, envoi à reprendre */
+    unsigned long stolen;        /* Commandes volées aux autres esclaves */
 } SlaveServer;
 
+/*
+ * Énumération ClientState
+ * -----------------------
+ * Étapes du traitement d'une connexion client.
+ */
+typedef enum {
+    CLIENT_FREE = 0,         /* Emplacement libre */
+    CLIENT_WAIT_SUBMIT,      /* Connecté, en attente de la trame MSG_SUBMIT */
+    CLIENT_DISPATCHING,      /* Fichier en cours de réception et de distribution */
+    CLIENT_DRAINING,         /* Fichier distribué, attente des derniers résultats */
+    CLIENT_CLOSING           /* Bilan envoyé, fermeture après vidage du tampon */
+} ClientState;
+
+/*
+ * Structure ClientConn
+ * --------------------
+ * Représente une connexion client gérée par la boucle d'événements.
+ *
+ * Champs:
+ *   - state: Étape courante (voir ClientState)
+ *   - gen: Génération de l'emplacement, incrémentée à chaque connexion; un
+ *          résultat arrivant après la déconnexion du client est ainsi ignoré
+ *   - sock: Socket TCP du client
+ *   - addr: Adresse IP du client
+ *   - ip: Adresse IP du client (ordre réseau, transmise aux esclaves)
+ *   - port: Port du client
+ *   - in_buf / in_len: Octets reçus du client, en attente d'une trame complète
+ *   - text / text_off / text_len: Contenu du fichier reçu (trames MSG_DATA);
+ *     les octets avant text_off sont déjà distribués, ceux après forment
+ *     les lignes suivantes, la dernière éventuellement incomplète
+ *   - text_scan: Position jusqu'à laquelle la ligne incomplète a déjà été
+ *     parcourue sans trouver de '\n' (elle n'est pas relue à chaque morceau)
+ *   - upload_done: 1 dès réception de MSG_END (fichier entièrement reçu)
+ *   - skip_line: 1 si la ligne en cours est trop longue: déjà rejetée
+ *     (résultat en échec), sa suite est ignorée
+ *   - read_paused: 1 si la lecture du socket est suspendue (text plein)
+ *   - cmd_count: Nombre de commandes lues dans le fichier (envoyées aux
+ *     esclaves, retenues par leurs dépendances ou rejetées)
+ *   - done_count: Nombre de résultats reçus et transmis au client
+ *   - failed_count: Nombre de résultats dont le code de retour est non nul
+ *   - out_buf / out_len / out_cap: Données en attente d'envoi au client
+ *   - dag: Dépendances entre les commandes du fichier (voir dag.h)
+ *   - job: Numéro du travail dans le journal (0 = non journalisé)
+ *   - detached: 1 pour un travail repris du journal au démarrage: aucun
+ *     client connecté, les résultats sont seulement affichés
+ *   - finished / finished_len: Travail repris: état de chaque commande
+ *     d'après le journal (voir JobCmdState, indexé par rang); celles déjà
+ *     terminées ne sont pas relancées
+ *   - tenant: Locataire (adresse IP) auquel le fichier est compté (voir
+ *     fairshare.h), -1 tant qu'aucun fichier n'est accepté
+ *   - priority: Priorité du fichier (MSG_SUBMIT), la plus élevée servie
+ *     d'abord
+ *   - deadline_us: Échéance de ses commandes (horloge monotone, 0 = aucune)
+ *   - late_count: Résultats obtenus après l'échéance (ou commandes
+ *     abandonnées faute de temps)
+ */
+typedef struct {
+    ClientState state;
+    unsigned int gen;
+    SOCKET sock;
+    char addr[50];
+    uint32_t ip;
+    int port;
+    uint8_t in_buf[PROTO_HEADER_SIZE + PROTO_MAX_CHUNK];
+    size_t in_len;
+    char *text;
+    size_t text_off;
+    size_t text_len;
+    size_t text_scan;
+    int upload_done;
+    int skip_line;
+    int read_paused;
+    int cmd_count;
+    int done_count;
+    int failed_count;
+    char *out_buf;
+    size_t out_len;
+    size_t out_cap;
+    Dag dag;
+    uint32_t job;
+    int detached;
+    uint8_t *finished;
+    size_t finished_len;
+    int tenant;
+    int priority;
+    uint64_t deadline_us;
+    int late_count;
+} ClientConn;
+
+/*
+ * Énumération JobCmdState
+ * -----------------------
+ * État d'une commande d'un travail d'après le journal.
+ */
+typedef enum {
+    JOB_CMD_PENDING = 0,  /* Jamais distribuée */
+    JOB_CMD_DISPATCHED,   /* Distribuée, sans résultat consigné (relancée) */
+    JOB_CMD_OK,           /* Terminée avec le code 0 */
+    JOB_CMD_FAILED        /* Terminée en échec */
+} JobCmdState;
+
+/*
+ * Structure RecoveredJob
+ * ----------------------
+ * Travail reconstitué à la relecture du journal.
+ *
+ * Champs:
+ *   - job: Numéro du travail
+ *   - origin: Client et fichier d'origine (enregistrement SUBMIT)
+ *   - text / text_len / text_cap: Contenu du fichier reçu
+ *   - ended: 1 si le fichier avait été entièrement reçu
+ *   - closed: 1 si le travail est terminé (rien à reprendre)
+ *   - states / states_cap: État de chaque commande (voir JobCmdState)
+ */
+typedef struct {
+    uint32_t job;
+    char origin[128];
+    char *text;
+    size_t text_len;
+    size_t text_cap;
+    int ended;
+    int closed;
+    uint8_t *states;
+    size_t states_cap;
+} RecoveredJob;
+
+/*
+ * Structure Recovery
+ * ------------------
+ * Travaux trouvés dans le journal, par numéro croissant (ordre des
+ * enregistrements SUBMIT).
+ */
+typedef struct {
+    RecoveredJob *jobs;
+    int num_jobs;
+    int jobs_cap;
+    int failed;
+} Recovery;
+
+/*
+ * Structure MasterStats
+ * ---------------------
+ * Compteurs et histogrammes exposés par la page /metrics (--metrics-port).
+ * Ils ne sont modifiés que par la boucle d'événements: un incrément
+ * ordinaire suffit, sans verrou ni opération atomique.
+ *
+ * Champs:
+ *   - dispatched: Commandes attribuées à un esclave (mises en file)
+ *   - sent: Commandes envoyées depuis la file d'un esclave
+ *   - retransmits: Retransmissions (acquittement ou résultat en retard)
+ *   - lost: Commandes abandonnées, esclave injoignable
+ *   - results: Résultats reçus des esclaves (doublons exclus)
+ *   - expired: Commandes abandonnées après l'échéance de leur fichier
+ *   - late: Résultats transmis après l'échéance de leur fichier
+ *   - queue_wait: Attente dans la file de l'esclave, chez le maître
+ *   - round_trip: Envoi à l'esclave -> réception du résultat
+ *   - exec: Durée d'exécution annoncée par l'esclave
+ */
+typedef struct {
+    uint64_t dispatched;
+    uint64_t sent;
+    uint64_t retransmits;
+    uint64_t lost;
+    uint64_t results;
+    uint64_t expired;
+    uint64_t late;
+    MetricsHistogram queue_wait;
+    MetricsHistogram round_trip;
+    MetricsHistogram exec;
+} MasterStats;
+
 /* ============================================================================
  * VARIABLES GLOBALES
  * ============================================================================ */
 
-SlaveServer slaves[MAX_SLAVES];  /* Tableau des serveurs esclaves */
-int num_slaves = 0;              /* Nombre d'esclaves chargés */
+SlaveServer **slaves = NULL;     /* Table des serveurs esclaves (agrandie à la demande) */
+int num_slaves = 0;              /* Nombre d'esclaves connus */
+int slaves_cap = 0;              /* Nombre d'entrées allouées dans slaves */
+unsigned int config_gen = 0;     /* Nombre de chargements de slaves.conf */
+volatile sig_atomic_t reload_requested = 0; /* SIGHUP reçu: recharger slaves.conf */
+
+Scheduler scheduler;             /* Ordonnanceur: charge et politique de sélection */
+InflightTable inflight;          /* Commandes envoyées sans résultat, par id */
+SlabPool frame_slab;             /* Trames MSG_COMMAND des commandes en cours */
+RetryQueue retries;              /* Échéances de retransmission des commandes */
+unsigned int next_command_id = 1;/* Prochain identifiant de commande (0 = invalide) */
+uint64_t next_heartbeat_us = 0;  /* Prochaine série de sondes MSG_PING */
+size_t queued_commands = 0;      /* Commandes en file chez le maître, tous esclaves */
+int pumps_blocked = 0;           /* Esclaves dont l'envoi attend une file d'envoi pleine */
+int slave_prefetch = DEFAULT_PREFETCH; /* Commandes envoyées d'avance (--prefetch) */
+
+size_t batch_mtu = BATCH_DEFAULT_MTU;     /* Taille maximale d'un datagramme groupé */
+uint64_t batch_flush_us = DEFAULT_FLUSH_US; /* Délai de vidage des lots */
+
+ClientConn clients[MAX_CLIENTS]; /* Table des connexions clients */
+int num_dispatching = 0;         /* Clients en phase de distribution */
+
+Journal journal;                 /* Journal des travaux (--journal) */
+int journal_enabled = 0;         /* 1 si le journal est tenu */
+uint32_t next_job_id = 1;        /* Prochain numéro de travail */
+int open_jobs = 0;               /* Travaux journalisés non terminés */
+
+FairShare fairshare;             /* Part des esclaves de chaque client (adresse IP) */
+size_t dispatch_window = 0;      /* Commandes admises en file chez le maître, tous esclaves */
+int dispatch_cursor = 0;         /* Départage des clients d'un même locataire */
+
+ResultCache result_cache;        /* Résultats des commandes "cache:" (--cache) */
+int cache_enabled = 0;           /* 1 si le cache des résultats est actif */
+
+MasterStats stats;               /* Mesures exposées par /metrics */
+MetricsServer metrics_server;    /* Page /metrics (--metrics-port) */
+
+/* ============================================================================
+ * FONCTIONS UTILITAIRES
+ * ============================================================================ */
+
+/*
+ * Fonction signal_handler()
+ * -------------------------
+ * Gestionnaire de signal pour l'arrêt propre du serveur.
+ * Ferme tous les sockets esclaves et libère les ressources Winsock.
+ *
+ * Paramètre:
+ *   sig - Numéro du signal reçu
+ */
+void signal_handler(int sig) {
+    printf("\n[Master Server] Arrêt du serveur maître...\n");
+
+    /* Fermeture de tous les sockets esclaves */
+    for (int i = 0; i < num_slaves; i++) {
+        if (slaves[i]->sock != INVALID_SOCKET) {
+            closesocket(slaves[i]->sock);
+        }
+    }
+
+    /* Libération des ressources Winsock */
+    WSACleanup();
+    exit(0);
+}
+
+/*
+ * Fonction journal_job()
+ * ----------------------
+ * Consigne un événement du travail d'un client dans le journal (sans
+ * effet si le journal n'est pas tenu ou si le client n'a pas de travail).
+ *
+ * Paramètres:
+ *   client - Connexion client
+ *   type - Type d'enregistrement (voir JournalType)
+ *   seq / code - Rang et code de retour de la commande (DISPATCH, DONE)
+ *   data / len - Données (SUBMIT, DATA)
+ */
+void journal_job(ClientConn *client, JournalType type, uint32_t seq, int32_t code,
+                 const void *data, size_t len) {
+    if (!journal_enabled || client->job == 0) return;
+
+    JournalRecord rec;
+    rec.type = (uint8_t)type;
+    rec.job = client->job;
+    rec.seq = seq;
+    rec.code = code;
+    rec.data = (const uint8_t *)data;
+    rec.data_len = len;
+    journal_append(&journal, &rec);
+}
+
+/* ============================================================================
+ * GESTION DES CONNEXIONS CLIENTS
+ * ============================================================================ */
+
+/*
+ * Fonction leave_dispatching()
+ * ----------------------------
+ * Le client quitte la phase de distribution (fichier distribué, erreur
+ * ou déconnexion): il ne compte plus parmi les clients à servir.
+ */
+void leave_dispatching(ClientConn *client) {
+    if (client->state != CLIENT_DISPATCHING) return;
+    num_dispatching--;
+    fair_deactivate(&fairshare, client->tenant);
+}
+
+/*
+ * Fonction close_client()
+ * -----------------------
+ * Ferme une connexion client et libère son emplacement.
+ * Les résultats encore attendus pour ce client seront ignorés.
+ *
+ * Paramètres:
+ *   reactor - Boucle d'événements
+ *   client - Connexion à fermer
+ */
+void close_client(Reactor *reactor, ClientConn *client) {
+    leave_dispatching(client);
+    fair_end_job(&fairshare, client->tenant);
+    client->tenant = -1;
+    free(client->text);
+    client->text = NULL;
+    if (!client->detached) {
+        reactor_remove(reactor, client->sock);
+        closesocket(client->sock);
+    }
+    client->sock = INVALID_SOCKET;
+
+    /*
+     * Fin du travail
+     * --------------
+     * Terminé ou abandonné par son client: il ne sera pas repris. Sans
+     * aucun travail ouvert, le journal ne sert plus à rien: il est vidé
+     * une fois assez grand.
+     */
+    if (journal_enabled && client->job != 0) {
+        journal_job(client, JOURNAL_CLOSE, 0, 0, NULL, 0);
+        client->job = 0;
+        if (--open_jobs == 0 && journal.size > JOURNAL_COMPACT_BYTES) {
+            journal_reset(&journal);
+        }
+    }
+    free(client->finished);
+    client->finished = NULL;
+    client->finished_len = 0;
+
+    free(client->out_buf);
+    client->out_buf = NULL;
+    client->out_len = 0;
+    client->out_cap = 0;
+    dag_free(&client->dag);
+    client->state = CLIENT_FREE;
+}
+
+/*
+ * Fonction update_client_events()
+ * -------------------------------
+ * Ajuste les événements surveillés pour un client: lecture sauf si elle
+ * est suspendue (contrôle de flux), écriture tant que des données restent
+ * à envoyer.
+ */
+void update_client_events(Reactor *reactor, ClientConn *client) {
+    int events = client->read_paused ? 0 : REACTOR_READ;
+    if (client->out_len > 0) events |= REACTOR_WRITE;
+    reactor_modify(reactor, client->sock, events);
+}
+
+/*
+ * Fonction flush_client()
+ * -----------------------
+ * Envoie autant que possible des données en attente pour le client.
+ * Si le socket est saturé, l'écriture reprendra lorsque la boucle
+ * d'événements le signalera inscriptible.
+ *
+ * Retourne:
+ *   0 si la connexion est toujours ouverte, -1 si elle a été fermée
+ */
+int flush_client(Reactor *reactor, ClientConn *client) {
+    size_t sent = 0;
+
+    while (sent < client->out_len) {
+        int n = send(client->sock, client->out_buf + sent, (int)(client->out_len - sent), 0);
+        if (n == SOCKET_ERROR) {
+            if (net_would_block(WSAGetLastError())) break;
+            fprintf(stderr, "send to client %s:%d failed: %d\n",
+                    client->addr, client->port, WSAGetLastError());
+            close_client(reactor, client);
+            return -1;
+        }
+        sent += (size_t)n;
+    }
+
+    /* Décalage des données restantes en début de tampon */
+    memmove(client->out_buf, client->out_buf + sent, client->out_len - sent);
+    client->out_len -= sent;
+
+    if (client->out_len == 0 && client->state == CLIENT_CLOSING) {
+        close_client(reactor, client);
+        return -1;
+    }
+    update_client_events(reactor, client);
+    return 0;
+}
+
+/*
+ * Fonction queue_client_output()
+ * ------------------------------
+ * Ajoute un message au tampon d'envoi du client puis tente de l'envoyer.
+ *
+ * Retourne:
+ *   0 si la connexion est toujours ouverte, -1 si elle a été fermée
+ */
+int queue_client_output(Reactor *reactor, ClientConn *client, const uint8_t *data, size_t len) {
+    if (client->detached) return 0;  /* Travail repris: personne à qui envoyer */
+
+    if (client->out_len + len > client->out_cap) {
+        size_t new_cap = client->out_cap ? client->out_cap : 1024;
+        while (new_cap < client->out_len + len) new_cap *= 2;
+
+        char *grown = realloc(client->out_buf, new_cap);
+        if (!grown) {
+            fprintf(stderr, "Out of memory for client %s:%d\n", client->addr, client->port);
+            close_client(reactor, client);
+            return -1;
+        }
+        client->out_buf = grown;
+        client->out_cap = new_cap;
+    }
+
+    memcpy(client->out_buf + client->out_len, data, len);
+    client->out_len += len;
+    return flush_client(reactor, client);
+}
+
+/*
+ * Fonction send_client_error()
+ * ----------------------------
+ * Envoie une trame MSG_ERROR au client puis ferme la connexion une fois
+ * le tampon vidé.
+ */
+void send_client_error(Reactor *reactor, ClientConn *client, const char *message) {
+    uint8_t frame[PROTO_HEADER_SIZE + 128];
+    size_t len = proto_encode_text(frame, sizeof(frame), MSG_ERROR, 0, message, strlen(message));
+    leave_dispatching(client);
+    client->state = CLIENT_CLOSING;
+    queue_client_output(reactor, client, frame, len);
+}
+
+/*
+ * Fonction send_client_busy()
+ * ---------------------------
+ * Refuse la soumission du client faute de place (trame MSG_BUSY): le
+ * client pourra la soumettre de nouveau plus tard.
+ */
+void send_client_busy(Reactor *reactor, ClientConn *client, const char *message) {
+    uint8_t frame[PROTO_HEADER_SIZE + 128];
+    size_t len = proto_encode_text(frame, sizeof(frame), MSG_BUSY, 0, message, strlen(message));
+    client->state = CLIENT_CLOSING;
+    queue_client_output(reactor, client, frame, len);
+}
+
+/*
+ * Fonction finish_client_if_done()
+ * --------------------------------
+ * Lorsque le fichier est entièrement distribué et que tous les résultats
+ * sont revenus, envoie le bilan MSG_DONE (commandes, échecs) au client et
+ * ferme la connexion une fois le tampon vidé.
+ */
+void finish_client_if_done(Reactor *reactor, ClientConn *client) {
+    if (client->state != CLIENT_DRAINING || client->done_count < client->cmd_count) return;
+
+    log_info("%d commandes terminées pour le client %s:%d (%d en échec, %d hors délai)",
+             client->done_count, client->addr, client->port, client->failed_count, client->late_count);
+
+    /* Plus aucune commande en cours: les blocs des trames sont rendus d'un coup */
+    slab_trim(&frame_slab);
+    if (client->detached) {
+        close_client(reactor, client);
+        return;
+    }
+
+    uint8_t summary[PROTO_HEADER_SIZE + 8];
+    size_t len = proto_encode_done(summary, sizeof(summary), (uint32_t)client->done_count,
+                                   (uint32_t)client->failed_count);
+    client->state = CLIENT_CLOSING;
+    queue_client_output(reactor, client, summary, len);
+}
+
+/*
+ * Fonction start_client_dispatch()
+ * --------------------------------
+ * Traite la trame MSG_SUBMIT du client: accusé de réception et passage
+ * en phase de distribution. Le contenu du fichier suit sur la connexion.
+ */
+void start_client_dispatch(Reactor *reactor, ClientConn *client, const ProtoFrame *frame) {
+    ProtoSubmit submit;
+    proto_decode_submit(frame, &submit);
+    log_info("Fichier soumis par %s:%d: %.*s (priorité %u, échéance %u ms)",
+             client->addr, client->port, (int)(submit.name_len > 255 ? 255 : submit.name_len),
+             submit.name, (unsigned)submit.priority, (unsigned)submit.deadline_ms);
+
+    /*
+     * Contrôle d'admission
+     * --------------------
+     * Au-delà de --client-jobs fichiers en cours pour la même adresse, la
+     * soumission est refusée (MSG_BUSY) au lieu d'attendre chez le maître.
+     */
+    int tenant = fair_tenant(&fairshare, client->ip);
+    if (fair_admit(&fairshare, tenant) < 0) {
+        log_warn("Soumission refusée: %d fichiers déjà en cours pour %s",
+                 fairshare.max_jobs, client->addr);
+        send_client_busy(reactor, client, "Too many jobs in progress from this client, retry later");
+        return;
+    }
+    client->tenant = tenant;
+
+    /*
+     * Tampon des lignes reçues
+     * ------------------------
+     * Il contient au plus CLIENT_TEXT_MAX octets non distribués, plus un
+     * morceau MSG_DATA: au-delà, la lecture du client est suspendue. Un
+     * octet de plus reçoit la fin de la dernière ligne, terminée en place
+     * (voir dispatch_client_batch()).
+     */
+    client->text = malloc(CLIENT_TEXT_SIZE + 1);
+    if (!client->text) {
+        send_client_error(reactor, client, "Server out of memory");
+        return;
+    }
+
+    /*
+     * Envoi de l'accusé de réception (ACK)
+     * ------------------------------------
+     * Confirmation au client que le maître attend le contenu du fichier.
+     * Les résultats suivront sur la même connexion, une trame par commande.
+     */
+    client->state = CLIENT_DISPATCHING;
+    client->text_off = 0;
+    client->text_len = 0;
+    client->text_scan = 0;
+    client->upload_done = 0;
+    client->skip_line = 0;
+    client->cmd_count = 0;
+    client->done_count = 0;
+    client->failed_count = 0;
+    client->priority = submit.priority;
+    client->deadline_us = submit.deadline_ms ? monotonic_us() + (uint64_t)submit.deadline_ms * 1000 : 0;
+    client->late_count = 0;
+    num_dispatching++;
+    fair_activate(&fairshare, client->tenant);
+
+    /*
+     * Journalisation du travail
+     * -------------------------
+     * Son numéro est communiqué au client dans l'accusé de réception: en
+     * cas d'arrêt du maître, le travail est repris à son redémarrage.
+     */
+    if (journal_enabled) {
+        char origin[128];
+        int origin_len = snprintf(origin, sizeof(origin), "%s:%d %.*s", client->addr, client->port,
+                                  (int)(submit.name_len > 64 ? 64 : submit.name_len), submit.name);
+        client->job = next_job_id++;
+        open_jobs++;
+        journal_job(client, JOURNAL_SUBMIT, 0, 0, origin,
+                    (size_t)origin_len < sizeof(origin) ? (size_t)origin_len : sizeof(origin) - 1);
+    }
+
+    uint8_t ack[PROTO_HEADER_SIZE];
+    size_t len = proto_encode_text(ack, sizeof(ack), MSG_ACCEPT, client->job, NULL, 0);
+    queue_client_output(reactor, client, ack, len);
+}
+
+/*
+ * Fonction append_client_text()
+ * -----------------------------
+ * Ajoute un morceau du fichier (trame MSG_DATA) aux lignes à distribuer.
+ * Les lignes déjà distribuées ne sont retirées du tampon que lorsque le
+ * morceau ne tient plus à la suite: les octets restants sont alors
+ * ramenés au début en une seule copie, au lieu d'une à chaque morceau.
+ *
+ * Retourne:
+ *   1 si le morceau a été ajouté, 0 si le tampon est plein (le morceau
+ *   sera repris lorsque des lignes auront été distribuées)
+ */
+int append_client_text(ClientConn *client, const uint8_t *data, size_t len) {
+    if (client->text_len - client->text_off >= CLIENT_TEXT_MAX) return 0;
+
+    if (client->text_len + len > CLIENT_TEXT_SIZE) {
+        memmove(client->text, client->text + client->text_off, client->text_len - client->text_off);
+        client->text_len -= client->text_off;
+        client->text_scan = client->text_scan > client->text_off ? client->text_scan - client->text_off : 0;
+        client->text_off = 0;
+    }
+    memcpy(client->text + client->text_len, data, len);
+    client->text_len += len;
+    return 1;
+}
+
+/*
+ * Fonction process_client_input()
+ * -------------------------------
+ * Traite les trames complètes reçues du client:
+ *   - MSG_SUBMIT (une seule fois): début de la soumission
+ *   - MSG_DATA: morceau du fichier, ajouté aux lignes à distribuer
+ *   - MSG_END: fin du fichier
+ * Si le tampon des lignes est plein, le traitement s'arrête et la lecture
+ * du socket est suspendue jusqu'à ce que des lignes soient distribuées
+ * (voir dispatch_client_batch()): un client rapide ne peut pas imposer au
+ * maître de mémoriser tout son fichier.
+ *
+ * Retourne:
+ *   0 si la connexion est toujours utilisable, -1 si elle est fermée ou
+ *   en cours de fermeture
+ */
+int process_client_input(Reactor *reactor, ClientConn *client) {
+    size_t offset = 0;
+    int stalled = 0;
+
+    while (client->state == CLIENT_WAIT_SUBMIT
+           || (client->state == CLIENT_DISPATCHING && !client->upload_done)) {
+        ProtoFrame frame;
+        int consumed = proto_decode(client->in_buf + offset, client->in_len - offset, &frame);
+        if (consumed == 0) {
+            if (offset > 0 || client->in_len < sizeof(client->in_buf)) break;  /* Trame incomplète */
+            consumed = -1;  /* Trame plus grande que le tampon */
+        }
+
+        int valid = consumed > 0;
+        if (valid && client->state == CLIENT_WAIT_SUBMIT) {
+            valid = frame.type == MSG_SUBMIT && frame.payload_len > 0;
+        } else if (valid) {
+            valid = frame.type == MSG_DATA || frame.type == MSG_END;
+        }
+        if (!valid) {
+            fprintf(stderr, "Invalid request from client %s:%d\n", client->addr, client->port);
+            send_client_error(reactor, client, "Invalid request");
+            return -1;
+        }
+
+        if (frame.type == MSG_SUBMIT) {
+            start_client_dispatch(reactor, client, &frame);
+            if (client->state != CLIENT_DISPATCHING) return -1;
+        } else if (frame.type == MSG_DATA) {
+            if (!append_client_text(client, frame.payload, frame.payload_len)) {
+                stalled = 1;
+                break;
+            }
+            journal_job(client, JOURNAL_DATA, 0, 0, frame.payload, frame.payload_len);
+        } else {
+            client->upload_done = 1;
+            journal_job(client, JOURNAL_END, 0, 0, NULL, 0);
+        }
+        offset += (size_t)consumed;
+    }
+
+    /* Retrait des trames traitées */
+    memmove(client->in_buf, client->in_buf + offset, client->in_len - offset);
+    client->in_len -= offset;
+
+    if (stalled != client->read_paused) {
+        client->read_paused = stalled;
+        update_client_events(reactor, client);
+    }
+    return 0;
+}
+
+/*
+ * Fonction on_client_event()
+ * --------------------------
+ * Rappel de la boucle d'événements pour une connexion client.
+ *   - Écriture possible: reprise de l'envoi des résultats en attente
+ *   - Lecture: trame MSG_SUBMIT puis contenu du fichier de commandes
+ *     (MSG_DATA, MSG_END); ensuite uniquement la détection de la
+ *     déconnexion du client
+ */
+void on_client_event(Reactor *reactor, SOCKET sock, int events, void *arg) {
+    ClientConn *client = (ClientConn *)arg;
+    (void)sock;
+
+    if (events & REACTOR_WRITE) {
+        if (flush_client(reactor, client) < 0) return;
+    }
+    if (!(events & (REACTOR_READ | REACTOR_ERROR))) return;
+
+    /*
+     * Réception de la soumission
+     * --------------------------
+     * Les trames du client peuvent arriver en plusieurs morceaux, ou
+     * plusieurs à la fois. Une fois le fichier entièrement reçu, le client
+     * ne fait qu'attendre les résultats: une lecture ne peut plus signaler
+     * que sa déconnexion.
+     */
+    int receiving = client->state == CLIENT_WAIT_SUBMIT
+                    || (client->state == CLIENT_DISPATCHING && !client->upload_done);
+    uint8_t discard[256];
+    uint8_t *dst = discard;
+    size_t room = sizeof(discard);
+    if (receiving) {
+        if (client->read_paused) return;  /* Lecture suspendue: tampon plein */
+        dst = client->in_buf + client->in_len;
+        room = sizeof(client->in_buf) - client->in_len;
+    }
+    int n = recv(client->sock, (char *)dst, (int)room, 0);
+    if (n < 0 && net_would_block(WSAGetLastError())) {
+        return;  /* Faux réveil: rien à lire pour l'instant */
+    }
+    if (n <= 0) {
+        if (client->state == CLIENT_WAIT_SUBMIT) {
+            fprintf(stderr, "Error reading request from client\n");
+        } else if (client->state != CLIENT_CLOSING) {
+            log_info("Client %s:%d déconnecté avant la fin (%d/%d résultats)",
+                     client->addr, client->port, client->done_count, client->cmd_count);
+        }
+        close_client(reactor, client);
+        return;
+    }
+    if (!receiving) return;  /* Données inattendues: ignorées */
+
+    client->in_len += (size_t)n;
+    process_client_input(reactor, client);
+}
+
+/*
+ * Fonction on_listener_readable()
+ * -------------------------------
+ * Rappel de la boucle d'événements: des connexions attendent sur le port
+ * d'écoute. Toutes les connexions en attente sont acceptées d'un coup
+ * (socket non bloquant), puis enregistrées dans la boucle d'événements.
+ */
+void on_listener_readable(Reactor *reactor, SOCKET master_sock, int events, void *arg) {
+    (void)events;
+    (void)arg;
+
+    while (1) {
+        struct sockaddr_in client_addr;
+        socklen_t client_addr_len = sizeof(client_addr);
+
+        SOCKET client_sock = accept(master_sock, (struct sockaddr *)&client_addr, &client_addr_len);
+        if (client_sock == INVALID_SOCKET) {
+            int err = WSAGetLastError();
+            if (!net_would_block(err)) {
+                fprintf(stderr, "accept failed: %d\n", err);
+            }
+            return;  /* File d'attente vide */
+        }
+
+        /* Recherche d'un emplacement libre dans la table des clients */
+        ClientConn *client = NULL;
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            if (clients[i].state == CLIENT_FREE) {
+                client = &clients[i];
+                break;
+            }
+        }
+        if (!client) {
+            uint8_t busy_msg[PROTO_HEADER_SIZE + 16];
+            size_t len = proto_encode_text(busy_msg, sizeof(busy_msg), MSG_BUSY, 0,
+                                           "Server busy", strlen("Server busy"));
+            send(client_sock, (const char *)busy_msg, (int)len, 0);
+            closesocket(client_sock);
+            continue;
+        }
+
+        net_set_nonblocking(client_sock);
+
+        /* Extraction des informations du client connecté */
+        unsigned int gen = client->gen + 1;
+        memset(client, 0, sizeof(*client));
+        client->gen = gen;
+        client->sock = client_sock;
+        strncpy(client->addr, inet_ntoa(client_addr.sin_addr), sizeof(client->addr) - 1);
+        client->ip = client_addr.sin_addr.s_addr;
+        client->port = ntohs(client_addr.sin_port);
+        client->tenant = -1;
+        client->state = CLIENT_WAIT_SUBMIT;
+
+        if (reactor_add(reactor, client_sock, REACTOR_READ, on_client_event, client) < 0) {
+            fprintf(stderr, "reactor_add failed for client %s:%d\n", client->addr, client->port);
+            closesocket(client_sock);
+            client->state = CLIENT_FREE;
+            continue;
+        }
+
+        log_info("Nouvelle connexion client: %s:%d", client->addr, client->port);
+    }
+}
+
+/* ============================================================================
+ * DISTRIBUTION DES COMMANDES
+ * ============================================================================ */
+
+/*
+ * Fonction schedule_retry()
+ * -------------------------
+ * Planifie la prochaine retransmission d'une commande. Le délai de base
+ * est court tant que l'esclave n'a pas acquitté la commande
+ * (RETRY_INITIAL_MS), plus long ensuite (RESULT_POLL_MS): la commande
+ * s'exécute, seul son résultat pourrait être perdu. Il double à chaque
+ * retransmission, jusqu'à RETRY_MAX_MS.
+ */
+void schedule_retry(InflightCmd *cmd) {
+    uint64_t delay_ms = cmd->acked ? RESULT_POLL_MS : RETRY_INITIAL_MS;
+    for (unsigned int i = 0; i < cmd->retries && delay_ms < RETRY_MAX_MS; i++) delay_ms *= 2;
+    if (delay_ms > RETRY_MAX_MS) delay_ms = RETRY_MAX_MS;
+
+    cmd->serial++;
+    if (retry_push(&retries, monotonic_us() + delay_ms * 1000, cmd->id, cmd->serial) < 0) {
+        fprintf(stderr, "Out of memory: command %u will not be retransmitted\n", cmd->id);
+    }
+}
+
+/*
+ * Fonction release_command()
+ * --------------------------
+ * Retire une commande terminée (ou abandonnée) de la table des commandes
+ * en cours, et de la part de son locataire. Son échéance éventuelle sera
+ * ignorée.
+ */
+void release_command(InflightCmd *cmd) {
+    fair_on_release(&fairshare, cmd->tenant);
+    slab_release(&frame_slab, cmd->frame, cmd->frame_len);
+    inflight_remove(&inflight, cmd);
+}
+
+/*
+ * Fonction client_of()
+ * --------------------
+ * Retourne:
+ *   La connexion cliente d'origine d'une commande, ou NULL si le client
+ *   s'est déconnecté entre-temps
+ */
+ClientConn *client_of(const InflightCmd *cmd) {
+    ClientConn *client = &clients[cmd->client_idx];
+    if (client->gen != cmd->client_gen || client->state == CLIENT_FREE
+        || client->state == CLIENT_CLOSING) {
+        return NULL;
+    }
+    return client;
+}
+
+/*
+ * Fonction steal_command()
+ * ------------------------
+ * Vol de travail: l'esclave thief n'a plus rien en file et peut recevoir
+ * une commande. La commande la plus récente (arrière de la file) de
+ * l'esclave ayant la plus longue file lui est réattribuée.
+ *
+ * Retourne:
+ *   1 si une commande a été volée (identifiant dans id), 0 sinon
+ */
+int steal_command(SlaveServer *thief, uint32_t *id) {
+    if (queued_commands == 0) return 0;
+
+    SlaveServer *victim = NULL;
+    for (int i = 0; i < num_slaves; i++) {
+        if (slaves[i] != thief && (!victim || slaves[i]->queue.len > victim->queue.len)) {
+            victim = slaves[i];
+        }
+    }
+    if (!victim || !deque_pop_back(&victim->queue, id)) return 0;
+
+    InflightCmd *cmd = inflight_find(&inflight, *id);
+    if (cmd) {
+        cmd->slave_idx = thief->idx;
+        sched_on_lost(&scheduler, victim->idx);
+        sched_on_dispatch(&scheduler, thief->idx);
+    }
+    thief->stolen++;
+    log_debug("Commande %u volée à %s:%d par %s:%d",
+              *id, victim->hostname, victim->port, thief->hostname, thief->port);
+    return 1;
+}
+
+/*
+ * Fonction pump_slave()
+ * ---------------------
+ * Envoie à l'esclave les commandes de sa file tant qu'il en a moins de
+ * capacity + slave_prefetch en cours: il ne reçoit jamais beaucoup plus
+ * de travail qu'il ne peut en exécuter, le reste attend chez le maître
+ * où il peut encore être volé. Sa file vide, l'esclave vole le travail
+ * des autres (steal_command()). Appelée à chaque fois que l'esclave
+ * annonce de la place (résultat, battement de cœur) et à chaque ajout
+ * dans sa file.
+ *
+ * Retourne:
+ *   1 si la file d'envoi de l'esclave est pleine alors que des commandes
+ *   attendent (réessayer au prochain tour), 0 sinon
+ */
+int pump_slave(SlaveServer *slave) {
+    SlaveLoad *load = &scheduler.loads[slave->idx];
+    if (!load->available) return 0;
+
+    while (slave->sent < load->capacity + slave_prefetch) {
+        uint32_t id;
+        if (!deque_pop_front(&slave->queue, &id) && !steal_command(slave, &id)) break;
+
+        InflightCmd *cmd = inflight_find(&inflight, id);
+        if (!cmd || !cmd->queued) continue;  /* Entrée périmée */
+
+        uint8_t *frame = sender_reserve(&slave->sender, cmd->frame_len);
+        if (!frame) {
+            deque_push_front(&slave->queue, id);  /* Place libérée par le retrait */
+            return 1;
+        }
+        memcpy(frame, cmd->frame, cmd->frame_len);
+        sender_commit(&slave->sender);
+
+        log_debug("Commande envoyée à %s:%d", slave->hostname, slave->port);
+        ClientConn *client = client_of(cmd);
+        if (client) journal_job(client, JOURNAL_DISPATCH, cmd->seq, 0, NULL, 0);
+        cmd->queued = 0;
+        cmd->sent_us = monotonic_us();
+        metrics_record(&stats.queue_wait, cmd->sent_us - cmd->queued_us);
+        stats.sent++;
+        slave->sent++;
+        queued_commands--;
+        schedule_retry(cmd);
+    }
+    return 0;
+}
+
+/*
+ * Fonction pump_blocked_slaves()
+ * ------------------------------
+ * Reprend l'envoi vers les esclaves dont la file d'envoi était pleine.
+ *
+ * Retourne:
+ *   Nombre d'esclaves encore bloqués
+ */
+int pump_blocked_slaves(void) {
+    int blocked = 0;
+    for (int i = 0; i < num_slaves; i++) {
+        if (slaves[i]->pump_blocked) {
+            slaves[i]->pump_blocked = pump_slave(slaves[i]);
+            blocked += slaves[i]->pump_blocked;
+        }
+    }
+    return blocked;
+}
+
+/*
+ * Fonction wake_slave()
+ * ---------------------
+ * De la place s'est libérée chez l'esclave: envoi de sa file, ou vol.
+ */
+void wake_slave(SlaveServer *slave) {
+    if (pump_slave(slave) && !slave->pump_blocked) {
+        slave->pump_blocked = 1;
+        pumps_blocked++;
+    }
+}
+
+/*
+ * Fonction forward_result()
+ * -------------------------
+ * Transmet au client d'origine la trame MSG_RESULT d'une commande, dont
+ * l'identifiant est le rang de la commande dans le fichier du client
+ * (1, 2, ...) et le message éventuel celui de l'esclave (à défaut, le
+ * dépassement de l'échéance du fichier).
+ * Le résultat est ignoré si le client s'est déconnecté entre-temps.
+ */
+void forward_result(Reactor *reactor, const InflightCmd *cmd, const ProtoResult *result) {
+    ClientConn *client = client_of(cmd);
+    if (!client) return;
+
+    client->done_count++;
+    if (result->return_code != 0) client->failed_count++;
+    journal_job(client, JOURNAL_DONE, cmd->seq, result->return_code, NULL, 0);
+    if (client->detached) {
+        log_debug("Travail %u repris, commande %u terminée: code=%d",
+                  client->job, cmd->seq, (int)result->return_code);
+    }
+
+    /* Les commandes qui en dépendent peuvent partir, ou échouent à leur tour */
+    dag_complete(&client->dag, cmd->dag_node, result->return_code == 0);
+
+    ProtoResult record = *result;
+    record.capacity = 0;
+    record.free_slots = 0;
+    if (record.message_len > 256) record.message_len = 256;
+
+    /* Résultat obtenu après l'échéance du fichier: signalé au client */
+    char late[64];
+    uint64_t now = monotonic_us();
+    if (client->deadline_us && now > client->deadline_us) {
+        client->late_count++;
+        stats.late++;
+        if (record.message_len == 0) {
+            record.message_len = (size_t)snprintf(late, sizeof(late), "Échéance dépassée de %.1f ms",
+                                                  (double)(now - client->deadline_us) / 1000.0);
+            record.message = late;
+        }
+    }
+
+    uint8_t frame[PROTO_HEADER_SIZE + 16 + 256];
+    size_t len = proto_encode_result(frame, sizeof(frame), cmd->seq, &record);
+    if (queue_client_output(reactor, client, frame, len) < 0) return;
+
+    finish_client_if_done(reactor, client);
+}
+
+/*
+ * Fonction fail_command()
+ * -----------------------
+ * Signale au client l'échec d'une commande du fichier qui ne sera pas
+ * exécutée (ligne de dépendances invalide, ou dépendance en échec).
+ *
+ * Paramètres:
+ *   reactor - Boucle d'événements
+ *   client - Connexion client
+ *   seq - Rang de la commande dans le fichier
+ *   dag_node - Identifiant déclaré par la commande (-1 = aucun), en échec
+ *              à son tour
+ *   message - Motif de l'échec
+ */
+void fail_command(Reactor *reactor, ClientConn *client, unsigned int seq, int dag_node,
+                  const char *message) {
+    log_debug("Commande %u non exécutée: %s", seq, message);
+
+    InflightCmd skipped;
+    memset(&skipped, 0, sizeof(skipped));
+    skipped.client_idx = (int)(client - clients);
+    skipped.client_gen = client->gen;
+    skipped.seq = seq;
+    skipped.dag_node = dag_node;
+
+    ProtoResult failed;
+    memset(&failed, 0, sizeof(failed));
+    failed.return_code = -1;
+    failed.message = message;
+    failed.message_len = strlen(message);
+    forward_result(reactor, &skipped, &failed);
+}
+
+/* ============================================================================
+ * CACHE DES RÉSULTATS
+ * ============================================================================ */
+
+/*
+ * Fonction deliver_cached_result()
+ * --------------------------------
+ * Transmet à une commande en attente (ou servie par le cache) la sortie
+ * conservée puis le résultat d'une commande identique, sans passer par un
+ * esclave.
+ *
+ * Paramètres:
+ *   reactor - Boucle d'événements
+ *   entry - Entrée du cache (sortie conservée)
+ *   waiter - Commande destinataire
+ *   result - Résultat à transmettre
+ */
+void deliver_cached_result(Reactor *reactor, const CacheEntry *entry, const CacheWaiter *waiter,
+                           const ProtoResult *result) {
+    InflightCmd served;
+    memset(&served, 0, sizeof(served));
+    served.client_idx = waiter->client_idx;
+    served.client_gen = waiter->client_gen;
+    served.seq = waiter->seq;
+    served.dag_node = waiter->dag_node;
+
+    ClientConn *client = client_of(&served);
+    uint16_t stream;
+    const uint8_t *data;
+    size_t len;
+    size_t offset = 0;
+    uint32_t chunk = 0;
+    while (client && (offset = cache_output_chunk(entry, offset, &stream, &data, &len)) != 0) {
+        ProtoOutput output;
+        output.stream = stream;
+        output.seq = chunk++;
+        output.data = data;
+        output.data_len = len;
+
+        uint8_t frame[PROTO_MAX_FRAME];
+        size_t frame_len = proto_encode_output(frame, sizeof(frame), served.seq, &output);
+        if (frame_len && queue_client_output(reactor, client, frame, frame_len) < 0) return;
+    }
+    forward_result(reactor, &served, result);
+}
+
+/*
+ * Fonction serve_from_cache()
+ * ---------------------------
+ * Commande "cache:" dont le résultat est en cache, ou en cours de calcul
+ * pour une commande identique.
+ *
+ * Retourne:
+ *   1 si la commande est servie (ou attend le résultat), 0 en cas
+ *   d'erreur d'allocation
+ */
+int serve_from_cache(Reactor *reactor, CacheEntry *entry, ClientConn *client, unsigned int seq,
+                     int dag_node) {
+    CacheWaiter waiter;
+    waiter.client_idx = (int)(client - clients);
+    waiter.client_gen = client->gen;
+    waiter.seq = seq;
+    waiter.dag_node = dag_node;
+
+    if (entry->state == CACHE_PENDING) {
+        log_debug("Commande %u: même commande en cours, résultat partagé", seq);
+        return cache_add_waiter(entry, &waiter) == 0;
+    }
+
+    log_debug("Commande %u servie par le cache", seq);
+    const char *note = "Résultat en cache";
+    ProtoResult result;
+    memset(&result, 0, sizeof(result));
+    result.return_code = entry->code;
+    result.duration_us = 0;
+    result.message = entry->message_len ? entry->message : note;
+    result.message_len = entry->message_len ? entry->message_len : strlen(note);
+    deliver_cached_result(reactor, entry, &waiter, &result);
+    return 1;
+}
+
+/*
+ * Fonction settle_cached_command()
+ * --------------------------------
+ * Une commande "cache:" est terminée: les commandes identiques en attente
+ * reçoivent son résultat, qui est conservé s'il vient de l'esclave sans
+ * anomalie (keep) et que sa sortie est complète.
+ */
+void settle_cached_command(Reactor *reactor, const InflightCmd *cmd, const ProtoResult *result,
+                           int keep) {
+    CacheEntry *entry = cmd->cache;
+    if (!entry) return;
+
+    for (int i = 0; i < entry->num_waiters; i++) {
+        deliver_cached_result(reactor, entry, &entry->waiters[i], result);
+    }
+    cache_complete(&result_cache, entry, result->return_code, result->duration_us,
+                   result->message, result->message_len, keep && result->message_len == 0,
+                   monotonic_us());
+}
+
+/*
+ * Fonction send_command()
+ * -----------------------
+ * Attribue une commande à l'esclave choisi par l'ordonnanceur:
+ * elle est enregistrée dans la table des commandes en cours et placée à
+ * l'arrière de la file de l'esclave, d'où pump_slave() l'envoie dès que
+ * l'esclave a de la place (ou d'où un esclave inactif la vole). Le
+ * datagramme part lorsqu'il est plein, à l'échéance du délai de vidage,
+ * ou dès que le maître n'a plus rien à distribuer (voir
+ * flush_slave_senders()).
+ *
+ * Une commande "cache:" (voir cache.h) dont le résultat est en cache, ou
+ * en cours de calcul, n'est pas distribuée; une commande dont le fichier a
+ * dépassé son échéance est abandonnée (échec signalé au client).
+ *
+ * Paramètres:
+ *   reactor - Boucle d'événements
+ *   client - Connexion client
+ *   line - Commande
+ *   seq - Rang de la commande dans le fichier
+ *   dag_node - Identifiant déclaré par la commande (-1 = aucun)
+ *
+ * Retourne:
+ *   1 si la commande a été mise en file (ou servie par le cache),
+ *   0 en cas d'erreur d'allocation (réessayer plus tard),
+ *   -1 si aucun esclave n'est disponible ou si la file choisie est pleine
+ *   (attendre un battement de cœur ou un résultat)
+ */
+int send_command(Reactor *reactor, ClientConn *client, const char *line, unsigned int seq,
+                 int dag_node) {
+    /*
+     * Cache des résultats
+     * -------------------
+     * Le préfixe "cache:" est retiré de la commande; sans --cache, elle
+     * s'exécute simplement.
+     */
+    const char *fingerprint = NULL;
+    size_t fingerprint_len = 0;
+    const char *cached = cache_parse(line, &fingerprint, &fingerprint_len);
+    if (cached) {
+        line = cached;
+        if (cache_enabled) {
+            CacheEntry *entry = cache_lookup(&result_cache, line, fingerprint, fingerprint_len,
+                                             monotonic_us());
+            if (entry) return serve_from_cache(reactor, entry, client, seq, dag_node);
+        }
+    }
+
+    /* Échéance du fichier dépassée: la commande ne peut plus la tenir */
+    if (client->deadline_us && monotonic_us() >= client->deadline_us) {
+        stats.expired++;
+        fail_command(reactor, client, seq, dag_node, "Erreur: échéance dépassée, commande abandonnée");
+        return 1;
+    }
+
+    /*
+     * Choix de l'esclave
+     * ------------------
+     * L'ordonnanceur applique la politique configurée (--policy) à partir
+     * des commandes en cours (envoyées ou en file) et de la latence
+     * observée de chaque esclave.
+     */
+    int slave_idx = sched_pick(&scheduler);
+    if (slave_idx < 0) {
+        return -1;  /* La ligne attend qu'un esclave soit de nouveau disponible */
+    }
+    SlaveServer *slave = slaves[slave_idx];
+    if (slave->queue.len >= SLAVE_QUEUE_MAX) {
+        return -1;  /* Travail en attente suffisant: la ligne attend un résultat */
+    }
+
+    /*
+     * Préparation de la requête de commande
+     * -------------------------------------
+     * Trame MSG_COMMAND: seuls les octets utiles de la commande sont
+     * transmis, avec l'adresse du client pour la traçabilité. Elle est
+     * conservée avec la commande: envoyée depuis la file de l'esclave,
+     * puis retransmise si l'esclave ne l'acquitte pas, ou ne renvoie pas
+     * son résultat, à temps.
+     */
+    ProtoCommand req;
+    req.origin_ip = client->ip;
+    req.origin_port = (uint16_t)client->port;
+    req.command = line;
+    req.command_len = strlen(line);
+
+    size_t frame_len = PROTO_HEADER_SIZE + 6 + req.command_len;
+    uint8_t *frame = slab_alloc(&frame_slab, frame_len);
+    InflightCmd *cmd = frame ? inflight_insert(&inflight, next_command_id) : NULL;
+    if (!cmd) {
+        fprintf(stderr, "Out of memory: command postponed\n");
+        slab_release(&frame_slab, frame, frame_len);
+        return 0;
+    }
+    proto_encode_command(frame, frame_len, next_command_id, &req);
+    cmd->slave_idx = slave_idx;
+    cmd->client_idx = (int)(client - clients);
+    cmd->client_gen = client->gen;
+    cmd->seq = seq;
+    cmd->dag_node = dag_node;
+    cmd->cache = NULL;
+    cmd->tenant = -1;
+    cmd->frame = frame;
+    cmd->frame_len = frame_len;
+    cmd->queued = 1;
+    cmd->queued_us = monotonic_us();
+
+    if (deque_push_back(&slave->queue, cmd->id) < 0) {
+        fprintf(stderr, "Out of memory: command postponed\n");
+        release_command(cmd);
+        return 0;
+    }
+    queued_commands++;
+    cmd->tenant = client->tenant;
+    fair_on_dispatch(&fairshare, cmd->tenant);
+    if (cached && cache_enabled) {
+        cmd->cache = cache_begin(&result_cache, line, fingerprint, fingerprint_len);
+    }
+    sched_on_dispatch(&scheduler, slave_idx);
+    stats.dispatched++;
+    wake_slave(slave);
+
+    if (++next_command_id == 0) next_command_id = 1;
+    return 1;
+}
+
+/*
+ * Fonction next_client_line()
+ * ---------------------------
+ * Repère la prochaine ligne complète dans le texte reçu du client. La
+ * dernière ligne du fichier n'a pas forcément de '\n': elle n'est complète
+ * qu'une fois MSG_END reçu. La recherche du '\n' (memchr, vectorisé par la
+ * bibliothèque C) reprend là où la précédente s'est arrêtée: une longue
+ * ligne reçue en plusieurs morceaux n'est parcourue qu'une fois.
+ *
+ * Paramètres:
+ *   client - Connexion client
+ *   line_len - Longueur de la ligne, sans le '\n'
+ *
+ * Retourne:
+ *   Nombre d'octets à consommer pour cette ligne (> 0), ou 0 si aucune
+ *   ligne complète n'est encore disponible
+ */
+size_t next_client_line(ClientConn *client, size_t *line_len) {
+    const char *start = client->text + client->text_off;
+    size_t avail = client->text_len - client->text_off;
+    size_t scanned = client->text_scan > client->text_off ? client->text_scan - client->text_off : 0;
+
+    const char *nl = memchr(start + scanned, '\n', avail - scanned);
+    if (nl) {
+        *line_len = (size_t)(nl - start);
+        return *line_len + 1;
+    }
+    client->text_scan = client->text_len;
+    if (!client->upload_done) return 0;
+    *line_len = avail;
+    return avail;
+}
+
+/*
+ * Fonction skip_finished_command()
+ * --------------------------------
+ * Travail repris du journal: une commande déjà terminée avant l'arrêt du
+ * maître n'est pas relancée, son résultat consigné est compté tel quel.
+ *
+ * Retourne:
+ *   1 si la commande est déjà terminée, 0 si elle est à exécuter
+ */
+int skip_finished_command(ClientConn *client, unsigned int seq, int dag_node) {
+    if (seq >= client->finished_len) return 0;
+
+    uint8_t state = client->finished[seq];
+    if (state != JOB_CMD_OK && state != JOB_CMD_FAILED) return 0;
+
+    client->done_count++;
+    if (state == JOB_CMD_FAILED) client->failed_count++;
+    dag_complete(&client->dag, dag_node, state == JOB_CMD_OK);
+    return 1;
+}
+
+/*
+ * Fonction reject_long_line()
+ * ---------------------------
+ * Une ligne du fichier dépasse MAX_CMD_LEN: elle ne tient pas dans un
+ * datagramme et n'est pas exécutée. Elle garde néanmoins son rang, et le
+ * client reçoit son résultat en échec: la numérotation des commandes
+ * reste celle des lignes du fichier.
+ *
+ * Retourne:
+ *   0 si le client est toujours en distribution, -1 s'il a été fermé
+ */
+int reject_long_line(Reactor *reactor, ClientConn *client) {
+    unsigned int seq = (unsigned int)client->cmd_count + 1;
+    client->cmd_count++;
+    if (skip_finished_command(client, seq, -1)) return 0;
+
+    log_warn("Commande %u du client %s:%d trop longue (plus de %d octets): rejetée",
+             seq, client->addr, client->port, MAX_CMD_LEN);
+    char message[96];
+    snprintf(message, sizeof(message), "Erreur: commande trop longue (plus de %d octets)",
+             MAX_CMD_LEN);
+    fail_command(reactor, client, seq, -1, message);
+    return client->state == CLIENT_DISPATCHING ? 0 : -1;
+}
+
+/*
+ * Fonction dispatch_ready_command()
+ * ---------------------------------
+ * Distribue une commande dont les dépendances sont terminées, ou la
+ * signale en échec si l'une d'elles a échoué.
+ *
+ * Retourne:
+ *   Voir send_command() (1 si la commande peut sortir de la file des
+ *   commandes prêtes)
+ */
+int dispatch_ready_command(Reactor *reactor, ClientConn *client, const DagReady *ready) {
+    if (skip_finished_command(client, ready->seq, ready->node)) return 1;
+    if (ready->failed_dep) {
+        char message[DAG_MAX_NAME + 64];
+        snprintf(message, sizeof(message), "Erreur: dépendance en échec: %s", ready->failed_dep);
+        fail_command(reactor, client, ready->seq, ready->node, message);
+        return 1;
+    }
+
+    log_debug("Dépendances terminées, commande %u: %s", ready->seq, ready->command);
+    return send_command(reactor, client, ready->command, ready->seq, ready->node);
+}
+
+/*
+ * Fonction dispatch_client_batch()
+ * --------------------------------
+ * Distribue au plus DISPATCH_BATCH lignes complètes déjà reçues du client,
+ * sans attendre la fin du fichier. Limiter le lot permet de faire
+ * progresser tous les clients à tour de rôle et de revenir rapidement à
+ * la boucle d'événements. Les commandes dont les dépendances viennent de
+ * se terminer passent avant les lignes suivantes du fichier.
+ *
+ * La distribution s'arrête aussi lorsque la file du maître est pleine
+ * (dispatch_window) ou que le locataire du client a atteint
+ * --client-running commandes: elle reprend au retour d'un résultat.
+ *
+ * Retourne:
+ *   1 s'il reste des commandes distribuables immédiatement (lot atteint ou
+ *   esclave saturé), 0 si le client attend la suite du fichier, un esclave
+ *   disponible, une place, ou a fini
+ */
+int dispatch_client_batch(Reactor *reactor, ClientConn *client) {
+    size_t line_len;
+    int consumed = 0;
+    int ready = 0;
+    int i;
+
+    for (i = 0; i < DISPATCH_BATCH; i++) {
+        if (queued_commands >= dispatch_window || !fair_may_dispatch(&fairshare, client->tenant)) {
+            break;
+        }
+
+        DagReady dag_ready;
+        if (dag_peek_ready(&client->dag, &dag_ready)) {
+            int sent = dispatch_ready_command(reactor, client, &dag_ready);
+            if (client->state != CLIENT_DISPATCHING) return 0;  /* Client fermé (erreur d'envoi) */
+            if (sent == 0) {
+                ready = 1;
+                break;
+            }
+            if (sent < 0) break;
+            dag_pop_ready(&client->dag);
+            continue;
+        }
+
+        size_t step = next_client_line(client, &line_len);
+        if (step == 0) {
+            if (!client->upload_done) {
+                /* Ligne incomplète: attente de la suite, sauf si elle est déjà trop longue */
+                if (client->text_len - client->text_off > MAX_CMD_LEN) {
+                    if (!client->skip_line && reject_long_line(reactor, client) < 0) return 0;
+                    client->skip_line = 1;
+                    client->text_off = client->text_len;
+                    consumed = 1;
+                }
+                break;
+            }
+
+            /* Fin du fichier: attente des commandes retenues par leurs dépendances */
+            if (client->dag.pending > 0) break;
+
+            /* Puis des résultats restants */
+            log_debug("%d commandes distribuées pour le client %s:%d",
+                      client->cmd_count, client->addr, client->port);
+            free(client->text);
+            client->text = NULL;
+            leave_dispatching(client);
+            client->state = CLIENT_DRAINING;
+            finish_client_if_done(reactor, client);
+            return 0;
+        }
+
+        /* Fin d'une ligne trop longue (déjà rejetée), ou ligne vide: ignorée */
+        if (client->skip_line || line_len == 0) {
+            client->skip_line = 0;
+            client->text_off += step;
+            consumed = 1;
+            continue;
+        }
+        if (line_len > MAX_CMD_LEN) {
+            client->text_off += step;
+            consumed = 1;
+            if (reject_long_line(reactor, client) < 0) return 0;
+            continue;
+        }
+
+        /*
+         * Ligne en place
+         * --------------
+         * La commande n'est pas recopiée: son '\n' (ou l'octet qui suit la
+         * dernière ligne) est remplacé par la fin de chaîne le temps de la
+         * distribuer, et rétabli si la ligne reste dans le tampon.
+         */
+        char *line = client->text + client->text_off;
+        char line_end = line[line_len];
+        line[line_len] = '\0';
+
+        /*
+         * Dépendances
+         * -----------
+         * Une ligne avec préfixe (@id, after:) est retenue par le graphe du
+         * fichier: elle repasse par la file des commandes prêtes une fois
+         * ses dépendances terminées, peut-être dès le tour suivant.
+         */
+        unsigned int seq = (unsigned int)client->cmd_count + 1;
+        char error[DAG_MAX_NAME + 64];
+        DagVerdict verdict = dag_submit(&client->dag, seq, line, error, sizeof(error));
+        int finished = verdict != DAG_WAIT && skip_finished_command(client, seq, -1);
+        if (!finished) log_debug("Traitement commande: %s", line);
+        if (verdict == DAG_RUN && !finished) {
+            /* Mémoire, file de l'esclave pleine ou aucun esclave: la ligne reste dans le tampon */
+            int sent = send_command(reactor, client, line, seq, -1);
+            if (client->state != CLIENT_DISPATCHING) return 0;  /* Client fermé (servi par le cache) */
+            if (sent <= 0) {
+                line[line_len] = line_end;
+                if (sent == 0) ready = 1;
+                break;
+            }
+        }
+        client->cmd_count++;
+        client->text_off += step;
+        consumed = 1;
+        if (verdict == DAG_REJECT && !finished) {
+            fail_command(reactor, client, seq, -1, error);
+            if (client->state != CLIENT_DISPATCHING) return 0;
+        }
+    }
+    if (i == DISPATCH_BATCH) ready = 1;
+
+    /* De la place s'est libérée: reprise des trames MSG_DATA en attente */
+    if (consumed && client->read_paused) {
+        process_client_input(reactor, client);
+    }
+    return ready;
+}
+
+/* Temps virtuel du locataire d'un client (voir fairshare.h) */
+uint64_t client_vtime(const ClientConn *client) {
+    return client->tenant >= 0 ? fairshare.tenants[client->tenant].vtime : fairshare.vclock;
+}
+
+/*
+ * Fonction serve_before()
+ * -----------------------
+ * Ordre de service des clients: priorité la plus élevée, puis échéance la
+ * plus proche (EDF, un fichier sans échéance passe après), puis locataire
+ * le moins servi.
+ *
+ * Retourne:
+ *   1 si a doit être servi avant b
+ */
+int serve_before(const ClientConn *a, const ClientConn *b) {
+    if (a->priority != b->priority) return a->priority > b->priority;
+    if (a->deadline_us != b->deadline_us) {
+        if (!a->deadline_us || !b->deadline_us) return a->deadline_us != 0;
+        return a->deadline_us < b->deadline_us;
+    }
+    return client_vtime(a) < client_vtime(b);
+}
+
+/*
+ * Fonction dispatch_pending_clients()
+ * -----------------------------------
+ * Fait avancer d'un lot chaque client en phase de distribution.
+ *
+ * Partage équitable
+ * -----------------
+ * Les commandes attendent dans le fichier de leur client tant que la
+ * file du maître est pleine: elle n'admet que DISPATCH_BACKLOG commandes
+ * par worker disponible, de quoi occuper les esclaves d'ici au tour
+ * suivant. Chaque place libérée va au fichier le plus prioritaire, puis à
+ * l'échéance la plus proche, puis au client dont le locataire (adresse
+ * IP) a le moins reçu, au prorata de son poids (voir serve_before()); à
+ * égalité, les clients passent à tour de rôle. Une petite soumission
+ * n'attend donc pas la fin d'un gros fichier d'un autre client.
+ *
+ * Retourne:
+ *   Nombre de clients ayant encore des commandes prêtes à distribuer
+ */
+int dispatch_pending_clients(Reactor *reactor) {
+    dispatch_window = 0;
+    for (int i = 0; i < num_slaves; i++) {
+        const SlaveLoad *load = &scheduler.loads[i];
+        if (load->available) dispatch_window += (size_t)load->capacity * DISPATCH_BACKLOG;
+    }
+
+    /* Clients à servir, à partir du curseur, dans l'ordre de service (tri stable) */
+    int order[MAX_CLIENTS];
+    int n = 0;
+    for (int k = 0; k < MAX_CLIENTS && n < num_dispatching; k++) {
+        int i = (dispatch_cursor + k) % MAX_CLIENTS;
+        if (clients[i].state != CLIENT_DISPATCHING) continue;
+
+        int pos = n++;
+        while (pos > 0 && serve_before(&clients[i], &clients[order[pos - 1]])) {
+            order[pos] = order[pos - 1];
+            pos--;
+        }
+        order[pos] = i;
+    }
+    if (n > 0) dispatch_cursor = (order[0] + 1) % MAX_CLIENTS;
+
+    int ready = 0;
+    for (int k = 0; k < n; k++) {
+        if (clients[order[k]].state == CLIENT_DISPATCHING) {
+            ready += dispatch_client_batch(reactor, &clients[order[k]]);
+        }
+    }
+    return ready;
+}
+
+/*
+ * Fonction handle_slave_output()
+ * ------------------------------
+ * Traite un morceau de sortie d'une commande. Le morceau attendu est
+ * retransmis au client (id = rang de la commande) puis acquitté; un
+ * morceau hors séquence est ignoré (l'esclave renverra la suite). Tant
+ * que le client n'a pas absorbé CLIENT_OUT_MAX octets, la sortie est
+ * retenue chez l'esclave: l'acquittement n'avance pas, ce qui suspend la
+ * commande sans consommer de mémoire dans le maître.
+ * L'acquittement passe par le thread d'envoi de l'esclave.
+ */
+void handle_slave_output(Reactor *reactor, SlaveServer *slave, const ProtoFrame *frame,
+                         const ProtoOutput *output) {
+    InflightCmd *cmd = inflight_find(&inflight, frame->id);
+    uint32_t next;
+
+    if (!cmd) {
+        next = output->seq + 1;  /* Commande abandonnée: sortie acquittée et ignorée */
+    } else {
+        cmd->misses = 0;
+        if (output->seq == cmd->out_next) {
+            ClientConn *client = client_of(cmd);
+            if (!client) {
+                cmd->out_next++;  /* Client parti: sortie ignorée */
+            } else if (client->out_len < CLIENT_OUT_MAX) {
+                ProtoOutput record = *output;
+                uint8_t out_frame[PROTO_MAX_FRAME];
+                size_t len = proto_encode_output(out_frame, sizeof(out_frame), cmd->seq, &record);
+                cmd->out_next++;
+                if (len) queue_client_output(reactor, client, out_frame, len);
+            }
+
+            /* Morceau accepté: conservé avec le résultat (cache) */
+            if (cmd->cache && cmd->out_next == output->seq + 1) {
+                cache_append_output(cmd->cache, output->stream, output->data, output->data_len);
+            }
+        }
+        next = cmd->out_next;
+    }
+
+    uint8_t *ack = sender_reserve(&slave->sender, PROTO_HEADER_SIZE + 4);
+    if (!ack) return;  /* File pleine: l'esclave retransmettra */
+    proto_encode_output_ack(ack, PROTO_HEADER_SIZE + 4, frame->id, next);
+    sender_commit(&slave->sender);
+}
+
+/*
+ * Fonction handle_slave_result()
+ * ------------------------------
+ * Traite le résultat d'une commande: il libère une place chez l'esclave,
+ * met à jour sa latence lissée et est retransmis immédiatement au client
+ * qui a soumis la commande. Un doublon (résultat déjà reçu, renvoyé suite
+ * à une retransmission) est ignoré.
+ */
+void handle_slave_result(Reactor *reactor, SlaveServer *slave, const ProtoFrame *frame,
+                         const ProtoResult *result) {
+    log_debug("Résultat de %s:%d: code=%d%s%.*s",
+              slave->hostname, slave->port, result->return_code,
+              result->message_len ? ", " : "", (int)result->message_len, result->message);
+
+    /* Capacité annoncée par l'esclave (nombre de workers) */
+    sched_on_capacity(&scheduler, slave->idx, result->capacity, result->free_slots);
+
+    InflightCmd *cmd = inflight_find(&inflight, frame->id);
+    if (!cmd) return;  /* Résultat inconnu ou déjà reçu */
+
+    uint64_t round_trip_us = monotonic_us() - cmd->sent_us;
+    sched_on_result(&scheduler, cmd->slave_idx, (double)round_trip_us / 1000.0);
+    stats.results++;
+    metrics_record(&stats.exec, result->duration_us);
+    if (!cmd->queued) metrics_record(&stats.round_trip, round_trip_us);
+
+    /* Une commande remise en file peut encore aboutir chez l'ancien esclave */
+    SlaveServer *owner = slaves[cmd->slave_idx];
+    if (cmd->queued) {
+        queued_commands--;  /* Son entrée dans la file est désormais périmée */
+    } else {
+        owner->sent--;
+    }
+
+    InflightCmd done = *cmd;
+    release_command(cmd);
+    settle_cached_command(reactor, &done, result, 1);
+    forward_result(reactor, &done, result);
+
+    /* Une place s'est libérée: commande suivante de la file, ou vol */
+    wake_slave(owner);
+}
+
+/*
+ * Fonction handle_slave_ack()
+ * ---------------------------
+ * L'esclave a reçu la commande: plus besoin de la retransmettre
+ * rapidement, seul son résultat est désormais attendu.
+ */
+void handle_slave_ack(const ProtoFrame *frame) {
+    InflightCmd *cmd = inflight_find(&inflight, frame->id);
+    if (!cmd) return;  /* Acquittement tardif d'une commande terminée */
+
+    cmd->misses = 0;
+    if (!cmd->acked) {
+        cmd->acked = 1;
+        cmd->retries = 0;
+        schedule_retry(cmd);
+    }
+}
+
+/*
+ * Fonction requeue_slave_queue()
+ * ------------------------------
+ * Les commandes de la file d'un esclave qui n'en reçoit plus (pas encore
+ * envoyées) rejoignent celles des esclaves disponibles.
+ *
+ * Retourne:
+ *   Nombre de commandes redistribuées
+ */
+int requeue_slave_queue(int slave_idx) {
+    SlaveServer *slave = slaves[slave_idx];
+    int moved = 0;
+
+    uint32_t id;
+    while (deque_pop_front(&slave->queue, &id)) {
+        int target = sched_pick(&scheduler);
+        if (target < 0 || deque_push_back(&slaves[target]->queue, id) < 0) {
+            deque_push_front(&slave->queue, id);  /* Volée plus tard par un esclave inactif */
+            break;
+        }
+        InflightCmd *cmd = inflight_find(&inflight, id);
+        if (!cmd) continue;
+        sched_on_lost(&scheduler, slave_idx);
+        sched_on_dispatch(&scheduler, target);
+        cmd->slave_idx = target;
+        moved++;
+    }
+
+    for (int i = 0; moved > 0 && i < num_slaves; i++) {
+        wake_slave(slaves[i]);
+    }
+    return moved;
+}
+
+/*
+ * Fonction reassign_commands()
+ * ----------------------------
+ * Redistribue aux esclaves disponibles le travail d'un esclave écarté,
+ * sans attendre l'épuisement des retransmissions:
+ *   - ses commandes envoyées repassent à l'avant de la file d'un autre
+ *     esclave. Une commande acquittée a pu commencer chez l'esclave
+ *     disparu: elle est relancée ailleurs (exécution au moins une fois).
+ *     Une commande dont la sortie a déjà été transmise au client reste à
+ *     son esclave;
+ *   - les commandes de sa file rejoignent celles des autres esclaves
+ *     (requeue_slave_queue()).
+ *
+ * Retourne:
+ *   Nombre de commandes redistribuées
+ */
+int reassign_commands(int slave_idx) {
+    SlaveServer *slave = slaves[slave_idx];
+    int moved = 0;
+
+    for (size_t i = 0; i < inflight.capacity; i++) {
+        InflightCmd *cmd = &inflight.slots[i];
+        if (cmd->id == 0 || cmd->slave_idx != slave_idx || cmd->queued) continue;
+        if (cmd->out_next > 0 || !cmd->frame) continue;
+
+        int target = sched_pick(&scheduler);
+        if (target < 0) break;  /* Aucun autre esclave: retransmissions vers l'esclave écarté */
+        if (deque_push_front(&slaves[target]->queue, cmd->id) < 0) break;
+
+        /* L'échéance de retransmission en cours est ignorée (commande en file) */
+        sched_on_lost(&scheduler, slave_idx);
+        sched_on_dispatch(&scheduler, target);
+        slave->sent--;
+        queued_commands++;
+        cmd->queued = 1;
+        cmd->queued_us = monotonic_us();
+        cmd->slave_idx = target;
+        cmd->acked = 0;
+        cmd->retries = 0;
+        cmd->misses = 0;
+        moved++;
+    }
+
+    if (moved > 0) {
+        for (int i = 0; i < num_slaves; i++) wake_slave(slaves[i]);
+    }
+    return moved + requeue_slave_queue(slave_idx);
+}
+
+/*
+ * Fonction mark_slave_alive()
+ * ---------------------------
+ * Une trame vient d'arriver de l'esclave: il est vivant. Un esclave écarté
+ * (ou pas encore entendu) est réintégré dans l'ordonnancement, sauf s'il a
+ * été retiré de la configuration.
+ */
+void mark_slave_alive(SlaveServer *slave) {
+    int idx = slave->idx;
+
+    slave->last_seen_us = monotonic_us();
+    if (scheduler.loads[idx].available || slave->retired) return;
+
+    sched_set_available(&scheduler, idx, 1);
+    log_info("Esclave %s:%d disponible", slave->hostname, slave->port);
+    wake_slave(slave);
+}
+
+/*
+ * Fonction handle_slave_heartbeat()
+ * ---------------------------------
+ * Enregistre l'état de santé annoncé par l'esclave: sa capacité alimente
+ * l'ordonnanceur, sa charge et sa file d'attente sont conservées. Un
+ * esclave qui annonce des workers libres reçoit du travail.
+ */
+void handle_slave_heartbeat(SlaveServer *slave, const ProtoHeartbeat *hb) {
+    slave->health = *hb;
+    sched_on_capacity(&scheduler, slave->idx, hb->capacity, hb->free_slots);
+
+    /* Esclave inactif: il réclame du travail (file, sinon vol) */
+    if (hb->free_slots > 0) wake_slave(slave);
+}
+
+/*
+ * Fonction process_heartbeats()
+ * -----------------------------
+ * Envoie périodiquement une sonde MSG_PING à chaque esclave (y compris
+ * aux esclaves écartés, pour détecter leur retour, mais pas aux esclaves
+ * retirés de la configuration) et écarte ceux qui sont restés muets
+ * pendant HEARTBEAT_MISSES périodes.
+ *
+ * Retourne:
+ *   Délai avant la prochaine série de sondes, en millisecondes
+ */
+int process_heartbeats(void) {
+    uint64_t now = monotonic_us();
+
+    if (now >= next_heartbeat_us) {
+        for (int i = 0; i < num_slaves; i++) {
+            if (slaves[i]->retired) continue;
+            uint8_t *ping = sender_reserve(&slaves[i]->sender, PROTO_HEADER_SIZE);
+            if (!ping) continue;  /* File pleine: l'esclave répondra aux commandes */
+            proto_encode_text(ping, PROTO_HEADER_SIZE, MSG_PING, 0, NULL, 0);
+            sender_commit(&slaves[i]->sender);
+        }
+        next_heartbeat_us = now + (uint64_t)HEARTBEAT_INTERVAL_MS * 1000;
+    }
+
+    for (int i = 0; i < num_slaves; i++) {
+        SlaveServer *slave = slaves[i];
+        if (!scheduler.loads[i].available) continue;
+        if (now - slave->last_seen_us <= (uint64_t)HEARTBEAT_MISSES * HEARTBEAT_INTERVAL_MS * 1000) {
+            continue;
+        }
+
+        sched_set_available(&scheduler, i, 0);
+        int moved = reassign_commands(i);
+        log_warn("Esclave %s:%d muet depuis %llu ms: écarté, %d commandes redistribuées",
+                 slave->hostname, slave->port,
+                 (unsigned long long)((now - slave->last_seen_us) / 1000), moved);
+    }
+
+    return (int)((next_heartbeat_us - now + 999) / 1000);
+}
+
+/*
+ * Fonction handle_slave_datagram()
+ * --------------------------------
+ * Traite un datagramme reçu d'un esclave: acquittements, sorties,
+ * résultats et battements de cœur.
+ */
+void handle_slave_datagram(Reactor *reactor, SlaveServer *slave, const uint8_t *data, size_t len) {
+    /* Un datagramme peut contenir plusieurs trames consécutives */
+    size_t offset = 0;
+    while (offset < len) {
+        ProtoFrame frame;
+        ProtoResult result;
+        ProtoOutput output;
+        ProtoHeartbeat heartbeat;
+        int consumed = proto_decode(data + offset, len - offset, &frame);
+        if (consumed <= 0) {
+            fprintf(stderr, "Invalid frame from slave %s:%d\n", slave->hostname, slave->port);
+            return;  /* Reste du datagramme ignoré */
+        }
+        offset += (size_t)consumed;
+        mark_slave_alive(slave);
+
+        if (frame.type == MSG_ACK) {
+            handle_slave_ack(&frame);
+        } else if (proto_decode_heartbeat(&frame, &heartbeat) == 0) {
+            handle_slave_heartbeat(slave, &heartbeat);
+        } else if (proto_decode_output(&frame, &output) == 0) {
+            handle_slave_output(reactor, slave, &frame, &output);
+        } else if (proto_decode_result(&frame, &result) == 0) {
+            handle_slave_result(reactor, slave, &frame, &result);
+        } else {
+            fprintf(stderr, "Unexpected frame type %d from slave %s:%d\n",
+                    frame.type, slave->hostname, slave->port);
+        }
+    }
+}
+
+/*
+ * Fonction process_retries()
+ * --------------------------
+ * Traite les échéances atteintes: chaque commande restée sans réponse est
+ * retransmise au même esclave (qui ne l'exécutera pas deux fois, voir
+ * dedup.h). Après RETRY_MAX_MISSES retransmissions sans aucune réponse,
+ * la commande est abandonnée et signalée en échec au client.
+ */
+void process_retries(Reactor *reactor) {
+    uint64_t now = monotonic_us();
+    RetryTimer timer;
+
+    while (retry_pop_due(&retries, now, &timer)) {
+        InflightCmd *cmd = inflight_find(&inflight, timer.id);
+        if (!cmd || cmd->serial != timer.serial || cmd->queued) continue;  /* Échéance périmée */
+
+        SlaveServer *slave = slaves[cmd->slave_idx];
+        if (cmd->misses >= RETRY_MAX_MISSES) {
+            log_warn("Commande %u abandonnée: %s:%d ne répond plus",
+                     cmd->id, slave->hostname, slave->port);
+
+            const char *reason = "Erreur: esclave injoignable";
+            ProtoResult lost;
+            memset(&lost, 0, sizeof(lost));
+            lost.return_code = -1;
+            lost.message = reason;
+            lost.message_len = strlen(reason);
+
+            sched_on_lost(&scheduler, cmd->slave_idx);
+            slave->sent--;
+            stats.lost++;
+            InflightCmd done = *cmd;
+            release_command(cmd);
+            settle_cached_command(reactor, &done, &lost, 0);
+            forward_result(reactor, &done, &lost);
+            continue;
+        }
+
+        cmd->misses++;
+        cmd->retries++;
+        stats.retransmits++;
+        uint8_t *frame = sender_reserve(&slave->sender, cmd->frame_len);
+        if (frame) {
+            memcpy(frame, cmd->frame, cmd->frame_len);
+            sender_commit(&slave->sender);
+            log_debug("Retransmission de la commande %u à %s:%d (%s)",
+                      cmd->id, slave->hostname, slave->port, cmd->acked ? "résultat attendu" : "non acquittée");
+        }
+        schedule_retry(cmd);
+    }
+}
+
+/*
+ * Fonction flush_slave_senders()
+ * ------------------------------
+ * Demande à chaque thread d'envoi de vider son lot sans attendre son
+ * échéance: le maître n'a plus rien à distribuer et va attendre, inutile
+ * de retenir une commande isolée.
+ */
+void flush_slave_senders(void) {
+    for (int i = 0; i < num_slaves; i++) {
+        sender_flush(&slaves[i]->sender);
+    }
+}
+
+/*
+ * Fonction on_slave_event()
+ * -------------------------
+ * Rappel de la boucle d'événements pour le socket UDP d'un esclave:
+ * l'esclave a répondu. Toutes les réponses en attente sont lues (par
+ * paquets de BATCH_IO_MAX datagrammes avec recvmmsg), afin que le tampon
+ * de réception UDP ne se remplisse pas. Les envois vers l'esclave sont
+ * faits par son thread d'envoi (sender.c).
+ */
+void on_slave_event(Reactor *reactor, SOCKET sock, int events, void *arg) {
+    SlaveServer *slave = (SlaveServer *)arg;
+    static RecvBatch rb;
+
+    if (!(events & (REACTOR_READ | REACTOR_ERROR))) return;
+
+    int n;
+    while ((n = batch_recv(sock, &rb)) > 0) {
+        for (int i = 0; i < n; i++) {
+            handle_slave_datagram(reactor, slave, rb.bufs[i], rb.lens[i]);
+        }
+        if (n < BATCH_IO_MAX) break;  /* Socket vidé */
+    }
+    /* n < 0: erreur ICMP (esclave injoignable), ignorée */
+}
+
+/* ============================================================================
+ * REGISTRE DES ESCLAVES
+ * ============================================================================ */
+
+/*
+ * Fonction find_slave()
+ * ---------------------
+ * Recherche un esclave connu par son adresse (IP et port).
+ *
+ * Retourne:
+ *   L'esclave, ou NULL s'il est inconnu
+ */
+SlaveServer *find_slave(const struct sockaddr_in *addr) {
+    for (int i = 0; i < num_slaves; i++) {
+        if (slaves[i]->addr.sin_addr.s_addr == addr->sin_addr.s_addr
+            && slaves[i]->addr.sin_port == addr->sin_port) {
+            return slaves[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Fonction add_slave()
+ * --------------------
+ * Ajoute un esclave à la table: création de son socket UDP et de son
+ * thread d'envoi, entrée dans l'ordonnanceur. La table est agrandie par
+ * doublement, sans limite fixée à la compilation. Comme au démarrage,
+ * l'esclave n'est utilisé qu'après sa première réponse à une sonde.
+ *
+ * Paramètres:
+ *   reactor - Boucle d'événements où surveiller son socket (NULL pendant
+ *             le chargement initial: main() l'y ajoute ensuite)
+ *   hostname - Nom affiché de l'esclave
+ *   addr - Adresse résolue de l'esclave
+ *
+ * Retourne:
+ *   L'esclave ajouté, ou NULL en cas d'erreur
+ */
+SlaveServer *add_slave(Reactor *reactor, const char *hostname, const struct sockaddr_in *addr) {
+    if (num_slaves == slaves_cap) {
+        int cap = slaves_cap > 0 ? slaves_cap * 2 : 16;
+        SlaveServer **table = realloc(slaves, (size_t)cap * sizeof(SlaveServer *));
+        if (!table) {
+            fprintf(stderr, "Out of memory: cannot add slave %s\n", hostname);
+            return NULL;
+        }
+        slaves = table;
+        slaves_cap = cap;
+    }
+
+    SlaveServer *slave = calloc(1, sizeof(SlaveServer));
+    if (!slave) {
+        fprintf(stderr, "Out of memory: cannot add slave %s\n", hostname);
+        return NULL;
+    }
+    snprintf(slave->hostname, sizeof(slave->hostname), "%s", hostname);
+    slave->port = ntohs(addr->sin_port);
+    slave->addr = *addr;
+
+    /*
+     * Création du socket UDP pour cet esclave
+     * Chaque esclave a son propre socket pour permettre
+     * l'envoi de commandes en parallèle si nécessaire.
+     */
+    slave->sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (slave->sock == INVALID_SOCKET) {
+        fprintf(stderr, "socket failed: %d\n", WSAGetLastError());
+        free(slave);
+        return NULL;
+    }
+
+    /* Socket non bloquant: il est surveillé par la boucle d'événements */
+    net_set_nonblocking(slave->sock);
+
+    /* Thread d'envoi dédié à cet esclave */
+    if (sender_start(&slave->sender, slave->sock, &slave->addr, batch_mtu, batch_flush_us,
+                     SLAVE_BATCH_MAX) < 0) {
+        fprintf(stderr, "Cannot start sender for slave %s:%d\n", hostname, slave->port);
+        closesocket(slave->sock);
+        free(slave);
+        return NULL;
+    }
+
+    slave->idx = sched_add_slave(&scheduler);
+    if (slave->idx < 0) {
+        fprintf(stderr, "Out of memory: cannot add slave %s\n", hostname);
+        sender_stop(&slave->sender);
+        closesocket(slave->sock);
+        free(slave);
+        return NULL;
+    }
+    sched_set_available(&scheduler, slave->idx, 0);
+    slaves[num_slaves++] = slave;
 
-/* ============================================================================
- * FONCTIONS UTILITAIRES
- * ============================================================================ */
+    if (reactor) reactor_add(reactor, slave->sock, REACTOR_READ, on_slave_event, slave);
+    return slave;
+}
 
 /*
- * Fonction signal_handler()
- * -------------------------
- * Gestionnaire de signal pour l'arrêt propre du serveur.
- * Ferme tous les sockets esclaves et libère les ressources Winsock.
- *
- * Paramètre:
- *   sig - Numéro du signal reçu
+ * Fonction retire_slave()
+ * -----------------------
+ * L'esclave a été retiré de slaves.conf: il n'est plus sondé ni choisi,
+ * et seules les commandes de sa file, pas encore envoyées, sont
+ * redistribuées. Il fonctionne toujours: les commandes déjà envoyées se
+ * terminent chez lui (ses résultats sont toujours lus, les
+ * retransmissions lui sont toujours adressées) au lieu d'être exécutées
+ * une seconde fois ailleurs. Son entrée reste dans la table (les index
+ * des commandes en cours restent valides) et resservira s'il est de
+ * nouveau configuré ou s'inscrit.
  */
-void signal_handler(int sig) {
-    printf("\n[Master Server] Arrêt du serveur maître...\n");
-
-    /* Fermeture de tous les sockets esclaves */
-    for (int i = 0; i < num_slaves; i++) {
-        if (slaves[i].sock != INVALID_SOCKET) {
-            closesocket(slaves[i].sock);
-        }
-    }
-
-    /* Libération des ressources Winsock */
-    WSACleanup();
-    exit(0);
+void retire_slave(SlaveServer *slave) {
+    slave->retired = 1;
+    slave->configured = 0;
+    sched_set_available(&scheduler, slave->idx, 0);
+    int moved = requeue_slave_queue(slave->idx);
+    log_info("Esclave %s:%d retiré de la configuration: %d commandes redistribuées",
+             slave->hostname, slave->port, moved);
 }
 
 /*
  * Fonction load_slaves_config()
  * -----------------------------
  * Charge la configuration des serveurs esclaves depuis un fichier.
- * Crée un socket UDP pour chaque esclave et résout son adresse.
+ * Au démarrage comme à chaque rechargement (SIGHUP):
+ *   - un esclave nouveau est ajouté à la table (add_slave())
+ *   - un esclave retiré auparavant et de nouveau listé est réintégré
+ *   - un esclave listé au chargement précédent mais plus maintenant est
+ *     retiré (retire_slave()): les commandes de sa file sont redistribuées,
+ *     celles qu'il a déjà reçues se terminent chez lui
+ * Les esclaves inscrits d'eux-mêmes (MSG_REGISTER) ne sont pas concernés.
  *
  * Format du fichier:
  *   hostname port
  *   (une ligne par esclave, les lignes commençant par # sont ignorées)
  *
- * Paramètre:
+ * Paramètres:
  *   config_file - Chemin vers le fichier de configuration
+ *   reactor - Boucle d'événements (NULL au démarrage, voir add_slave())
  *
  * Retourne:
- *   Nombre d'esclaves chargés avec succès, ou -1 en cas d'erreur
+ *   Nombre d'esclaves listés dans le fichier, ou -1 en cas d'erreur
  */
-int load_slaves_config(const char *config_file) {
+int load_slaves_config(const char *config_file, Reactor *reactor) {
     /* Ouverture du fichier de configuration */
     FILE *fp = fopen(config_file, "r");
     if (!fp) {
@@ -183,12 +2365,12 @@ int load_slaves_config(const char *config_file) {
         return -1;
     }
 
-    /* Réinitialisation du compteur d'esclaves */
-    num_slaves = 0;
+    config_gen++;
+    int listed = 0;
     char line[512];
 
     /* Lecture ligne par ligne du fichier */
-    while (fgets(line, sizeof(line), fp) && num_slaves < MAX_SLAVES) {
+    while (fgets(line, sizeof(line), fp)) {
         /* Suppression du caractère de nouvelle ligne */
         line[strcspn(line, "\n")] = 0;
 
@@ -198,27 +2380,11 @@ int load_slaves_config(const char *config_file) {
         /* Extraction du hostname et du port */
         char hostname[256];
         int port;
-        if (sscanf(line, "%255s %d", hostname, &port) != 2) {
+        if (sscanf(line, "%255s %d", hostname, &port) != 2 || port <= 0 || port > 65535) {
             fprintf(stderr, "Invalid config line: %s\n", line);
             continue;
         }
 
-        /* Stockage des informations de l'esclave */
-        strcpy(slaves[num_slaves].hostname, hostname);
-        slaves[num_slaves].port = port;
-        slaves[num_slaves].available = 1;  /* Disponible par défaut */
-
-        /*
-         * Création du socket UDP pour cet esclave
-         * Chaque esclave a son propre socket pour permettre
-         * l'envoi de commandes en parallèle si nécessaire.
-         */
-        slaves[num_slaves].sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-        if (slaves[num_slaves].sock == INVALID_SOCKET) {
-            fprintf(stderr, "socket failed: %d\n", WSAGetLastError());
-            continue;
-        }
-
         /*
          * Résolution du nom d'hôte en adresse IP
          * gethostbyname() convertit "localhost" en 127.0.0.1, etc.
@@ -226,44 +2392,497 @@ int load_slaves_config(const char *config_file) {
         struct hostent *he = gethostbyname(hostname);
         if (!he) {
             fprintf(stderr, "Cannot resolve hostname: %s\n", hostname);
-            closesocket(slaves[num_slaves].sock);
             continue;
         }
 
         /* Configuration de la structure d'adresse pour l'esclave */
-        memset(&slaves[num_slaves].addr, 0, sizeof(slaves[num_slaves].addr));
-        slaves[num_slaves].addr.sin_family = AF_INET;
-        slaves[num_slaves].addr.sin_port = htons(port);
-        memcpy(&slaves[num_slaves].addr.sin_addr, he->h_addr_list[0], he->h_length);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        memcpy(&addr.sin_addr, he->h_addr_list[0], he->h_length);
 
-        printf("[Master Server] Loaded slave: %s:%d\n", hostname, port);
-        num_slaves++;
+        SlaveServer *slave = find_slave(&addr);
+        if (!slave) {
+            slave = add_slave(reactor, hostname, &addr);
+            if (!slave) continue;
+            log_info("Loaded slave: %s:%d", hostname, port);
+        } else if (slave->retired) {
+            slave->retired = 0;
+            log_info("Esclave %s:%d de nouveau configuré", hostname, port);
+        }
+        slave->configured = 1;
+        slave->config_gen = config_gen;
+        listed++;
     }
-
     fclose(fp);
-    return num_slaves;
+
+    /* Esclaves qui ne figurent plus dans le fichier */
+    for (int i = 0; i < num_slaves; i++) {
+        if (slaves[i]->configured && slaves[i]->config_gen != config_gen) {
+            retire_slave(slaves[i]);
+        }
+    }
+    return listed;
 }
 
 /*
- * Fonction find_available_slave()
- * -------------------------------
- * Recherche un serveur esclave disponible pour traiter une commande.
- * Utilise une stratégie simple: premier disponible trouvé.
+ * Fonction handle_registration()
+ * ------------------------------
+ * Un esclave s'inscrit (MSG_REGISTER): il est joignable à l'adresse IP
+ * émettrice, sur le port annoncé. Un esclave inconnu est ajouté à la
+ * table, un esclave retiré est réintégré. Une sonde lui est envoyée
+ * aussitôt: il est utilisé dès sa réponse, sans attendre la prochaine
+ * série de sondes.
+ */
+void handle_registration(Reactor *reactor, const struct sockaddr_in *from, uint16_t port) {
+    struct sockaddr_in addr = *from;
+    addr.sin_port = htons(port);
+
+    SlaveServer *slave = find_slave(&addr);
+    if (!slave) {
+        slave = add_slave(reactor, inet_ntoa(addr.sin_addr), &addr);
+        if (!slave) return;
+        log_info("Esclave inscrit: %s:%d", slave->hostname, slave->port);
+    } else if (slave->retired) {
+        slave->retired = 0;
+        log_info("Esclave %s:%d réinscrit", slave->hostname, slave->port);
+    }
+
+    uint8_t *ping = sender_reserve(&slave->sender, PROTO_HEADER_SIZE);
+    if (!ping) return;
+    proto_encode_text(ping, PROTO_HEADER_SIZE, MSG_PING, 0, NULL, 0);
+    sender_commit(&slave->sender);
+}
+
+/*
+ * Fonction on_register_event()
+ * ----------------------------
+ * Rappel de la boucle d'événements pour le socket UDP d'inscription:
+ * lit les trames MSG_REGISTER des esclaves lancés avec --master.
+ */
+void on_register_event(Reactor *reactor, SOCKET sock, int events, void *arg) {
+    static RecvBatch rb;
+    (void)arg;
+
+    if (!(events & (REACTOR_READ | REACTOR_ERROR))) return;
+
+    int n;
+    while ((n = batch_recv(sock, &rb)) > 0) {
+        for (int i = 0; i < n; i++) {
+            ProtoFrame frame;
+            uint16_t port;
+            if (proto_decode(rb.bufs[i], rb.lens[i], &frame) <= 0
+                || proto_decode_register(&frame, &port) < 0) {
+                fprintf(stderr, "Invalid registration from %s:%d\n",
+                        inet_ntoa(rb.addrs[i].sin_addr), ntohs(rb.addrs[i].sin_port));
+                continue;
+            }
+            handle_registration(reactor, &rb.addrs[i], port);
+        }
+        if (n < BATCH_IO_MAX) break;  /* Socket vidé */
+    }
+}
+
+#ifndef _WIN32
+/*
+ * Fonction on_sighup()
+ * --------------------
+ * Gestionnaire de SIGHUP: demande le rechargement de slaves.conf, fait
+ * par la boucle principale (l'attente d'événements est interrompue).
+ */
+void on_sighup(int sig) {
+    (void)sig;
+    reload_requested = 1;
+}
+
+/* Gestionnaire de SIGUSR1: active ou désactive les messages par commande */
+void on_sigusr1(int sig) {
+    (void)sig;
+    logger_toggle_debug();
+}
+#endif
+
+/* ============================================================================
+ * REPRISE DU JOURNAL
+ * ============================================================================ */
+
+/*
+ * Fonction grow_bytes()
+ * ---------------------
+ * Agrandit (par doublement) un tableau d'octets pour qu'il en contienne
+ * au moins need; les nouveaux octets sont à zéro.
+ *
+ * Retourne:
+ *   Le tableau agrandi, ou NULL en cas d'erreur d'allocation (l'ancien
+ *   tableau reste valide)
+ */
+void *grow_bytes(void *buf, size_t *cap, size_t need) {
+    if (need <= *cap) return buf;
+
+    size_t new_cap = *cap ? *cap : 256;
+    while (new_cap < need) new_cap *= 2;
+    uint8_t *grown = realloc(buf, new_cap);
+    if (!grown) return NULL;
+    memset(grown + *cap, 0, new_cap - *cap);
+    *cap = new_cap;
+    return grown;
+}
+
+/*
+ * Fonction find_recovered_job()
+ * -----------------------------
+ * Retourne:
+ *   Le travail de numéro job (recherche dichotomique, les travaux étant
+ *   rangés par numéro croissant), ou NULL s'il est inconnu
+ */
+RecoveredJob *find_recovered_job(Recovery *recovery, uint32_t job) {
+    int lo = 0, hi = recovery->num_jobs - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (recovery->jobs[mid].job == job) return &recovery->jobs[mid];
+        if (recovery->jobs[mid].job < job) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return NULL;
+}
+
+/*
+ * Fonction replay_record()
+ * ------------------------
+ * Rappel de journal_replay(): reconstitue les travaux à partir des
+ * enregistrements du journal (fichier reçu, état de chaque commande).
+ */
+void replay_record(const JournalRecord *r, void *arg) {
+    Recovery *recovery = (Recovery *)arg;
+    if (r->job >= next_job_id) next_job_id = r->job + 1;
+
+    if (r->type == JOURNAL_SUBMIT) {
+        if (recovery->num_jobs > 0 && recovery->jobs[recovery->num_jobs - 1].job >= r->job) return;
+        if (recovery->num_jobs == recovery->jobs_cap) {
+            int cap = recovery->jobs_cap ? recovery->jobs_cap * 2 : 16;
+            RecoveredJob *jobs = realloc(recovery->jobs, (size_t)cap * sizeof(RecoveredJob));
+            if (!jobs) {
+                recovery->failed = 1;
+                return;
+            }
+            recovery->jobs = jobs;
+            recovery->jobs_cap = cap;
+        }
+        RecoveredJob *job = &recovery->jobs[recovery->num_jobs++];
+        memset(job, 0, sizeof(*job));
+        job->job = r->job;
+        size_t len = r->data_len < sizeof(job->origin) ? r->data_len : sizeof(job->origin) - 1;
+        memcpy(job->origin, r->data, len);
+        return;
+    }
+
+    RecoveredJob *job = find_recovered_job(recovery, r->job);
+    if (!job || job->closed) return;
+
+    if (r->type == JOURNAL_DATA) {
+        char *text = grow_bytes(job->text, &job->text_cap, job->text_len + r->data_len);
+        if (!text) {
+            recovery->failed = 1;
+            return;
+        }
+        job->text = text;
+        memcpy(job->text + job->text_len, r->data, r->data_len);
+        job->text_len += r->data_len;
+    } else if (r->type == JOURNAL_END) {
+        job->ended = 1;
+    } else if (r->type == JOURNAL_DISPATCH || r->type == JOURNAL_DONE) {
+        uint8_t *states = grow_bytes(job->states, &job->states_cap, (size_t)r->seq + 1);
+        if (!states) {
+            recovery->failed = 1;
+            return;
+        }
+        job->states = states;
+        if (r->type == JOURNAL_DONE) {
+            job->states[r->seq] = r->code == 0 ? JOB_CMD_OK : JOB_CMD_FAILED;
+        } else if (job->states[r->seq] == JOB_CMD_PENDING) {
+            job->states[r->seq] = JOB_CMD_DISPATCHED;
+        }
+    } else if (r->type == JOURNAL_CLOSE) {
+        job->closed = 1;
+        free(job->text);
+        free(job->states);
+        job->text = NULL;
+        job->states = NULL;
+    }
+}
+
+/*
+ * Fonction resume_job()
+ * ---------------------
+ * Reprend un travail interrompu: il occupe un emplacement client sans
+ * connexion et repasse par la distribution normale (dépendances
+ * comprises), les commandes déjà terminées étant sautées.
  *
- * Note: Dans cette implémentation, tous les esclaves sont toujours
- * marqués comme disponibles. Une amélioration serait d'implémenter
- * un vrai suivi de disponibilité basé sur les réponses des esclaves.
+ * Retourne:
+ *   0 en cas de succès, -1 si aucun emplacement client n'est libre
+ */
+int resume_job(RecoveredJob *job) {
+    ClientConn *client = NULL;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i].state == CLIENT_FREE) {
+            client = &clients[i];
+            break;
+        }
+    }
+    if (!client) {
+        fprintf(stderr, "No free client slot to resume job %u\n", job->job);
+        return -1;
+    }
+
+    /* Fichier reçu en partie: sa dernière ligne est peut-être incomplète */
+    if (!job->ended) {
+        while (job->text_len > 0 && job->text[job->text_len - 1] != '\n') job->text_len--;
+    }
+
+    /* Un octet de plus: fin de la dernière ligne, terminée en place */
+    char *text = grow_bytes(job->text, &job->text_cap, job->text_len + 1);
+    if (!text) {
+        fprintf(stderr, "Out of memory: cannot resume job %u\n", job->job);
+        return -1;
+    }
+    job->text = text;
+
+    int done = 0, relaunched = 0;
+    for (size_t seq = 0; seq < job->states_cap; seq++) {
+        if (job->states[seq] == JOB_CMD_OK || job->states[seq] == JOB_CMD_FAILED) done++;
+        else if (job->states[seq] == JOB_CMD_DISPATCHED) relaunched++;
+    }
+    log_info("Reprise du travail %u (%s): %d commandes déjà terminées, "
+             "%d interrompues relancées%s", job->job, job->origin, done, relaunched,
+             job->ended ? "" : ", fichier reçu en partie");
+
+    unsigned int gen = client->gen + 1;
+    memset(client, 0, sizeof(*client));
+    client->gen = gen;
+    client->sock = INVALID_SOCKET;
+    snprintf(client->addr, sizeof(client->addr), "travail-%u", job->job);
+    client->job = job->job;
+    client->detached = 1;
+    client->text = text;
+    client->text_len = job->text_len;
+    client->upload_done = 1;
+    client->finished = job->states;
+    client->finished_len = job->states_cap;
+    client->tenant = fair_tenant(&fairshare, 0);
+    fair_start_job(&fairshare, client->tenant);
+    client->state = CLIENT_DISPATCHING;
+    num_dispatching++;
+    fair_activate(&fairshare, client->tenant);
+    open_jobs++;
+
+    job->text = NULL;
+    job->states = NULL;
+    return 0;
+}
+
+/*
+ * Fonction recover_jobs()
+ * -----------------------
+ * Ouvre le journal, reprend les travaux qu'un arrêt du maître a
+ * interrompus, puis démarre le thread d'écriture.
  *
  * Retourne:
- *   Index de l'esclave disponible, ou -1 si aucun disponible
+ *   0 en cas de succès, -1 en cas d'erreur
  */
-int find_available_slave() {
-    for (int i = 0; i < num_slaves; i++) {
-        if (slaves[i].available) {
-            return i;
+int recover_jobs(const char *path) {
+    uint64_t start_us = monotonic_us();
+
+    if (journal_open(&journal, path) < 0) {
+        fprintf(stderr, "Cannot open journal %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    Recovery recovery;
+    memset(&recovery, 0, sizeof(recovery));
+    long records = journal_replay(&journal, replay_record, &recovery);
+    if (records < 0 || recovery.failed) {
+        fprintf(stderr, "Cannot replay journal %s\n", path);
+        return -1;
+    }
+    journal_enabled = 1;
+
+    int resumed = 0;
+    for (int i = 0; i < recovery.num_jobs; i++) {
+        RecoveredJob *job = &recovery.jobs[i];
+        if (!job->closed) {
+            if (resume_job(job) == 0) {
+                resumed++;
+            } else {
+                JournalRecord close_rec = {JOURNAL_CLOSE, job->job, 0, 0, NULL, 0};
+                journal_append(&journal, &close_rec);
+            }
         }
+        free(job->text);
+        free(job->states);
+    }
+    free(recovery.jobs);
+
+    /* Aucun travail à reprendre: le journal repart de zéro */
+    if (open_jobs == 0) journal_reset(&journal);
+
+    log_info("Journal %s: %ld enregistrements relus en %.1f ms, %d travaux repris",
+             path, records, (double)(monotonic_us() - start_us) / 1000.0, resumed);
+    return journal_start(&journal);
+}
+
+/* ============================================================================
+ * PAGE /METRICS
+ * ============================================================================ */
+
+/* Mesure d'un esclave (voir les appels de render_slave_metric()) */
+double slave_metric_value(const SlaveServer *slave, int field) {
+    const SlaveLoad *load = &scheduler.loads[slave->idx];
+    switch (field) {
+    case 0: return (double)slave->queue.len;
+    case 1: return (double)slave->sent;
+    case 2: return (double)load->available;
+    case 3: return (double)load->capacity;
+    case 4: return load->ewma_latency_ms / 1000.0;
+    case 5: return (double)load->dispatched;
+    case 6: return (double)load->completed;
+    case 7: return (double)slave->stolen;
+    case 8: return (double)atomic_load_explicit(&slave->sender.batch.sent_datagrams,
+                                                memory_order_relaxed);
+    default: return (double)atomic_load_explicit(&slave->sender.batch.send_errors,
+                                                 memory_order_relaxed);
+    }
+}
+
+/*
+ * Fonction render_slave_metric()
+ * ------------------------------
+ * Ajoute une famille de mesures par esclave (étiquette slave="hôte:port").
+ *
+ * Paramètres:
+ *   out - Page en cours de rendu
+ *   name / type / help - Famille de mesures
+ *   field - Mesure, voir slave_metric_value()
+ */
+void render_slave_metric(MetricsText *out, const char *name, const char *type,
+                         const char *help, int field) {
+    metrics_header(out, name, type, help);
+    for (int i = 0; i < num_slaves; i++) {
+        char labels[320];
+        snprintf(labels, sizeof(labels), "slave=\"%s:%d\"", slaves[i]->hostname, slaves[i]->port);
+        metrics_value(out, name, labels, slave_metric_value(slaves[i], field));
+    }
+}
+
+/* Famille de mesures par locataire (étiquette tenant="adresse IP") */
+void render_tenant_metric(MetricsText *out, const char *name, const char *type,
+                          const char *help, int field) {
+    metrics_header(out, name, type, help);
+    for (int t = 0; t < fairshare.num_tenants; t++) {
+        const Tenant *tenant = &fairshare.tenants[t];
+        char labels[64];
+        struct in_addr ip;
+        ip.s_addr = tenant->ip;
+        snprintf(labels, sizeof(labels), "tenant=\"%s\"", inet_ntoa(ip));
+        metrics_value(out, name, labels, field == 0 ? (double)tenant->running
+                                         : field == 1 ? (double)tenant->dispatched
+                                         : (double)tenant->rejected);
+    }
+}
+
+/*
+ * Fonction render_metrics()
+ * -------------------------
+ * Rendu de la page /metrics du maître (voir metrics.h): appelée par la
+ * boucle d'événements à chaque requête, elle lit les compteurs sans rien
+ * modifier.
+ */
+void render_metrics(MetricsText *out, void *arg) {
+    (void)arg;
+
+    metrics_header(out, "master_commands_dispatched_total", "counter",
+                   "Commands assigned to a slave queue");
+    metrics_value(out, "master_commands_dispatched_total", NULL, (double)stats.dispatched);
+    metrics_header(out, "master_commands_sent_total", "counter", "Commands sent to a slave");
+    metrics_value(out, "master_commands_sent_total", NULL, (double)stats.sent);
+    metrics_header(out, "master_retransmits_total", "counter", "Command retransmissions");
+    metrics_value(out, "master_retransmits_total", NULL, (double)stats.retransmits);
+    metrics_header(out, "master_commands_lost_total", "counter",
+                   "Commands abandoned because their slave stopped answering");
+    metrics_value(out, "master_commands_lost_total", NULL, (double)stats.lost);
+    metrics_header(out, "master_results_total", "counter", "Results received from slaves");
+    metrics_value(out, "master_results_total", NULL, (double)stats.results);
+    metrics_header(out, "master_commands_expired_total", "counter",
+                   "Commands abandoned after their submission deadline");
+    metrics_value(out, "master_commands_expired_total", NULL, (double)stats.expired);
+    metrics_header(out, "master_results_late_total", "counter",
+                   "Results delivered after their submission deadline");
+    metrics_value(out, "master_results_late_total", NULL, (double)stats.late);
+
+    int connected = 0;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i].state != CLIENT_FREE && !clients[i].detached) connected++;
+    }
+    metrics_header(out, "master_clients", "gauge", "Connected clients");
+    metrics_value(out, "master_clients", NULL, (double)connected);
+    metrics_header(out, "master_clients_dispatching", "gauge", "Submissions being dispatched");
+    metrics_value(out, "master_clients_dispatching", NULL, (double)num_dispatching);
+    metrics_header(out, "master_commands_queued", "gauge", "Commands waiting in slave queues");
+    metrics_value(out, "master_commands_queued", NULL, (double)queued_commands);
+    metrics_header(out, "master_commands_inflight", "gauge", "Commands without a result");
+    metrics_value(out, "master_commands_inflight", NULL, (double)inflight.count);
+    metrics_header(out, "master_frame_slab_bytes", "gauge", "Memory held for command frames");
+    metrics_value(out, "master_frame_slab_bytes", NULL,
+                  (double)frame_slab.block_count * SLAB_BLOCK_SIZE);
+    metrics_header(out, "master_dispatch_window", "gauge", "Commands admitted to slave queues");
+    metrics_value(out, "master_dispatch_window", NULL, (double)dispatch_window);
+
+    metrics_histogram(out, "master_queue_wait_seconds",
+                      "Time spent in a slave queue on the master before sending", &stats.queue_wait);
+    metrics_histogram(out, "master_command_round_trip_seconds",
+                      "Time from sending a command to receiving its result", &stats.round_trip);
+    metrics_histogram(out, "master_command_exec_seconds",
+                      "Execution time reported by slaves", &stats.exec);
+
+    render_slave_metric(out, "master_slave_queue_depth", "gauge", "Commands waiting in the slave queue", 0);
+    render_slave_metric(out, "master_slave_outstanding", "gauge", "Commands sent without a result", 1);
+    render_slave_metric(out, "master_slave_up", "gauge", "1 if the slave answers heartbeats", 2);
+    render_slave_metric(out, "master_slave_capacity", "gauge", "Workers announced by the slave", 3);
+    render_slave_metric(out, "master_slave_latency_ewma_seconds", "gauge",
+                        "Smoothed result latency", 4);
+    render_slave_metric(out, "master_slave_dispatched_total", "counter", "Commands assigned", 5);
+    render_slave_metric(out, "master_slave_completed_total", "counter", "Results received", 6);
+    render_slave_metric(out, "master_slave_stolen_total", "counter", "Commands stolen from other slaves", 7);
+    render_slave_metric(out, "master_slave_datagrams_sent_total", "counter",
+                        "Datagrams sent by the slave sender thread", 8);
+    render_slave_metric(out, "master_slave_send_errors_total", "counter",
+                        "Datagrams dropped on send errors", 9);
+
+    render_tenant_metric(out, "master_tenant_running", "gauge",
+                         "Commands dispatched without a result", 0);
+    render_tenant_metric(out, "master_tenant_dispatched_total", "counter", "Commands dispatched", 1);
+    render_tenant_metric(out, "master_tenant_rejected_total", "counter",
+                         "Submissions refused (MSG_BUSY)", 2);
+
+    if (cache_enabled) {
+        metrics_header(out, "master_cache_hits_total", "counter", "Results served from the cache");
+        metrics_value(out, "master_cache_hits_total", NULL, (double)result_cache.hits);
+        metrics_header(out, "master_cache_misses_total", "counter", "Cache lookups without a result");
+        metrics_value(out, "master_cache_misses_total", NULL, (double)result_cache.misses);
+        metrics_header(out, "master_cache_coalesced_total", "counter",
+                       "Commands waiting for an identical running command");
+        metrics_value(out, "master_cache_coalesced_total", NULL, (double)result_cache.coalesced);
+        metrics_header(out, "master_cache_evictions_total", "counter", "Results evicted");
+        metrics_value(out, "master_cache_evictions_total", NULL, (double)result_cache.evictions);
+        metrics_header(out, "master_cache_bytes", "gauge", "Bytes of cached results");
+        metrics_value(out, "master_cache_bytes", NULL, (double)result_cache.bytes);
+    }
+    if (journal_enabled) {
+        metrics_header(out, "master_journal_bytes", "gauge", "Size of the job journal");
+        metrics_value(out, "master_journal_bytes", NULL, (double)journal.size);
+        metrics_header(out, "master_journal_open_jobs", "gauge", "Journaled jobs not finished");
+        metrics_value(out, "master_journal_open_jobs", NULL, (double)open_jobs);
     }
-    return -1;  /* Aucun esclave disponible */
 }
 
 /* ============================================================================
@@ -279,8 +2898,12 @@ int find_available_slave() {
  * des commandes.
  *
  * Paramètres:
- *   argc - Nombre d'arguments (doit être 2)
- *   argv - argv[1] = fichier de configuration des esclaves
+ *   argc - Nombre d'arguments
+ *   argv - [--policy rr|least|ewma] [--mtu N] [--flush-us N] [--register-port N]
+ *          [--prefetch N] [--journal FILE] [--cache MO] [--cache-ttl S]
+ *          [--client-running N] [--client-jobs N] [--client-weight IP=W]
+ *          [--metrics-port N] [--log-level L] [--log-format text|json]
+ *          <fichier de configuration>
  *
  * Retourne:
  *   0 en cas de succès (jamais atteint en fonctionnement normal)
@@ -291,13 +2914,148 @@ int main(int argc, char *argv[]) {
     /*
      * ÉTAPE 1: Vérification des arguments
      * ------------------------------------
-     * Le programme nécessite exactement un argument: le chemin vers
-     * le fichier de configuration des serveurs esclaves.
+     * Le programme nécessite un argument: le chemin vers le fichier de
+     * configuration des serveurs esclaves. L'option --policy choisit la
+     * politique de l'ordonnanceur (par défaut: least); --mtu et --flush-us
+     * règlent le regroupement des commandes en datagrammes; --register-port
+     * fixe le port UDP des inscriptions d'esclaves (0 = désactivées);
+     * --prefetch le nombre de commandes envoyées d'avance à chaque esclave
+     * au-delà de ses workers (le reste attend chez le maître); --journal
+     * le fichier du journal des travaux (reprise après un arrêt); --cache
+     * la taille en Mo du cache des résultats des commandes "cache:" (0 =
+     * désactivé, par défaut) et --cache-ttl leur durée de vie en secondes.
+     * Par adresse IP cliente: --client-running borne les commandes
+     * distribuées à la fois, --client-jobs les fichiers en cours (au-delà,
+     * MSG_BUSY), --client-weight fixe la part des esclaves (répétable).
+     * --metrics-port ouvre la page HTTP /metrics (0 = fermée, par défaut).
+     * --log-level (error, warn, info, debug) et --log-format (text, json)
+     * règlent la journalisation; debug affiche chaque commande.
      */
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s <slaves_config_file>\n", argv[0]);
+    const char *config_file = NULL;
+    const char *journal_file = NULL;
+    int cache_mb = 0;
+    int cache_ttl_s = DEFAULT_CACHE_TTL_S;
+    fair_init(&fairshare, 0, 0);
+    SchedPolicy policy = SCHED_LEAST_OUTSTANDING;
+    int register_port = REGISTER_PORT;
+    int metrics_port = 0;
+    LogLevel log_level = LOG_INFO;
+    LogFormat log_format = LOG_TEXT;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            if (sched_parse_policy(argv[++i], &policy) < 0) {
+                fprintf(stderr, "Unknown scheduling policy: %s (rr, least, ewma)\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--mtu") == 0 && i + 1 < argc) {
+            int mtu = atoi(argv[++i]);
+            if (mtu < PROTO_HEADER_SIZE || mtu > PROTO_MAX_DATAGRAM) {
+                fprintf(stderr, "Invalid MTU: %s\n", argv[i]);
+                exit(1);
+            }
+            batch_mtu = (size_t)mtu;
+        } else if (strcmp(argv[i], "--flush-us") == 0 && i + 1 < argc) {
+            int flush_us = atoi(argv[++i]);
+            if (flush_us < 0) {
+                fprintf(stderr, "Invalid flush delay: %s\n", argv[i]);
+                exit(1);
+            }
+            batch_flush_us = (uint64_t)flush_us;
+        } else if (strcmp(argv[i], "--prefetch") == 0 && i + 1 < argc) {
+            slave_prefetch = atoi(argv[++i]);
+            if (slave_prefetch < 0) {
+                fprintf(stderr, "Invalid prefetch: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--register-port") == 0 && i + 1 < argc) {
+            register_port = atoi(argv[++i]);
+            if (register_port < 0 || register_port > 65535) {
+                fprintf(stderr, "Invalid registration port: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc) {
+            metrics_port = atoi(argv[++i]);
+            if (metrics_port < 0 || metrics_port > 65535) {
+                fprintf(stderr, "Invalid metrics port: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            if (logger_parse_level(argv[++i], &log_level) < 0) {
+                fprintf(stderr, "Unknown log level: %s (error, warn, info, debug)\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--log-format") == 0 && i + 1 < argc) {
+            if (logger_parse_format(argv[++i], &log_format) < 0) {
+                fprintf(stderr, "Unknown log format: %s (text, json)\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--journal") == 0 && i + 1 < argc) {
+            journal_file = argv[++i];
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cache_mb = atoi(argv[++i]);
+            if (cache_mb < 0) {
+                fprintf(stderr, "Invalid cache size: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--cache-ttl") == 0 && i + 1 < argc) {
+            cache_ttl_s = atoi(argv[++i]);
+            if (cache_ttl_s <= 0) {
+                fprintf(stderr, "Invalid cache TTL: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--client-running") == 0 && i + 1 < argc) {
+            fairshare.max_running = atoi(argv[++i]);
+            if (fairshare.max_running < 0) {
+                fprintf(stderr, "Invalid client concurrency cap: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--client-jobs") == 0 && i + 1 < argc) {
+            fairshare.max_jobs = atoi(argv[++i]);
+            if (fairshare.max_jobs < 0) {
+                fprintf(stderr, "Invalid client job limit: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--client-weight") == 0 && i + 1 < argc) {
+            char ip[64];
+            int weight = 0;
+            const char *eq = strchr(argv[++i], '=');
+            size_t ip_len = eq ? (size_t)(eq - argv[i]) : 0;
+            if (ip_len > 0 && ip_len < sizeof(ip)) {
+                memcpy(ip, argv[i], ip_len);
+                ip[ip_len] = '\0';
+                weight = atoi(eq + 1);
+            }
+            if (ip_len == 0 || ip_len >= sizeof(ip) || inet_addr(ip) == INADDR_NONE
+                || fair_set_weight(&fairshare, inet_addr(ip), weight) < 0) {
+                fprintf(stderr, "Invalid client weight: %s (IP=1..%d)\n", argv[i], FAIR_MAX_WEIGHT);
+                exit(1);
+            }
+        } else if (!config_file) {
+            config_file = argv[i];
+        } else {
+            config_file = NULL;
+            break;
+        }
+    }
+    if (!config_file) {
+        fprintf(stderr, "Usage: %s [--policy rr|least|ewma] [--mtu N] [--flush-us N] [--register-port N] "
+                "[--prefetch N] [--journal FILE] [--cache MB] [--cache-ttl S] [--client-running N] "
+                "[--client-jobs N] [--client-weight IP=W] [--metrics-port N] [--log-level L] "
+                "[--log-format text|json] <slaves_config_file>\n", argv[0]);
         exit(1);
     }
+    if (logger_start("Master Server", log_level, log_format) < 0) {
+        fprintf(stderr, "Cannot start logger: messages are written synchronously\n");
+    }
+    if (cache_mb > 0) {
+        if (cache_init(&result_cache, (size_t)cache_mb * 1024 * 1024,
+                       (uint64_t)cache_ttl_s * 1000000) < 0) {
+            fprintf(stderr, "Out of memory: result cache\n");
+            exit(1);
+        }
+        cache_enabled = 1;
+    }
 
     /*
      * ÉTAPE 2: Initialisation de Winsock
@@ -311,20 +3069,52 @@ int main(int argc, char *argv[]) {
         exit(1);
     }
 
+    /*
+     * Ordonnanceur, table des commandes en cours et retransmissions.
+     * Les identifiants de commande partent d'une valeur dépendant de
+     * l'instant de démarrage: après un redémarrage du maître, un esclave
+     * ne confond pas une nouvelle commande avec une commande déjà exécutée.
+     */
+    next_command_id = (unsigned int)time(NULL) ^ ((unsigned int)_getpid() << 16);
+    if (next_command_id == 0) next_command_id = 1;
+    if (sched_init(&scheduler, policy, 0) < 0 || inflight_init(&inflight, 1024) < 0
+        || retry_init(&retries, 1024) < 0) {
+        fprintf(stderr, "Error: Cannot allocate scheduler state\n");
+        WSACleanup();
+        exit(1);
+    }
+
     /*
      * ÉTAPE 3: Chargement de la configuration des esclaves
      * -----------------------------------------------------
      * Lecture du fichier de configuration pour obtenir la liste
      * des serveurs esclaves disponibles et création des sockets UDP.
+     * Le fichier peut être vide si les esclaves s'inscrivent d'eux-mêmes;
+     * il est relu à chaque SIGHUP. Un esclave n'est utilisé qu'après sa
+     * première réponse à une sonde.
      */
-    if (load_slaves_config(argv[1]) <= 0) {
+    int configured = load_slaves_config(config_file, NULL);
+    if (configured < 0 || (configured == 0 && register_port == 0)) {
         fprintf(stderr, "Error: No slave servers loaded\n");
         WSACleanup();
         exit(1);
     }
 
     /*
-     * ÉTAPE 4: Création du socket TCP maître
+     * ÉTAPE 4: Reprise du journal des travaux
+     * ----------------------------------------
+     * Avec --journal, les travaux interrompus par un arrêt du maître sont
+     * repris: seules leurs commandes non terminées sont relancées, dès
+     * que les esclaves répondent. Le journal est ensuite tenu pour les
+     * nouveaux travaux.
+     */
+    if (journal_file && recover_jobs(journal_file) < 0) {
+        WSACleanup();
+        exit(1);
+    }
+
+    /*
+     * ÉTAPE 5: Création du socket TCP maître
      * ---------------------------------------
      * Création d'un socket TCP pour accepter les connexions des clients.
      * - AF_INET: Famille d'adresses IPv4
@@ -339,7 +3129,7 @@ int main(int argc, char *argv[]) {
     }
 
     /*
-     * ÉTAPE 5: Configuration de l'adresse du serveur maître
+     * ÉTAPE 6: Configuration de l'adresse du serveur maître
      * ------------------------------------------------------
      * Préparation de la structure sockaddr_in pour le binding.
      */
@@ -359,7 +3149,7 @@ int main(int argc, char *argv[]) {
     setsockopt(master_sock, SOL_SOCKET, SO_REUSEADDR, (const char *)&opt, sizeof(opt));
 
     /*
-     * ÉTAPE 6: Liaison du socket au port (bind)
+     * ÉTAPE 7: Liaison du socket au port (bind)
      * ------------------------------------------
      * Association du socket à l'adresse et au port configurés.
      */
@@ -371,172 +3161,173 @@ int main(int argc, char *argv[]) {
     }
 
     /*
-     * ÉTAPE 7: Mise en écoute du socket (listen)
+     * ÉTAPE 8: Mise en écoute du socket (listen)
      * -------------------------------------------
      * Le socket commence à écouter les connexions entrantes.
-     * Le paramètre 5 est la taille de la file d'attente des connexions.
+     * SOMAXCONN: file d'attente maximale autorisée par le système, pour
+     * absorber les rafales de connexions simultanées.
      */
-    if (listen(master_sock, 5) == SOCKET_ERROR) {
+    if (listen(master_sock, SOMAXCONN) == SOCKET_ERROR) {
         fprintf(stderr, "listen failed: %d\n", WSAGetLastError());
         closesocket(master_sock);
         WSACleanup();
         exit(1);
     }
+    net_set_nonblocking(master_sock);
 
-    /* Affichage du message de démarrage */
-    printf("[Master Server] Maître lancé sur le port %d avec %d esclaves (PID=%d)\n",
-           MASTER_PORT, num_slaves, _getpid());
+#ifndef _WIN32
+    /* Un client qui se déconnecte ne doit pas tuer le maître lors d'un send() */
+    signal(SIGPIPE, SIG_IGN);
 
     /*
-     * ÉTAPE 8: Boucle principale du serveur
-     * --------------------------------------
-     * Boucle infinie qui:
-     * 1. Accepte une connexion client
-     * 2. Reçoit le nom du fichier de commandes
-     * 3. Distribue les commandes aux esclaves
-     * 4. Ferme la connexion client
-     * 5. Recommence
+     * SIGHUP: rechargement de slaves.conf. Sans SA_RESTART, le signal
+     * interrompt l'attente d'événements et le rechargement est immédiat
+     * (au plus une période de sonde s'il arrive juste avant l'attente).
      */
-    while (1) {
-        struct sockaddr_in client_addr;
-        int client_addr_len = sizeof(client_addr);
-
-        /*
-         * ÉTAPE 8a: Acceptation d'une connexion client
-         * ---------------------------------------------
-         * accept() est bloquant - le serveur attend ici jusqu'à
-         * ce qu'un client se connecte.
-         */
-        SOCKET client_sock = accept(master_sock, (struct sockaddr *)&client_addr, &client_addr_len);
-        if (client_sock == INVALID_SOCKET) {
-            fprintf(stderr, "accept failed: %d\n", WSAGetLastError());
-            continue;
-        }
-
-        /* Extraction des informations du client connecté */
-        char *client_ip = inet_ntoa(client_addr.sin_addr);  /* Conversion IP en chaîne */
-        int client_port = ntohs(client_addr.sin_port);       /* Conversion port en entier */
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_sighup;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGHUP, &sa, NULL);
 
-        printf("[Master Server] Nouvelle connexion client: %s:%d\n", client_ip, client_port);
+    /* SIGUSR1: bascule du niveau debug (messages émis pour chaque commande) */
+    sa.sa_handler = on_sigusr1;
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &sa, NULL);
+#endif
 
-        /*
-         * ÉTAPE 8b: Réception du nom de fichier
-         * --------------------------------------
-         * Le client envoie le nom du fichier contenant les commandes.
-         */
-        char filename[256];
-        int n = recv(client_sock, filename, sizeof(filename) - 1, 0);
-        if (n <= 0) {
-            fprintf(stderr, "Error reading filename from client\n");
-            closesocket(client_sock);
-            continue;
-        }
-        filename[n] = '\0';  /* Terminaison de la chaîne */
-        printf("[Master Server] Fichier demandé: %s\n", filename);
+    /*
+     * Socket UDP d'inscription des esclaves
+     * -------------------------------------
+     * Un esclave lancé avec --master s'y annonce (MSG_REGISTER) et est
+     * ajouté à la table sans redémarrage du maître.
+     */
+    SOCKET register_sock = INVALID_SOCKET;
+    if (register_port > 0) {
+        struct sockaddr_in register_addr;
+        memset(&register_addr, 0, sizeof(register_addr));
+        register_addr.sin_family = AF_INET;
+        register_addr.sin_port = htons(register_port);
+        register_addr.sin_addr.s_addr = htonl(INADDR_ANY);
 
-        /*
-         * ÉTAPE 8c: Ouverture du fichier de commandes
-         * --------------------------------------------
-         * Le maître ouvre le fichier localement pour lire les commandes.
-         */
-        FILE *fp = fopen(filename, "r");
-        if (!fp) {
-            /* Envoi d'un message d'erreur au client */
-            char error_msg[] = "ERROR: Cannot open file";
-            send(client_sock, error_msg, (int)strlen(error_msg), 0);
-            closesocket(client_sock);
-            continue;
+        register_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (register_sock == INVALID_SOCKET
+            || bind(register_sock, (struct sockaddr *)&register_addr, sizeof(register_addr)) == SOCKET_ERROR) {
+            fprintf(stderr, "Cannot bind registration port %d: %d\n", register_port, WSAGetLastError());
+            if (register_sock != INVALID_SOCKET) closesocket(register_sock);
+            closesocket(master_sock);
+            WSACleanup();
+            exit(1);
         }
+        net_set_nonblocking(register_sock);
+    }
 
-        char line[MAX_CMD_LEN];
-        int cmd_count = 0;  /* Compteur de commandes traitées */
-
-        /*
-         * ÉTAPE 8d: Envoi de l'accusé de réception (ACK)
-         * -----------------------------------------------
-         * Confirmation au client que le fichier a été ouvert avec succès.
-         */
-        char ack[] = "OK";
-        send(client_sock, ack, (int)strlen(ack), 0);
-
-        /*
-         * ÉTAPE 8e: Traitement des commandes
-         * -----------------------------------
-         * Lecture du fichier ligne par ligne et distribution
-         * des commandes aux esclaves.
-         */
-        while (fgets(line, sizeof(line), fp)) {
-            /* Suppression du caractère de nouvelle ligne */
-            line[strcspn(line, "\n")] = 0;
-
-            /* Ignorer les lignes vides */
-            if (line[0] == '\0') continue;
-
-            printf("[Master Server] Traitement commande: %s\n", line);
-
-            /*
-             * Recherche d'un esclave disponible
-             * ---------------------------------
-             * Tentative de trouver un esclave libre pour exécuter la commande.
-             * Si aucun n'est disponible, attendre 1 seconde et réessayer.
-             */
-            int slave_idx = find_available_slave();
-            if (slave_idx < 0) {
-                printf("[Master Server] Aucun esclave disponible, attente...\n");
-                Sleep(1000);  /* Attente de 1 seconde */
-                slave_idx = find_available_slave();
-                if (slave_idx < 0) {
-                    fprintf(stderr, "No available slaves\n");
-                    continue;  /* Passer à la commande suivante */
-                }
-            }
-
-            /*
-             * Préparation de la requête de commande
-             * -------------------------------------
-             * Construction de la structure CommandRequest avec
-             * la commande et les informations du client.
-             */
-            CommandRequest req;
-            strcpy(req.command, line);
-            strcpy(req.client_addr, client_ip);
-            req.client_port = client_port;
-
-            /*
-             * Envoi de la commande à l'esclave via UDP
-             * -----------------------------------------
-             * sendto() envoie la requête à l'esclave sélectionné.
-             */
-            if (sendto(slaves[slave_idx].sock, (const char *)&req, sizeof(req), 0,
-                      (struct sockaddr *)&slaves[slave_idx].addr,
-                      sizeof(slaves[slave_idx].addr)) == SOCKET_ERROR) {
-                fprintf(stderr, "sendto to slave failed: %d\n", WSAGetLastError());
-                continue;
-            }
+    /*
+     * ÉTAPE 9: Création de la boucle d'événements
+     * --------------------------------------------
+     * Le socket d'écoute, le socket d'inscription et les sockets UDP des
+     * esclaves sont surveillés par un unique réacteur; les connexions
+     * clients et les esclaves ajoutés en cours de route y sont ajoutés
+     * au fur et à mesure.
+     */
+    Reactor *reactor = reactor_create();
+    if (!reactor) {
+        fprintf(stderr, "reactor_create failed\n");
+        closesocket(master_sock);
+        WSACleanup();
+        exit(1);
+    }
+    reactor_add(reactor, master_sock, REACTOR_READ, on_listener_readable, NULL);
+    if (register_sock != INVALID_SOCKET) {
+        reactor_add(reactor, register_sock, REACTOR_READ, on_register_event, NULL);
+    }
+    for (int i = 0; i < num_slaves; i++) {
+        reactor_add(reactor, slaves[i]->sock, REACTOR_READ, on_slave_event, slaves[i]);
+    }
+    metrics_server.sock = INVALID_SOCKET;
+    if (metrics_port > 0
+        && metrics_listen(&metrics_server, reactor, metrics_port, render_metrics, NULL) < 0) {
+        fprintf(stderr, "Cannot open metrics port %d: %d\n", metrics_port, WSAGetLastError());
+        closesocket(master_sock);
+        WSACleanup();
+        exit(1);
+    }
 
-            printf("[Master Server] Commande envoyée à %s:%d\n",
-                   slaves[slave_idx].hostname, slaves[slave_idx].port);
+    /* Affichage du message de démarrage */
+    log_info("Maître lancé sur le port %d avec %d esclaves, politique %s (PID=%d)",
+             MASTER_PORT, num_slaves, sched_policy_name(policy), _getpid());
+    if (register_sock != INVALID_SOCKET) {
+        log_info("Inscription des esclaves sur le port UDP %d", register_port);
+    }
+    if (metrics_server.sock != INVALID_SOCKET) {
+        log_info("Mesures sur http://localhost:%d/metrics", metrics_port);
+    }
 
-            cmd_count++;
+    /*
+     * ÉTAPE 10: Boucle principale du serveur
+     * --------------------------------------
+     * Boucle infinie qui:
+     * 1. Attend des événements réseau (sans délai si des commandes
+     *    reçues sont prêtes à être distribuées, jusqu'à la prochaine
+     *    échéance de retransmission sinon)
+     * 2. Traite les connexions, fichiers reçus et réponses des esclaves
+     * 3. Attribue un lot de commandes pour chaque client actif (files des
+     *    esclaves), et reprend les envois bloqués par une file d'envoi pleine
+     * 4. Retransmet les commandes restées sans réponse
+     * 5. Sonde les esclaves et écarte ceux qui ne répondent plus
+     *    (après un SIGHUP, slaves.conf est d'abord rechargé)
+     * 6. Avant de se remettre en attente, demande aux threads d'envoi de
+     *    vider leurs lots (ils envoient d'eux-mêmes les lots pleins ou
+     *    dont le délai est écoulé), et au thread du journal d'écrire les
+     *    enregistrements du tour
+     */
+    int ready = 0;
+    int heartbeat_ms = 0;
+    while (1) {
+        int timeout_ms = ready > 0 ? 0 : retry_timeout_ms(&retries, monotonic_us());
+        if (timeout_ms < 0 || timeout_ms > heartbeat_ms) timeout_ms = heartbeat_ms;
+        if (reactor_run_once(reactor, timeout_ms) < 0) {
+            fprintf(stderr, "reactor wait failed: %d\n", WSAGetLastError());
         }
-
-        /* Fermeture du fichier de commandes */
-        fclose(fp);
-
-        /* Affichage du résumé pour ce client */
-        printf("[Master Server] %d commandes traitées pour le client %s:%d\n",
-               cmd_count, client_ip, client_port);
-
-        /* Fermeture de la connexion avec le client */
-        closesocket(client_sock);
+        if (reload_requested) {
+            reload_requested = 0;
+            log_info("Rechargement de %s", config_file);
+            load_slaves_config(config_file, reactor);
+        }
+        ready = dispatch_pending_clients(reactor);
+        if (pumps_blocked > 0) {
+            pumps_blocked = pump_blocked_slaves();
+            ready += pumps_blocked;
+        }
+        process_retries(reactor);
+        heartbeat_ms = process_heartbeats();
+        if (ready == 0) flush_slave_senders();
+        if (journal_enabled) journal_commit(&journal);
     }
 
     /*
-     * ÉTAPE 9: Nettoyage (jamais atteint en fonctionnement normal)
+     * ÉTAPE 11: Nettoyage (jamais atteint en fonctionnement normal)
      * -------------------------------------------------------------
      * Ces lignes ne sont jamais exécutées car le serveur tourne
      * indéfiniment. Elles sont présentes pour la complétude du code.
      */
+    metrics_close(&metrics_server, reactor);
+    reactor_destroy(reactor);
+    for (int i = 0; i < num_slaves; i++) {
+        sender_stop(&slaves[i]->sender);
+        deque_free(&slaves[i]->queue);
+        closesocket(slaves[i]->sock);
+        free(slaves[i]);
+    }
+    free(slaves);
+    if (register_sock != INVALID_SOCKET) closesocket(register_sock);
+    if (journal_enabled) journal_close(&journal);
+    if (cache_enabled) cache_free(&result_cache);
+    fair_free(&fairshare);
+    retry_free(&retries);
+    inflight_free(&inflight);
+    slab_free(&frame_slab);
+    sched_free(&scheduler);
     closesocket(master_sock);
     WSACleanup();
     return 0;
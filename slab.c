@@ -0,0 +1,158 @@
+/*
+ * ============================================================================
+ * SLAB - Allocateur par classes de taille des trames de commande (maître)
+ * ============================================================================
+ *
+ * Voir slab.h pour la description de l'interface.
+ *
+ * ============================================================================
+ */
+
+#include <stdlib.h>
+
+#include "slab.h"
+
+/*
+ * Fonction size_class()
+ * ---------------------
+ * Retourne:
+ *   La classe des objets de size octets (la plus petite qui les
+ *   contient), ou SLAB_CLASSES s'ils sont plus grands que SLAB_MAX_SIZE
+ */
+static int size_class(size_t size) {
+    int c = 0;
+    size_t class_size = SLAB_MIN_SIZE;
+
+    while (class_size < size && c < SLAB_CLASSES) {
+        class_size <<= 1;
+        c++;
+    }
+    return c;
+}
+
+/*
+ * Fonction put_free()
+ * -------------------
+ * Range un objet libre dans la liste de sa classe.
+ */
+static void put_free(SlabPool *pool, int c, void *ptr) {
+    SlabFree *obj = ptr;
+    obj->next = pool->free_lists[c];
+    pool->free_lists[c] = obj;
+}
+
+/*
+ * Fonction new_block()
+ * --------------------
+ * Alloue un bloc, à découper à partir de son deuxième objet (le premier
+ * chaîne les blocs). Le reste du bloc précédent n'est pas perdu: il est
+ * découpé en objets des plus grandes classes qu'il contient encore.
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation
+ */
+static int new_block(SlabPool *pool) {
+    uint8_t *block = malloc(SLAB_BLOCK_SIZE);
+    if (!block) return -1;
+
+    for (int c = SLAB_CLASSES - 1; c >= 0 && pool->bump_left > 0; c--) {
+        size_t class_size = (size_t)SLAB_MIN_SIZE << c;
+        while (pool->bump_left >= class_size) {
+            put_free(pool, c, pool->bump);
+            pool->bump += class_size;
+            pool->bump_left -= class_size;
+        }
+    }
+
+    *(void **)block = pool->blocks;
+    pool->blocks = block;
+    pool->block_count++;
+    pool->bump = block + SLAB_MIN_SIZE;
+    pool->bump_left = SLAB_BLOCK_SIZE - SLAB_MIN_SIZE;
+    return 0;
+}
+
+/*
+ * Fonction slab_alloc()
+ * ---------------------
+ * Alloue un objet de size octets: objet libre de sa classe, sinon découpé
+ * dans le bloc courant (un nouveau bloc au besoin).
+ *
+ * Retourne:
+ *   L'objet (aligné sur SLAB_MIN_SIZE octets dans un bloc), ou NULL en cas
+ *   d'erreur d'allocation
+ */
+void *slab_alloc(SlabPool *pool, size_t size) {
+    int c = size_class(size);
+    if (c == SLAB_CLASSES) {
+        void *ptr = malloc(size);
+        if (ptr) pool->large++;
+        return ptr;
+    }
+
+    SlabFree *obj = pool->free_lists[c];
+    if (obj) {
+        pool->free_lists[c] = obj->next;
+        pool->live++;
+        return obj;
+    }
+
+    size_t class_size = (size_t)SLAB_MIN_SIZE << c;
+    if (pool->bump_left < class_size && new_block(pool) < 0) return NULL;
+
+    void *ptr = pool->bump;
+    pool->bump += class_size;
+    pool->bump_left -= class_size;
+    pool->live++;
+    return ptr;
+}
+
+/*
+ * Fonction slab_release()
+ * -----------------------
+ * Libère un objet de slab_alloc(); size est la taille demandée à son
+ * allocation. ptr peut être NULL.
+ */
+void slab_release(SlabPool *pool, void *ptr, size_t size) {
+    if (!ptr) return;
+
+    int c = size_class(size);
+    if (c == SLAB_CLASSES) {
+        free(ptr);
+        pool->large--;
+        return;
+    }
+    put_free(pool, c, ptr);
+    pool->live--;
+}
+
+/*
+ * Fonction slab_trim()
+ * --------------------
+ * Rend tous les blocs si plus aucun objet n'est en cours; sans effet
+ * sinon.
+ */
+void slab_trim(SlabPool *pool) {
+    if (pool->live == 0) slab_free(pool);
+}
+
+/*
+ * Fonction slab_free()
+ * --------------------
+ * Rend tous les blocs (les objets encore en cours deviennent invalides,
+ * sauf les objets alloués directement) et remet la pool à vide.
+ */
+void slab_free(SlabPool *pool) {
+    void *block = pool->blocks;
+    while (block) {
+        void *next = *(void **)block;
+        free(block);
+        block = next;
+    }
+    for (int c = 0; c < SLAB_CLASSES; c++) pool->free_lists[c] = NULL;
+    pool->blocks = NULL;
+    pool->bump = NULL;
+    pool->bump_left = 0;
+    pool->live = 0;
+    pool->block_count = 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * ============================================================================
+ * SLAB - Allocateur par classes de taille des trames de commande (maître)
+ * ============================================================================
+ *
+ * Description:
+ *   Chaque commande distribuée garde sa trame MSG_COMMAND encodée jusqu'à
+ *   son résultat, pour la retransmission (voir inflight.h). Un fichier d'un
+ *   million de lignes ferait autant d'appels à malloc() et free() sur le
+ *   chemin de distribution.
+ *
+ *   Les trames sont taillées dans des blocs de SLAB_BLOCK_SIZE octets, par
+ *   classes de taille puissances de 2 (SLAB_MIN_SIZE à SLAB_MAX_SIZE). Une
+ *   trame libérée rejoint la liste libre de sa classe et sert à la commande
+ *   suivante de même classe: en régime établi, la distribution n'appelle
+ *   plus malloc(). Une trame plus grande que SLAB_MAX_SIZE (commande très
+ *   longue, rare) est allouée directement.
+ *
+ *   La mémoire occupée suit le nombre de commandes en cours, à moins d'un
+ *   facteur 2 près (arrondi de la classe): 64 octets par commande courte.
+ *   Lorsque plus aucune trame n'est en cours (fin des fichiers), tous les
+ *   blocs sont rendus d'un coup (slab_trim()).
+ *
+ *   Un SlabPool n'est pas partagé entre threads: chacun a le sien, avec ses
+ *   propres listes libres, et aucun verrou n'est pris. Celui du maître
+ *   appartient à la boucle d'événements (les threads d'envoi recopient les
+ *   trames, voir sender.h). Une pool initialisée à zéro est vide et valide.
+ *
+ * ============================================================================
+ */
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SLAB_MIN_SIZE 32        /* Plus petite classe (octets, puissance de 2) */
+#define SLAB_CLASSES 9          /* Classes 32, 64, ..., 8192 octets */
+#define SLAB_MAX_SIZE (SLAB_MIN_SIZE << (SLAB_CLASSES - 1))
+#define SLAB_BLOCK_SIZE 65536   /* Taille d'un bloc obtenu de malloc() */
+
+/* Objet libre d'une classe (chaîné dans l'objet lui-même) */
+typedef struct SlabFree {
+    struct SlabFree *next;
+} SlabFree;
+
+/*
+ * Structure SlabPool
+ * ------------------
+ * Champs:
+ *   - free_lists: Objets libres de chaque classe
+ *   - blocks: Blocs alloués (chaînés par leur premier mot)
+ *   - bump / bump_left: Partie du dernier bloc pas encore découpée
+ *   - live: Objets en cours (alloués, pas encore libérés)
+ *   - block_count: Nombre de blocs alloués
+ *   - large: Objets en cours alloués directement (> SLAB_MAX_SIZE)
+ */
+typedef struct {
+    SlabFree *free_lists[SLAB_CLASSES];
+    void *blocks;
+    uint8_t *bump;
+    size_t bump_left;
+    size_t live;
+    size_t block_count;
+    size_t large;
+} SlabPool;
+
+void *slab_alloc(SlabPool *pool, size_t size);
+void slab_release(SlabPool *pool, void *ptr, size_t size);
+void slab_trim(SlabPool *pool);
+void slab_free(SlabPool *pool);
+
+#endif /* SLAB_H */
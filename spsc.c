@@ -0,0 +1,156 @@
+/*
+ * ============================================================================
+ * SPSC - File circulaire sans verrou, un producteur / un consommateur
+ * ============================================================================
+ *
+ * Voir spsc.h pour la description de l'interface.
+ *
+ * ============================================================================
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "spsc.h"
+
+/* En-tête d'un enregistrement: sa longueur */
+#define SPSC_HEADER 4
+
+/* Longueur réservée au marqueur de bouclage */
+#define SPSC_WRAP UINT32_MAX
+
+/* Place occupée par un enregistrement de len octets (aligné sur 8) */
+static size_t record_size(size_t len) {
+    return (SPSC_HEADER + len + 7) & ~(size_t)7;
+}
+
+/*
+ * Fonction spsc_init()
+ * --------------------
+ * Paramètres:
+ *   r - File à initialiser
+ *   capacity - Taille du tampon en octets (arrondie à la puissance de 2
+ *              supérieure)
+ *
+ * Retourne:
+ *   0 en cas de succès, -1 en cas d'erreur d'allocation
+ */
+int spsc_init(SpscRing *r, size_t capacity) {
+    size_t cap = 64;
+    while (cap < capacity) cap *= 2;
+
+    memset(r, 0, sizeof(*r));
+    r->buf = malloc(cap);
+    if (!r->buf) return -1;
+    r->capacity = cap;
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    return 0;
+}
+
+void spsc_free(SpscRing *r) {
+    free(r->buf);
+    r->buf = NULL;
+    r->capacity = 0;
+}
+
+/*
+ * Fonction spsc_reserve()
+ * -----------------------
+ * Producteur: réserve la place d'un enregistrement de len octets. Il n'est
+ * visible du consommateur qu'après spsc_commit().
+ *
+ * Retourne:
+ *   Adresse où écrire les len octets, ou NULL si la file est pleine (ou
+ *   l'enregistrement plus grand que la moitié de la capacité)
+ */
+uint8_t *spsc_reserve(SpscRing *r, size_t len) {
+    size_t size = record_size(len);
+    if (size > r->capacity / 2) return NULL;
+
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    size_t pos = tail & (r->capacity - 1);
+    size_t to_end = r->capacity - pos;
+    size_t needed = size + (to_end < size ? to_end : 0);
+
+    if (r->capacity - (tail - r->head_cache) < needed) {
+        r->head_cache = atomic_load_explicit(&r->head, memory_order_acquire);
+        if (r->capacity - (tail - r->head_cache) < needed) return NULL;
+    }
+
+    /* Pas assez de place avant la fin: marqueur de bouclage, reprise au début */
+    if (to_end < size) {
+        uint32_t wrap = SPSC_WRAP;
+        memcpy(r->buf + pos, &wrap, sizeof(wrap));
+        tail += to_end;
+        pos = 0;
+    }
+
+    uint32_t header = (uint32_t)len;
+    memcpy(r->buf + pos, &header, sizeof(header));
+    r->reserve_pos = tail;
+    r->reserve_len = size;
+    return r->buf + pos + SPSC_HEADER;
+}
+
+/*
+ * Fonction spsc_commit()
+ * ----------------------
+ * Producteur: publie l'enregistrement réservé (et le marqueur de bouclage
+ * éventuel qui le précède).
+ */
+void spsc_commit(SpscRing *r) {
+    atomic_store_explicit(&r->tail, r->reserve_pos + r->reserve_len, memory_order_release);
+}
+
+/*
+ * Fonction spsc_peek()
+ * --------------------
+ * Consommateur: accède au plus ancien enregistrement publié, sans le
+ * retirer de la file.
+ *
+ * Retourne:
+ *   Adresse de l'enregistrement (len octets), ou NULL si la file est vide
+ */
+const uint8_t *spsc_peek(SpscRing *r, size_t *len) {
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    if (head == r->tail_cache) {
+        r->tail_cache = atomic_load_explicit(&r->tail, memory_order_acquire);
+        if (head == r->tail_cache) return NULL;
+    }
+
+    size_t pos = head & (r->capacity - 1);
+    uint32_t header;
+    memcpy(&header, r->buf + pos, sizeof(header));
+    if (header == SPSC_WRAP) {
+        head += r->capacity - pos;
+        pos = 0;
+        memcpy(&header, r->buf, sizeof(header));
+    }
+
+    r->peek_pos = head;
+    r->peek_len = record_size(header);
+    *len = header;
+    return r->buf + pos + SPSC_HEADER;
+}
+
+/*
+ * Fonction spsc_release()
+ * -----------------------
+ * Consommateur: libère l'enregistrement rendu par spsc_peek(); sa place
+ * redevient disponible pour le producteur.
+ */
+void spsc_release(SpscRing *r) {
+    atomic_store_explicit(&r->head, r->peek_pos + r->peek_len, memory_order_release);
+}
+
+/*
+ * Fonction spsc_empty()
+ * ---------------------
+ * Consommateur: indique si aucun enregistrement n'est en attente.
+ */
+int spsc_empty(SpscRing *r) {
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    r->tail_cache = atomic_load_explicit(&r->tail, memory_order_acquire);
+    return head == r->tail_cache;
+}
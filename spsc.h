@@ -0,0 +1,83 @@
+/*
+ * ============================================================================
+ * SPSC - File circulaire sans verrou, un producteur / un consommateur
+ * ============================================================================
+ *
+ * Description:
+ *   Relie deux étages du pipeline de distribution du maître qui tournent
+ *   sur des threads différents: un seul thread écrit (producteur), un seul
+ *   thread lit (consommateur). Aucun verrou n'est nécessaire: chaque
+ *   position n'est modifiée que par son propriétaire et publiée par une
+ *   écriture atomique (sémantique release/acquire).
+ *
+ *   La file transporte des enregistrements de taille variable (trames
+ *   encodées), écrits directement à leur place définitive:
+ *
+ *     Producteur                          Consommateur
+ *     p = spsc_reserve(r, len);           p = spsc_peek(r, &len);
+ *     ... écriture de len octets ...      ... lecture de len octets ...
+ *     spsc_commit(r);                     spsc_release(r);
+ *
+ *   Chaque enregistrement est précédé de sa longueur (4 octets) et aligné
+ *   sur 8 octets. Un enregistrement ne chevauche jamais la fin du tampon:
+ *   s'il n'y tient pas, un marqueur de bouclage renvoie au début.
+ *
+ *   Les positions sont des compteurs d'octets croissants (jamais remis à
+ *   zéro); la place occupée vaut tail - head.
+ *
+ * ============================================================================
+ */
+
+#ifndef SPSC_H
+#define SPSC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+/* Taille d'une ligne de cache: head et tail n'en partagent jamais une */
+#define SPSC_CACHE_LINE 64
+
+/*
+ * Structure SpscRing
+ * ------------------
+ * Champs (par propriétaire):
+ *   - buf / capacity: Tampon circulaire (capacité = puissance de 2)
+ *   - tail: Fin des données publiées (écrite par le producteur)
+ *   - head_cache: Dernière valeur de head vue par le producteur
+ *   - reserve_pos / reserve_len: Enregistrement réservé, pas encore publié
+ *   - head: Début des données non consommées (écrite par le consommateur)
+ *   - tail_cache: Dernière valeur de tail vue par le consommateur
+ *   - peek_pos / peek_len: Enregistrement lu, pas encore libéré
+ *
+ * Les copies locales (head_cache, tail_cache) évitent de relire à chaque
+ * opération la ligne de cache modifiée par l'autre thread.
+ */
+typedef struct {
+    uint8_t *buf;
+    size_t capacity;
+
+    _Alignas(SPSC_CACHE_LINE) _Atomic size_t tail;
+    size_t head_cache;
+    size_t reserve_pos;
+    size_t reserve_len;
+
+    _Alignas(SPSC_CACHE_LINE) _Atomic size_t head;
+    size_t tail_cache;
+    size_t peek_pos;
+    size_t peek_len;
+} SpscRing;
+
+int spsc_init(SpscRing *r, size_t capacity);
+void spsc_free(SpscRing *r);
+
+/* Producteur */
+uint8_t *spsc_reserve(SpscRing *r, size_t len);
+void spsc_commit(SpscRing *r);
+
+/* Consommateur */
+const uint8_t *spsc_peek(SpscRing *r, size_t *len);
+void spsc_release(SpscRing *r);
+int spsc_empty(SpscRing *r);
+
+#endif /* SPSC_H */
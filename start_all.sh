@@ -10,20 +10,36 @@ echo "=========================================="
 SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
 cd "$SCRIPT_DIR"
 
+# Sources of each program (shared modules are listed explicitly)
+SLAVE_SRCS="serveur_esclave.c reactor.c executor.c builtin.c protocol.c batch.c dedup.c output.c metrics.c spsc.c logger.c"
+MASTER_SRCS="serveur_maitre.c reactor.c scheduler.c inflight.c slab.c protocol.c batch.c retry.c spsc.c sender.c deque.c dag.c journal.c cache.c fairshare.c metrics.c logger.c"
+CLIENT_SRCS="client.c protocol.c spsc.c logger.c"
+
+# Returns success if the binary is missing or older than one of its sources/headers
+needs_build() {
+    local target=$1
+    shift
+    [ ! -f "$target" ] && return 0
+    for src in "$@" *.h; do
+        [ "$src" -nt "$target" ] && return 0
+    done
+    return 1
+}
+
 # Compile if needed
-if [ ! -f serveur_esclave ] || [ serveur_esclave.c -nt serveur_esclave ]; then
+if needs_build serveur_esclave $SLAVE_SRCS; then
     echo "Compilation du serveur esclave..."
-    gcc -o serveur_esclave serveur_esclave.c
+    gcc -pthread -o serveur_esclave $SLAVE_SRCS
 fi
 
-if [ ! -f serveur_maitre ] || [ serveur_maitre.c -nt serveur_maitre ]; then
+if needs_build serveur_maitre $MASTER_SRCS; then
     echo "Compilation du serveur maître..."
-    gcc -o serveur_maitre serveur_maitre.c
+    gcc -pthread -o serveur_maitre $MASTER_SRCS
 fi
 
-if [ ! -f client ] || [ client.c -nt client ]; then
+if needs_build client $CLIENT_SRCS; then
     echo "Compilation du client..."
-    gcc -o client client.c
+    gcc -pthread -o client $CLIENT_SRCS
 fi
 
 # Start 3 slave servers